@@ -0,0 +1,112 @@
+#include <optional>
+#include <utility>
+
+#include "bench_cases.hpp"
+#include "habitrpg/app/app_state.hpp"
+#include "habitrpg/app/persistence.hpp"
+#include "habitrpg/app/persistence_worker.hpp"
+#include "habitrpg/app/reward_history.hpp"
+#include "habitrpg/app/user_state_ledger.hpp"
+#include "habitrpg/domain/reward_engine.hpp"
+#include "habitrpg/domain/today_queue.hpp"
+
+namespace habitrpg::bench {
+namespace {
+
+constexpr size_t kDirtyRowsPerSave = 4;  // per track
+
+// Application::LoadStartupState without archival, UI resources, seeding or journal
+// replay: those need the SDL shell or depend on wall-clock time.
+void LoadStartupState(
+    data::SqliteRepository& repository,
+    const domain::RewardEngine& reward_engine,
+    app::AppState* app_state) {
+  app_state->user_state = app::ReplayUserState(repository, repository, reward_engine).user_state;
+  app_state->runtime.life_actions = repository.ListActionUnitsByTrack(domain::TrackType::Life);
+  app_state->runtime.learning_goals = repository.ListLearningGoals();
+  app_state->runtime.learning_sessions = repository.ListLearningSessions();
+  app_state->runtime.milestone_checkpoints = repository.ListMilestoneCheckpoints();
+  app::LoadRecentRewardEvents(repository, app_state);
+  app::ResetPersistedShadow(app_state);
+  app_state->today_queue = domain::TodayQueueService().BuildQueue(
+      app_state->ui_state.queue_mode,
+      app_state->runtime.life_actions,
+      app_state->runtime.learning_sessions);
+}
+
+// What one UI frame of edits leaves behind: a few rows changed and marked dirty on each
+// track.
+void DirtyRows(const size_t iteration, app::AppState* app_state) {
+  auto& runtime = app_state->runtime;
+  for (size_t k = 0; k < kDirtyRowsPerSave; ++k) {
+    const size_t seed = (iteration * kDirtyRowsPerSave + k) * 7919;
+    auto& action = runtime.life_actions[seed % runtime.life_actions.size()];
+    action.priority_score = (action.priority_score + 1) % 200;
+    app::MarkDirty(app_state, action);
+    auto& session = runtime.learning_sessions[seed % runtime.learning_sessions.size()];
+    session.priority_score = (session.priority_score + 1) % 200;
+    app::MarkDirty(app_state, session);
+  }
+  app::MarkMutated(app_state);
+}
+
+}  // namespace
+
+void RunAppBenchmarks(BenchContext& context) {
+  auto& runner = context.runner;
+  const domain::RewardEngine reward_engine;
+
+  std::optional<data::SqliteRepository> startup_repository;
+  std::optional<app::AppState> startup_state;
+  runner.RunWithSetup(
+      "app.startup",
+      [&](size_t) {
+        startup_state.reset();
+        startup_repository.reset();
+      },
+      [&](size_t) {
+        startup_repository.emplace(context.sqlite_path, BenchStorageOptions(2));
+        LoadStartupState(*startup_repository, reward_engine, &startup_state.emplace());
+      });
+  startup_state.reset();
+  startup_repository.reset();
+
+  runner.Run("app.replay_user_state", [&](size_t) {
+    DoNotOptimize(app::ReplayUserState(context.repository, context.repository, reward_engine));
+  });
+
+  if (!runner.Selected("app.collect_change_set") && !runner.Selected("app.persist_runtime_state")) {
+    return;
+  }
+
+  app::AppState app_state{};
+  LoadStartupState(context.repository, reward_engine, &app_state);
+
+  // The UI-thread half of Application::PersistRuntimeState: collecting the dirty rows.
+  runner.RunWithSetup(
+      "app.collect_change_set",
+      [&](const size_t i) { DirtyRows(i, &app_state); },
+      [&](size_t) {
+        auto change_set = app::CollectChangeSet(app_state);
+        app::MarkChangeSetPersisted(&app_state, change_set);
+        DoNotOptimize(change_set);
+      });
+
+  // The whole save: collect, hand off to the write-behind worker and wait for the commit.
+  app::PersistenceWorker worker(context.sqlite_path, BenchStorageOptions(0));
+  runner.RunWithSetup(
+      "app.persist_runtime_state",
+      [&](const size_t i) { DirtyRows(i, &app_state); },
+      [&](size_t) {
+        auto change_set = app::CollectChangeSet(app_state);
+        app::MarkChangeSetPersisted(&app_state, change_set);
+        app_state.submitted_revision = app_state.mutation_revision;
+        worker.Submit(std::move(change_set));
+        worker.Flush();
+        for (auto& result : worker.PollResults()) {
+          app::ApplyPersistenceResult(&app_state, std::move(result));
+        }
+      });
+}
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "bench_dataset.hpp"
+#include "bench_harness.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
+
+namespace habitrpg::bench {
+
+// Shared state for one run: the seeded database and the rows written into it. Cases may
+// update rows in place, but keep the table sizes of the tier.
+struct BenchContext {
+  BenchRunner& runner;
+  BenchDataset& dataset;
+  data::SqliteRepository& repository;
+  std::string sqlite_path;
+};
+
+// Case groups, run in this order: the reads see exactly the seeded tier, and the writes
+// (which append ledger rows and snapshots) come last.
+void RunRepositoryReadBenchmarks(BenchContext& context);   // sqlite.* lookups and lists
+void RunDomainBenchmarks(BenchContext& context);           // domain.* queue, flow, rewards
+void RunAppBenchmarks(BenchContext& context);              // app.* startup, replay, saves
+void RunRepositoryWriteBenchmarks(BenchContext& context);  // sqlite.* upserts and appends
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,251 @@
+#include "bench_compare.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace habitrpg::bench {
+namespace {
+
+// MAD times this estimates the standard deviation of normally distributed samples.
+constexpr double kMadToSigma = 1.4826;
+
+std::vector<double> RepetitionMedians(const CaseResult& result) {
+  return result.repetition_p50_ns.empty() ? std::vector<double>{result.p50_ns} : result.repetition_p50_ns;
+}
+
+double ThresholdFor(const std::string_view name, const CompareOptions& options) {
+  double threshold = options.threshold;
+  size_t matched_length = 0;
+  for (const auto& [prefix, prefix_threshold] : options.prefix_thresholds) {
+    if (name.starts_with(prefix) && prefix.size() >= matched_length) {
+      threshold = prefix_threshold;
+      matched_length = prefix.size();
+    }
+  }
+  return threshold;
+}
+
+std::string FormatDuration(const double ns) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  if (ns >= 1e6) {
+    out << ns / 1e6 << " ms";
+  } else {
+    out << ns / 1e3 << " us";
+  }
+  return out.str();
+}
+
+std::string FormatPercent(const double fraction, const bool signed_value) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1) << (signed_value ? std::showpos : std::noshowpos) << fraction * 100.0
+      << '%';
+  return out.str();
+}
+
+}  // namespace
+
+std::string_view CaseVerdictToString(const CaseVerdict verdict) {
+  switch (verdict) {
+    case CaseVerdict::Unchanged:
+      return "unchanged";
+    case CaseVerdict::Improved:
+      return "improved";
+    case CaseVerdict::Regressed:
+      return "REGRESSED";
+    case CaseVerdict::Missing:
+      return "missing";
+    case CaseVerdict::Added:
+      return "added";
+  }
+  return "unchanged";
+}
+
+double Median(std::vector<double> values) {
+  if (values.empty()) {
+    throw std::invalid_argument("Median of an empty sample set");
+  }
+  const size_t middle = values.size() / 2;
+  std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle), values.end());
+  const double upper = values[middle];
+  if (values.size() % 2 == 1) {
+    return upper;
+  }
+  const double lower = *std::max_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(middle));
+  return (lower + upper) / 2.0;
+}
+
+double MedianAbsoluteDeviation(const std::vector<double>& values) {
+  const double center = Median(values);
+  std::vector<double> deviations;
+  deviations.reserve(values.size());
+  for (const double value : values) {
+    deviations.push_back(std::abs(value - center));
+  }
+  return Median(std::move(deviations));
+}
+
+BenchReport MergeReports(const std::vector<BenchReport>& runs) {
+  if (runs.empty()) {
+    throw std::invalid_argument("No benchmark runs to merge");
+  }
+  if (runs.size() == 1) {
+    return runs.front();
+  }
+
+  BenchReport merged = runs.front();
+  merged.cases.clear();
+  merged.repetitions = 0;
+
+  std::unordered_map<std::string, std::vector<const CaseResult*>> runs_by_case;
+  std::vector<std::string> order;
+  for (const auto& run : runs) {
+    if (run.tier != merged.tier) {
+      throw std::invalid_argument("Cannot merge benchmark runs from different tiers");
+    }
+    merged.repetitions += run.repetitions;
+    for (const auto& result : run.cases) {
+      auto& entries = runs_by_case[result.name];
+      if (entries.empty()) {
+        order.push_back(result.name);
+      }
+      entries.push_back(&result);
+    }
+  }
+
+  for (const auto& name : order) {
+    const auto& entries = runs_by_case.at(name);
+    const auto across_runs = [&entries](double CaseResult::*field) {
+      std::vector<double> values;
+      for (const auto* entry : entries) {
+        values.push_back(entry->*field);
+      }
+      return Median(std::move(values));
+    };
+
+    CaseResult pooled{};
+    pooled.name = name;
+    pooled.rows = entries.front()->rows;
+    pooled.iterations = entries.front()->iterations;
+    pooled.p50_ns = across_runs(&CaseResult::p50_ns);
+    pooled.p90_ns = across_runs(&CaseResult::p90_ns);
+    pooled.p99_ns = across_runs(&CaseResult::p99_ns);
+    pooled.mean_ns = across_runs(&CaseResult::mean_ns);
+    pooled.min_ns = entries.front()->min_ns;
+    pooled.max_ns = entries.front()->max_ns;
+    for (const auto* entry : entries) {
+      pooled.min_ns = std::min(pooled.min_ns, entry->min_ns);
+      pooled.max_ns = std::max(pooled.max_ns, entry->max_ns);
+      const auto medians = RepetitionMedians(*entry);
+      pooled.repetition_p50_ns.insert(pooled.repetition_p50_ns.end(), medians.begin(), medians.end());
+    }
+    merged.cases.push_back(std::move(pooled));
+  }
+  return merged;
+}
+
+ComparisonReport CompareReports(
+    const BenchReport& baseline,
+    const BenchReport& candidate,
+    const CompareOptions& options) {
+  if (baseline.tier != candidate.tier) {
+    throw std::invalid_argument(
+        "Cannot compare a " + std::string(ScaleTierToString(baseline.tier)) + " baseline with a " +
+        std::string(ScaleTierToString(candidate.tier)) + " run");
+  }
+
+  const auto selected = [&options](const std::string& name) {
+    return options.filter.empty() || name.find(options.filter) != std::string::npos;
+  };
+
+  std::unordered_map<std::string, const CaseResult*> candidate_cases;
+  for (const auto& result : candidate.cases) {
+    candidate_cases.emplace(result.name, &result);
+  }
+
+  ComparisonReport report{};
+  for (const auto& base : baseline.cases) {
+    if (!selected(base.name)) {
+      continue;
+    }
+
+    CaseComparison comparison{};
+    comparison.name = base.name;
+    const auto base_medians = RepetitionMedians(base);
+    comparison.baseline_median_ns = Median(base_medians);
+    comparison.baseline_mad_ns = MedianAbsoluteDeviation(base_medians);
+    comparison.threshold = ThresholdFor(base.name, options);
+
+    const auto found = candidate_cases.find(base.name);
+    if (found == candidate_cases.end()) {
+      comparison.verdict = CaseVerdict::Missing;
+      report.cases.push_back(std::move(comparison));
+      continue;
+    }
+    const auto candidate_medians = RepetitionMedians(*found->second);
+    candidate_cases.erase(found);
+    comparison.candidate_median_ns = Median(candidate_medians);
+    comparison.candidate_mad_ns = MedianAbsoluteDeviation(candidate_medians);
+
+    const double reference = std::max(comparison.baseline_median_ns, 1.0);
+    const double shift_ns = comparison.candidate_median_ns - comparison.baseline_median_ns;
+    const double noise_ns = options.noise_factor * kMadToSigma *
+                            std::hypot(comparison.baseline_mad_ns, comparison.candidate_mad_ns);
+    comparison.delta = shift_ns / reference;
+    comparison.noise = noise_ns / reference;
+
+    if (comparison.delta > comparison.threshold && shift_ns > noise_ns) {
+      comparison.verdict = CaseVerdict::Regressed;
+      ++report.regressions;
+    } else if (-comparison.delta > comparison.threshold && -shift_ns > noise_ns) {
+      comparison.verdict = CaseVerdict::Improved;
+      ++report.improvements;
+    }
+    report.cases.push_back(std::move(comparison));
+  }
+
+  for (const auto& result : candidate.cases) {
+    if (candidate_cases.contains(result.name) && selected(result.name)) {
+      CaseComparison comparison{};
+      comparison.name = result.name;
+      comparison.verdict = CaseVerdict::Added;
+      const auto medians = RepetitionMedians(result);
+      comparison.candidate_median_ns = Median(medians);
+      comparison.candidate_mad_ns = MedianAbsoluteDeviation(medians);
+      report.cases.push_back(std::move(comparison));
+    }
+  }
+  return report;
+}
+
+void WriteComparison(std::ostream& out, const ComparisonReport& report) {
+  size_t name_width = 4;
+  for (const auto& comparison : report.cases) {
+    name_width = std::max(name_width, comparison.name.size());
+  }
+
+  out << std::left << std::setw(static_cast<int>(name_width)) << "case" << std::right << std::setw(14) << "baseline"
+      << std::setw(14) << "candidate" << std::setw(10) << "delta" << std::setw(10) << "noise" << std::setw(10)
+      << "limit" << "  verdict\n";
+  for (const auto& comparison : report.cases) {
+    const bool compared =
+        comparison.verdict != CaseVerdict::Missing && comparison.verdict != CaseVerdict::Added;
+    const bool has_baseline = comparison.verdict != CaseVerdict::Added;
+    const bool has_candidate = comparison.verdict != CaseVerdict::Missing;
+    out << std::left << std::setw(static_cast<int>(name_width)) << comparison.name << std::right;
+    out << std::setw(14) << (has_baseline ? FormatDuration(comparison.baseline_median_ns) : "-");
+    out << std::setw(14) << (has_candidate ? FormatDuration(comparison.candidate_median_ns) : "-");
+    out << std::setw(10) << (compared ? FormatPercent(comparison.delta, true) : "-");
+    out << std::setw(10) << (compared ? FormatPercent(comparison.noise, false) : "-");
+    out << std::setw(10) << (has_baseline ? FormatPercent(comparison.threshold, false) : "-");
+    out << "  " << CaseVerdictToString(comparison.verdict) << '\n';
+  }
+  out << report.regressions << " regressed, " << report.improvements << " improved, " << report.cases.size()
+      << " cases\n";
+}
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench_report.hpp"
+
+namespace habitrpg::bench {
+
+// A case regresses when its median over the per-repetition medians slowed down by more
+// than the threshold *and* by more than the noise band, noise_factor scaled MADs of the
+// two runs combined. One-repetition runs have no spread, so only the threshold applies.
+struct CompareOptions {
+  double threshold{0.10};  // relative slowdown of the median, 0.10 = 10%
+  double noise_factor{3.0};
+  // Looser (or tighter) thresholds for noisy groups: the longest matching name prefix wins.
+  std::vector<std::pair<std::string, double>> prefix_thresholds{};
+  std::string filter{};  // compare only cases whose name contains this
+};
+
+enum class CaseVerdict {
+  Unchanged,
+  Improved,
+  Regressed,
+  Missing,  // in the baseline only
+  Added,    // in the candidate only
+};
+
+std::string_view CaseVerdictToString(CaseVerdict verdict);
+
+struct CaseComparison {
+  std::string name{};
+  CaseVerdict verdict{CaseVerdict::Unchanged};
+  double baseline_median_ns{0.0};
+  double baseline_mad_ns{0.0};
+  double candidate_median_ns{0.0};
+  double candidate_mad_ns{0.0};
+  double delta{0.0};      // relative change of the median, +0.12 = 12% slower
+  double noise{0.0};      // noise band relative to the baseline median
+  double threshold{0.0};  // threshold applied to this case
+};
+
+struct ComparisonReport {
+  std::vector<CaseComparison> cases{};  // baseline order, then added cases
+  size_t regressions{0};
+  size_t improvements{0};
+};
+
+double Median(std::vector<double> values);
+double MedianAbsoluteDeviation(const std::vector<double>& values);
+
+// Pools repeated runs of one tier into a single report: each case keeps the repetition
+// medians of every run, so drift between runs (not only within one) widens its noise
+// band. p50/p90/p99/mean are the median across runs, min/max the extremes. Throws
+// std::invalid_argument when `runs` is empty or mixes tiers.
+BenchReport MergeReports(const std::vector<BenchReport>& runs);
+
+// Throws std::invalid_argument when the reports come from different scale tiers.
+ComparisonReport CompareReports(
+    const BenchReport& baseline,
+    const BenchReport& candidate,
+    const CompareOptions& options = {});
+
+void WriteComparison(std::ostream& out, const ComparisonReport& report);
+
+}  // namespace habitrpg::bench
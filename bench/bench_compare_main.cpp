@@ -0,0 +1,142 @@
+#include <charconv>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "bench_compare.hpp"
+#include "bench_report.hpp"
+
+namespace {
+
+using habitrpg::bench::CompareOptions;
+
+constexpr std::string_view kUsage =
+    "Usage: habitrpg_bench_compare BASELINE CANDIDATE [--baseline FILE]... [--candidate FILE]...\n"
+    "                              [--threshold PCT] [--noise-factor K] [--threshold-for PREFIX=PCT]...\n"
+    "                              [--filter TEXT]\n"
+    "       habitrpg_bench_compare --merge OUTPUT RUN...\n"
+    "  BASELINE, CANDIDATE  habitrpg_bench results (JSON or CSV) from the same tier\n"
+    "  --baseline, --candidate  further runs pooled into that side\n"
+    "  --threshold          slowdown of a case's median that fails the run, in percent (default 10)\n"
+    "  --noise-factor       the slowdown must also exceed K scaled MADs of both runs (default 3)\n"
+    "  --threshold-for      threshold for cases whose name starts with PREFIX; repeatable\n"
+    "  --filter             compare only cases whose name contains TEXT\n"
+    "  --merge              pool RUN files into one JSON report (e.g. a new baseline) and exit\n"
+    "Exits 1 when a case regressed, 2 on bad arguments or unreadable reports.\n";
+
+struct CommandLine {
+  std::vector<std::string> baseline_paths{};
+  std::vector<std::string> candidate_paths{};
+  std::vector<std::string> merge_paths{};
+  std::string merge_output{};
+  CompareOptions options{};
+};
+
+std::optional<double> ParseNonNegative(const std::string_view text) {
+  double value = 0.0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc{} || end != text.data() + text.size() || value < 0.0) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<CommandLine> ParseCommandLine(const int argc, char** argv) {
+  CommandLine command_line{};
+  std::vector<std::string_view> paths;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view argument = argv[i];
+    if (!argument.starts_with("--")) {
+      paths.push_back(argument);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      return std::nullopt;
+    }
+    const std::string_view value = argv[++i];
+
+    if (argument == "--baseline") {
+      command_line.baseline_paths.emplace_back(value);
+    } else if (argument == "--candidate") {
+      command_line.candidate_paths.emplace_back(value);
+    } else if (argument == "--merge") {
+      command_line.merge_output = value;
+    } else if (argument == "--threshold" && ParseNonNegative(value).has_value()) {
+      command_line.options.threshold = *ParseNonNegative(value) / 100.0;
+    } else if (argument == "--noise-factor" && ParseNonNegative(value).has_value()) {
+      command_line.options.noise_factor = *ParseNonNegative(value);
+    } else if (argument == "--threshold-for") {
+      const size_t separator = value.rfind('=');
+      const auto percent =
+          separator == std::string_view::npos ? std::nullopt : ParseNonNegative(value.substr(separator + 1));
+      if (!percent.has_value()) {
+        return std::nullopt;
+      }
+      command_line.options.prefix_thresholds.emplace_back(std::string(value.substr(0, separator)), *percent / 100.0);
+    } else if (argument == "--filter") {
+      command_line.options.filter = value;
+    } else {
+      return std::nullopt;
+    }
+  }
+
+  if (!command_line.merge_output.empty()) {
+    command_line.merge_paths.assign(paths.begin(), paths.end());
+    return command_line.merge_paths.empty() ? std::nullopt : std::optional<CommandLine>(command_line);
+  }
+  if (paths.size() == 2) {
+    command_line.baseline_paths.emplace(command_line.baseline_paths.begin(), paths[0]);
+    command_line.candidate_paths.emplace(command_line.candidate_paths.begin(), paths[1]);
+  } else if (!paths.empty()) {
+    return std::nullopt;
+  }
+  if (command_line.baseline_paths.empty() || command_line.candidate_paths.empty()) {
+    return std::nullopt;
+  }
+  return command_line;
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  namespace bench = habitrpg::bench;
+
+  const auto command_line = ParseCommandLine(argc, argv);
+  if (!command_line.has_value()) {
+    std::cerr << kUsage;
+    return 2;
+  }
+
+  const auto read_runs = [](const std::vector<std::string>& paths) {
+    std::vector<bench::BenchReport> runs;
+    for (const auto& path : paths) {
+      runs.push_back(bench::ReadReportFile(path));
+    }
+    return bench::MergeReports(runs);
+  };
+
+  try {
+    if (!command_line->merge_output.empty()) {
+      std::ofstream out(command_line->merge_output, std::ios::trunc);
+      bench::WriteJson(out, read_runs(command_line->merge_paths));
+      if (!out) {
+        std::cerr << "Cannot write " << command_line->merge_output << '\n';
+        return 2;
+      }
+      return 0;
+    }
+
+    const auto baseline = read_runs(command_line->baseline_paths);
+    const auto candidate = read_runs(command_line->candidate_paths);
+    const auto comparison = bench::CompareReports(baseline, candidate, command_line->options);
+    bench::WriteComparison(std::cout, comparison);
+    return comparison.regressions > 0 ? 1 : 0;
+  } catch (const std::exception& ex) {
+    std::cerr << "Benchmark comparison failed: " << ex.what() << '\n';
+    return 2;
+  }
+}
@@ -0,0 +1,183 @@
+#include "bench_dataset.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <system_error>
+
+namespace habitrpg::bench {
+namespace {
+
+constexpr int64_t kDatasetEpochMs = 1'704'067'200'000;  // 2024-01-01T00:00:00Z
+constexpr int64_t kRewardSpacingMs = 5 * 60 * 1000;
+constexpr size_t kSeedBatchRows = 10'000;
+
+constexpr std::array<domain::LifecycleState, 4> kPendingStates{
+    domain::LifecycleState::Ready,
+    domain::LifecycleState::Partial,
+    domain::LifecycleState::Paused,
+    domain::LifecycleState::Missed,
+};
+
+std::string Timestamp(const size_t index) {
+  return domain::FormatTimestampUtcMs(kDatasetEpochMs + static_cast<int64_t>(index) * kRewardSpacingMs);
+}
+
+std::string Title(const std::string_view kind, const size_t index) {
+  return std::string(kind) + " " + std::to_string(index) + " on topic" + std::to_string(index % 1000) +
+         " with spaced review";
+}
+
+domain::LifecycleState StateFor(const size_t index) {
+  return index % 4 == 3 ? domain::LifecycleState::Completed : kPendingStates[(index / 4) % kPendingStates.size()];
+}
+
+template <typename Row, typename Write>
+void WriteInBatches(const std::vector<Row>& rows, const Write& write) {
+  const std::span<const Row> all(rows);
+  for (size_t begin = 0; begin < all.size(); begin += kSeedBatchRows) {
+    write(all.subspan(begin, std::min(kSeedBatchRows, all.size() - begin)));
+  }
+}
+
+}  // namespace
+
+BenchDataset BuildDataset(const size_t rows) {
+  BenchDataset dataset{};
+  const size_t goal_count = std::max<size_t>(1, rows / 100);
+  const size_t checkpoint_count = std::max<size_t>(1, rows / 10);
+
+  dataset.habits.reserve(rows);
+  dataset.quests.reserve(rows);
+  dataset.life_actions.reserve(rows);
+  dataset.learning_goals.reserve(goal_count);
+  dataset.learning_sessions.reserve(rows);
+  dataset.milestone_checkpoints.reserve(checkpoint_count);
+  dataset.reward_events.reserve(rows);
+
+  for (size_t i = 0; i < rows; ++i) {
+    domain::Habit habit{};
+    habit.id = "bench_habit_" + std::to_string(i);
+    habit.title = Title("Habit", i);
+    habit.cadence = i % 7 == 0 ? "weekly" : "daily";
+    habit.is_active = i % 10 != 0;
+    habit.created_at = Timestamp(i);
+    dataset.habits.push_back(std::move(habit));
+
+    domain::Quest quest{};
+    quest.id = "bench_quest_" + std::to_string(i);
+    quest.title = Title("Quest", i);
+    quest.track_type = i % 2 == 0 ? domain::TrackType::Life : domain::TrackType::Learning;
+    quest.is_completed = i % 4 == 3;
+    quest.created_at = Timestamp(i);
+    dataset.quests.push_back(std::move(quest));
+
+    domain::ActionUnit action{};
+    action.id = "bench_action_" + std::to_string(i);
+    action.parent_id = "bench_quest_" + std::to_string(i);
+    action.title = Title("Action", i);
+    action.lifecycle_state = StateFor(i);
+    action.priority_score = static_cast<int>((i * 37) % 200);
+    if (action.lifecycle_state == domain::LifecycleState::Completed) {
+      action.status = domain::ActionStatus::Completed;
+      action.started_at = Timestamp(i);
+      action.completed_at = Timestamp(i + 1);
+    }
+    dataset.life_actions.push_back(std::move(action));
+
+    domain::LearningSession session{};
+    session.id = "bench_session_" + std::to_string(i);
+    session.goal_id = "bench_goal_" + std::to_string(i % goal_count);
+    session.title = Title("Session", i);
+    session.lifecycle_state = StateFor(i + 1);
+    session.priority_score = static_cast<int>((i * 53) % 200);
+    session.duration_minutes = 15 + static_cast<int>(i % 4) * 15;
+    session.artifact_kind = "note";
+    session.artifact_ref = "notes/session_" + std::to_string(i) + ".md";
+    if (session.lifecycle_state == domain::LifecycleState::Completed) {
+      session.checkpoint_note = "Summarised topic" + std::to_string(i % 1000) + " and listed open questions";
+      session.started_at = Timestamp(i);
+      session.completed_at = Timestamp(i + 1);
+    }
+    dataset.learning_sessions.push_back(std::move(session));
+
+    domain::RewardEvent reward{};
+    reward.id = "bench_reward_" + std::to_string(i);
+    reward.track_type = i % 2 == 0 ? domain::TrackType::Life : domain::TrackType::Learning;
+    reward.source_type = reward.track_type == domain::TrackType::Life ? "action_unit" : "learning_session";
+    reward.source_id = reward.track_type == domain::TrackType::Life ? "bench_action_" + std::to_string(i)
+                                                                    : "bench_session_" + std::to_string(i);
+    reward.xp_delta = reward.track_type == domain::TrackType::Life ? 12 : 16 + static_cast<int>(i % 4) * 2;
+    reward.reward_kind = reward.track_type == domain::TrackType::Life ? "action_completion" : "session_completion";
+    reward.created_at = Timestamp(i);
+    dataset.reward_events.push_back(std::move(reward));
+  }
+
+  for (size_t i = 0; i < goal_count; ++i) {
+    domain::LearningGoal goal{};
+    goal.id = "bench_goal_" + std::to_string(i);
+    goal.title = Title("Goal", i);
+    goal.milestone = "Explain topic" + std::to_string(i % 1000) + " without notes";
+    goal.confidence_level = static_cast<int>(i % 5) + 1;
+    goal.created_at = Timestamp(i);
+    dataset.learning_goals.push_back(std::move(goal));
+  }
+
+  for (size_t i = 0; i < checkpoint_count; ++i) {
+    const size_t session_index = (i * 10) % rows;
+    domain::MilestoneCheckpoint checkpoint{};
+    checkpoint.id = "bench_checkpoint_" + std::to_string(i);
+    checkpoint.goal_id = dataset.learning_sessions[session_index].goal_id;
+    checkpoint.learning_session_id = dataset.learning_sessions[session_index].id;
+    checkpoint.milestone_key = "milestone_" + std::to_string(i % 100);
+    checkpoint.state = i % 3 == 0 ? domain::MilestoneCheckpointState::Confirmed
+                                  : domain::MilestoneCheckpointState::Candidate;
+    checkpoint.evidence_kind = "note";
+    checkpoint.evidence_ref = "evidence/topic" + std::to_string(i % 1000) + ".md";
+    checkpoint.confidence_level = static_cast<int>(i % 5) + 1;
+    checkpoint.candidate_reason = "Session covered topic" + std::to_string(i % 1000);
+    // reward_event_id is UNIQUE and an empty id is stored as '', so every row gets its own.
+    checkpoint.reward_event_id = "reward_milestone_" + checkpoint.id.str();
+    checkpoint.submitted_at = Timestamp(session_index);
+    checkpoint.created_at = Timestamp(session_index);
+    checkpoint.updated_at = Timestamp(session_index);
+    dataset.milestone_checkpoints.push_back(std::move(checkpoint));
+  }
+  return dataset;
+}
+
+void SeedRepository(const BenchDataset& dataset, data::SqliteRepository* repository) {
+  WriteInBatches(dataset.habits, [&](const auto batch) { repository->UpsertHabits(batch); });
+  WriteInBatches(dataset.quests, [&](const auto batch) { repository->UpsertQuests(batch); });
+  WriteInBatches(dataset.life_actions, [&](const auto batch) { repository->UpsertActionUnits(batch); });
+  WriteInBatches(dataset.learning_goals, [&](const auto batch) { repository->UpsertLearningGoals(batch); });
+  WriteInBatches(dataset.learning_sessions, [&](const auto batch) { repository->UpsertLearningSessions(batch); });
+  WriteInBatches(
+      dataset.milestone_checkpoints,
+      [&](const auto batch) { repository->UpsertMilestoneCheckpoints(batch); });
+  WriteInBatches(dataset.reward_events, [&](const auto batch) { repository->AppendRewardEvents(batch); });
+}
+
+data::SqliteRepositoryOptions BenchStorageOptions(const size_t read_connections) {
+  data::SqliteRepositoryOptions options{};
+  options.enable_wal = true;
+  options.read_connections = read_connections;
+  return options;
+}
+
+std::string BuildBenchDbPath(const std::string_view tag) {
+  const auto temp_dir = std::filesystem::temp_directory_path();
+  const auto file_name = "habitrpg_bench_" + std::string(tag) + "_" + domain::GenerateStableId("db") + ".sqlite3";
+  return (temp_dir / file_name).string();
+}
+
+void RemoveBenchDb(const std::string& sqlite_path) {
+  std::error_code ignored;
+  for (const char* suffix : {"", "-wal", "-shm"}) {
+    std::filesystem::remove(sqlite_path + suffix, ignored);
+  }
+}
+
+}  // namespace habitrpg::bench
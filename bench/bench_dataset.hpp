@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "habitrpg/data/sqlite_repository.hpp"
+#include "habitrpg/domain/entities.hpp"
+
+namespace habitrpg::bench {
+
+// Deterministic rows for one scale tier: `rows` habits, quests, life actions, learning
+// sessions and reward events, one learning goal per 100 sessions and one milestone
+// checkpoint per 10. A quarter of the actions and sessions are completed; the rest are
+// spread over the pending lifecycle states. Titles carry a "topicN" word (N < 1000) so a
+// search for one topic matches about rows / 1000 entries.
+struct BenchDataset {
+  std::vector<domain::Habit> habits{};
+  std::vector<domain::Quest> quests{};
+  std::vector<domain::ActionUnit> life_actions{};
+  std::vector<domain::LearningGoal> learning_goals{};
+  std::vector<domain::LearningSession> learning_sessions{};
+  std::vector<domain::MilestoneCheckpoint> milestone_checkpoints{};
+  std::vector<domain::RewardEvent> reward_events{};  // oldest first
+};
+
+BenchDataset BuildDataset(size_t rows);
+
+// Writes the dataset through the batch upserts, in bounded transactions.
+void SeedRepository(const BenchDataset& dataset, data::SqliteRepository* repository);
+
+// Same storage tuning as Application, so timings match what the app sees.
+data::SqliteRepositoryOptions BenchStorageOptions(size_t read_connections);
+
+std::string BuildBenchDbPath(std::string_view tag);
+
+// Removes the database file and its WAL/SHM side files.
+void RemoveBenchDb(const std::string& sqlite_path);
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,90 @@
+#include "bench_harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+
+namespace habitrpg::bench {
+
+double Percentile(const std::vector<double>& sorted, const double fraction) {
+  if (sorted.empty()) {
+    throw std::invalid_argument("Percentile of an empty sample set");
+  }
+  const double rank = std::clamp(fraction, 0.0, 1.0) * static_cast<double>(sorted.size() - 1);
+  const auto lower = static_cast<size_t>(std::floor(rank));
+  const size_t upper = std::min(lower + 1, sorted.size() - 1);
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - static_cast<double>(lower));
+}
+
+CaseResult SummarizeCase(std::string name, const size_t rows, std::vector<std::vector<double>> repetitions) {
+  CaseResult result{};
+  result.name = std::move(name);
+  result.rows = rows;
+
+  std::vector<double> all_samples;
+  for (auto& samples : repetitions) {
+    if (samples.empty()) {
+      continue;
+    }
+    result.iterations = samples.size();
+    std::sort(samples.begin(), samples.end());
+    result.repetition_p50_ns.push_back(Percentile(samples, 0.5));
+    all_samples.insert(all_samples.end(), samples.begin(), samples.end());
+  }
+  if (all_samples.empty()) {
+    throw std::invalid_argument("Benchmark case " + result.name + " recorded no samples");
+  }
+
+  std::sort(all_samples.begin(), all_samples.end());
+  result.p50_ns = Percentile(all_samples, 0.50);
+  result.p90_ns = Percentile(all_samples, 0.90);
+  result.p99_ns = Percentile(all_samples, 0.99);
+  result.min_ns = all_samples.front();
+  result.max_ns = all_samples.back();
+  result.mean_ns = std::accumulate(all_samples.begin(), all_samples.end(), 0.0) /
+                   static_cast<double>(all_samples.size());
+  return result;
+}
+
+BenchRunner::BenchRunner(BenchOptions options) : options_(std::move(options)) {
+  if (options_.repetitions == 0) {
+    throw std::invalid_argument("Benchmark repetitions must be positive");
+  }
+}
+
+bool BenchRunner::Selected(const std::string_view name) const {
+  if (options_.filter.empty()) {
+    return true;
+  }
+  const std::string_view filter = options_.filter;
+  size_t begin = 0;
+  while (begin <= filter.size()) {
+    const size_t end = std::min(filter.find(',', begin), filter.size());
+    const auto pattern = filter.substr(begin, end - begin);
+    if (!pattern.empty() && name.find(pattern) != std::string_view::npos) {
+      return true;
+    }
+    begin = end + 1;
+  }
+  return false;
+}
+
+size_t BenchRunner::IterationsFor(const double probe_ns) const {
+  const double budget_ns = std::chrono::duration<double, std::nano>(options_.repetition_budget).count();
+  const double fitting = budget_ns / std::max(probe_ns, 1.0);
+  return static_cast<size_t>(std::clamp(fitting, 1.0, static_cast<double>(kMaxIterations)));
+}
+
+void BenchRunner::Record(std::string name, std::vector<std::vector<double>> repetitions) {
+  results_.push_back(SummarizeCase(std::move(name), rows(), std::move(repetitions)));
+  if (options_.progress != nullptr) {
+    const auto& result = results_.back();
+    *options_.progress << std::fixed << std::setprecision(1) << result.name << ": p50 " << result.p50_ns / 1000.0
+                       << " us, p99 " << result.p99_ns / 1000.0 << " us (" << result.iterations << " x "
+                       << options_.repetitions << ")\n";
+  }
+}
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "bench_report.hpp"
+
+namespace habitrpg::bench {
+
+struct BenchOptions {
+  ScaleTier tier{ScaleTier::Small};
+  size_t repetitions{5};
+  // Time one repetition of a case aims for; the iteration count is derived from it.
+  std::chrono::milliseconds repetition_budget{100};
+  std::string filter{};  // comma-separated substrings of case names; empty runs every case
+  std::ostream* progress{nullptr};  // one line per finished case when set
+};
+
+// Keeps a computed value observable so the optimizer cannot drop the work behind it.
+template <typename Value>
+inline void DoNotOptimize(const Value& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+// Linear interpolation between closest ranks; `sorted` must be ascending and non-empty.
+double Percentile(const std::vector<double>& sorted, double fraction);
+
+CaseResult SummarizeCase(std::string name, size_t rows, std::vector<std::vector<double>> repetitions);
+
+// Runs cases one after another on the calling thread. A case is warmed up once, then
+// timed for `repetitions` rounds of the same iteration count, one sample per call.
+class BenchRunner final {
+ public:
+  static constexpr size_t kMaxIterations = 10000;
+
+  explicit BenchRunner(BenchOptions options);
+
+  const BenchOptions& options() const { return options_; }
+  size_t rows() const { return RowsForTier(options_.tier); }
+  bool Selected(std::string_view name) const;
+  const std::vector<CaseResult>& results() const { return results_; }
+
+  template <typename Body>
+  void Run(std::string name, Body&& body) {
+    RunWithSetup(std::move(name), [](size_t) {}, body);
+  }
+
+  // `setup(iteration)` runs untimed before each timed `body(iteration)`.
+  template <typename Setup, typename Body>
+  void RunWithSetup(std::string name, Setup&& setup, Body&& body) {
+    if (!Selected(name)) {
+      return;
+    }
+
+    size_t iteration = 0;
+    setup(iteration);
+    const double probe_ns = Time(body, iteration++);
+    const size_t iterations = IterationsFor(probe_ns);
+
+    std::vector<std::vector<double>> repetitions(options_.repetitions);
+    for (auto& samples : repetitions) {
+      samples.reserve(iterations);
+      for (size_t i = 0; i < iterations; ++i) {
+        setup(iteration);
+        samples.push_back(Time(body, iteration++));
+      }
+    }
+    Record(std::move(name), std::move(repetitions));
+  }
+
+ private:
+  template <typename Body>
+  static double Time(Body& body, const size_t iteration) {
+    const auto start = std::chrono::steady_clock::now();
+    body(iteration);
+    const auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(stop - start).count();
+  }
+
+  size_t IterationsFor(double probe_ns) const;
+  void Record(std::string name, std::vector<std::vector<double>> repetitions);
+
+  BenchOptions options_;
+  std::vector<CaseResult> results_{};
+};
+
+}  // namespace habitrpg::bench
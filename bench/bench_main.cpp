@@ -0,0 +1,144 @@
+#include <sqlite3.h>
+
+#include <charconv>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "bench_cases.hpp"
+#include "bench_dataset.hpp"
+#include "bench_harness.hpp"
+#include "habitrpg/domain/entities.hpp"
+
+#ifndef HABITRPG_BENCH_BUILD_TYPE
+#define HABITRPG_BENCH_BUILD_TYPE ""
+#endif
+
+namespace {
+
+using habitrpg::bench::BenchOptions;
+
+constexpr std::string_view kUsage =
+    "Usage: habitrpg_bench [--tier small|medium|large] [--format json|csv] [--output FILE]\n"
+    "                      [--filter TEXT] [--repetitions N] [--budget-ms N]\n"
+    "  --tier         rows per table: small = 1k, medium = 100k, large = 1M (default small)\n"
+    "  --format       result format (default json)\n"
+    "  --output       write results to FILE instead of stdout\n"
+    "  --filter       run only cases whose name contains TEXT (comma-separated alternatives)\n"
+    "  --repetitions  timed rounds per case (default 5)\n"
+    "  --budget-ms    target time of one round; sets the iterations per round (default 100)\n";
+
+struct CommandLine {
+  BenchOptions options{};
+  std::string format{"json"};
+  std::string output_path{};
+};
+
+std::optional<size_t> ParseCount(const std::string_view text) {
+  size_t value = 0;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+  if (error != std::errc{} || end != text.data() + text.size() || value == 0) {
+    return std::nullopt;
+  }
+  return value;
+}
+
+std::optional<CommandLine> ParseCommandLine(const int argc, char** argv) {
+  CommandLine command_line{};
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view flag = argv[i];
+    if (i + 1 >= argc) {
+      return std::nullopt;
+    }
+    const std::string_view value = argv[++i];
+
+    if (flag == "--tier") {
+      const auto tier = habitrpg::bench::ScaleTierFromString(value);
+      if (!tier.has_value()) {
+        return std::nullopt;
+      }
+      command_line.options.tier = *tier;
+    } else if (flag == "--format" && (value == "json" || value == "csv")) {
+      command_line.format = value;
+    } else if (flag == "--output") {
+      command_line.output_path = value;
+    } else if (flag == "--filter") {
+      command_line.options.filter = value;
+    } else if (flag == "--repetitions" && ParseCount(value).has_value()) {
+      command_line.options.repetitions = *ParseCount(value);
+    } else if (flag == "--budget-ms" && ParseCount(value).has_value()) {
+      command_line.options.repetition_budget = std::chrono::milliseconds(*ParseCount(value));
+    } else {
+      return std::nullopt;
+    }
+  }
+  return command_line;
+}
+
+}  // namespace
+
+int main(const int argc, char** argv) {
+  namespace bench = habitrpg::bench;
+
+  const auto command_line = ParseCommandLine(argc, argv);
+  if (!command_line.has_value()) {
+    std::cerr << kUsage;
+    return 2;
+  }
+
+  const std::string sqlite_path = bench::BuildBenchDbPath(bench::ScaleTierToString(command_line->options.tier));
+  try {
+    auto options = command_line->options;
+    options.progress = &std::cerr;
+    bench::BenchRunner runner(std::move(options));
+    std::cerr << "Seeding " << runner.rows() << " rows per table into " << sqlite_path << '\n';
+    auto dataset = bench::BuildDataset(runner.rows());
+
+    bench::BenchReport report{};
+    {
+      habitrpg::data::SqliteRepository repository(sqlite_path, bench::BenchStorageOptions(2));
+      bench::SeedRepository(dataset, &repository);
+
+      bench::BenchContext context{runner, dataset, repository, sqlite_path};
+      bench::RunRepositoryReadBenchmarks(context);
+      bench::RunDomainBenchmarks(context);
+      bench::RunAppBenchmarks(context);
+      bench::RunRepositoryWriteBenchmarks(context);
+    }
+    bench::RemoveBenchDb(sqlite_path);
+
+    report.tier = command_line->options.tier;
+    report.rows = runner.rows();
+    report.repetitions = command_line->options.repetitions;
+    report.build_type = HABITRPG_BENCH_BUILD_TYPE;
+    report.sqlite_version = sqlite3_libversion();
+    report.recorded_at = habitrpg::domain::CurrentTimestampUtc();
+    report.cases = runner.results();
+
+    std::ofstream file;
+    if (!command_line->output_path.empty()) {
+      file.open(command_line->output_path, std::ios::trunc);
+      if (!file) {
+        std::cerr << "Cannot write " << command_line->output_path << '\n';
+        return 1;
+      }
+    }
+    std::ostream& out = file.is_open() ? static_cast<std::ostream&>(file) : std::cout;
+    if (command_line->format == "csv") {
+      bench::WriteCsv(out, report);
+    } else {
+      bench::WriteJson(out, report);
+    }
+    std::cerr << "Ran " << report.cases.size() << " cases\n";
+    return out ? 0 : 1;
+  } catch (const std::exception& ex) {
+    bench::RemoveBenchDb(sqlite_path);
+    std::cerr << "Benchmark failed: " << ex.what() << '\n';
+    return 1;
+  }
+}
@@ -0,0 +1,512 @@
+#include "bench_report.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+namespace habitrpg::bench {
+namespace {
+
+void WriteJsonString(std::ostream& out, const std::string_view text) {
+  out << '"';
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+          << std::setfill(' ');
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+// Case names and metadata are plain identifiers, but quote anything CSV would split on.
+void WriteCsvField(std::ostream& out, const std::string_view text) {
+  if (text.find_first_of(",\"\n") == std::string_view::npos) {
+    out << text;
+    return;
+  }
+  out << '"';
+  for (const char c : text) {
+    out << c;
+    if (c == '"') {
+      out << '"';
+    }
+  }
+  out << '"';
+}
+
+
+// Just enough JSON for reading reports back: objects, arrays, strings, numbers, booleans
+// and null. Unicode escapes outside the BMP are not combined into one code point.
+struct JsonValue {
+  enum class Kind {
+    Null,
+    Bool,
+    Number,
+    String,
+    Array,
+    Object,
+  };
+
+  Kind kind{Kind::Null};
+  bool boolean{false};
+  double number{0.0};
+  std::string text{};
+  std::vector<JsonValue> items{};
+  std::vector<std::pair<std::string, JsonValue>> members{};
+
+  const JsonValue* Find(const std::string_view key) const {
+    for (const auto& [name, value] : members) {
+      if (name == key) {
+        return &value;
+      }
+    }
+    return nullptr;
+  }
+};
+
+class JsonParser final {
+ public:
+  explicit JsonParser(const std::string_view text) : text_(text) {}
+
+  JsonValue ParseDocument() {
+    JsonValue value = ParseValue();
+    SkipWhitespace();
+    if (position_ != text_.size()) {
+      Fail("trailing characters");
+    }
+    return value;
+  }
+
+ private:
+  [[noreturn]] void Fail(const std::string& what) const {
+    throw std::runtime_error("Malformed benchmark JSON at offset " + std::to_string(position_) + ": " + what);
+  }
+
+  void SkipWhitespace() {
+    while (position_ < text_.size() &&
+           (text_[position_] == ' ' || text_[position_] == '\n' || text_[position_] == '\r' ||
+            text_[position_] == '\t')) {
+      ++position_;
+    }
+  }
+
+  bool Consume(const char expected) {
+    SkipWhitespace();
+    if (position_ < text_.size() && text_[position_] == expected) {
+      ++position_;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(const char expected) {
+    if (!Consume(expected)) {
+      Fail(std::string("expected '") + expected + "'");
+    }
+  }
+
+  bool ConsumeWord(const std::string_view word) {
+    if (text_.substr(position_, word.size()) != word) {
+      return false;
+    }
+    position_ += word.size();
+    return true;
+  }
+
+  JsonValue ParseValue() {
+    SkipWhitespace();
+    if (position_ >= text_.size()) {
+      Fail("unexpected end of input");
+    }
+
+    JsonValue value{};
+    const char c = text_[position_];
+    if (c == '{') {
+      value.kind = JsonValue::Kind::Object;
+      ++position_;
+      if (Consume('}')) {
+        return value;
+      }
+      do {
+        SkipWhitespace();
+        std::string key = ParseString();
+        Expect(':');
+        value.members.emplace_back(std::move(key), ParseValue());
+      } while (Consume(','));
+      Expect('}');
+    } else if (c == '[') {
+      value.kind = JsonValue::Kind::Array;
+      ++position_;
+      if (Consume(']')) {
+        return value;
+      }
+      do {
+        value.items.push_back(ParseValue());
+      } while (Consume(','));
+      Expect(']');
+    } else if (c == '"') {
+      value.kind = JsonValue::Kind::String;
+      value.text = ParseString();
+    } else if (ConsumeWord("true") || ConsumeWord("false")) {
+      value.kind = JsonValue::Kind::Bool;
+      value.boolean = c == 't';
+    } else if (ConsumeWord("null")) {
+      value.kind = JsonValue::Kind::Null;
+    } else {
+      value.kind = JsonValue::Kind::Number;
+      const char* begin = text_.data() + position_;
+      const auto [end, error] = std::from_chars(begin, text_.data() + text_.size(), value.number);
+      if (error != std::errc{}) {
+        Fail("expected a value");
+      }
+      position_ += static_cast<size_t>(end - begin);
+    }
+    return value;
+  }
+
+  std::string ParseString() {
+    if (position_ >= text_.size() || text_[position_] != '"') {
+      Fail("expected a string");
+    }
+    ++position_;
+
+    std::string out;
+    while (position_ < text_.size() && text_[position_] != '"') {
+      const char c = text_[position_++];
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (position_ >= text_.size()) {
+        break;
+      }
+      const char escaped = text_[position_++];
+      switch (escaped) {
+        case 'b':
+          out.push_back('\b');
+          break;
+        case 'f':
+          out.push_back('\f');
+          break;
+        case 'n':
+          out.push_back('\n');
+          break;
+        case 'r':
+          out.push_back('\r');
+          break;
+        case 't':
+          out.push_back('\t');
+          break;
+        case 'u':
+          AppendCodePoint(ParseHex4(), &out);
+          break;
+        default:
+          out.push_back(escaped);
+          break;
+      }
+    }
+    if (position_ >= text_.size()) {
+      Fail("unterminated string");
+    }
+    ++position_;
+    return out;
+  }
+
+  unsigned ParseHex4() {
+    unsigned code_point = 0;
+    const char* begin = text_.data() + position_;
+    const auto [end, error] = std::from_chars(begin, begin + std::min<size_t>(4, text_.size() - position_),
+                                              code_point, 16);
+    if (error != std::errc{} || end != begin + 4) {
+      Fail("bad \\u escape");
+    }
+    position_ += 4;
+    return code_point;
+  }
+
+  static void AppendCodePoint(const unsigned code_point, std::string* out) {
+    if (code_point < 0x80) {
+      out->push_back(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+      out->push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+      out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+      out->push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+      out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      out->push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+  }
+
+  std::string_view text_;
+  size_t position_{0};
+};
+
+const JsonValue& Member(const JsonValue& object, const std::string_view key, const JsonValue::Kind kind) {
+  const JsonValue* value = object.kind == JsonValue::Kind::Object ? object.Find(key) : nullptr;
+  if (value == nullptr || value->kind != kind) {
+    throw std::runtime_error("Benchmark report field " + std::string(key) + " is missing or mistyped");
+  }
+  return *value;
+}
+
+std::string OptionalText(const JsonValue& object, const std::string_view key) {
+  const JsonValue* value = object.Find(key);
+  return value != nullptr && value->kind == JsonValue::Kind::String ? value->text : std::string{};
+}
+
+size_t Count(const JsonValue& object, const std::string_view key) {
+  const double value = Member(object, key, JsonValue::Kind::Number).number;
+  if (value < 0.0) {
+    throw std::runtime_error("Benchmark report field " + std::string(key) + " is negative");
+  }
+  return static_cast<size_t>(value);
+}
+
+ScaleTier TierFrom(const std::string_view raw) {
+  const auto tier = ScaleTierFromString(raw);
+  if (!tier.has_value()) {
+    throw std::runtime_error("Unknown benchmark tier: " + std::string(raw));
+  }
+  return *tier;
+}
+
+BenchReport ReportFromJson(const std::string_view text) {
+  const JsonValue document = JsonParser(text).ParseDocument();
+  if (Member(document, "schema_version", JsonValue::Kind::Number).number != 1.0) {
+    throw std::runtime_error("Unsupported benchmark report schema_version");
+  }
+
+  BenchReport report{};
+  report.tier = TierFrom(Member(document, "tier", JsonValue::Kind::String).text);
+  report.rows = Count(document, "rows");
+  report.repetitions = Count(document, "repetitions");
+  report.build_type = OptionalText(document, "build_type");
+  report.sqlite_version = OptionalText(document, "sqlite_version");
+  report.recorded_at = OptionalText(document, "recorded_at");
+
+  for (const auto& item : Member(document, "cases", JsonValue::Kind::Array).items) {
+    CaseResult result{};
+    result.name = Member(item, "name", JsonValue::Kind::String).text;
+    result.rows = Count(item, "rows");
+    result.iterations = Count(item, "iterations");
+    result.p50_ns = Member(item, "p50_ns", JsonValue::Kind::Number).number;
+    result.p90_ns = Member(item, "p90_ns", JsonValue::Kind::Number).number;
+    result.p99_ns = Member(item, "p99_ns", JsonValue::Kind::Number).number;
+    result.min_ns = Member(item, "min_ns", JsonValue::Kind::Number).number;
+    result.max_ns = Member(item, "max_ns", JsonValue::Kind::Number).number;
+    result.mean_ns = Member(item, "mean_ns", JsonValue::Kind::Number).number;
+    for (const auto& median : Member(item, "repetition_p50_ns", JsonValue::Kind::Array).items) {
+      if (median.kind != JsonValue::Kind::Number) {
+        throw std::runtime_error("Benchmark case " + result.name + " has a non-numeric repetition median");
+      }
+      result.repetition_p50_ns.push_back(median.number);
+    }
+    report.cases.push_back(std::move(result));
+  }
+  return report;
+}
+
+std::vector<std::string> SplitCsvLine(const std::string_view line) {
+  std::vector<std::string> fields(1);
+  bool quoted = false;
+  for (size_t i = 0; i < line.size(); ++i) {
+    const char c = line[i];
+    if (quoted) {
+      if (c == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        fields.back().push_back('"');
+        ++i;
+      } else if (c == '"') {
+        quoted = false;
+      } else {
+        fields.back().push_back(c);
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields.emplace_back();
+    } else {
+      fields.back().push_back(c);
+    }
+  }
+  return fields;
+}
+
+double CsvNumber(const std::string& field, const std::string& case_name) {
+  double value = 0.0;
+  const auto [end, error] = std::from_chars(field.data(), field.data() + field.size(), value);
+  if (error != std::errc{} || end != field.data() + field.size()) {
+    throw std::runtime_error("Benchmark case " + case_name + " has a malformed number: " + field);
+  }
+  return value;
+}
+
+BenchReport ReportFromCsv(const std::string_view text) {
+  constexpr std::string_view kHeader =
+      "name,tier,rows,iterations,p50_ns,p90_ns,p99_ns,min_ns,max_ns,mean_ns,repetition_p50_ns";
+
+  BenchReport report{};
+  size_t line_begin = 0;
+  bool header_seen = false;
+  while (line_begin < text.size()) {
+    const size_t line_end = std::min(text.find('\n', line_begin), text.size());
+    auto line = text.substr(line_begin, line_end - line_begin);
+    line_begin = line_end + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    if (line.empty()) {
+      continue;
+    }
+    if (!header_seen) {
+      if (line != kHeader) {
+        throw std::runtime_error("Benchmark CSV header does not match");
+      }
+      header_seen = true;
+      continue;
+    }
+
+    const auto fields = SplitCsvLine(line);
+    if (fields.size() != 11) {
+      throw std::runtime_error("Benchmark CSV row has " + std::to_string(fields.size()) + " fields, expected 11");
+    }
+    CaseResult result{};
+    result.name = fields[0];
+    report.tier = TierFrom(fields[1]);
+    result.rows = static_cast<size_t>(CsvNumber(fields[2], result.name));
+    result.iterations = static_cast<size_t>(CsvNumber(fields[3], result.name));
+    result.p50_ns = CsvNumber(fields[4], result.name);
+    result.p90_ns = CsvNumber(fields[5], result.name);
+    result.p99_ns = CsvNumber(fields[6], result.name);
+    result.min_ns = CsvNumber(fields[7], result.name);
+    result.max_ns = CsvNumber(fields[8], result.name);
+    result.mean_ns = CsvNumber(fields[9], result.name);
+    const std::string_view medians = fields[10];
+    size_t begin = 0;
+    while (begin < medians.size()) {
+      const size_t end = std::min(medians.find(';', begin), medians.size());
+      result.repetition_p50_ns.push_back(CsvNumber(std::string(medians.substr(begin, end - begin)), result.name));
+      begin = end + 1;
+    }
+
+    report.rows = result.rows;
+    report.repetitions = std::max(report.repetitions, result.repetition_p50_ns.size());
+    report.cases.push_back(std::move(result));
+  }
+  if (!header_seen) {
+    throw std::runtime_error("Benchmark CSV is empty");
+  }
+  return report;
+}
+
+}  // namespace
+
+std::string_view ScaleTierToString(const ScaleTier tier) {
+  switch (tier) {
+    case ScaleTier::Small:
+      return "small";
+    case ScaleTier::Medium:
+      return "medium";
+    case ScaleTier::Large:
+      return "large";
+  }
+  return "small";
+}
+
+std::optional<ScaleTier> ScaleTierFromString(const std::string_view raw) {
+  if (raw == "small" || raw == "1k") {
+    return ScaleTier::Small;
+  }
+  if (raw == "medium" || raw == "100k") {
+    return ScaleTier::Medium;
+  }
+  if (raw == "large" || raw == "1m") {
+    return ScaleTier::Large;
+  }
+  return std::nullopt;
+}
+
+size_t RowsForTier(const ScaleTier tier) {
+  switch (tier) {
+    case ScaleTier::Small:
+      return 1'000;
+    case ScaleTier::Medium:
+      return 100'000;
+    case ScaleTier::Large:
+      return 1'000'000;
+  }
+  return 1'000;
+}
+
+void WriteJson(std::ostream& out, const BenchReport& report) {
+  out << std::fixed << std::setprecision(1);
+  out << "{\n";
+  out << "  \"schema_version\": 1,\n";
+  out << "  \"tier\": ";
+  WriteJsonString(out, ScaleTierToString(report.tier));
+  out << ",\n  \"rows\": " << report.rows;
+  out << ",\n  \"repetitions\": " << report.repetitions;
+  out << ",\n  \"build_type\": ";
+  WriteJsonString(out, report.build_type);
+  out << ",\n  \"sqlite_version\": ";
+  WriteJsonString(out, report.sqlite_version);
+  out << ",\n  \"recorded_at\": ";
+  WriteJsonString(out, report.recorded_at);
+  out << ",\n  \"cases\": [";
+  for (size_t i = 0; i < report.cases.size(); ++i) {
+    const auto& result = report.cases[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"name\": ";
+    WriteJsonString(out, result.name);
+    out << ", \"rows\": " << result.rows << ", \"iterations\": " << result.iterations;
+    out << ", \"p50_ns\": " << result.p50_ns << ", \"p90_ns\": " << result.p90_ns;
+    out << ", \"p99_ns\": " << result.p99_ns << ", \"min_ns\": " << result.min_ns;
+    out << ", \"max_ns\": " << result.max_ns << ", \"mean_ns\": " << result.mean_ns;
+    out << ", \"repetition_p50_ns\": [";
+    for (size_t r = 0; r < result.repetition_p50_ns.size(); ++r) {
+      out << (r == 0 ? "" : ", ") << result.repetition_p50_ns[r];
+    }
+    out << "]}";
+  }
+  out << (report.cases.empty() ? "]\n" : "\n  ]\n") << "}\n";
+}
+
+void WriteCsv(std::ostream& out, const BenchReport& report) {
+  out << std::fixed << std::setprecision(1);
+  out << "name,tier,rows,iterations,p50_ns,p90_ns,p99_ns,min_ns,max_ns,mean_ns,repetition_p50_ns\n";
+  for (const auto& result : report.cases) {
+    WriteCsvField(out, result.name);
+    out << ',' << ScaleTierToString(report.tier) << ',' << result.rows << ',' << result.iterations;
+    out << ',' << result.p50_ns << ',' << result.p90_ns << ',' << result.p99_ns;
+    out << ',' << result.min_ns << ',' << result.max_ns << ',' << result.mean_ns << ',';
+    for (size_t r = 0; r < result.repetition_p50_ns.size(); ++r) {
+      out << (r == 0 ? "" : ";") << result.repetition_p50_ns[r];
+    }
+    out << '\n';
+  }
+}
+
+BenchReport ReadReport(std::istream& in) {
+  const std::string text{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+  const size_t first = text.find_first_not_of(" \t\r\n");
+  if (first == std::string::npos) {
+    throw std::runtime_error("Benchmark report is empty");
+  }
+  return text[first] == '{' ? ReportFromJson(text) : ReportFromCsv(text);
+}
+
+BenchReport ReadReportFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Cannot open benchmark report " + path);
+  }
+  return ReadReport(in);
+}
+
+}  // namespace habitrpg::bench
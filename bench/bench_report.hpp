@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace habitrpg::bench {
+
+// Rows seeded per table (see BuildDataset for the per-table ratios).
+enum class ScaleTier {
+  Small,   // 1k
+  Medium,  // 100k
+  Large,   // 1M
+};
+
+std::string_view ScaleTierToString(ScaleTier tier);
+std::optional<ScaleTier> ScaleTierFromString(std::string_view raw);
+size_t RowsForTier(ScaleTier tier);
+
+// Timings of one case in nanoseconds. Percentiles cover every sample of every
+// repetition; repetition_p50_ns keeps each repetition's median separately so a
+// comparison can tell run-to-run noise from a real shift.
+struct CaseResult {
+  std::string name{};
+  size_t rows{0};
+  size_t iterations{0};  // samples per repetition
+  std::vector<double> repetition_p50_ns{};
+  double p50_ns{0.0};
+  double p90_ns{0.0};
+  double p99_ns{0.0};
+  double min_ns{0.0};
+  double max_ns{0.0};
+  double mean_ns{0.0};
+};
+
+struct BenchReport {
+  ScaleTier tier{ScaleTier::Small};
+  size_t rows{0};
+  size_t repetitions{0};
+  std::string build_type{};
+  std::string sqlite_version{};
+  std::string recorded_at{};
+  std::vector<CaseResult> cases{};
+};
+
+void WriteJson(std::ostream& out, const BenchReport& report);
+void WriteCsv(std::ostream& out, const BenchReport& report);
+
+// Reads what WriteJson or WriteCsv produced; the format is detected from the first
+// character. Throws std::runtime_error on malformed input.
+BenchReport ReadReport(std::istream& in);
+BenchReport ReadReportFile(const std::string& path);
+
+}  // namespace habitrpg::bench
@@ -0,0 +1,129 @@
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bench_cases.hpp"
+#include "habitrpg/domain/interaction_flow.hpp"
+#include "habitrpg/domain/reward_engine.hpp"
+#include "habitrpg/domain/today_queue.hpp"
+
+namespace habitrpg::bench {
+namespace {
+
+// Runs a transition on rows[pick(i)] and puts the row back before the next iteration, so
+// every sample starts from the seeded state. `prepare` resets the picked row untimed.
+template <typename Row, typename Pick, typename Prepare, typename Body>
+void RunRestoringRow(
+    BenchRunner& runner,
+    std::string name,
+    std::vector<Row>& rows,
+    const Pick& pick,
+    const Prepare& prepare,
+    const Body& body) {
+  std::optional<std::pair<size_t, Row>> saved;
+  const auto restore = [&] {
+    if (saved.has_value()) {
+      rows[saved->first] = std::move(saved->second);
+      saved.reset();
+    }
+  };
+  runner.RunWithSetup(
+      std::move(name),
+      [&](const size_t i) {
+        restore();
+        const size_t index = pick(i);
+        saved.emplace(index, rows[index]);
+        prepare(rows[index]);
+      },
+      [&](const size_t i) { body(rows[pick(i)]); });
+  restore();
+}
+
+}  // namespace
+
+void RunDomainBenchmarks(BenchContext& context) {
+  auto& runner = context.runner;
+  auto& dataset = context.dataset;
+
+  const domain::TodayQueueService queue_service;
+  runner.Run("domain.today_queue.mixed", [&](size_t) {
+    DoNotOptimize(queue_service.BuildQueue(
+        ui::contracts::TrackFilter::Mixed,
+        dataset.life_actions,
+        dataset.learning_sessions));
+  });
+  runner.Run("domain.today_queue.life_only", [&](size_t) {
+    DoNotOptimize(queue_service.BuildQueue(
+        ui::contracts::TrackFilter::LifeOnly,
+        dataset.life_actions,
+        dataset.learning_sessions));
+  });
+  runner.Run("domain.today_queue.learning_only", [&](size_t) {
+    DoNotOptimize(queue_service.BuildQueue(
+        ui::contracts::TrackFilter::LearningOnly,
+        dataset.life_actions,
+        dataset.learning_sessions));
+  });
+
+  domain::RewardEngine reward_engine;
+  runner.Run("domain.reward_engine.replay", [&](size_t) {
+    domain::UserState user_state{};
+    for (const auto& reward : dataset.reward_events) {
+      reward_engine.ApplyReward(reward, &user_state);
+    }
+    DoNotOptimize(user_state);
+  });
+
+  // Transitions run against the full runtime collections, as the app holds them: starting
+  // a unit scans both tracks for another active unit.
+  const domain::InteractionFlowService flow;
+  domain::UserState user_state{};
+  std::vector<domain::RewardEvent> rewards;
+  runner.RunWithSetup(
+      "domain.flow.action_create_start_complete",
+      [&](size_t) { rewards.clear(); },
+      [&](size_t) {
+        dataset.life_actions.push_back(flow.CreateLifeAction("bench_quest_0", "Benchmark action", 120));
+        const auto id = dataset.life_actions.back().id;
+        flow.StartActionUnit(id, &dataset.life_actions, &dataset.learning_sessions);
+        flow.CompleteActionUnit(id, &dataset.life_actions, &reward_engine, &user_state, &rewards);
+        dataset.life_actions.pop_back();
+      });
+
+  RunRestoringRow(
+      runner,
+      "domain.flow.session_start_checkpoint_complete",
+      dataset.learning_sessions,
+      [&](const size_t i) { return (i * 7919) % dataset.learning_sessions.size(); },
+      [&](domain::LearningSession& session) {
+        session.lifecycle_state = domain::LifecycleState::Ready;
+        rewards.clear();
+      },
+      [&](const domain::LearningSession& session) {
+        const auto id = session.id;
+        flow.StartLearningSession(id, &dataset.life_actions, &dataset.learning_sessions);
+        flow.CheckpointLearningSession(id, "Checkpoint note", &dataset.learning_sessions);
+        flow.CompleteLearningSession(id, &dataset.learning_sessions, &reward_engine, &user_state, &rewards);
+      });
+
+  RunRestoringRow(
+      runner,
+      "domain.flow.promote_milestone_checkpoint",
+      dataset.milestone_checkpoints,
+      [&](const size_t i) { return (i * 7919) % dataset.milestone_checkpoints.size(); },
+      [&](domain::MilestoneCheckpoint& checkpoint) {
+        checkpoint.state = domain::MilestoneCheckpointState::Candidate;
+        rewards.clear();
+      },
+      [&](const domain::MilestoneCheckpoint& checkpoint) {
+        flow.PromoteMilestoneCheckpointToConfirmed(
+            checkpoint.id,
+            &dataset.milestone_checkpoints,
+            &reward_engine,
+            &user_state,
+            &rewards);
+      });
+}
+
+}  // namespace habitrpg::bench
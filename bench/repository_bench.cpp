@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bench_cases.hpp"
+#include "habitrpg/domain/entities.hpp"
+
+namespace habitrpg::bench {
+namespace {
+
+constexpr size_t kWriteBatchRows = 1'000;
+
+// Rows [begin, begin + count) of the i-th batch, wrapping around the table.
+template <typename Row>
+std::span<Row> BatchAt(std::vector<Row>& rows, const size_t iteration) {
+  const size_t count = std::min(kWriteBatchRows, rows.size());
+  const size_t batches = std::max<size_t>(1, rows.size() / count);
+  return std::span<Row>(rows).subspan((iteration % batches) * count, count);
+}
+
+// Single-row and batch upsert cases for one table. Every write changes the row's
+// priority-like field first (untimed), so SQLite really rewrites the row.
+template <typename Row, typename Touch, typename UpsertOne, typename UpsertMany>
+void RunUpsertCases(
+    BenchRunner& runner,
+    const std::string& name,
+    std::vector<Row>& rows,
+    const Touch& touch,
+    const UpsertOne& upsert_one,
+    const UpsertMany& upsert_many) {
+  runner.RunWithSetup(
+      "sqlite.upsert_" + name,
+      [&](const size_t i) { touch(rows[i % rows.size()], i); },
+      [&](const size_t i) { upsert_one(rows[i % rows.size()]); });
+  runner.RunWithSetup(
+      "sqlite.upsert_" + name + "s_batch",
+      [&](const size_t i) {
+        for (auto& row : BatchAt(rows, i)) {
+          touch(row, i);
+        }
+      },
+      [&](const size_t i) {
+        const auto batch = BatchAt(rows, i);
+        upsert_many(std::span<const Row>(batch.data(), batch.size()));
+      });
+}
+
+domain::RewardEvent ExtraRewardEvent(const size_t serial) {
+  domain::RewardEvent reward{};
+  reward.id = "bench_reward_extra_" + std::to_string(serial);
+  reward.source_type = "action_unit";
+  reward.source_id = "bench_action_" + std::to_string(serial % 1000);
+  reward.xp_delta = 12;
+  reward.reward_kind = "action_completion";
+  reward.created_at = "2026-06-01T12:00:00Z";
+  return reward;
+}
+
+}  // namespace
+
+void RunRepositoryReadBenchmarks(BenchContext& context) {
+  auto& runner = context.runner;
+  auto& repository = context.repository;
+  const auto& dataset = context.dataset;
+
+  runner.Run("sqlite.find_habit_by_id", [&](const size_t i) {
+    DoNotOptimize(repository.FindHabitById(dataset.habits[(i * 7919) % dataset.habits.size()].id.str()));
+  });
+  runner.Run("sqlite.find_action_unit_by_id", [&](const size_t i) {
+    const auto& rows = dataset.life_actions;
+    DoNotOptimize(repository.FindActionUnitById(rows[(i * 7919) % rows.size()].id.str()));
+  });
+  runner.Run("sqlite.find_learning_goal_by_id", [&](const size_t i) {
+    const auto& rows = dataset.learning_goals;
+    DoNotOptimize(repository.FindLearningGoalById(rows[(i * 7919) % rows.size()].id.str()));
+  });
+  runner.Run("sqlite.find_milestone_checkpoint_by_id", [&](const size_t i) {
+    const auto& rows = dataset.milestone_checkpoints;
+    DoNotOptimize(repository.FindMilestoneCheckpointById(rows[(i * 7919) % rows.size()].id.str()));
+  });
+
+  runner.Run("sqlite.list_habits", [&](size_t) { DoNotOptimize(repository.ListHabits()); });
+  runner.Run("sqlite.list_quests", [&](size_t) { DoNotOptimize(repository.ListQuests()); });
+  runner.Run("sqlite.list_action_units_by_track", [&](size_t) {
+    DoNotOptimize(repository.ListActionUnitsByTrack(domain::TrackType::Life));
+  });
+  runner.Run("sqlite.list_learning_goals", [&](size_t) { DoNotOptimize(repository.ListLearningGoals()); });
+  runner.Run("sqlite.list_learning_sessions", [&](size_t) { DoNotOptimize(repository.ListLearningSessions()); });
+  runner.Run("sqlite.list_learning_sessions_by_goal", [&](const size_t i) {
+    const auto& goals = dataset.learning_goals;
+    DoNotOptimize(repository.ListLearningSessionsByGoal(goals[i % goals.size()].id.str()));
+  });
+  runner.Run("sqlite.visit_learning_sessions", [&](size_t) {
+    size_t visited = 0;
+    repository.VisitLearningSessions([&visited](const domain::LearningSession&) {
+      ++visited;
+      return true;
+    });
+    DoNotOptimize(visited);
+  });
+  runner.Run("sqlite.list_milestone_checkpoints", [&](size_t) {
+    DoNotOptimize(repository.ListMilestoneCheckpoints());
+  });
+  runner.Run("sqlite.list_milestone_checkpoints_by_goal", [&](const size_t i) {
+    const auto& goals = dataset.learning_goals;
+    DoNotOptimize(repository.ListMilestoneCheckpointsByGoal(goals[i % goals.size()].id.str()));
+  });
+  runner.Run("sqlite.visit_milestone_checkpoints", [&](size_t) {
+    size_t visited = 0;
+    repository.VisitMilestoneCheckpoints([&visited](const domain::MilestoneCheckpoint&) {
+      ++visited;
+      return true;
+    });
+    DoNotOptimize(visited);
+  });
+
+  runner.Run("sqlite.list_reward_events_by_track", [&](size_t) {
+    DoNotOptimize(repository.ListRewardEventsByTrack(domain::TrackType::Learning));
+  });
+  runner.Run("sqlite.list_reward_events_page", [&](size_t) {
+    DoNotOptimize(repository.ListRewardEventsPage(data::RewardEventPageQuery{}));
+  });
+  runner.Run("sqlite.visit_reward_ledger", [&](size_t) {
+    int xp = 0;
+    repository.VisitRewardLedgerAfter(0, [&xp](uint64_t, const domain::RewardEvent& reward) {
+      xp += reward.xp_delta;
+      return true;
+    });
+    DoNotOptimize(xp);
+  });
+
+  runner.Run("sqlite.list_daily_xp", [&](size_t) { DoNotOptimize(repository.ListDailyXp("", "")); });
+  runner.Run("sqlite.list_daily_learning_minutes", [&](size_t) {
+    DoNotOptimize(repository.ListDailyLearningMinutes("", ""));
+  });
+  runner.Run("sqlite.list_weekly_learning_minutes", [&](size_t) {
+    DoNotOptimize(repository.ListWeeklyLearningMinutes("", ""));
+  });
+  runner.Run("sqlite.load_track_xp_totals", [&](size_t) { DoNotOptimize(repository.LoadTrackXpTotals()); });
+
+  runner.Run("sqlite.search", [&](const size_t i) {
+    data::SearchQuery query{};
+    query.text = "topic" + std::to_string((i * 7) % 1000);
+    DoNotOptimize(repository.Search(query));
+  });
+
+  runner.Run("sqlite.load_user_state", [&](size_t) { DoNotOptimize(repository.LoadUserState()); });
+  runner.Run("sqlite.load_ui_preferences", [&](size_t) { DoNotOptimize(repository.LoadUiPreferences()); });
+}
+
+void RunRepositoryWriteBenchmarks(BenchContext& context) {
+  auto& runner = context.runner;
+  auto& repository = context.repository;
+  auto& dataset = context.dataset;
+
+  RunUpsertCases(
+      runner,
+      "habit",
+      dataset.habits,
+      [](domain::Habit& habit, size_t) { habit.is_active = !habit.is_active; },
+      [&](const domain::Habit& habit) { repository.UpsertHabit(habit); },
+      [&](std::span<const domain::Habit> habits) { repository.UpsertHabits(habits); });
+  RunUpsertCases(
+      runner,
+      "quest",
+      dataset.quests,
+      [](domain::Quest& quest, size_t) { quest.is_completed = !quest.is_completed; },
+      [&](const domain::Quest& quest) { repository.UpsertQuest(quest); },
+      [&](std::span<const domain::Quest> quests) { repository.UpsertQuests(quests); });
+  RunUpsertCases(
+      runner,
+      "action_unit",
+      dataset.life_actions,
+      [](domain::ActionUnit& action, const size_t i) { action.priority_score = static_cast<int>(i % 200); },
+      [&](const domain::ActionUnit& action) { repository.UpsertActionUnit(action); },
+      [&](std::span<const domain::ActionUnit> actions) { repository.UpsertActionUnits(actions); });
+  RunUpsertCases(
+      runner,
+      "learning_goal",
+      dataset.learning_goals,
+      [](domain::LearningGoal& goal, const size_t i) { goal.confidence_level = static_cast<int>(i % 5) + 1; },
+      [&](const domain::LearningGoal& goal) { repository.UpsertLearningGoal(goal); },
+      [&](std::span<const domain::LearningGoal> goals) { repository.UpsertLearningGoals(goals); });
+  RunUpsertCases(
+      runner,
+      "learning_session",
+      dataset.learning_sessions,
+      [](domain::LearningSession& session, const size_t i) { session.priority_score = static_cast<int>(i % 200); },
+      [&](const domain::LearningSession& session) { repository.UpsertLearningSession(session); },
+      [&](std::span<const domain::LearningSession> sessions) { repository.UpsertLearningSessions(sessions); });
+  RunUpsertCases(
+      runner,
+      "milestone_checkpoint",
+      dataset.milestone_checkpoints,
+      [](domain::MilestoneCheckpoint& checkpoint, const size_t i) {
+        checkpoint.confidence_level = static_cast<int>(i % 5) + 1;
+      },
+      [&](const domain::MilestoneCheckpoint& checkpoint) { repository.UpsertMilestoneCheckpoint(checkpoint); },
+      [&](std::span<const domain::MilestoneCheckpoint> checkpoints) {
+        repository.UpsertMilestoneCheckpoints(checkpoints);
+      });
+
+  // The ledger is append-only, so these cases add fresh events instead of rewriting.
+  size_t next_reward = 0;
+  domain::RewardEvent reward{};
+  runner.RunWithSetup(
+      "sqlite.append_reward_event",
+      [&](size_t) { reward = ExtraRewardEvent(next_reward++); },
+      [&](size_t) { repository.AppendRewardEvent(reward); });
+  std::vector<domain::RewardEvent> rewards;
+  runner.RunWithSetup(
+      "sqlite.append_reward_events_batch",
+      [&](size_t) {
+        rewards.clear();
+        for (size_t i = 0; i < kWriteBatchRows; ++i) {
+          rewards.push_back(ExtraRewardEvent(next_reward++));
+        }
+      },
+      [&](size_t) { repository.AppendRewardEvents(rewards); });
+
+  domain::UserState user_state = repository.LoadUserState();
+  runner.RunWithSetup(
+      "sqlite.save_user_state",
+      [&](const size_t i) { user_state.recovery_tokens = static_cast<int>(i % 4); },
+      [&](size_t) { repository.SaveUserState(user_state); });
+  data::UiPreferences preferences = repository.LoadUiPreferences();
+  runner.RunWithSetup(
+      "sqlite.save_ui_preferences",
+      [&](const size_t i) { preferences.motion_level = static_cast<int>(i % 3); },
+      [&](size_t) { repository.SaveUiPreferences(preferences); });
+
+  data::CommandJournalRecord command{};
+  command.command_id = "start_unit";
+  command.payload = "unit_id=bench_action_0\ntrack_type=life\n";
+  command.recorded_at = "2026-06-01T12:00:00Z";
+  runner.Run("sqlite.append_command", [&](size_t) { DoNotOptimize(repository.AppendCommand(command)); });
+
+  // Snapshots shorten every later ledger replay, so this case runs last.
+  data::UserStateSnapshot snapshot{};
+  snapshot.through_sequence = repository.LatestRewardSequence();
+  snapshot.user_state = user_state;
+  snapshot.created_at = "2026-06-01T12:00:00Z";
+  runner.Run("sqlite.save_user_state_snapshot", [&](size_t) { repository.SaveUserStateSnapshot(snapshot); });
+}
+
+}  // namespace habitrpg::bench
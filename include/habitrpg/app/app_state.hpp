@@ -1,10 +1,15 @@
 #pragma once
 
 #include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "habitrpg/data/repositories.hpp"
 #include "habitrpg/domain/entities.hpp"
 #include "habitrpg/domain/today_queue.hpp"
 #include "habitrpg/ui/contracts.hpp"
@@ -12,12 +17,34 @@
 
 namespace habitrpg::app {
 
+// What storage already holds. The single-row user state and preferences are kept as
+// values and compared on save; the append-only reward ledger needs only a watermark.
+struct PersistedShadow {
+  std::optional<domain::UserState> user_state{};
+  std::optional<data::UiPreferences> ui_preferences{};
+  size_t reward_events{0};  // reward_events is append-only; rows before this index are stored
+  uint64_t journal_through{0};  // journaled commands up to this sequence are truncated
+};
+
+// Ids of runtime rows changed since they were last saved. Every mutation path marks the
+// rows it touches (MarkDirty); saves write only these rows and never diff the others.
+struct DirtyRows {
+  std::unordered_set<domain::EntityId> life_actions{};
+  std::unordered_set<domain::EntityId> learning_goals{};
+  std::unordered_set<domain::EntityId> learning_sessions{};
+  std::unordered_set<domain::EntityId> milestone_checkpoints{};
+};
+
 struct RuntimeCollections {
   std::vector<domain::ActionUnit> life_actions{};
   std::vector<domain::LearningGoal> learning_goals{};
   std::vector<domain::LearningSession> learning_sessions{};
   std::vector<domain::MilestoneCheckpoint> milestone_checkpoints{};
-  std::vector<domain::RewardEvent> reward_events{};
+  std::vector<domain::RewardEvent> reward_events{};  // recent window, oldest first
+  std::vector<domain::RewardEvent> older_reward_events{};  // read-only history pages, newest first
+  std::optional<data::RewardEventCursor> older_reward_cursor{};
+  PersistedShadow persisted{};
+  DirtyRows dirty{};
 };
 
 struct AppState {
@@ -36,9 +63,9 @@ struct AppState {
   int selected_learning_goal_index{0};
   int selected_checkpoint_index{0};
 
-  std::string active_unit_id{};
+  domain::EntityId active_unit_id{};
   domain::TrackType active_track_type{domain::TrackType::Life};
-  std::string pending_start_unit_id{};
+  domain::EntityId pending_start_unit_id{};
   domain::TrackType pending_start_track_type{domain::TrackType::Life};
   bool show_active_conflict_modal{false};
 
@@ -58,12 +85,33 @@ struct AppState {
   ui::CopyPack copy_pack{};
 
   uint64_t mutation_revision{0};
+  uint64_t submitted_revision{0};
   uint64_t persisted_revision{0};
+  size_t last_save_rows_written{0};
+  // Journaled commands wait for the next compaction save; other edits request one.
+  bool save_requested{false};
+  std::chrono::steady_clock::time_point last_save_submitted_at{};
+
+  std::string last_backup_path{};
+  std::string last_backup_error{};
+
+  // Set by Application. runtime.reward_events is only the recent window, so reward
+  // lookups and older history pages go to storage through this.
+  const data::IRewardRepository* reward_repository{nullptr};
+
+  // Set by Application; commands dispatched while it is null are applied unjournaled.
+  data::ICommandJournalRepository* command_journal{nullptr};
+  uint64_t journaled_through{0};  // sequence of the newest journaled command
+  // A failed append leaves its command durable only once a save covers it; the error is
+  // shown until a save reaches unjournaled_revision.
+  std::string last_journal_error{};
+  uint64_t unjournaled_revision{0};
 };
 
 bool StartupSmokeCheck(const std::string& sqlite_path, std::string* error_out = nullptr);
 
-inline void MarkMutated(AppState* app_state) {
+// For edits the command journal already holds: the next compaction save covers them.
+inline void MarkJournaledMutation(AppState* app_state) {
   if (app_state == nullptr) {
     return;
   }
@@ -71,4 +119,29 @@ inline void MarkMutated(AppState* app_state) {
   app_state->mutation_revision += 1;
 }
 
+// For edits only a save makes durable, so one is requested right away.
+inline void MarkMutated(AppState* app_state) {
+  if (app_state == nullptr) {
+    return;
+  }
+  MarkJournaledMutation(app_state);
+  app_state->save_requested = true;
+}
+
+inline void MarkDirty(AppState* app_state, const domain::ActionUnit& action_unit) {
+  app_state->runtime.dirty.life_actions.insert(action_unit.id);
+}
+
+inline void MarkDirty(AppState* app_state, const domain::LearningGoal& goal) {
+  app_state->runtime.dirty.learning_goals.insert(goal.id);
+}
+
+inline void MarkDirty(AppState* app_state, const domain::LearningSession& session) {
+  app_state->runtime.dirty.learning_sessions.insert(session.id);
+}
+
+inline void MarkDirty(AppState* app_state, const domain::MilestoneCheckpoint& checkpoint) {
+  app_state->runtime.dirty.milestone_checkpoints.insert(checkpoint.id);
+}
+
 }  // namespace habitrpg::app
@@ -5,6 +5,13 @@
 #include <SDL3/SDL.h>
 
 #include "habitrpg/app/app_state.hpp"
+#include "habitrpg/app/archival.hpp"
+#include "habitrpg/app/backup_service.hpp"
+#include "habitrpg/app/command_journal.hpp"
+#include "habitrpg/app/persistence.hpp"
+#include "habitrpg/app/persistence_worker.hpp"
+#include "habitrpg/app/reward_history.hpp"
+#include "habitrpg/app/user_state_ledger.hpp"
 #include "habitrpg/data/sqlite_repository.hpp"
 #include "habitrpg/domain/interaction_flow.hpp"
 #include "habitrpg/domain/reward_engine.hpp"
@@ -31,11 +38,17 @@ class Application {
   void LoadStartupState();
   void LoadUiPreferencesAndResources();
   void SeedDefaultsIfEmpty();
-  bool PersistRuntimeState();
+  void PersistRuntimeState();
+  void DrainPersistenceResults();
+  void DrainBackupResults();
+  bool FlushPersistence();
   void RefreshTodayQueue();
 
   std::string sqlite_path_;
   data::SqliteRepository repository_;
+  PersistenceWorker persistence_worker_;
+  data::SqliteRepository journal_repository_;
+  BackupService backup_service_;
   domain::InteractionFlowService interaction_flow_service_;
   domain::RewardEngine reward_engine_;
   domain::TodayQueueService today_queue_service_;
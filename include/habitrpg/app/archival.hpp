@@ -0,0 +1,22 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "habitrpg/data/repositories.hpp"
+
+namespace habitrpg::app {
+
+struct ArchivePolicy {
+  // Work finished longer ago than this leaves the live tables.
+  std::chrono::days horizon{90};
+};
+
+// Archives everything finished before `now_epoch_ms - policy.horizon`. Run at startup,
+// before the runtime collections are loaded, so they only hold the working set.
+data::ArchiveSummary ArchiveFinishedWork(
+    data::IArchiveRepository& archive,
+    const ArchivePolicy& policy,
+    int64_t now_epoch_ms);
+
+}  // namespace habitrpg::app
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "habitrpg/app/mpsc_queue.hpp"
+#include "habitrpg/data/sqlite_backup.hpp"
+
+namespace habitrpg::app {
+
+struct BackupSchedule {
+  std::string directory{};
+  std::chrono::minutes interval{std::chrono::hours(6)};
+  // Minimum wait after launch before the first scheduled backup, so it never competes
+  // with startup loading.
+  std::chrono::seconds startup_delay{std::chrono::seconds(60)};
+  size_t keep_latest{7};
+  data::SqliteBackupOptions copy_options{};
+};
+
+struct BackupResult {
+  bool ok{false};
+  std::string path{};
+  int pages{0};
+  std::string error{};
+};
+
+// Scheduled online backups of the live database. A background thread copies the file
+// with the SQLite backup API every `interval` (measured from the newest backup already
+// in `directory`, so restarts do not reset the clock) and on RequestBackup(), then
+// deletes all but the `keep_latest` newest backups. Nothing runs on the calling
+// thread; results are collected with PollResults().
+class BackupService final {
+ public:
+  BackupService(std::string sqlite_path, BackupSchedule schedule);
+  ~BackupService();
+
+  BackupService(const BackupService&) = delete;
+  BackupService& operator=(const BackupService&) = delete;
+  BackupService(BackupService&&) = delete;
+  BackupService& operator=(BackupService&&) = delete;
+
+  void RequestBackup();
+  std::vector<BackupResult> PollResults();
+  void Stop();
+
+ private:
+  void Run(const std::stop_token& stop_token);
+  BackupResult RunBackup(const std::stop_token& stop_token);
+
+  std::string sqlite_path_;
+  BackupSchedule schedule_;
+  MpscQueue<BackupResult> results_;
+  std::mutex mutex_;
+  std::condition_variable_any wake_;
+  bool backup_requested_{false};
+  std::jthread thread_;
+};
+
+// `habitrpg-backup-YYYYMMDDTHHMMSSmmmZ.sqlite3`; names sort in creation order.
+std::string BackupFileName(int64_t epoch_ms);
+// Backups in `directory`, newest first.
+std::vector<std::filesystem::path> ListBackups(const std::string& directory);
+// Deletes all but the `keep_latest` newest backups; returns how many were removed.
+size_t PruneBackups(const std::string& directory, size_t keep_latest);
+
+}  // namespace habitrpg::app
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <variant>
+
+#include "habitrpg/app/app_state.hpp"
+#include "habitrpg/data/repositories.hpp"
+#include "habitrpg/domain/contracts.hpp"
+#include "habitrpg/domain/interaction_flow.hpp"
+
+namespace habitrpg::app {
+
+// Every user command that changes the runtime collections. Each is journaled before it
+// applies, so a crash between two compaction saves loses none of them.
+using JournaledCommand = std::variant<
+    domain::contracts::CreateLifeActionCommand,
+    domain::contracts::StartUnitCommand,
+    domain::contracts::CompleteActionCommand,
+    domain::contracts::CompleteLearningSessionCommand,
+    domain::contracts::CheckpointLearningSessionCommand,
+    domain::contracts::CreateLearningGoalCommand,
+    domain::contracts::CreateLearningSessionCommand,
+    domain::contracts::SetUnitLifecycleCommand,
+    domain::contracts::SaveCheckpointCandidateCommand,
+    domain::contracts::ConfirmMilestoneCheckpointCommand>;
+
+// Payloads are `key=value` lines (backslash-escaped), tagged with the contract command id.
+data::CommandJournalRecord EncodeCommand(const JournaledCommand& command);
+// nullopt for unknown command ids or malformed payloads.
+std::optional<JournaledCommand> DecodeCommand(const data::CommandJournalRecord& record);
+
+// Applies a command to the runtime collections through InteractionFlowService and returns
+// true when state changed. Completions and confirmations use the command's timestamp, so
+// a replay credits the original day; a create with an id uses that id and is skipped when
+// the row already exists.
+bool ApplyCommand(const JournaledCommand& command, const domain::InteractionFlowService& flow, AppState* app_state);
+
+// Assigns a created row's id, appends the command to app_state->command_journal (when
+// set), then applies it. A journaled command only bumps the mutation revision and waits
+// for the next compaction save (see SaveDue); an unjournaled one requests a save at once.
+// The append commits before the command applies, so any save collected afterwards covers
+// it and may truncate it. Give the journal
+// its own connection with a short busy timeout (Application uses 16 ms), since a save in
+// flight holds the write lock: a busy or failed append is reported through
+// last_journal_error (shown in the State Panel), and the command still applies and
+// reaches disk with the next save.
+bool DispatchCommand(AppState* app_state, const domain::InteractionFlowService& flow, const JournaledCommand& command);
+
+// Re-applies the commands left in the journal, i.e. those whose effects were not saved
+// before the app stopped. Call after the runtime collections are loaded from storage.
+// Returns the number of commands that changed state; undecodable records are skipped.
+size_t ReplayCommandJournal(
+    const data::ICommandJournalRepository& journal,
+    const domain::InteractionFlowService& flow,
+    AppState* app_state);
+
+}  // namespace habitrpg::app
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace habitrpg::app {
+
+// Unbounded lock-free multi-producer / single-consumer queue. Producers push with a
+// CAS on the list head; the consumer detaches the whole list in one exchange, so
+// there is no per-node pop and therefore no ABA hazard.
+template <typename T>
+class MpscQueue final {
+ public:
+  MpscQueue() = default;
+
+  ~MpscQueue() {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+    while (node != nullptr) {
+      Node* next = node->next;
+      delete node;
+      node = next;
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  MpscQueue(MpscQueue&&) = delete;
+  MpscQueue& operator=(MpscQueue&&) = delete;
+
+  void Push(T value) {
+    auto* node = new Node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+  }
+
+  // Removes every queued item and returns them in push order.
+  std::vector<T> Drain() {
+    Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+
+    std::vector<T> items;
+    while (node != nullptr) {
+      Node* next = node->next;
+      items.push_back(std::move(node->value));
+      delete node;
+      node = next;
+    }
+
+    std::reverse(items.begin(), items.end());
+    return items;
+  }
+
+  bool Empty() const { return head_.load(std::memory_order_acquire) == nullptr; }
+
+ private:
+  struct Node {
+    T value;
+    Node* next{nullptr};
+  };
+
+  std::atomic<Node*> head_{nullptr};
+};
+
+}  // namespace habitrpg::app
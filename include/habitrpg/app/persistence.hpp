@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "habitrpg/app/app_state.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
+
+namespace habitrpg::app {
+
+// Rows marked dirty as of `revision`, plus reward events appended since the last save.
+// Journaled commands up to `journal_through` are already reflected in the rows and are
+// dropped from the journal in the same transaction.
+struct PersistenceChangeSet {
+  uint64_t revision{0};
+  std::optional<domain::UserState> user_state{};
+  std::optional<data::UiPreferences> ui_preferences{};
+  std::vector<domain::ActionUnit> life_actions{};
+  std::vector<domain::LearningGoal> learning_goals{};
+  std::vector<domain::LearningSession> learning_sessions{};
+  std::vector<domain::MilestoneCheckpoint> milestone_checkpoints{};
+  std::vector<domain::RewardEvent> reward_events{};
+  size_t reward_events_begin{0};
+  size_t reward_events_end{0};
+  uint64_t journal_through{0};
+
+  size_t RowCount() const;
+};
+
+// Journaled commands are already durable, so their rows are compacted into the tables at
+// most this often.
+inline constexpr std::chrono::seconds kCompactionInterval{30};
+
+// True when unsaved changes should be submitted now: a save was requested (an edit the
+// journal does not hold) or the compaction interval has passed since the last one.
+// Never while a failed save waits for a retry.
+bool SaveDue(const AppState& app_state, std::chrono::steady_clock::time_point now);
+
+data::UiPreferences BuildUiPreferences(const AppState& app_state);
+
+// Records the current runtime collections as persisted and clears every dirty mark (used
+// after loading from storage).
+void ResetPersistedShadow(AppState* app_state);
+
+PersistenceChangeSet CollectChangeSet(const AppState& app_state);
+
+// Writes the change set in one unit of work and returns the number of rows written.
+size_t WriteChangeSet(data::SqliteRepository& repository, const PersistenceChangeSet& change_set);
+
+void MarkChangeSetPersisted(AppState* app_state, const PersistenceChangeSet& change_set);
+
+// Marks the rows of a change set that failed to write dirty again, so the next save
+// collects them again.
+void ForgetPersisted(AppState* app_state, const PersistenceChangeSet& change_set);
+
+// Folds `newer` into `into`: rows of the same entity keep only the newest value and
+// reward events are appended in order.
+void MergeChangeSets(PersistenceChangeSet* into, PersistenceChangeSet&& newer);
+
+}  // namespace habitrpg::app
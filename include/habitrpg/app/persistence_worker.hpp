@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "habitrpg/app/app_state.hpp"
+#include "habitrpg/app/mpsc_queue.hpp"
+#include "habitrpg/app/persistence.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
+
+namespace habitrpg::app {
+
+struct PersistenceResult {
+  uint64_t revision{0};
+  bool ok{false};
+  size_t rows_written{0};
+  size_t coalesced_change_sets{0};
+  std::string error{};
+  PersistenceChangeSet failed_change_set{};  // populated only when ok == false
+};
+
+// Write-behind persistence. The UI thread submits immutable change sets; a worker
+// thread drains everything queued so far, coalesces it into one change set, and
+// writes it through its own SQLite connection. Results flow back through a second
+// lock-free queue and are applied on the UI thread with ApplyPersistenceResult().
+class PersistenceWorker final {
+ public:
+  explicit PersistenceWorker(const std::string& sqlite_path, data::SqliteRepositoryOptions options = {});
+  ~PersistenceWorker();
+
+  PersistenceWorker(const PersistenceWorker&) = delete;
+  PersistenceWorker& operator=(const PersistenceWorker&) = delete;
+  PersistenceWorker(PersistenceWorker&&) = delete;
+  PersistenceWorker& operator=(PersistenceWorker&&) = delete;
+
+  void Submit(PersistenceChangeSet change_set);
+  std::vector<PersistenceResult> PollResults();
+
+  // Blocks until every change set submitted before the call has been written or failed.
+  void Flush();
+  void Stop();
+
+ private:
+  void Run(const std::stop_token& stop_token);
+
+  data::SqliteRepository repository_;
+  MpscQueue<PersistenceChangeSet> pending_;
+  MpscQueue<PersistenceResult> results_;
+  std::atomic<uint64_t> submitted_{0};
+  std::atomic<uint64_t> completed_{0};
+  std::atomic<uint64_t> wake_{0};
+  std::jthread thread_;
+};
+
+// Applies a worker result to the UI-side state while keeping the synchronous save
+// semantics: a failure sets save_error_pending_retry/last_save_error and re-dirties
+// the failed rows; successes only advance persisted_revision while no error is pending.
+void ApplyPersistenceResult(AppState* app_state, PersistenceResult result);
+
+}  // namespace habitrpg::app
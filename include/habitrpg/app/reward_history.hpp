@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+#include "habitrpg/app/app_state.hpp"
+#include "habitrpg/data/repositories.hpp"
+
+namespace habitrpg::app {
+
+inline constexpr size_t kStartupRewardWindow = 500;
+inline constexpr size_t kRewardHistoryPageSize = 100;
+
+// Replaces runtime.reward_events with the newest `window` events across both tracks
+// (oldest first) and remembers where older history continues.
+void LoadRecentRewardEvents(
+    const data::IRewardRepository& repository,
+    AppState* app_state,
+    size_t window = kStartupRewardWindow);
+
+// Appends the next older page to runtime.older_reward_events. Those rows are already
+// stored and never take part in saves. Returns the number of rows fetched.
+size_t LoadOlderRewardEvents(
+    const data::IRewardRepository& repository,
+    AppState* app_state,
+    size_t page_size = kRewardHistoryPageSize);
+
+bool HasOlderRewardEvents(const AppState& app_state);
+
+}  // namespace habitrpg::app
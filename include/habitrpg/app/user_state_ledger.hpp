@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "habitrpg/data/repositories.hpp"
+#include "habitrpg/domain/reward_engine.hpp"
+
+namespace habitrpg::app {
+
+inline constexpr size_t kUserStateSnapshotInterval = 256;
+
+struct UserStateReplay {
+  domain::UserState user_state{};
+  uint64_t through_sequence{0};
+  size_t replayed_events{0};
+  bool cached_row_stale{false};  // the stored user_state row disagreed with the ledger
+};
+
+// Rebuilds UserState from the reward ledger: the latest snapshot plus every event
+// appended after it, folded with RewardEngine::ApplyReward. recovery_tokens is not
+// derived from rewards and is taken from the stored user_state row.
+UserStateReplay ReplayUserState(
+    const data::IRewardRepository& rewards,
+    const data::IUserStateRepository& user_states,
+    const domain::RewardEngine& reward_engine);
+
+// Writes a new snapshot once at least `interval` events were appended since the last
+// one. Call inside the unit of work that appended the events. Returns true when a
+// snapshot was written.
+bool CheckpointUserState(
+    const data::IRewardRepository& rewards,
+    data::IUserStateRepository& user_states,
+    const domain::RewardEngine& reward_engine,
+    size_t interval = kUserStateSnapshotInterval);
+
+}  // namespace habitrpg::app
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "habitrpg/data/change_feed.hpp"
+#include "habitrpg/data/lru_cache.hpp"
+#include "habitrpg/data/repositories.hpp"
+
+namespace habitrpg::data {
+
+inline constexpr size_t kDefaultEntityCacheCapacity = 512;
+
+// Thread-safe id -> row cache shared by the read-through decorators below. Misses are
+// cached too (as nullopt), so repeated lookups of unknown ids stay off the backend.
+// A load that raced with an invalidation is returned but not cached. Keys are plain
+// strings: interning them would pin every queried id, misses included, for the life of
+// the process.
+template <typename Entity>
+class ReadThroughCache final {
+ public:
+  explicit ReadThroughCache(const size_t capacity) : cache_(capacity) {}
+
+  template <typename Loader>
+  std::optional<Entity> Find(const std::string& id, const Loader& load) const {
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (auto cached = cache_.Get(id)) {
+        return *cached;
+      }
+      generation = generation_;
+    }
+
+    auto loaded = load(id);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (generation == generation_) {
+      cache_.Put(id, loaded);
+    }
+    return loaded;
+  }
+
+  void Invalidate(const std::string& id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    cache_.Erase(id);
+  }
+
+  void Invalidate(const std::span<const EntityChange> changes, const ChangeTable table) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    for (const auto& change : changes) {
+      if (change.table == table) {
+        cache_.Erase(change.entity_id);
+      }
+    }
+  }
+
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    cache_.Clear();
+  }
+
+  LruCacheStats Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_.Stats();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  mutable LruCache<std::string, std::optional<Entity>> cache_;
+  uint64_t generation_{0};
+};
+
+// Read-through decorators for the Find*ById lookups. Upserts are written through to the
+// wrapped repository and then invalidate the cached row, so the next lookup re-reads the
+// normalized row. Every other call is forwarded unchanged. The wrapped repository must
+// outlive the decorator. Writes that bypass the decorator are picked up by feeding
+// committed changes (SqliteRepository::Changes()) to ApplyChanges; a rolled-back unit of
+// work still requires Clear().
+class CachedActionUnitRepository final : public IActionUnitRepository {
+ public:
+  explicit CachedActionUnitRepository(
+      IActionUnitRepository& inner,
+      size_t capacity = kDefaultEntityCacheCapacity);
+
+  void UpsertActionUnit(const domain::ActionUnit& action_unit) override;
+  void UpsertActionUnits(std::span<const domain::ActionUnit> action_units) override;
+  std::optional<domain::ActionUnit> FindActionUnitById(const std::string& id) const override;
+  std::vector<domain::ActionUnit> ListActionUnitsByTrack(domain::TrackType track_type) const override;
+
+  void ApplyChanges(std::span<const EntityChange> changes);
+  void Clear() { cache_.Clear(); }
+  LruCacheStats Stats() const { return cache_.Stats(); }
+
+ private:
+  IActionUnitRepository& inner_;
+  ReadThroughCache<domain::ActionUnit> cache_;
+};
+
+class CachedLearningRepository final : public ILearningRepository {
+ public:
+  explicit CachedLearningRepository(ILearningRepository& inner, size_t capacity = kDefaultEntityCacheCapacity);
+
+  void UpsertLearningGoal(const domain::LearningGoal& goal) override;
+  void UpsertLearningGoals(std::span<const domain::LearningGoal> goals) override;
+  std::optional<domain::LearningGoal> FindLearningGoalById(const std::string& id) const override;
+  std::vector<domain::LearningGoal> ListLearningGoals() const override;
+  void UpsertLearningSession(const domain::LearningSession& session) override;
+  void UpsertLearningSessions(std::span<const domain::LearningSession> sessions) override;
+  std::vector<domain::LearningSession> ListLearningSessionsByGoal(const std::string& goal_id) const override;
+  std::vector<domain::LearningSession> ListLearningSessions() const override;
+  void VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const override;
+
+  void ApplyChanges(std::span<const EntityChange> changes);
+  void Clear() { cache_.Clear(); }
+  LruCacheStats Stats() const { return cache_.Stats(); }
+
+ private:
+  ILearningRepository& inner_;
+  ReadThroughCache<domain::LearningGoal> cache_;
+};
+
+class CachedMilestoneCheckpointRepository final : public IMilestoneCheckpointRepository {
+ public:
+  explicit CachedMilestoneCheckpointRepository(
+      IMilestoneCheckpointRepository& inner,
+      size_t capacity = kDefaultEntityCacheCapacity);
+
+  void UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) override;
+  void UpsertMilestoneCheckpoints(std::span<const domain::MilestoneCheckpoint> checkpoints) override;
+  std::optional<domain::MilestoneCheckpoint> FindMilestoneCheckpointById(const std::string& id) const override;
+  std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpointsByGoal(const std::string& goal_id) const override;
+  std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpoints() const override;
+  void VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const override;
+
+  void ApplyChanges(std::span<const EntityChange> changes);
+  void Clear() { cache_.Clear(); }
+  LruCacheStats Stats() const { return cache_.Stats(); }
+
+ private:
+  IMilestoneCheckpointRepository& inner_;
+  ReadThroughCache<domain::MilestoneCheckpoint> cache_;
+};
+
+}  // namespace habitrpg::data
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace habitrpg::data {
+
+enum class ChangeTable {
+  Habits,
+  Quests,
+  ActionUnits,
+  LearningGoals,
+  LearningSessions,
+  MilestoneCheckpoints,
+  RewardEvents,
+  UserState,
+  UiPreferences,
+};
+
+enum class ChangeOperation {
+  Insert,
+  Update,
+  Delete,  // the row left the live table (archival)
+};
+
+// One committed row change. entity_id is empty for the single-row tables (user state,
+// UI preferences). It is a plain string so that reward ledger changes are not interned.
+struct EntityChange {
+  ChangeTable table{ChangeTable::ActionUnits};
+  std::string entity_id;
+  ChangeOperation operation{ChangeOperation::Update};
+
+  bool operator==(const EntityChange&) const = default;
+};
+
+using ChangeSubscriber = std::function<void(std::span<const EntityChange> changes)>;
+
+// Fan-out of committed row changes. A publisher hands over every change of one
+// transaction as a single batch, in write order. Subscribers run synchronously on the
+// publishing (writer) thread, outside the feed's lock, so callbacks may subscribe or
+// unsubscribe (e.g. one-shot listeners); a subscriber added during a batch first sees the
+// next one. Unsubscribe from another thread waits for batches in flight, so once it
+// returns the callback is not running and will not run again. A callback that throws
+// does not stop the others or fail the write.
+class ChangeFeed final {
+ public:
+  using SubscriptionId = uint64_t;
+
+  ChangeFeed() = default;
+
+  ChangeFeed(const ChangeFeed&) = delete;
+  ChangeFeed& operator=(const ChangeFeed&) = delete;
+  ChangeFeed(ChangeFeed&&) = delete;
+  ChangeFeed& operator=(ChangeFeed&&) = delete;
+
+  SubscriptionId Subscribe(ChangeSubscriber subscriber);
+  void Unsubscribe(SubscriptionId id);
+  bool HasSubscribers() const;
+
+  void Publish(std::span<const EntityChange> changes) const;
+
+ private:
+  struct Subscription {
+    SubscriptionId id{0};
+    ChangeSubscriber callback{};
+    bool active{true};  // guarded by mutex_
+  };
+
+  mutable std::mutex mutex_;
+  mutable std::condition_variable idle_;
+  std::vector<std::shared_ptr<Subscription>> subscribers_;
+  mutable std::vector<std::thread::id> publishing_threads_;  // one entry per batch in flight
+  SubscriptionId next_id_{1};
+};
+
+}  // namespace habitrpg::data
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "habitrpg/data/repositories.hpp"
+
+namespace habitrpg::data {
+
+// Memory-only implementation of every repository interface, for benchmarks, large
+// simulations and headless runs that should not pay for disk I/O or SQL. Writes are
+// normalized exactly like SqliteRepository (clamped scores, derived action status,
+// canonical timestamps, unparseable timestamps rejected) and list/visit/page calls
+// return rows in the same order, so the two backends are interchangeable.
+//
+// Rows live in dense insertion-ordered vectors with an id -> slot hash index. The
+// reward ledger additionally keeps (created_at, id)-sorted slot indexes, overall and
+// per track, and per-day rollups are maintained on write like the SQLite triggers.
+// Archival follows the SQLite rules; archived ledger rows leave the front of the
+// ledger, so sequences are offset by the number of rows archived.
+// Batch writes validate every row before applying any, under a single write lock.
+// Search scans the live rows: it matches like the FTS5 index for ASCII text, but ranks
+// by weighted hit count instead of bm25 and does not shorten snippets.
+// Calls are thread-safe; visitors run under the read lock and must not
+// write back into the repository.
+class InMemoryRepository final : public IHabitRepository,
+                                 public IQuestRepository,
+                                 public IActionUnitRepository,
+                                 public ILearningRepository,
+                                 public IMilestoneCheckpointRepository,
+                                 public IRewardRepository,
+                                 public IUserStateRepository,
+                                 public IInsightsRepository,
+                                 public IArchiveRepository,
+                                 public ICommandJournalRepository,
+                                 public ISearchRepository,
+                                 public IUiPreferencesRepository {
+ public:
+  InMemoryRepository() = default;
+
+  InMemoryRepository(const InMemoryRepository&) = delete;
+  InMemoryRepository& operator=(const InMemoryRepository&) = delete;
+  InMemoryRepository(InMemoryRepository&&) = delete;
+  InMemoryRepository& operator=(InMemoryRepository&&) = delete;
+
+  // Replaces the current contents with everything stored in the SQLite file (migrated
+  // to the latest schema first).
+  void LoadSnapshot(const std::string& sqlite_path);
+  // Upserts the current contents into the SQLite file in a single transaction.
+  // UserState snapshots and the command journal are not copied in either direction:
+  // sequences are local to a backend, and restores without a snapshot replay the full
+  // ledger instead.
+  // Archived rows are loaded into the archive; on save they are written as live rows,
+  // which a file that already archived them ignores.
+  void SaveSnapshot(const std::string& sqlite_path) const;
+  void Clear();
+
+  void UpsertHabit(const domain::Habit& habit) override;
+  void UpsertHabits(std::span<const domain::Habit> habits) override;
+  std::optional<domain::Habit> FindHabitById(const std::string& id) const override;
+  std::vector<domain::Habit> ListHabits() const override;
+
+  void UpsertQuest(const domain::Quest& quest) override;
+  void UpsertQuests(std::span<const domain::Quest> quests) override;
+  std::vector<domain::Quest> ListQuests() const override;
+
+  void UpsertActionUnit(const domain::ActionUnit& action_unit) override;
+  void UpsertActionUnits(std::span<const domain::ActionUnit> action_units) override;
+  std::optional<domain::ActionUnit> FindActionUnitById(const std::string& id) const override;
+  std::vector<domain::ActionUnit> ListActionUnitsByTrack(domain::TrackType track_type) const override;
+
+  void UpsertLearningGoal(const domain::LearningGoal& goal) override;
+  void UpsertLearningGoals(std::span<const domain::LearningGoal> goals) override;
+  std::optional<domain::LearningGoal> FindLearningGoalById(const std::string& id) const override;
+  std::vector<domain::LearningGoal> ListLearningGoals() const override;
+  void UpsertLearningSession(const domain::LearningSession& session) override;
+  void UpsertLearningSessions(std::span<const domain::LearningSession> sessions) override;
+  std::vector<domain::LearningSession> ListLearningSessionsByGoal(const std::string& goal_id) const override;
+  std::vector<domain::LearningSession> ListLearningSessions() const override;
+  void VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const override;
+
+  void UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) override;
+  void UpsertMilestoneCheckpoints(std::span<const domain::MilestoneCheckpoint> checkpoints) override;
+  std::optional<domain::MilestoneCheckpoint> FindMilestoneCheckpointById(const std::string& id) const override;
+  std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpointsByGoal(const std::string& goal_id) const override;
+  std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpoints() const override;
+  void VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const override;
+
+  void AppendRewardEvent(const domain::RewardEvent& reward_event) override;
+  void AppendRewardEvents(std::span<const domain::RewardEvent> reward_events) override;
+  std::vector<domain::RewardEvent> ListRewardEventsByTrack(domain::TrackType track_type) const override;
+  void VisitRewardEventsByTrack(
+      domain::TrackType track_type,
+      const RowVisitor<domain::RewardEvent>& visitor) const override;
+  RewardEventPage ListRewardEventsPage(const RewardEventPageQuery& query) const override;
+  bool HasRewardEvent(const std::string& reward_event_id) const override;
+  uint64_t LatestRewardSequence() const override;
+  void VisitRewardLedgerAfter(uint64_t after_sequence, const RewardLedgerVisitor& visitor) const override;
+
+  domain::UserState LoadUserState() const override;
+  void SaveUserState(const domain::UserState& user_state) override;
+  void SaveUserStateSnapshot(const UserStateSnapshot& snapshot) override;
+  std::optional<UserStateSnapshot> LoadLatestUserStateSnapshot() const override;
+
+  std::vector<DailyXpPoint> ListDailyXp(const std::string& from_day, const std::string& until_day) const override;
+  std::vector<LearningMinutesPoint> ListDailyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const override;
+  std::vector<LearningMinutesPoint> ListWeeklyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const override;
+  TrackXpTotals LoadTrackXpTotals() const override;
+
+  ArchiveSummary ArchiveCompletedBefore(const std::string& completed_before) override;
+  ArchiveSummary CountArchivedRows() const override;
+  void VisitArchivedActionUnits(const RowVisitor<domain::ActionUnit>& visitor) const override;
+  void VisitArchivedLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const override;
+  void VisitArchivedRewardEvents(const RewardLedgerVisitor& visitor) const override;
+
+  uint64_t AppendCommand(const CommandJournalRecord& record) override;
+  void VisitCommandsAfter(uint64_t after_sequence, const CommandJournalVisitor& visitor) const override;
+  void TruncateCommandsThrough(uint64_t through_sequence) override;
+
+  SearchPage Search(const SearchQuery& query) const override;
+
+  UiPreferences LoadUiPreferences() const override;
+  void SaveUiPreferences(const UiPreferences& preferences) override;
+
+ private:
+  template <typename Entity>
+  struct Table {
+    std::vector<Entity> rows;
+    std::unordered_map<domain::EntityId, size_t> slot_by_id;
+  };
+
+  struct StoredRewardEvent {
+    domain::RewardEvent event;
+    int64_t created_at_ms{0};
+  };
+
+  struct ArchivedRewardEvent {
+    uint64_t sequence{0};
+    domain::RewardEvent event;
+    int64_t created_at_ms{0};
+  };
+
+  struct RewardDayRollup {
+    std::array<int, 2> xp_total{};  // indexed by storage track code
+    int event_count{0};
+  };
+
+  struct LearningDayRollup {
+    int minutes{0};
+    int completed_sessions{0};
+  };
+
+  template <typename Entity>
+  static void UpsertRow(Table<Entity>* table, Entity row);
+  template <typename Entity>
+  static std::optional<Entity> FindRow(const Table<Entity>& table, const std::string& id);
+  // Moves matching rows to `to`, keeping the order of both tables.
+  template <typename Entity, typename Predicate>
+  static size_t MoveRowsIf(Table<Entity>* from, Table<Entity>* to, Predicate predicate);
+
+  bool RewardSlotLess(uint32_t lhs, uint32_t rhs) const;
+  void AppendRewardEventLocked(const domain::RewardEvent& reward_event);
+  void AppendArchivedRewardEventLocked(ArchivedRewardEvent archived);
+  void AddRewardRollup(const domain::RewardEvent& reward_event, int64_t created_at_ms);
+  size_t ArchiveLedgerPrefixLocked(int64_t horizon_ms);
+  void UpsertLearningSessionLocked(const domain::LearningSession& session);
+  void AddLearningRollup(const domain::LearningSession& session, int sign);
+  void ClearLocked();
+
+  mutable std::shared_mutex mutex_;
+  Table<domain::Habit> habits_;
+  Table<domain::Quest> quests_;
+  Table<domain::ActionUnit> action_units_;
+  Table<domain::LearningGoal> learning_goals_;
+  Table<domain::LearningSession> learning_sessions_;
+  Table<domain::MilestoneCheckpoint> milestone_checkpoints_;
+
+  std::vector<StoredRewardEvent> reward_events_;
+  std::unordered_map<std::string, size_t> reward_slot_by_id_;
+  std::vector<uint32_t> reward_order_;                          // ascending (created_at, id)
+  std::array<std::vector<uint32_t>, 2> reward_order_by_track_;  // indexed by storage track code
+  uint64_t reward_sequence_base_{0};                              // sequence of slot i is base + i + 1
+
+  Table<domain::ActionUnit> archived_action_units_;
+  Table<domain::LearningSession> archived_learning_sessions_;
+  std::vector<ArchivedRewardEvent> archived_reward_events_;      // ascending sequence
+  std::unordered_set<std::string> archived_reward_ids_;
+  std::vector<uint32_t> archived_reward_order_;                          // ascending (created_at, id)
+  std::array<std::vector<uint32_t>, 2> archived_reward_order_by_track_;  // indexed by storage track code
+
+  std::map<int64_t, RewardDayRollup> reward_daily_rollups_;      // by epoch day
+  std::map<int64_t, LearningDayRollup> learning_daily_rollups_;  // by epoch day
+
+  std::vector<UserStateSnapshot> user_state_snapshots_;  // ascending through_sequence
+  std::vector<CommandJournalRecord> command_journal_;     // ascending sequence
+  uint64_t next_command_sequence_{1};
+  std::optional<domain::UserState> user_state_;
+  std::optional<UiPreferences> ui_preferences_;
+};
+
+}  // namespace habitrpg::data
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace habitrpg::data {
+
+struct LruCacheStats {
+  uint64_t hits{0};
+  uint64_t misses{0};
+  uint64_t evictions{0};
+  uint64_t invalidations{0};
+  size_t entries{0};
+  size_t capacity{0};
+
+  double HitRate() const {
+    const uint64_t lookups = hits + misses;
+    return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+  }
+};
+
+// Bounded least-recently-used map. Get refreshes recency; Put evicts the least recently
+// used entry once `capacity` entries are held. A capacity of 0 caches nothing. Not
+// thread-safe.
+template <typename Key, typename Value>
+class LruCache final {
+ public:
+  explicit LruCache(const size_t capacity) : capacity_(capacity) { index_.reserve(capacity); }
+
+  std::optional<Value> Get(const Key& key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      ++misses_;
+      return std::nullopt;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->second;
+  }
+
+  void Put(const Key& key, Value value) {
+    if (capacity_ == 0) {
+      return;
+    }
+
+    const auto it = index_.find(key);
+    if (it != index_.end()) {
+      it->second->second = std::move(value);
+      entries_.splice(entries_.begin(), entries_, it->second);
+      return;
+    }
+
+    if (entries_.size() == capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+      ++evictions_;
+    }
+    entries_.emplace_front(key, std::move(value));
+    index_.emplace(key, entries_.begin());
+  }
+
+  void Erase(const Key& key) {
+    const auto it = index_.find(key);
+    if (it == index_.end()) {
+      return;
+    }
+    entries_.erase(it->second);
+    index_.erase(it);
+    ++invalidations_;
+  }
+
+  void Clear() {
+    invalidations_ += entries_.size();
+    entries_.clear();
+    index_.clear();
+  }
+
+  LruCacheStats Stats() const {
+    return LruCacheStats{hits_, misses_, evictions_, invalidations_, entries_.size(), capacity_};
+  }
+
+ private:
+  using Entries = std::list<std::pair<Key, Value>>;  // most recently used first
+
+  size_t capacity_{0};
+  Entries entries_;
+  std::unordered_map<Key, typename Entries::iterator> index_;
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  uint64_t evictions_{0};
+  uint64_t invalidations_{0};
+};
+
+}  // namespace habitrpg::data
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
+
 #include <sqlite3.h>
 
 namespace habitrpg::data {
@@ -7,8 +10,37 @@ namespace habitrpg::data {
 inline constexpr int kSchemaVersionV1 = 1;
 inline constexpr int kSchemaVersionV2 = 2;
 inline constexpr int kSchemaVersionV3 = 3;
+inline constexpr int kSchemaVersionV4 = 4;
+inline constexpr int kSchemaVersionV5 = 5;
+inline constexpr int kSchemaVersionV6 = 6;
+inline constexpr int kSchemaVersionV7 = 7;
+inline constexpr int kSchemaVersionV8 = 8;
+inline constexpr int kSchemaVersionV9 = 9;
+inline constexpr int kSchemaVersionV10 = 10;
+inline constexpr int kSchemaVersionV11 = 11;
+inline constexpr int kSchemaVersionV12 = 12;
+inline constexpr int kSchemaVersionV13 = 13;
+inline constexpr int kSchemaVersionLatest = kSchemaVersionV13;
+
+// Reported after each committed batch of a chunked table copy during an upgrade.
+struct MigrationProgress {
+  int version{0};  // schema version being applied
+  size_t rows_done{0};
+  size_t rows_total{0};
+};
+
+using MigrationProgressCallback = std::function<void(const MigrationProgress&)>;
+
+struct MigrationOptions {
+  int target_version{kSchemaVersionLatest};
+  // Rows copied per transaction by the chunked legacy rebuilds.
+  size_t batch_rows{20000};
+  MigrationProgressCallback on_progress{};
+};
 
 int ReadSchemaVersion(sqlite3* db);
-void RunMigrations(sqlite3* db, int target_version = kSchemaVersionV3);
+// Returns after a single SELECT when the stored version is already >= the target.
+void RunMigrations(sqlite3* db, int target_version = kSchemaVersionLatest);
+void RunMigrations(sqlite3* db, const MigrationOptions& options);
 
 }  // namespace habitrpg::data
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -16,11 +20,22 @@ inline constexpr std::string_view kLifeTrackId = "life";
 inline constexpr std::string_view kLearningTrackId = "learning";
 }  // namespace contracts
 
+// Streaming read callback. Rows are delivered in the same order as the matching List*
+// call; the referenced row is only valid for the duration of the call. Return false
+// to stop the scan early.
+template <typename Entity>
+using RowVisitor = std::function<bool(const Entity&)>;
+
+// Batch writes (Upsert*s / AppendRewardEvents) behave like calling the single-row
+// method for each element in order, but apply the whole span atomically: either every
+// row is written or, when one is rejected, none is.
+
 class IHabitRepository {
  public:
   virtual ~IHabitRepository() = default;
 
   virtual void UpsertHabit(const domain::Habit& habit) = 0;
+  virtual void UpsertHabits(std::span<const domain::Habit> habits) = 0;
   virtual std::optional<domain::Habit> FindHabitById(const std::string& id) const = 0;
   virtual std::vector<domain::Habit> ListHabits() const = 0;
 };
@@ -30,6 +45,7 @@ class IQuestRepository {
   virtual ~IQuestRepository() = default;
 
   virtual void UpsertQuest(const domain::Quest& quest) = 0;
+  virtual void UpsertQuests(std::span<const domain::Quest> quests) = 0;
   virtual std::vector<domain::Quest> ListQuests() const = 0;
 };
 
@@ -38,6 +54,7 @@ class IActionUnitRepository {
   virtual ~IActionUnitRepository() = default;
 
   virtual void UpsertActionUnit(const domain::ActionUnit& action_unit) = 0;
+  virtual void UpsertActionUnits(std::span<const domain::ActionUnit> action_units) = 0;
   virtual std::optional<domain::ActionUnit> FindActionUnitById(const std::string& id) const = 0;
   virtual std::vector<domain::ActionUnit> ListActionUnitsByTrack(domain::TrackType track_type) const = 0;
 };
@@ -47,11 +64,14 @@ class ILearningRepository {
   virtual ~ILearningRepository() = default;
 
   virtual void UpsertLearningGoal(const domain::LearningGoal& goal) = 0;
+  virtual void UpsertLearningGoals(std::span<const domain::LearningGoal> goals) = 0;
   virtual std::optional<domain::LearningGoal> FindLearningGoalById(const std::string& id) const = 0;
   virtual std::vector<domain::LearningGoal> ListLearningGoals() const = 0;
   virtual void UpsertLearningSession(const domain::LearningSession& session) = 0;
+  virtual void UpsertLearningSessions(std::span<const domain::LearningSession> sessions) = 0;
   virtual std::vector<domain::LearningSession> ListLearningSessionsByGoal(const std::string& goal_id) const = 0;
   virtual std::vector<domain::LearningSession> ListLearningSessions() const = 0;
+  virtual void VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const = 0;
 };
 
 class IMilestoneCheckpointRepository {
@@ -59,17 +79,66 @@ class IMilestoneCheckpointRepository {
   virtual ~IMilestoneCheckpointRepository() = default;
 
   virtual void UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) = 0;
+  virtual void UpsertMilestoneCheckpoints(std::span<const domain::MilestoneCheckpoint> checkpoints) = 0;
   virtual std::optional<domain::MilestoneCheckpoint> FindMilestoneCheckpointById(const std::string& id) const = 0;
   virtual std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpointsByGoal(const std::string& goal_id) const = 0;
   virtual std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpoints() const = 0;
+  virtual void VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const = 0;
+};
+
+// Keyset position in the reward ledger, ordered by (created_at, id).
+struct RewardEventCursor {
+  std::string created_at{};
+  std::string id{};
+
+  bool operator==(const RewardEventCursor&) const = default;
+};
+
+// Newest-first page request. Empty time bounds are unbounded; created_from is
+// inclusive and created_until exclusive. A set `before` cursor continues a
+// previous page with strictly older rows.
+struct RewardEventPageQuery {
+  std::optional<domain::TrackType> track_type{};
+  std::optional<RewardEventCursor> before{};
+  std::string created_from{};
+  std::string created_until{};
+  size_t page_size{100};
 };
 
+struct RewardEventPage {
+  std::vector<domain::RewardEvent> events{};  // newest first
+  std::optional<RewardEventCursor> next{};    // set when older rows remain
+};
+
+// Reward ledger in append order. Sequences are positive, strictly increasing and never
+// reused; 0 means "before the first event". VisitRewardLedgerAfter includes archived
+// events (see IArchiveRepository).
+using RewardLedgerVisitor = std::function<bool(uint64_t sequence, const domain::RewardEvent&)>;
+
 class IRewardRepository {
  public:
   virtual ~IRewardRepository() = default;
 
   virtual void AppendRewardEvent(const domain::RewardEvent& reward_event) = 0;
+  virtual void AppendRewardEvents(std::span<const domain::RewardEvent> reward_events) = 0;
   virtual std::vector<domain::RewardEvent> ListRewardEventsByTrack(domain::TrackType track_type) const = 0;
+  virtual void VisitRewardEventsByTrack(
+      domain::TrackType track_type,
+      const RowVisitor<domain::RewardEvent>& visitor) const = 0;
+  virtual RewardEventPage ListRewardEventsPage(const RewardEventPageQuery& query) const = 0;
+  // True when an event with this id is stored, live or archived.
+  virtual bool HasRewardEvent(const std::string& reward_event_id) const = 0;
+  virtual uint64_t LatestRewardSequence() const = 0;
+  virtual void VisitRewardLedgerAfter(uint64_t after_sequence, const RewardLedgerVisitor& visitor) const = 0;
+};
+
+// UserState folded from every reward event up to and including through_sequence.
+struct UserStateSnapshot {
+  uint64_t through_sequence{0};
+  domain::UserState user_state{};
+  std::string created_at{};
+
+  bool operator==(const UserStateSnapshot&) const = default;
 };
 
 class IUserStateRepository {
@@ -78,6 +147,145 @@ class IUserStateRepository {
 
   virtual domain::UserState LoadUserState() const = 0;
   virtual void SaveUserState(const domain::UserState& user_state) = 0;
+  virtual void SaveUserStateSnapshot(const UserStateSnapshot& snapshot) = 0;
+  virtual std::optional<UserStateSnapshot> LoadLatestUserStateSnapshot() const = 0;
+};
+
+// Insights series read from the per-day rollup tables, so their cost grows with the
+// number of days rather than the number of events. Days are UTC "YYYY-MM-DD";
+// from_day is inclusive, until_day exclusive, and empty bounds are unbounded. Days
+// without activity are omitted.
+struct DailyXpPoint {
+  std::string day{};
+  int life_xp{0};
+  int learning_xp{0};
+  int reward_events{0};
+
+  bool operator==(const DailyXpPoint&) const = default;
+};
+
+// period_start is the day itself for daily series and the Monday for weekly series.
+struct LearningMinutesPoint {
+  std::string period_start{};
+  int minutes{0};
+  int completed_sessions{0};
+
+  bool operator==(const LearningMinutesPoint&) const = default;
+};
+
+struct TrackXpTotals {
+  int life_xp{0};
+  int learning_xp{0};
+  int reward_events{0};
+
+  bool operator==(const TrackXpTotals&) const = default;
+};
+
+class IInsightsRepository {
+ public:
+  virtual ~IInsightsRepository() = default;
+
+  virtual std::vector<DailyXpPoint> ListDailyXp(const std::string& from_day, const std::string& until_day) const = 0;
+  virtual std::vector<LearningMinutesPoint> ListDailyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const = 0;
+  virtual std::vector<LearningMinutesPoint> ListWeeklyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const = 0;
+  virtual TrackXpTotals LoadTrackXpTotals() const = 0;
+};
+
+struct ArchiveSummary {
+  size_t action_units{0};
+  size_t learning_sessions{0};
+  size_t reward_events{0};
+
+  size_t Total() const { return action_units + learning_sessions + reward_events; }
+  bool operator==(const ArchiveSummary&) const = default;
+};
+
+// Moves finished work out of the live tables so startup loads and list queries only see
+// the working set. Archived rows are final: later upserts/appends of an archived id are
+// ignored, and insights rollups keep counting them.
+//
+// ArchiveCompletedBefore moves rows finished before the UTC timestamp `completed_before`:
+// completed action units, completed learning sessions not referenced by a milestone
+// checkpoint, and the prefix of the reward ledger older than the horizon. Ledger rows
+// are only archived up to the latest UserState snapshot, so replay from that snapshot
+// reads live rows only, and the newest row always stays live so sequences are not reused.
+class IArchiveRepository {
+ public:
+  virtual ~IArchiveRepository() = default;
+
+  virtual ArchiveSummary ArchiveCompletedBefore(const std::string& completed_before) = 0;
+  virtual ArchiveSummary CountArchivedRows() const = 0;
+  // Archive order, i.e. oldest archived first.
+  virtual void VisitArchivedActionUnits(const RowVisitor<domain::ActionUnit>& visitor) const = 0;
+  virtual void VisitArchivedLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const = 0;
+  virtual void VisitArchivedRewardEvents(const RewardLedgerVisitor& visitor) const = 0;
+};
+
+// One journaled user command. `command_id` is the versioned contract id and `payload`
+// its encoded fields; `sequence` is assigned by AppendCommand.
+struct CommandJournalRecord {
+  uint64_t sequence{0};
+  std::string command_id{};
+  std::string payload{};
+  std::string recorded_at{};
+
+  bool operator==(const CommandJournalRecord&) const = default;
+};
+
+using CommandJournalVisitor = std::function<bool(const CommandJournalRecord&)>;
+
+// Append-only command journal for crash recovery. Sequences are positive, strictly
+// increasing and never reused, even after the journal was truncated.
+class ICommandJournalRepository {
+ public:
+  virtual ~ICommandJournalRepository() = default;
+
+  virtual uint64_t AppendCommand(const CommandJournalRecord& record) = 0;
+  virtual void VisitCommandsAfter(uint64_t after_sequence, const CommandJournalVisitor& visitor) const = 0;
+  // Drops every record with sequence <= `through_sequence`.
+  virtual void TruncateCommandsThrough(uint64_t through_sequence) = 0;
+};
+
+enum class SearchEntityKind {
+  ActionUnit,           // title
+  LearningSession,      // title, checkpoint_note
+  MilestoneCheckpoint,  // milestone_key, evidence_ref and candidate_reason
+};
+
+// Ranked page request. `text` is split into words (see SplitSearchWords); a row matches
+// when every word is a case-insensitive prefix of one of its words. Pages continue at
+// `offset`.
+struct SearchQuery {
+  std::string text{};
+  std::optional<SearchEntityKind> kind{};
+  size_t offset{0};
+  size_t page_size{20};
+};
+
+struct SearchHit {
+  SearchEntityKind kind{SearchEntityKind::ActionUnit};
+  domain::EntityId entity_id{};
+  std::string title{};
+  std::string snippet{};  // matched text with the matching words wrapped in [ ]
+
+  bool operator==(const SearchHit&) const = default;
+};
+
+struct SearchPage {
+  std::vector<SearchHit> hits{};        // best match first
+  std::optional<size_t> next_offset{};  // set when more hits remain
+};
+
+// Full-text search over live rows; archived rows are not indexed.
+class ISearchRepository {
+ public:
+  virtual ~ISearchRepository() = default;
+
+  virtual SearchPage Search(const SearchQuery& query) const = 0;
 };
 
 struct UiPreferences {
@@ -90,6 +298,8 @@ struct UiPreferences {
   int prompt_concurrency_limit{2};
   int nudge_cooldown_seconds{30};
   std::string updated_at{};
+
+  bool operator==(const UiPreferences&) const = default;
 };
 
 class IUiPreferencesRepository {
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace habitrpg::data {
+
+inline bool IsSearchWordByte(const char c) {
+  const auto byte = static_cast<unsigned char>(c);
+  return (byte >= '0' && byte <= '9') || (byte >= 'a' && byte <= 'z') || (byte >= 'A' && byte <= 'Z') ||
+         byte >= 0x80;
+}
+
+// Splits text into lower-cased words the way the search index tokenizes it for ASCII:
+// runs of letters and digits. Bytes >= 0x80 count as word bytes so UTF-8 words stay
+// whole; they are not case-folded here.
+inline std::vector<std::string> SplitSearchWords(const std::string_view text) {
+  std::vector<std::string> words;
+  std::string word;
+  for (const char c : text) {
+    if (IsSearchWordByte(c)) {
+      word.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c);
+    } else if (!word.empty()) {
+      words.push_back(std::move(word));
+      word.clear();
+    }
+  }
+  if (!word.empty()) {
+    words.push_back(std::move(word));
+  }
+  return words;
+}
+
+}  // namespace habitrpg::data
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <chrono>
+#include <stop_token>
+#include <string>
+
+namespace habitrpg::data {
+
+struct SqliteBackupOptions {
+  // Pages copied per sqlite3_backup_step call; the pause between steps yields the disk
+  // to the writer connections.
+  int pages_per_step{256};
+  std::chrono::milliseconds step_pause{2};
+};
+
+struct SqliteBackupStats {
+  int pages{0};
+  int steps{0};
+};
+
+// Copies the database at `source_path` to `destination_path` with the SQLite online
+// backup API, through a private read-only connection. On a WAL database the copy reads
+// from one pinned snapshot, so it is consistent without blocking writers and never
+// restarts; in rollback-journal mode a concurrent commit restarts the copy.
+// The copy is written to `<destination_path>.partial` and renamed on success, so
+// `destination_path` only ever holds a complete database. Throws std::runtime_error on
+// failure or when `stop_token` is triggered between steps.
+SqliteBackupStats BackupDatabase(
+    const std::string& source_path,
+    const std::string& destination_path,
+    const SqliteBackupOptions& options = {},
+    const std::stop_token& stop_token = {});
+
+}  // namespace habitrpg::data
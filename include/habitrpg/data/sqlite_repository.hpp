@@ -2,13 +2,73 @@
 
 #include <sqlite3.h>
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "habitrpg/data/change_feed.hpp"
 #include "habitrpg/data/migrations.hpp"
 #include "habitrpg/data/repositories.hpp"
+#include "habitrpg/data/statement_cache.hpp"
 
 namespace habitrpg::data {
 
+class SqliteRepository;
+
+enum class SqliteSynchronous {
+  Off,
+  Normal,
+  Full,
+};
+
+// Storage tuning for SqliteRepository. The defaults keep the original single
+// rollback-journal connection, where reads wait for another thread's unit of work to
+// finish; enable_wal switches to WAL and opens read_connections read-only connections so
+// list/find calls from other threads do not queue behind the writer.
+struct SqliteRepositoryOptions {
+  bool enable_wal{false};
+  size_t read_connections{2};
+  SqliteSynchronous synchronous{SqliteSynchronous::Normal};
+  int64_t mmap_size_bytes{64LL * 1024 * 1024};
+  int cache_size_kib{8 * 1024};
+  // How long a statement waits for another connection's lock before failing with SQLITE_BUSY.
+  int busy_timeout_ms{5000};
+  // Called while the constructor upgrades a legacy database in batches.
+  MigrationProgressCallback on_migration_progress{};
+};
+
+// Groups repository writes into a single BEGIN IMMEDIATE ... COMMIT. The transaction
+// rolls back on destruction unless Commit() succeeded. The outermost unit of work holds
+// the repository's writer lock until it finishes, so units of work and writes from other
+// threads wait for it instead of joining it. One opened on the same thread while another
+// is active joins the outer transaction; abandoning the inner one poisons the outer
+// Commit() so a partial save can never be committed.
+class UnitOfWork final {
+ public:
+  explicit UnitOfWork(SqliteRepository& repository);
+  ~UnitOfWork();
+
+  UnitOfWork(const UnitOfWork&) = delete;
+  UnitOfWork& operator=(const UnitOfWork&) = delete;
+  UnitOfWork(UnitOfWork&&) = delete;
+  UnitOfWork& operator=(UnitOfWork&&) = delete;
+
+  void Commit();
+
+ private:
+  SqliteRepository& repository_;
+  std::unique_lock<std::recursive_mutex> writer_lock_;
+  bool owns_transaction_{false};
+  bool finished_{false};
+};
+
 class SqliteRepository final : public IHabitRepository,
                                public IQuestRepository,
                                public IActionUnitRepository,
@@ -16,9 +76,13 @@ class SqliteRepository final : public IHabitRepository,
                                public IMilestoneCheckpointRepository,
                                public IRewardRepository,
                                public IUserStateRepository,
+                               public IInsightsRepository,
+                               public IArchiveRepository,
+                               public ICommandJournalRepository,
+                               public ISearchRepository,
                                public IUiPreferencesRepository {
  public:
-  explicit SqliteRepository(std::string sqlite_path);
+  explicit SqliteRepository(std::string sqlite_path, SqliteRepositoryOptions options = {});
   ~SqliteRepository() override;
 
   SqliteRepository(const SqliteRepository&) = delete;
@@ -26,46 +90,149 @@ class SqliteRepository final : public IHabitRepository,
   SqliteRepository(SqliteRepository&&) = delete;
   SqliteRepository& operator=(SqliteRepository&&) = delete;
 
+  // Runs from the constructor; later calls return after one SELECT when already current.
   void Migrate();
   int SchemaVersion() const;
+  StatementCacheStats StatementStats() const;
+  size_t ReadConnectionCount() const { return read_connections_.size(); }
+
+  // Row changes made through this repository (not through other connections to the same
+  // file). Changes inside a unit of work are published as one batch after COMMIT and
+  // dropped on rollback; a write outside one is published right after its statement.
+  // Batches are published on the writing thread after it releases the writer lock.
+  ChangeFeed& Changes() { return change_feed_; }
 
   void UpsertHabit(const domain::Habit& habit) override;
+  void UpsertHabits(std::span<const domain::Habit> habits) override;
   std::optional<domain::Habit> FindHabitById(const std::string& id) const override;
   std::vector<domain::Habit> ListHabits() const override;
 
   void UpsertQuest(const domain::Quest& quest) override;
+  void UpsertQuests(std::span<const domain::Quest> quests) override;
   std::vector<domain::Quest> ListQuests() const override;
 
   void UpsertActionUnit(const domain::ActionUnit& action_unit) override;
+  void UpsertActionUnits(std::span<const domain::ActionUnit> action_units) override;
   std::optional<domain::ActionUnit> FindActionUnitById(const std::string& id) const override;
   std::vector<domain::ActionUnit> ListActionUnitsByTrack(domain::TrackType track_type) const override;
 
   void UpsertLearningGoal(const domain::LearningGoal& goal) override;
+  void UpsertLearningGoals(std::span<const domain::LearningGoal> goals) override;
   std::optional<domain::LearningGoal> FindLearningGoalById(const std::string& id) const override;
   std::vector<domain::LearningGoal> ListLearningGoals() const override;
   void UpsertLearningSession(const domain::LearningSession& session) override;
+  void UpsertLearningSessions(std::span<const domain::LearningSession> sessions) override;
   std::vector<domain::LearningSession> ListLearningSessionsByGoal(const std::string& goal_id) const override;
   std::vector<domain::LearningSession> ListLearningSessions() const override;
+  void VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const override;
 
   void UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) override;
+  void UpsertMilestoneCheckpoints(std::span<const domain::MilestoneCheckpoint> checkpoints) override;
   std::optional<domain::MilestoneCheckpoint> FindMilestoneCheckpointById(const std::string& id) const override;
   std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpointsByGoal(const std::string& goal_id) const override;
   std::vector<domain::MilestoneCheckpoint> ListMilestoneCheckpoints() const override;
+  void VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const override;
 
   void AppendRewardEvent(const domain::RewardEvent& reward_event) override;
+  void AppendRewardEvents(std::span<const domain::RewardEvent> reward_events) override;
   std::vector<domain::RewardEvent> ListRewardEventsByTrack(domain::TrackType track_type) const override;
+  void VisitRewardEventsByTrack(
+      domain::TrackType track_type,
+      const RowVisitor<domain::RewardEvent>& visitor) const override;
+  RewardEventPage ListRewardEventsPage(const RewardEventPageQuery& query) const override;
+  bool HasRewardEvent(const std::string& reward_event_id) const override;
+  uint64_t LatestRewardSequence() const override;
+  void VisitRewardLedgerAfter(uint64_t after_sequence, const RewardLedgerVisitor& visitor) const override;
 
   domain::UserState LoadUserState() const override;
   void SaveUserState(const domain::UserState& user_state) override;
+  void SaveUserStateSnapshot(const UserStateSnapshot& snapshot) override;
+  std::optional<UserStateSnapshot> LoadLatestUserStateSnapshot() const override;
+
+  std::vector<DailyXpPoint> ListDailyXp(const std::string& from_day, const std::string& until_day) const override;
+  std::vector<LearningMinutesPoint> ListDailyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const override;
+  std::vector<LearningMinutesPoint> ListWeeklyLearningMinutes(
+      const std::string& from_day,
+      const std::string& until_day) const override;
+  TrackXpTotals LoadTrackXpTotals() const override;
+
+  ArchiveSummary ArchiveCompletedBefore(const std::string& completed_before) override;
+  ArchiveSummary CountArchivedRows() const override;
+  void VisitArchivedActionUnits(const RowVisitor<domain::ActionUnit>& visitor) const override;
+  void VisitArchivedLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const override;
+  void VisitArchivedRewardEvents(const RewardLedgerVisitor& visitor) const override;
+
+  uint64_t AppendCommand(const CommandJournalRecord& record) override;
+  void VisitCommandsAfter(uint64_t after_sequence, const CommandJournalVisitor& visitor) const override;
+  void TruncateCommandsThrough(uint64_t through_sequence) override;
+
+  SearchPage Search(const SearchQuery& query) const override;
 
   UiPreferences LoadUiPreferences() const override;
   void SaveUiPreferences(const UiPreferences& preferences) override;
 
  private:
+  friend class UnitOfWork;
+
+  struct ReadConnection {
+    sqlite3* db{nullptr};
+    StatementCache statements;
+
+    ~ReadConnection();
+  };
+
+  // Routes a read to the writer when the calling thread has a unit of work open or there
+  // is no pool (under the writer lock, so it never sees another thread's uncommitted
+  // rows); otherwise to an idle pooled connection, or a temporary read-only one when all
+  // pooled connections are busy.
+  class ReadLease;
+  // Holds writer_mutex_ around a write made outside a unit of work, then publishes the
+  // change it staged.
+  class WriteLock;
+
   sqlite3* db_{nullptr};
   std::string sqlite_path_;
-
+  SqliteRepositoryOptions options_;
+  mutable StatementCache statements_;
+  // Serialises all use of db_ and guards the transaction and change-tracking state below.
+  // Held by the outermost unit of work for its whole lifetime, by each write outside one
+  // and by reads routed to the writer; change batches are published after it is released.
+  mutable std::recursive_mutex writer_mutex_;
+  int transaction_depth_{0};
+  bool transaction_rollback_only_{false};
+  std::atomic<std::thread::id> transaction_thread_{};
+
+  ChangeFeed change_feed_;
+  std::vector<EntityChange> pending_changes_;  // staged until the writer lock is released
+  std::optional<ChangeTable> hooked_table_;  // last tracked table the update hook saw
+  ChangeOperation hooked_operation_{ChangeOperation::Update};
+
+  std::vector<std::unique_ptr<ReadConnection>> read_connections_;
+  mutable std::vector<ReadConnection*> idle_read_connections_;
+  mutable std::mutex read_connections_mutex_;
+
+  void ApplyConnectionPragmas(sqlite3* db) const;
+  void OpenReadConnections();
+  std::unique_ptr<ReadConnection> OpenReadConnection() const;
+  void CloseReadConnections() noexcept;
+  bool ReadsUseWriter() const;
+  ReadConnection* AcquireReadConnection() const;
+  void ReleaseReadConnection(ReadConnection* connection) const;
   void ExecOrThrow(const std::string& sql) const;
+  void RollbackQuietly() noexcept;
+
+  static void OnRowChanged(
+      void* repository,
+      int operation,
+      const char* database,
+      const char* table,
+      sqlite3_int64 rowid);
+  // Called after a write statement on `table`; stages the row change the update hook
+  // reported for it, if any. Callers hold the writer lock.
+  void RecordChange(ChangeTable table, const std::string& id);
+  void StageChange(EntityChange change);
 };
 
 }  // namespace habitrpg::data
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace habitrpg::data {
+
+struct StatementCacheStats {
+  uint64_t hits{0};
+  uint64_t misses{0};
+  size_t cached_statements{0};
+};
+
+// Owns one prepared statement per distinct SQL text for a single connection.
+// Leased statements are reset and have their bindings cleared on release, so the
+// next caller always starts from a clean statement. A query that is already
+// leased (re-entrant use) gets a one-off statement that is finalized on release.
+class StatementCache final {
+ public:
+  struct Lease {
+    sqlite3_stmt* statement{nullptr};
+    bool* in_use{nullptr};
+  };
+
+  StatementCache() = default;
+  ~StatementCache();
+
+  StatementCache(const StatementCache&) = delete;
+  StatementCache& operator=(const StatementCache&) = delete;
+  StatementCache(StatementCache&&) = delete;
+  StatementCache& operator=(StatementCache&&) = delete;
+
+  void Attach(sqlite3* db);
+  sqlite3* db() const { return db_; }
+
+  Lease Acquire(std::string_view sql);
+  void Release(const Lease& lease);
+  void Clear();
+
+  StatementCacheStats Stats() const;
+
+ private:
+  struct Entry {
+    sqlite3_stmt* statement{nullptr};
+    bool in_use{false};
+  };
+
+  struct SqlHash {
+    using is_transparent = void;
+    size_t operator()(const std::string_view sql) const { return std::hash<std::string_view>{}(sql); }
+  };
+
+  sqlite3_stmt* Prepare(std::string_view sql) const;
+
+  sqlite3* db_{nullptr};
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, Entry, SqlHash, std::equal_to<>> entries_;
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+};
+
+}  // namespace habitrpg::data
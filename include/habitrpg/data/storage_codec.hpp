@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "habitrpg/data/repositories.hpp"
+#include "habitrpg/domain/entities.hpp"
+
+namespace habitrpg::data {
+
+// Integer codes used for enum columns since schema v7. The codes are part of the
+// on-disk format: never renumber them, only append.
+inline int TrackTypeToStorage(const domain::TrackType track_type) {
+  switch (track_type) {
+    case domain::TrackType::Life:
+      return 0;
+    case domain::TrackType::Learning:
+      return 1;
+  }
+
+  throw std::invalid_argument("Unknown TrackType");
+}
+
+inline domain::TrackType TrackTypeFromStorage(const int code) {
+  switch (code) {
+    case 0:
+      return domain::TrackType::Life;
+    case 1:
+      return domain::TrackType::Learning;
+    default:
+      throw std::invalid_argument("Unknown stored track type: " + std::to_string(code));
+  }
+}
+
+inline int ActionStatusToStorage(const domain::ActionStatus status) {
+  switch (status) {
+    case domain::ActionStatus::Todo:
+      return 0;
+    case domain::ActionStatus::InProgress:
+      return 1;
+    case domain::ActionStatus::Completed:
+      return 2;
+  }
+
+  throw std::invalid_argument("Unknown ActionStatus");
+}
+
+inline domain::ActionStatus ActionStatusFromStorage(const int code) {
+  switch (code) {
+    case 0:
+      return domain::ActionStatus::Todo;
+    case 1:
+      return domain::ActionStatus::InProgress;
+    case 2:
+      return domain::ActionStatus::Completed;
+    default:
+      throw std::invalid_argument("Unknown stored action status: " + std::to_string(code));
+  }
+}
+
+inline int LifecycleStateToStorage(const domain::LifecycleState state) {
+  switch (state) {
+    case domain::LifecycleState::Ready:
+      return 0;
+    case domain::LifecycleState::Active:
+      return 1;
+    case domain::LifecycleState::Partial:
+      return 2;
+    case domain::LifecycleState::Missed:
+      return 3;
+    case domain::LifecycleState::Paused:
+      return 4;
+    case domain::LifecycleState::Completed:
+      return 5;
+    case domain::LifecycleState::CheckpointCandidate:
+      return 6;
+  }
+
+  throw std::invalid_argument("Unknown LifecycleState");
+}
+
+inline domain::LifecycleState LifecycleStateFromStorage(const int code) {
+  switch (code) {
+    case 0:
+      return domain::LifecycleState::Ready;
+    case 1:
+      return domain::LifecycleState::Active;
+    case 2:
+      return domain::LifecycleState::Partial;
+    case 3:
+      return domain::LifecycleState::Missed;
+    case 4:
+      return domain::LifecycleState::Paused;
+    case 5:
+      return domain::LifecycleState::Completed;
+    case 6:
+      return domain::LifecycleState::CheckpointCandidate;
+    default:
+      throw std::invalid_argument("Unknown stored lifecycle state: " + std::to_string(code));
+  }
+}
+
+inline int MilestoneCheckpointStateToStorage(const domain::MilestoneCheckpointState state) {
+  switch (state) {
+    case domain::MilestoneCheckpointState::Candidate:
+      return 0;
+    case domain::MilestoneCheckpointState::Confirmed:
+      return 1;
+    case domain::MilestoneCheckpointState::Rejected:
+      return 2;
+  }
+
+  throw std::invalid_argument("Unknown MilestoneCheckpointState");
+}
+
+inline domain::MilestoneCheckpointState MilestoneCheckpointStateFromStorage(const int code) {
+  switch (code) {
+    case 0:
+      return domain::MilestoneCheckpointState::Candidate;
+    case 1:
+      return domain::MilestoneCheckpointState::Confirmed;
+    case 2:
+      return domain::MilestoneCheckpointState::Rejected;
+    default:
+      throw std::invalid_argument("Unknown stored milestone checkpoint state: " + std::to_string(code));
+  }
+}
+
+inline int SearchEntityKindToStorage(const SearchEntityKind kind) {
+  switch (kind) {
+    case SearchEntityKind::ActionUnit:
+      return 0;
+    case SearchEntityKind::LearningSession:
+      return 1;
+    case SearchEntityKind::MilestoneCheckpoint:
+      return 2;
+  }
+
+  throw std::invalid_argument("Unknown SearchEntityKind");
+}
+
+inline SearchEntityKind SearchEntityKindFromStorage(const int code) {
+  switch (code) {
+    case 0:
+      return SearchEntityKind::ActionUnit;
+    case 1:
+      return SearchEntityKind::LearningSession;
+    case 2:
+      return SearchEntityKind::MilestoneCheckpoint;
+    default:
+      throw std::invalid_argument("Unknown stored search entity kind: " + std::to_string(code));
+  }
+}
+
+// The stored action status column is derived from the lifecycle state on every write.
+inline domain::ActionStatus StatusFromLifecycle(const domain::LifecycleState state) {
+  switch (state) {
+    case domain::LifecycleState::Completed:
+      return domain::ActionStatus::Completed;
+    case domain::LifecycleState::Active:
+      return domain::ActionStatus::InProgress;
+    case domain::LifecycleState::Ready:
+    case domain::LifecycleState::Partial:
+    case domain::LifecycleState::Missed:
+    case domain::LifecycleState::Paused:
+    case domain::LifecycleState::CheckpointCandidate:
+      return domain::ActionStatus::Todo;
+  }
+
+  return domain::ActionStatus::Todo;
+}
+
+// Timestamps are stored as INTEGER epoch milliseconds.
+inline int64_t TimestampToStorage(const std::string& timestamp) {
+  const auto epoch_ms = domain::ParseTimestampUtcMs(timestamp);
+  if (!epoch_ms.has_value()) {
+    throw std::invalid_argument("Unparseable timestamp: " + timestamp);
+  }
+
+  return *epoch_ms;
+}
+
+inline constexpr int64_t kMillisecondsPerDay = 86400000;
+
+// Rollup tables key days by UTC epoch day (epoch ms / kMillisecondsPerDay); the API
+// uses "YYYY-MM-DD".
+inline int64_t EpochDayFromString(const std::string_view day) {
+  const auto epoch_ms = domain::ParseTimestampUtcMs(std::string(day) + "T00:00:00Z");
+  if (day.size() != 10 || !epoch_ms.has_value()) {
+    throw std::invalid_argument("Expected a YYYY-MM-DD day, got: " + std::string(day));
+  }
+
+  return *epoch_ms / kMillisecondsPerDay;
+}
+
+inline std::string EpochDayToString(const int64_t epoch_day) {
+  return domain::FormatTimestampUtcMs(epoch_day * kMillisecondsPerDay).substr(0, 10);
+}
+
+}  // namespace habitrpg::data
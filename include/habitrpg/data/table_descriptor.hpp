@@ -0,0 +1,314 @@
+#pragma once
+
+#include <sqlite3.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "habitrpg/data/storage_codec.hpp"
+#include "habitrpg/domain/entities.hpp"
+#include "habitrpg/domain/entity_id.hpp"
+
+namespace habitrpg::data {
+
+// Text of a result column without copying it. Valid until the statement is stepped,
+// reset or finalized; NULL reads as empty.
+inline std::string_view ColumnView(sqlite3_stmt* statement, const int index) {
+  const auto* raw = reinterpret_cast<const char*>(sqlite3_column_text(statement, index));
+  if (raw == nullptr) {
+    return {};
+  }
+  return std::string_view(raw, static_cast<size_t>(sqlite3_column_bytes(statement, index)));
+}
+
+// Column codecs: how one member value is bound to a statement parameter and read back
+// from a result column. Readers assign into the existing member, so a row object reused
+// across a scan keeps its string buffers.
+struct TextCodec {
+  // Members are bound in place (SQLITE_STATIC): the row outlives the step that reads it.
+  static int Bind(sqlite3_stmt* statement, const int index, const std::string& value) {
+    return sqlite3_bind_text(statement, index, value.data(), static_cast<int>(value.size()), SQLITE_STATIC);
+  }
+
+  // Projected values are temporaries, so SQLite has to keep its own copy.
+  static int Bind(sqlite3_stmt* statement, const int index, std::string&& value) {
+    return sqlite3_bind_text(statement, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+  }
+
+  static void Read(sqlite3_stmt* statement, const int index, std::string* value) {
+    value->assign(ColumnView(statement, index));
+  }
+};
+
+struct IdCodec {
+  // Interned id text lives for the whole process.
+  static int Bind(sqlite3_stmt* statement, const int index, const domain::EntityId& value) {
+    return TextCodec::Bind(statement, index, value.str());
+  }
+
+  // Interns straight from the column bytes; known ids cost a lookup, not an allocation.
+  static void Read(sqlite3_stmt* statement, const int index, domain::EntityId* value) {
+    *value = domain::EntityId(ColumnView(statement, index));
+  }
+};
+
+struct IntCodec {
+  static int Bind(sqlite3_stmt* statement, const int index, const int value) {
+    return sqlite3_bind_int(statement, index, value);
+  }
+
+  static void Read(sqlite3_stmt* statement, const int index, int* value) {
+    *value = sqlite3_column_int(statement, index);
+  }
+};
+
+struct BoolCodec {
+  static int Bind(sqlite3_stmt* statement, const int index, const bool value) {
+    return sqlite3_bind_int(statement, index, value ? 1 : 0);
+  }
+
+  static void Read(sqlite3_stmt* statement, const int index, bool* value) {
+    *value = sqlite3_column_int(statement, index) == 1;
+  }
+};
+
+// INTEGER epoch milliseconds; an empty string maps to NULL.
+struct TimestampCodec {
+  static int Bind(sqlite3_stmt* statement, const int index, const std::string& value) {
+    return value.empty() ? sqlite3_bind_null(statement, index)
+                         : sqlite3_bind_int64(statement, index, TimestampToStorage(value));
+  }
+
+  static void Read(sqlite3_stmt* statement, const int index, std::string* value) {
+    if (sqlite3_column_type(statement, index) == SQLITE_NULL) {
+      value->clear();
+      return;
+    }
+    domain::FormatTimestampUtcMs(sqlite3_column_int64(statement, index), value);
+  }
+};
+
+template <typename Enum, int (*ToStorage)(Enum), Enum (*FromStorage)(int)>
+struct EnumCodec {
+  static int Bind(sqlite3_stmt* statement, const int index, const Enum value) {
+    return sqlite3_bind_int(statement, index, ToStorage(value));
+  }
+
+  static void Read(sqlite3_stmt* statement, const int index, Enum* value) {
+    *value = FromStorage(sqlite3_column_int(statement, index));
+  }
+};
+
+// Codec picked by Column() from the member type. Timestamps are plain strings in the
+// entities, so they are declared with TimestampColumn() instead.
+template <typename Value>
+struct DefaultCodec;
+
+template <>
+struct DefaultCodec<std::string> {
+  using type = TextCodec;
+};
+
+template <>
+struct DefaultCodec<domain::EntityId> {
+  using type = IdCodec;
+};
+
+template <>
+struct DefaultCodec<int> {
+  using type = IntCodec;
+};
+
+template <>
+struct DefaultCodec<bool> {
+  using type = BoolCodec;
+};
+
+template <>
+struct DefaultCodec<domain::TrackType> {
+  using type = EnumCodec<domain::TrackType, TrackTypeToStorage, TrackTypeFromStorage>;
+};
+
+template <>
+struct DefaultCodec<domain::ActionStatus> {
+  using type = EnumCodec<domain::ActionStatus, ActionStatusToStorage, ActionStatusFromStorage>;
+};
+
+template <>
+struct DefaultCodec<domain::LifecycleState> {
+  using type = EnumCodec<domain::LifecycleState, LifecycleStateToStorage, LifecycleStateFromStorage>;
+};
+
+template <>
+struct DefaultCodec<domain::MilestoneCheckpointState> {
+  using type = EnumCodec<
+      domain::MilestoneCheckpointState,
+      MilestoneCheckpointStateToStorage,
+      MilestoneCheckpointStateFromStorage>;
+};
+
+template <typename Entity, typename Value, typename Codec>
+struct ColumnDescriptor {
+  std::string_view name;
+  Value Entity::*member{nullptr};
+  // Value bound instead of the member (clamps, derived columns); reads still fill the member.
+  Value (*written_as)(const Entity&){nullptr};
+  // Upserts leave the stored value alone once the row exists.
+  bool insert_only{false};
+
+  constexpr ColumnDescriptor WrittenAs(Value (*projection)(const Entity&)) const {
+    ColumnDescriptor column = *this;
+    column.written_as = projection;
+    return column;
+  }
+
+  constexpr ColumnDescriptor InsertOnly() const {
+    ColumnDescriptor column = *this;
+    column.insert_only = true;
+    return column;
+  }
+
+  int Bind(sqlite3_stmt* statement, const int index, const Entity& row) const {
+    return written_as != nullptr ? Codec::Bind(statement, index, written_as(row))
+                                 : Codec::Bind(statement, index, row.*member);
+  }
+
+  void Read(sqlite3_stmt* statement, const int index, Entity* row) const {
+    Codec::Read(statement, index, &(row->*member));
+  }
+};
+
+template <typename Entity, typename Value>
+constexpr auto Column(const std::string_view name, Value Entity::*member) {
+  return ColumnDescriptor<Entity, Value, typename DefaultCodec<Value>::type>{name, member};
+}
+
+template <typename Entity>
+constexpr auto TimestampColumn(const std::string_view name, std::string Entity::*member) {
+  return ColumnDescriptor<Entity, std::string, TimestampCodec>{name, member};
+}
+
+// One definition per table: column names, member mapping and codecs. The SQL text, the
+// parameter binder and the row decoder are all generated from it, so they cannot drift
+// apart. The first column is the `id` conflict target.
+template <typename Entity, typename... Columns>
+class TableDescriptor final {
+ public:
+  using Row = Entity;
+
+  static constexpr size_t kColumnCount = sizeof...(Columns);
+
+  constexpr TableDescriptor(const std::string_view table, Columns... columns)
+      : table_(table), columns_(std::move(columns)...) {}
+
+  // Upserts skip ids already moved to `archive_table`, so an old copy cannot revive them.
+  constexpr TableDescriptor GuardedByArchive(const std::string_view archive_table) const {
+    TableDescriptor descriptor = *this;
+    descriptor.archive_table_ = archive_table;
+    return descriptor;
+  }
+
+  // Rows are never rewritten: a second insert of the same id is ignored.
+  constexpr TableDescriptor AppendOnly() const {
+    TableDescriptor descriptor = *this;
+    descriptor.append_only_ = true;
+    return descriptor;
+  }
+
+  constexpr std::string_view table() const { return table_; }
+
+  // "id, title, ..." in decode order.
+  std::string ColumnList() const {
+    std::string list;
+    ForEachColumn([&list](const auto& column, const int index) {
+      if (index > 0) {
+        list += ", ";
+      }
+      list += column.name;
+    });
+    return list;
+  }
+
+  // "SELECT <columns> FROM <table> <clauses>"; `from_table` overrides the table (archives).
+  std::string SelectSql(const std::string_view clauses, const std::string_view from_table = {}) const {
+    std::string sql = "SELECT " + ColumnList() + " FROM ";
+    sql += from_table.empty() ? table_ : from_table;
+    sql += ' ';
+    sql += clauses;
+    return sql;
+  }
+
+  // Parameters ?1..?N follow the column order, matching Bind().
+  std::string UpsertSql() const {
+    std::string parameters;
+    for (size_t i = 1; i <= kColumnCount; ++i) {
+      parameters += (i > 1 ? ", ?" : "?") + std::to_string(i);
+    }
+
+    const std::string_view id_column = std::get<0>(columns_).name;
+    std::string sql = "INSERT INTO " + std::string(table_) + "(" + ColumnList() + ") ";
+    if (archive_table_.empty()) {
+      sql += "VALUES(" + parameters + ")";
+    } else {
+      sql += "SELECT " + parameters + " WHERE NOT EXISTS (SELECT 1 FROM " + std::string(archive_table_) +
+             " WHERE " + std::string(id_column) + " = ?1)";
+    }
+    sql += " ON CONFLICT(" + std::string(id_column) + ")";
+    if (append_only_) {
+      return sql + " DO NOTHING;";
+    }
+
+    std::string assignments;
+    ForEachColumn([&assignments](const auto& column, const int index) {
+      if (index == 0 || column.insert_only) {
+        return;
+      }
+      assignments += assignments.empty() ? " " : ", ";
+      assignments += std::string(column.name) + " = excluded." + std::string(column.name);
+    });
+    return sql + " DO UPDATE SET" + assignments + ";";
+  }
+
+  void Bind(sqlite3* db, sqlite3_stmt* statement, const Entity& row) const {
+    ForEachColumn([&](const auto& column, const int index) {
+      if (column.Bind(statement, index + 1, row) != SQLITE_OK) {
+        throw std::runtime_error(
+            "Binding " + std::string(table_) + "." + std::string(column.name) + " failed: " + sqlite3_errmsg(db));
+      }
+    });
+  }
+
+  // Reads the current result row into `row`, starting at result column `first_column`.
+  void Decode(sqlite3_stmt* statement, Entity* row, const int first_column = 0) const {
+    ForEachColumn([&](const auto& column, const int index) { column.Read(statement, first_column + index, row); });
+  }
+
+ private:
+  template <typename Visitor>
+  void ForEachColumn(const Visitor& visitor) const {
+    std::apply(
+        [&visitor](const auto&... column) {
+          int index = 0;
+          (visitor(column, index++), ...);
+        },
+        columns_);
+  }
+
+  std::string_view table_;
+  std::tuple<Columns...> columns_;
+  std::string_view archive_table_{};
+  bool append_only_{false};
+};
+
+template <typename Entity, typename... Values, typename... Codecs>
+constexpr auto DescribeTable(
+    const std::string_view table,
+    ColumnDescriptor<Entity, Values, Codecs>... columns) {
+  return TableDescriptor<Entity, ColumnDescriptor<Entity, Values, Codecs>...>(table, columns...);
+}
+
+}  // namespace habitrpg::data
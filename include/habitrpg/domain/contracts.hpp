@@ -25,6 +25,8 @@ struct CreateLifeActionCommand {
   std::string parent_id;
   std::string title;
   int priority_score{100};
+  // Empty until app::DispatchCommand assigns one, so a journal replay recreates the same id.
+  std::string action_unit_id{};
 };
 
 struct StartUnitCommand {
@@ -60,6 +62,54 @@ struct CheckpointLearningSessionCommand {
   std::string checkpoint_note;
 };
 
+struct CreateLearningGoalCommand {
+  static constexpr std::string_view kCommandId = "command.create_learning_goal.v1";
+
+  std::string title;
+  std::string milestone;
+  // Empty until app::DispatchCommand assigns one, so a journal replay recreates the same id.
+  std::string learning_goal_id{};
+};
+
+struct CreateLearningSessionCommand {
+  static constexpr std::string_view kCommandId = "command.create_learning_session.v1";
+
+  std::string learning_goal_id;
+  std::string title;
+  int duration_minutes{25};
+  int priority_score{100};
+  std::string artifact_kind;
+  std::string artifact_ref;
+  // Empty until app::DispatchCommand assigns one, so a journal replay recreates the same id.
+  std::string learning_session_id{};
+};
+
+// Partial, paused or missed; other lifecycle states have their own commands.
+struct SetUnitLifecycleCommand {
+  static constexpr std::string_view kCommandId = "command.set_unit_lifecycle.v1";
+
+  std::string unit_id;
+  TrackType track_type{TrackType::Life};
+  LifecycleState lifecycle_state{LifecycleState::Paused};
+};
+
+// Creates the milestone checkpoint candidate of a session, or refreshes the open one.
+struct SaveCheckpointCandidateCommand {
+  static constexpr std::string_view kCommandId = "command.save_checkpoint_candidate.v1";
+
+  std::string learning_session_id;
+  std::string candidate_reason;
+  // Empty until app::DispatchCommand assigns one; used only when a new candidate is created.
+  std::string milestone_checkpoint_id{};
+};
+
+struct ConfirmMilestoneCheckpointCommand {
+  static constexpr std::string_view kCommandId = "command.confirm_milestone_checkpoint.v1";
+
+  std::string milestone_checkpoint_id;
+  std::string confirmed_at;
+};
+
 struct LearningSessionCompletedEvent {
   static constexpr std::string_view kEventId = "event.learning_session_completed.v1";
 
@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <string_view>
 
+#include "habitrpg/domain/entity_id.hpp"
+
 namespace habitrpg::domain {
 
 enum class TrackType {
@@ -37,24 +41,28 @@ LifecycleState LifecycleStateFromString(std::string_view raw);
 bool LifecycleStateIsPending(LifecycleState state);
 
 struct Habit {
-  std::string id;
+  EntityId id;
   std::string title;
   std::string cadence;
   bool is_active{true};
   std::string created_at;
+
+  bool operator==(const Habit&) const = default;
 };
 
 struct Quest {
-  std::string id;
+  EntityId id;
   std::string title;
   TrackType track_type{TrackType::Life};
   bool is_completed{false};
   std::string created_at;
+
+  bool operator==(const Quest&) const = default;
 };
 
 struct ActionUnit {
-  std::string id;
-  std::string parent_id;
+  EntityId id;
+  EntityId parent_id;
   std::string title;
   TrackType track_type{TrackType::Life};
   ActionStatus status{ActionStatus::Todo};
@@ -62,19 +70,23 @@ struct ActionUnit {
   int priority_score{100};
   std::string started_at;
   std::string completed_at;
+
+  bool operator==(const ActionUnit&) const = default;
 };
 
 struct LearningGoal {
-  std::string id;
+  EntityId id;
   std::string title;
   std::string milestone;
   int confidence_level{0};
   std::string created_at;
+
+  bool operator==(const LearningGoal&) const = default;
 };
 
 struct LearningSession {
-  std::string id;
-  std::string goal_id;
+  EntityId id;
+  EntityId goal_id;
   std::string title;
   LifecycleState lifecycle_state{LifecycleState::Ready};
   int priority_score{100};
@@ -84,6 +96,8 @@ struct LearningSession {
   std::string checkpoint_note;
   std::string started_at;
   std::string completed_at;
+
+  bool operator==(const LearningSession&) const = default;
 };
 
 enum class MilestoneCheckpointState {
@@ -96,22 +110,24 @@ std::string_view MilestoneCheckpointStateToString(MilestoneCheckpointState state
 MilestoneCheckpointState MilestoneCheckpointStateFromString(std::string_view raw);
 
 struct MilestoneCheckpoint {
-  std::string id;
-  std::string goal_id;
-  std::string learning_session_id;
+  EntityId id;
+  EntityId goal_id;
+  EntityId learning_session_id;
   std::string milestone_key;
   MilestoneCheckpointState state{MilestoneCheckpointState::Candidate};
   std::string evidence_kind;
   std::string evidence_ref;
   int confidence_level{1};
   std::string candidate_reason;
-  std::string reward_event_id;
+  EntityId reward_event_id;
   std::string submitted_at;
   std::string reviewed_at;
   std::string confirmed_at;
   std::string rejected_at;
   std::string created_at;
   std::string updated_at;
+
+  bool operator==(const MilestoneCheckpoint&) const = default;
 };
 
 struct UserState {
@@ -120,8 +136,11 @@ struct UserState {
   int life_xp{0};
   int learning_xp{0};
   int recovery_tokens{3};
+
+  bool operator==(const UserState&) const = default;
 };
 
+// Ledger ids stay plain strings: the ledger only grows, and interned ids are never freed.
 struct RewardEvent {
   std::string id;
   std::string source_type;
@@ -130,9 +149,19 @@ struct RewardEvent {
   int xp_delta{0};
   std::string reward_kind;
   std::string created_at;
+
+  bool operator==(const RewardEvent&) const = default;
 };
 
 std::string CurrentTimestampUtc();
+
+// Conversions between the ISO-8601 UTC form used in memory ("YYYY-MM-DDTHH:MM:SSZ",
+// optionally with ".mmm" before the Z) and Unix epoch milliseconds used in storage.
+// Whole seconds format without a fraction, so second-resolution strings round-trip.
+std::optional<int64_t> ParseTimestampUtcMs(std::string_view timestamp);
+std::string FormatTimestampUtcMs(int64_t epoch_ms);
+// Same as above, written into `formatted` so a reused string keeps its buffer.
+void FormatTimestampUtcMs(int64_t epoch_ms, std::string* formatted);
 std::string GenerateStableId(std::string_view prefix);
 
 }  // namespace habitrpg::domain
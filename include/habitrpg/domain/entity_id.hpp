@@ -0,0 +1,84 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace habitrpg::domain {
+
+using EntityKey = uint64_t;
+inline constexpr EntityKey kEmptyEntityKey = 0;
+
+// Process-wide intern table for entity id strings. Each distinct id is stored once
+// and mapped to a dense 64-bit key; key 0 is the empty id. Entries are never removed,
+// so the string references handed out stay valid for the life of the process.
+class IdInterner final {
+ public:
+  static IdInterner& Instance();
+
+  IdInterner(const IdInterner&) = delete;
+  IdInterner& operator=(const IdInterner&) = delete;
+
+  EntityKey Intern(std::string_view text, const std::string** interned_text);
+  std::optional<EntityKey> Find(std::string_view text) const;
+  const std::string& Text(EntityKey key) const;
+  size_t Size() const;
+
+ private:
+  IdInterner();
+
+  mutable std::shared_mutex mutex_;
+  std::deque<std::string> texts_;  // index == key; deque keeps element addresses stable
+  std::unordered_map<std::string_view, EntityKey> keys_;
+};
+
+// Entity identifier. The string form is what storage and the UI see; equality and
+// hashing use the interned key, so comparing or hashing ids never touches the heap.
+// Ordering stays lexicographic on the string form to match ORDER BY id in SQL.
+class EntityId final {
+ public:
+  EntityId() = default;
+  EntityId(std::string_view text);
+  EntityId(const std::string& text) : EntityId(std::string_view(text)) {}
+  EntityId(const char* text) : EntityId(std::string_view(text)) {}
+
+  static EntityId FromKey(EntityKey key);
+
+  EntityKey key() const { return key_; }
+  const std::string& str() const { return *text_; }
+  operator const std::string&() const { return *text_; }
+  const char* c_str() const { return text_->c_str(); }
+  bool empty() const { return key_ == kEmptyEntityKey; }
+  size_t size() const { return text_->size(); }
+  void clear() { *this = EntityId(); }
+
+  friend bool operator==(const EntityId& left, const EntityId& right) { return left.key_ == right.key_; }
+  friend std::strong_ordering operator<=>(const EntityId& left, const EntityId& right) {
+    if (left.key_ == right.key_) {
+      return std::strong_ordering::equal;
+    }
+    return left.text_->compare(*right.text_) <=> 0;
+  }
+  friend std::ostream& operator<<(std::ostream& stream, const EntityId& id) { return stream << *id.text_; }
+
+ private:
+  static const std::string kEmptyText;
+
+  EntityKey key_{kEmptyEntityKey};
+  const std::string* text_{&kEmptyText};
+};
+
+}  // namespace habitrpg::domain
+
+template <>
+struct std::hash<habitrpg::domain::EntityId> {
+  size_t operator()(const habitrpg::domain::EntityId& id) const noexcept { return std::hash<uint64_t>{}(id.key()); }
+};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -11,7 +12,7 @@ namespace habitrpg::domain {
 class InteractionFlowService {
  public:
   ActionUnit CreateLifeAction(
-      const std::string& parent_id,
+      const EntityId& parent_id,
       const std::string& title,
       int priority_score,
       std::string created_at = {}) const;
@@ -20,7 +21,7 @@ class InteractionFlowService {
       const;
 
   LearningSession CreateLearningSession(
-      const std::string& goal_id,
+      const EntityId& goal_id,
       const std::string& title,
       int duration_minutes,
       int priority_score,
@@ -29,24 +30,25 @@ class InteractionFlowService {
       std::string created_at = {}) const;
 
   bool StartActionUnit(
-      const std::string& action_id,
+      const EntityId& action_id,
       std::vector<ActionUnit>* action_units,
       std::vector<LearningSession>* learning_sessions) const;
 
   bool CompleteActionUnit(
-      const std::string& action_id,
+      const EntityId& action_id,
       std::vector<ActionUnit>* action_units,
       RewardEngine* reward_engine,
       UserState* user_state,
-      std::vector<RewardEvent>* reward_events) const;
+      std::vector<RewardEvent>* reward_events,
+      std::string completed_at = {}) const;
 
   bool StartLearningSession(
-      const std::string& session_id,
+      const EntityId& session_id,
       std::vector<ActionUnit>* action_units,
       std::vector<LearningSession>* learning_sessions) const;
 
   bool CheckpointLearningSession(
-      const std::string& session_id,
+      const EntityId& session_id,
       const std::string& checkpoint_note,
       std::vector<LearningSession>* learning_sessions) const;
 
@@ -59,19 +61,25 @@ class InteractionFlowService {
       const std::string& candidate_reason,
       std::string created_at = {}) const;
 
+  // No reward is credited when its id is already in `reward_events` or `reward_recorded`
+  // reports it stored; `reward_events` may hold only a recent window of the ledger. An
+  // empty `confirmed_at` means now.
   bool PromoteMilestoneCheckpointToConfirmed(
-      const std::string& checkpoint_id,
+      const EntityId& checkpoint_id,
       std::vector<MilestoneCheckpoint>* checkpoints,
       RewardEngine* reward_engine,
       UserState* user_state,
-      std::vector<RewardEvent>* reward_events) const;
+      std::vector<RewardEvent>* reward_events,
+      const std::function<bool(const EntityId&)>& reward_recorded = {},
+      std::string confirmed_at = {}) const;
 
   bool CompleteLearningSession(
-      const std::string& session_id,
+      const EntityId& session_id,
       std::vector<LearningSession>* learning_sessions,
       RewardEngine* reward_engine,
       UserState* user_state,
-      std::vector<RewardEvent>* reward_events) const;
+      std::vector<RewardEvent>* reward_events,
+      std::string completed_at = {}) const;
 };
 
 }  // namespace habitrpg::domain
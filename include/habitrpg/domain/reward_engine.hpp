@@ -28,7 +28,7 @@ class RewardEngine {
   RewardEvent BuildMilestoneCheckpointConfirmedReward(
       const MilestoneCheckpoint& milestone_checkpoint,
       std::string_view created_at = {},
-      std::string_view event_id_override = {}) const;
+      const EntityId& event_id_override = {}) const;
 
   void ApplyReward(const RewardEvent& reward_event, UserState* user_state) const;
 
@@ -8,8 +8,8 @@
 namespace habitrpg::domain {
 
 struct TodayQueueItem {
-  std::string unit_id;
-  std::string parent_id;
+  EntityId unit_id;
+  EntityId parent_id;
   std::string title;
   TrackType track_type{TrackType::Life};
   LifecycleState lifecycle_state{LifecycleState::Ready};
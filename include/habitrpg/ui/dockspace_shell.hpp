@@ -15,6 +15,7 @@ class DockspaceShell {
   void RenderLeftNavigation(app::AppState* app_state);
   void RenderCenterActionPanel(app::AppState* app_state);
   void RenderRightStatePanel(app::AppState* app_state);
+  void RenderRewardHistory(app::AppState* app_state);
   void RenderBottomControlStrip(app::AppState* app_state);
   void RenderTodayControls(app::AppState* app_state);
   void RenderQueueItemRow(app::AppState* app_state, const domain::TodayQueueItem& item);
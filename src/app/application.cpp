@@ -1,8 +1,12 @@
 #include "habitrpg/app/application.hpp"
 
 #include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 #include <SDL3/SDL_opengl.h>
 
@@ -11,10 +15,41 @@
 #include "imgui_impl_sdl3.h"
 
 namespace habitrpg::app {
+namespace {
+
+// The UI thread reads while the persistence worker writes, so the app runs in WAL mode.
+data::SqliteRepositoryOptions BuildStorageOptions(const size_t read_connections) {
+  data::SqliteRepositoryOptions options{};
+  options.enable_wal = true;
+  options.read_connections = read_connections;
+  return options;
+}
+
+// Commands are journaled from the UI thread while the persistence worker may hold the
+// write lock, so the journal has its own connection that gives up after a frame's worth
+// of waiting; the command then still applies and reaches disk with the next save.
+constexpr int kJournalBusyTimeoutMs = 16;
+
+data::SqliteRepositoryOptions BuildJournalStorageOptions() {
+  auto options = BuildStorageOptions(0);
+  options.busy_timeout_ms = kJournalBusyTimeoutMs;
+  return options;
+}
+
+BackupSchedule BuildBackupSchedule(const std::string& sqlite_path) {
+  BackupSchedule schedule{};
+  schedule.directory = (std::filesystem::absolute(sqlite_path).parent_path() / "backups").string();
+  return schedule;
+}
+
+}  // namespace
 
 Application::Application(std::string sqlite_path)
     : sqlite_path_(std::move(sqlite_path)),
-      repository_(sqlite_path_),
+      repository_(sqlite_path_, BuildStorageOptions(2)),
+      persistence_worker_(sqlite_path_, BuildStorageOptions(0)),
+      journal_repository_(sqlite_path_, BuildJournalStorageOptions()),
+      backup_service_(sqlite_path_, BuildBackupSchedule(sqlite_path_)),
       interaction_flow_service_(),
       reward_engine_(),
       today_queue_service_() {}
@@ -114,8 +149,22 @@ void Application::Shutdown() {
 }
 
 void Application::LoadStartupState() {
-  repository_.Migrate();
-  app_state_.user_state = repository_.LoadUserState();
+  // Archival only trims the working set; if it fails the rows stay live and startup
+  // continues, but the error is shown in the status line below.
+  std::string archival_error;
+  try {
+    const auto now = std::chrono::system_clock::now().time_since_epoch();
+    ArchiveFinishedWork(
+        repository_,
+        ArchivePolicy{},
+        std::chrono::duration_cast<std::chrono::milliseconds>(now).count());
+  } catch (const std::exception& error) {
+    archival_error = error.what();
+  }
+
+  // The reward ledger is the source of truth; the user_state row is only a cache.
+  const auto replay = ReplayUserState(repository_, repository_, reward_engine_);
+  app_state_.user_state = replay.user_state;
   LoadUiPreferencesAndResources();
 
   app_state_.runtime.life_actions = repository_.ListActionUnitsByTrack(domain::TrackType::Life);
@@ -123,14 +172,17 @@ void Application::LoadStartupState() {
   app_state_.runtime.learning_sessions = repository_.ListLearningSessions();
   app_state_.runtime.milestone_checkpoints = repository_.ListMilestoneCheckpoints();
 
-  auto life_rewards = repository_.ListRewardEventsByTrack(domain::TrackType::Life);
-  auto learning_rewards = repository_.ListRewardEventsByTrack(domain::TrackType::Learning);
-  app_state_.runtime.reward_events.clear();
-  app_state_.runtime.reward_events.reserve(life_rewards.size() + learning_rewards.size());
-  app_state_.runtime.reward_events.insert(
-      app_state_.runtime.reward_events.end(), life_rewards.begin(), life_rewards.end());
-  app_state_.runtime.reward_events.insert(
-      app_state_.runtime.reward_events.end(), learning_rewards.begin(), learning_rewards.end());
+  app_state_.reward_repository = &repository_;
+  LoadRecentRewardEvents(repository_, &app_state_);
+  ResetPersistedShadow(&app_state_);
+  if (replay.cached_row_stale) {
+    app_state_.runtime.persisted.user_state.reset();
+  }
+
+  // Commands journaled after the last save are re-applied on top of the stored rows; the
+  // save submitted below persists them and truncates the journal.
+  app_state_.command_journal = &journal_repository_;
+  ReplayCommandJournal(journal_repository_, interaction_flow_service_, &app_state_);
 
   SeedDefaultsIfEmpty();
   RefreshTodayQueue();
@@ -154,7 +206,14 @@ void Application::LoadStartupState() {
   }
 
   app_state_.focus_status = "Ready for next action";
+  if (!archival_error.empty()) {
+    app_state_.focus_status = "Archiving finished work failed; it stays in the live tables: " + archival_error;
+  }
+  app_state_.submitted_revision = app_state_.mutation_revision;
   app_state_.persisted_revision = app_state_.mutation_revision;
+  if (app_state_.journaled_through > 0) {
+    MarkMutated(&app_state_);
+  }
 }
 
 void Application::LoadUiPreferencesAndResources() {
@@ -199,6 +258,7 @@ void Application::SeedDefaultsIfEmpty() {
         "C++ Momentum",
         "Complete one short C++ coding exercise with notes");
     app_state_.runtime.learning_goals.push_back(std::move(learning_goal));
+    MarkDirty(&app_state_, app_state_.runtime.learning_goals.back());
     MarkMutated(&app_state_);
   }
 
@@ -208,6 +268,7 @@ void Application::SeedDefaultsIfEmpty() {
         "Pick one high-impact life task",
         120);
     app_state_.runtime.life_actions.push_back(std::move(life_action));
+    MarkDirty(&app_state_, app_state_.runtime.life_actions.back());
     MarkMutated(&app_state_);
   }
 
@@ -220,54 +281,46 @@ void Application::SeedDefaultsIfEmpty() {
         "note",
         "seed-session");
     app_state_.runtime.learning_sessions.push_back(std::move(learning_session));
+    MarkDirty(&app_state_, app_state_.runtime.learning_sessions.back());
     MarkMutated(&app_state_);
   }
 }
 
-bool Application::PersistRuntimeState() {
-  try {
-    repository_.SaveUserState(app_state_.user_state);
-
-    data::UiPreferences preferences{};
-    preferences.preset_mode = app_state_.ui_state.preset_mode;
-    preferences.last_non_custom_preset = app_state_.ui_state.last_non_custom_preset;
-    preferences.motion_level = app_state_.ui_state.motion_level;
-    preferences.sound_level = app_state_.ui_state.sound_level;
-    preferences.density_level = app_state_.ui_state.density_level;
-    preferences.queue_mode = app_state_.ui_state.queue_mode;
-    preferences.prompt_concurrency_limit = 2;
-    preferences.nudge_cooldown_seconds = 30;
-    preferences.updated_at = domain::CurrentTimestampUtc();
-    repository_.SaveUiPreferences(preferences);
-
-    for (const auto& action : app_state_.runtime.life_actions) {
-      repository_.UpsertActionUnit(action);
-    }
-    for (const auto& learning_goal : app_state_.runtime.learning_goals) {
-      repository_.UpsertLearningGoal(learning_goal);
-    }
-    for (const auto& learning_session : app_state_.runtime.learning_sessions) {
-      repository_.UpsertLearningSession(learning_session);
-    }
-    for (const auto& checkpoint : app_state_.runtime.milestone_checkpoints) {
-      repository_.UpsertMilestoneCheckpoint(checkpoint);
-    }
-    for (const auto& reward_event : app_state_.runtime.reward_events) {
-      repository_.AppendRewardEvent(reward_event);
-    }
+void Application::PersistRuntimeState() {
+  // The shadow is advanced optimistically; a failed write re-dirties its rows when the
+  // result is drained, so the next attempt picks them up again.
+  auto change_set = CollectChangeSet(app_state_);
+  MarkChangeSetPersisted(&app_state_, change_set);
+  app_state_.submitted_revision = app_state_.mutation_revision;
+  app_state_.save_requested = false;
+  app_state_.last_save_submitted_at = std::chrono::steady_clock::now();
+  persistence_worker_.Submit(std::move(change_set));
+}
 
-    app_state_.save_error_pending_retry = false;
-    app_state_.last_save_error.clear();
-    app_state_.persisted_revision = app_state_.mutation_revision;
-    return true;
-  } catch (const std::exception& ex) {
-    app_state_.save_error_pending_retry = true;
-    app_state_.last_save_error = ex.what();
-    app_state_.focus_status = app_state_.copy_pack.error_save_primary;
-    return false;
+void Application::DrainPersistenceResults() {
+  for (auto& result : persistence_worker_.PollResults()) {
+    ApplyPersistenceResult(&app_state_, std::move(result));
   }
 }
 
+void Application::DrainBackupResults() {
+  for (auto& result : backup_service_.PollResults()) {
+    if (result.ok) {
+      app_state_.last_backup_path = std::move(result.path);
+      app_state_.last_backup_error.clear();
+    } else {
+      app_state_.last_backup_error = std::move(result.error);
+    }
+  }
+}
+
+bool Application::FlushPersistence() {
+  PersistRuntimeState();
+  persistence_worker_.Flush();
+  DrainPersistenceResults();
+  return !app_state_.save_error_pending_retry;
+}
+
 void Application::RefreshTodayQueue() {
   app_state_.today_queue = today_queue_service_.BuildQueue(
       app_state_.ui_state.queue_mode,
@@ -318,12 +371,14 @@ int Application::Run() {
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
     SDL_GL_SwapWindow(window_);
 
-    if (app_state_.mutation_revision != app_state_.persisted_revision && !app_state_.save_error_pending_retry) {
+    DrainPersistenceResults();
+    DrainBackupResults();
+    if (SaveDue(app_state_, std::chrono::steady_clock::now())) {
       PersistRuntimeState();
     }
   }
 
-  PersistRuntimeState();
+  FlushPersistence();
   return 0;
 }
 
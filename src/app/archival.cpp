@@ -0,0 +1,15 @@
+#include "habitrpg/app/archival.hpp"
+
+#include "habitrpg/domain/entities.hpp"
+
+namespace habitrpg::app {
+
+data::ArchiveSummary ArchiveFinishedWork(
+    data::IArchiveRepository& archive,
+    const ArchivePolicy& policy,
+    const int64_t now_epoch_ms) {
+  const int64_t horizon_ms = std::chrono::duration_cast<std::chrono::milliseconds>(policy.horizon).count();
+  return archive.ArchiveCompletedBefore(domain::FormatTimestampUtcMs(now_epoch_ms - horizon_ms));
+}
+
+}  // namespace habitrpg::app
@@ -0,0 +1,159 @@
+#include "habitrpg/app/backup_service.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "habitrpg/domain/entities.hpp"
+
+namespace habitrpg::app {
+namespace {
+
+constexpr std::string_view kBackupPrefix = "habitrpg-backup-";
+constexpr std::string_view kBackupExtension = ".sqlite3";
+
+bool IsBackupFileName(const std::string& name) {
+  return name.size() > kBackupPrefix.size() + kBackupExtension.size() && name.starts_with(kBackupPrefix) &&
+         name.ends_with(kBackupExtension);
+}
+
+int64_t NowEpochMs() {
+  const auto now = std::chrono::system_clock::now().time_since_epoch();
+  return std::chrono::duration_cast<std::chrono::milliseconds>(now).count();
+}
+
+// Time until the next scheduled backup, based on the age of the newest one on disk.
+std::chrono::steady_clock::duration DelayUntilDue(const BackupSchedule& schedule) {
+  const auto backups = ListBackups(schedule.directory);
+  std::chrono::steady_clock::duration delay = std::chrono::steady_clock::duration::zero();
+  if (!backups.empty()) {
+    std::error_code time_error;
+    const auto written_at = std::filesystem::last_write_time(backups.front(), time_error);
+    if (!time_error) {
+      const auto age = std::filesystem::file_time_type::clock::now() - written_at;
+      delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(schedule.interval - age);
+    }
+  }
+  return std::max<std::chrono::steady_clock::duration>(delay, schedule.startup_delay);
+}
+
+}  // namespace
+
+BackupService::BackupService(std::string sqlite_path, BackupSchedule schedule)
+    : sqlite_path_(std::move(sqlite_path)), schedule_(std::move(schedule)) {
+  if (schedule_.directory.empty()) {
+    throw std::invalid_argument("BackupService requires a backup directory");
+  }
+  thread_ = std::jthread([this](const std::stop_token& stop_token) { Run(stop_token); });
+}
+
+BackupService::~BackupService() {
+  Stop();
+}
+
+void BackupService::RequestBackup() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    backup_requested_ = true;
+  }
+  wake_.notify_one();
+}
+
+std::vector<BackupResult> BackupService::PollResults() {
+  return results_.Drain();
+}
+
+void BackupService::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+
+  thread_.request_stop();
+  thread_.join();
+}
+
+void BackupService::Run(const std::stop_token& stop_token) {
+  auto due = std::chrono::steady_clock::now() + DelayUntilDue(schedule_);
+  while (!stop_token.stop_requested()) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wake_.wait_until(lock, stop_token, due, [this] { return backup_requested_; });
+      if (stop_token.stop_requested()) {
+        return;
+      }
+      if (!backup_requested_ && std::chrono::steady_clock::now() < due) {
+        continue;
+      }
+      backup_requested_ = false;
+    }
+
+    BackupResult result = RunBackup(stop_token);
+    if (stop_token.stop_requested()) {
+      return;
+    }
+    results_.Push(std::move(result));
+    due = std::chrono::steady_clock::now() + schedule_.interval;
+  }
+}
+
+BackupResult BackupService::RunBackup(const std::stop_token& stop_token) {
+  BackupResult result{};
+  try {
+    std::filesystem::create_directories(schedule_.directory);
+    const auto path = std::filesystem::path(schedule_.directory) / BackupFileName(NowEpochMs());
+    result.path = path.string();
+    result.pages = data::BackupDatabase(sqlite_path_, result.path, schedule_.copy_options, stop_token).pages;
+    PruneBackups(schedule_.directory, schedule_.keep_latest);
+    result.ok = true;
+  } catch (const std::exception& ex) {
+    result.error = ex.what();
+  }
+  return result;
+}
+
+std::string BackupFileName(const int64_t epoch_ms) {
+  const int64_t millis = ((epoch_ms % 1000) + 1000) % 1000;
+  std::string stamp;
+  for (const char c : domain::FormatTimestampUtcMs(epoch_ms - millis)) {
+    if (c != '-' && c != ':' && c != 'Z') {
+      stamp.push_back(c);
+    }
+  }
+
+  char millis_text[8];
+  std::snprintf(millis_text, sizeof(millis_text), "%03d", static_cast<int>(millis));
+  return std::string(kBackupPrefix) + stamp + millis_text + "Z" + std::string(kBackupExtension);
+}
+
+std::vector<std::filesystem::path> ListBackups(const std::string& directory) {
+  std::vector<std::filesystem::path> backups;
+  std::error_code list_error;
+  for (const auto& entry : std::filesystem::directory_iterator(directory, list_error)) {
+    if (entry.is_regular_file() && IsBackupFileName(entry.path().filename().string())) {
+      backups.push_back(entry.path());
+    }
+  }
+
+  std::sort(backups.begin(), backups.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.filename() > rhs.filename();
+  });
+  return backups;
+}
+
+size_t PruneBackups(const std::string& directory, const size_t keep_latest) {
+  const auto backups = ListBackups(directory);
+  size_t removed = 0;
+  for (size_t i = keep_latest; i < backups.size(); ++i) {
+    std::error_code remove_error;
+    if (std::filesystem::remove(backups[i], remove_error)) {
+      removed += 1;
+    }
+  }
+  return removed;
+}
+
+}  // namespace habitrpg::app
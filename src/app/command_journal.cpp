@@ -0,0 +1,591 @@
+#include "habitrpg/app/command_journal.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#include "habitrpg/domain/reward_engine.hpp"
+
+namespace habitrpg::app {
+namespace {
+
+using PayloadFields = std::unordered_map<std::string, std::string>;
+
+class PayloadWriter final {
+ public:
+  void Field(const std::string_view key, const std::string_view value) {
+    payload_.append(key);
+    payload_.push_back('=');
+    for (const char c : value) {
+      if (c == '\\') {
+        payload_.append("\\\\");
+      } else if (c == '\n') {
+        payload_.append("\\n");
+      } else {
+        payload_.push_back(c);
+      }
+    }
+    payload_.push_back('\n');
+  }
+
+  void Field(const std::string_view key, const int value) { Field(key, std::to_string(value)); }
+
+  std::string Take() { return std::move(payload_); }
+
+ private:
+  std::string payload_{};
+};
+
+std::optional<PayloadFields> ParsePayload(const std::string_view payload) {
+  PayloadFields fields;
+  size_t line_begin = 0;
+  while (line_begin < payload.size()) {
+    const size_t line_end = std::min(payload.find('\n', line_begin), payload.size());
+    const auto line = payload.substr(line_begin, line_end - line_begin);
+    line_begin = line_end + 1;
+
+    const size_t separator = line.find('=');
+    if (separator == std::string_view::npos) {
+      return std::nullopt;
+    }
+
+    std::string value;
+    const auto raw = line.substr(separator + 1);
+    for (size_t i = 0; i < raw.size(); ++i) {
+      if (raw[i] != '\\') {
+        value.push_back(raw[i]);
+        continue;
+      }
+      if (++i == raw.size()) {
+        return std::nullopt;
+      }
+      value.push_back(raw[i] == 'n' ? '\n' : raw[i]);
+    }
+    fields.emplace(std::string(line.substr(0, separator)), std::move(value));
+  }
+  return fields;
+}
+
+std::string FieldText(const PayloadFields& fields, const std::string& key) {
+  const auto it = fields.find(key);
+  return it != fields.end() ? it->second : std::string{};
+}
+
+bool FieldInt(const PayloadFields& fields, const std::string& key, int* value) {
+  const auto it = fields.find(key);
+  if (it == fields.end()) {
+    return false;
+  }
+  const auto& text = it->second;
+  const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), *value);
+  return error == std::errc{} && end == text.data() + text.size();
+}
+
+void WriteFields(const domain::contracts::CreateLifeActionCommand& command, PayloadWriter* writer) {
+  writer->Field("parent_id", command.parent_id);
+  writer->Field("title", command.title);
+  writer->Field("priority_score", command.priority_score);
+  writer->Field("action_unit_id", command.action_unit_id);
+}
+
+void WriteFields(const domain::contracts::StartUnitCommand& command, PayloadWriter* writer) {
+  writer->Field("unit_id", command.unit_id);
+  writer->Field("track_type", domain::TrackTypeToString(command.track_type));
+}
+
+void WriteFields(const domain::contracts::CompleteActionCommand& command, PayloadWriter* writer) {
+  writer->Field("action_unit_id", command.action_unit_id);
+  writer->Field("track_type", domain::TrackTypeToString(command.track_type));
+  writer->Field("completed_at", command.completed_at);
+}
+
+void WriteFields(const domain::contracts::CompleteLearningSessionCommand& command, PayloadWriter* writer) {
+  writer->Field("learning_session_id", command.learning_session_id);
+  writer->Field("learning_goal_id", command.learning_goal_id);
+  writer->Field("duration_minutes", command.duration_minutes);
+  writer->Field("completed_at", command.completed_at);
+}
+
+void WriteFields(const domain::contracts::CheckpointLearningSessionCommand& command, PayloadWriter* writer) {
+  writer->Field("learning_session_id", command.learning_session_id);
+  writer->Field("checkpoint_note", command.checkpoint_note);
+}
+
+void WriteFields(const domain::contracts::CreateLearningGoalCommand& command, PayloadWriter* writer) {
+  writer->Field("title", command.title);
+  writer->Field("milestone", command.milestone);
+  writer->Field("learning_goal_id", command.learning_goal_id);
+}
+
+void WriteFields(const domain::contracts::CreateLearningSessionCommand& command, PayloadWriter* writer) {
+  writer->Field("learning_goal_id", command.learning_goal_id);
+  writer->Field("title", command.title);
+  writer->Field("duration_minutes", command.duration_minutes);
+  writer->Field("priority_score", command.priority_score);
+  writer->Field("artifact_kind", command.artifact_kind);
+  writer->Field("artifact_ref", command.artifact_ref);
+  writer->Field("learning_session_id", command.learning_session_id);
+}
+
+void WriteFields(const domain::contracts::SetUnitLifecycleCommand& command, PayloadWriter* writer) {
+  writer->Field("unit_id", command.unit_id);
+  writer->Field("track_type", domain::TrackTypeToString(command.track_type));
+  writer->Field("lifecycle_state", domain::LifecycleStateToString(command.lifecycle_state));
+}
+
+void WriteFields(const domain::contracts::SaveCheckpointCandidateCommand& command, PayloadWriter* writer) {
+  writer->Field("learning_session_id", command.learning_session_id);
+  writer->Field("candidate_reason", command.candidate_reason);
+  writer->Field("milestone_checkpoint_id", command.milestone_checkpoint_id);
+}
+
+void WriteFields(const domain::contracts::ConfirmMilestoneCheckpointCommand& command, PayloadWriter* writer) {
+  writer->Field("milestone_checkpoint_id", command.milestone_checkpoint_id);
+  writer->Field("confirmed_at", command.confirmed_at);
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CreateLifeActionCommand* command) {
+  command->parent_id = FieldText(fields, "parent_id");
+  command->title = FieldText(fields, "title");
+  command->action_unit_id = FieldText(fields, "action_unit_id");
+  return FieldInt(fields, "priority_score", &command->priority_score);
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::StartUnitCommand* command) {
+  command->unit_id = FieldText(fields, "unit_id");
+  command->track_type = domain::TrackTypeFromString(FieldText(fields, "track_type"));
+  return !command->unit_id.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CompleteActionCommand* command) {
+  command->action_unit_id = FieldText(fields, "action_unit_id");
+  command->track_type = domain::TrackTypeFromString(FieldText(fields, "track_type"));
+  command->completed_at = FieldText(fields, "completed_at");
+  return !command->action_unit_id.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CompleteLearningSessionCommand* command) {
+  command->learning_session_id = FieldText(fields, "learning_session_id");
+  command->learning_goal_id = FieldText(fields, "learning_goal_id");
+  command->completed_at = FieldText(fields, "completed_at");
+  return !command->learning_session_id.empty() && FieldInt(fields, "duration_minutes", &command->duration_minutes);
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CheckpointLearningSessionCommand* command) {
+  command->learning_session_id = FieldText(fields, "learning_session_id");
+  command->checkpoint_note = FieldText(fields, "checkpoint_note");
+  return !command->learning_session_id.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CreateLearningGoalCommand* command) {
+  command->title = FieldText(fields, "title");
+  command->milestone = FieldText(fields, "milestone");
+  command->learning_goal_id = FieldText(fields, "learning_goal_id");
+  return !command->title.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::CreateLearningSessionCommand* command) {
+  command->learning_goal_id = FieldText(fields, "learning_goal_id");
+  command->title = FieldText(fields, "title");
+  command->artifact_kind = FieldText(fields, "artifact_kind");
+  command->artifact_ref = FieldText(fields, "artifact_ref");
+  command->learning_session_id = FieldText(fields, "learning_session_id");
+  return !command->learning_goal_id.empty() && FieldInt(fields, "duration_minutes", &command->duration_minutes) &&
+         FieldInt(fields, "priority_score", &command->priority_score);
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::SetUnitLifecycleCommand* command) {
+  command->unit_id = FieldText(fields, "unit_id");
+  command->track_type = domain::TrackTypeFromString(FieldText(fields, "track_type"));
+  command->lifecycle_state = domain::LifecycleStateFromString(FieldText(fields, "lifecycle_state"));
+  return !command->unit_id.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::SaveCheckpointCandidateCommand* command) {
+  command->learning_session_id = FieldText(fields, "learning_session_id");
+  command->candidate_reason = FieldText(fields, "candidate_reason");
+  command->milestone_checkpoint_id = FieldText(fields, "milestone_checkpoint_id");
+  return !command->learning_session_id.empty();
+}
+
+bool ReadFields(const PayloadFields& fields, domain::contracts::ConfirmMilestoneCheckpointCommand* command) {
+  command->milestone_checkpoint_id = FieldText(fields, "milestone_checkpoint_id");
+  command->confirmed_at = FieldText(fields, "confirmed_at");
+  return !command->milestone_checkpoint_id.empty();
+}
+
+template <typename Command>
+bool TryDecode(
+    const data::CommandJournalRecord& record,
+    const PayloadFields& fields,
+    std::optional<JournaledCommand>* out) {
+  if (record.command_id != Command::kCommandId) {
+    return false;
+  }
+
+  Command command{};
+  if (ReadFields(fields, &command)) {
+    *out = std::move(command);
+  }
+  return true;
+}
+
+template <typename Entity>
+bool ContainsId(const std::vector<Entity>& rows, const std::string& id) {
+  return std::any_of(rows.begin(), rows.end(), [&id](const Entity& row) { return row.id == id; });
+}
+
+// Assigns the id of a row the command creates (if not assigned yet), so commands that
+// later refer to it still match after a replay.
+void AssignCreatedId(std::string* id, const std::string_view prefix) {
+  if (id->empty()) {
+    *id = domain::GenerateStableId(prefix);
+  }
+}
+
+// Starting a unit pauses whichever units are active, so their rows change too.
+void MarkActiveUnitsDirty(AppState* app_state) {
+  for (const auto& action_unit : app_state->runtime.life_actions) {
+    if (action_unit.lifecycle_state == domain::LifecycleState::Active) {
+      MarkDirty(app_state, action_unit);
+    }
+  }
+  for (const auto& session : app_state->runtime.learning_sessions) {
+    if (session.lifecycle_state == domain::LifecycleState::Active) {
+      MarkDirty(app_state, session);
+    }
+  }
+}
+
+void ClearActiveUnit(const std::string& unit_id, AppState* app_state) {
+  if (app_state->active_unit_id == unit_id) {
+    app_state->active_unit_id.clear();
+  }
+}
+
+}  // namespace
+
+data::CommandJournalRecord EncodeCommand(const JournaledCommand& command) {
+  return std::visit(
+      [](const auto& typed) {
+        PayloadWriter writer;
+        WriteFields(typed, &writer);
+
+        data::CommandJournalRecord record{};
+        record.command_id = std::decay_t<decltype(typed)>::kCommandId;
+        record.payload = writer.Take();
+        record.recorded_at = domain::CurrentTimestampUtc();
+        return record;
+      },
+      command);
+}
+
+std::optional<JournaledCommand> DecodeCommand(const data::CommandJournalRecord& record) {
+  const auto fields = ParsePayload(record.payload);
+  if (!fields.has_value()) {
+    return std::nullopt;
+  }
+
+  std::optional<JournaledCommand> command;
+  try {
+    TryDecode<domain::contracts::CreateLifeActionCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::StartUnitCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::CompleteActionCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::CompleteLearningSessionCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::CheckpointLearningSessionCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::CreateLearningGoalCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::CreateLearningSessionCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::SetUnitLifecycleCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::SaveCheckpointCandidateCommand>(record, *fields, &command) ||
+        TryDecode<domain::contracts::ConfirmMilestoneCheckpointCommand>(record, *fields, &command);
+  } catch (const std::invalid_argument&) {
+    return std::nullopt;  // unknown track type or lifecycle state
+  }
+  return command;
+}
+
+bool ApplyCommand(const JournaledCommand& command, const domain::InteractionFlowService& flow, AppState* app_state) {
+  if (app_state == nullptr) {
+    return false;
+  }
+
+  auto& runtime = app_state->runtime;
+  if (const auto* create = std::get_if<domain::contracts::CreateLifeActionCommand>(&command)) {
+    if (create->title.empty()) {
+      return false;
+    }
+    auto action = flow.CreateLifeAction(create->parent_id, create->title, create->priority_score);
+    if (!create->action_unit_id.empty()) {
+      if (ContainsId(runtime.life_actions, create->action_unit_id)) {
+        return false;
+      }
+      action.id = create->action_unit_id;
+    }
+    runtime.life_actions.push_back(std::move(action));
+    MarkDirty(app_state, runtime.life_actions.back());
+    return true;
+  }
+
+  if (const auto* start = std::get_if<domain::contracts::StartUnitCommand>(&command)) {
+    MarkActiveUnitsDirty(app_state);
+    const bool changed = start->track_type == domain::TrackType::Life
+                             ? flow.StartActionUnit(start->unit_id, &runtime.life_actions, &runtime.learning_sessions)
+                             : flow.StartLearningSession(
+                                   start->unit_id,
+                                   &runtime.life_actions,
+                                   &runtime.learning_sessions);
+    if (changed) {
+      auto& dirty_ids =
+          start->track_type == domain::TrackType::Life ? runtime.dirty.life_actions : runtime.dirty.learning_sessions;
+      dirty_ids.insert(start->unit_id);
+      app_state->active_unit_id = start->unit_id;
+      app_state->active_track_type = start->track_type;
+    }
+    return changed;
+  }
+
+  if (const auto* complete = std::get_if<domain::contracts::CompleteActionCommand>(&command)) {
+    domain::RewardEngine reward_engine;
+    const bool changed = flow.CompleteActionUnit(
+        complete->action_unit_id,
+        &runtime.life_actions,
+        &reward_engine,
+        &app_state->user_state,
+        &runtime.reward_events,
+        complete->completed_at);
+    if (changed) {
+      runtime.dirty.life_actions.insert(complete->action_unit_id);
+      ClearActiveUnit(complete->action_unit_id, app_state);
+    }
+    return changed;
+  }
+
+  if (const auto* complete = std::get_if<domain::contracts::CompleteLearningSessionCommand>(&command)) {
+    if (complete->duration_minutes > 0) {
+      for (auto& session : runtime.learning_sessions) {
+        if (session.id == complete->learning_session_id) {
+          session.duration_minutes = complete->duration_minutes;
+        }
+      }
+    }
+
+    domain::RewardEngine reward_engine;
+    const bool changed = flow.CompleteLearningSession(
+        complete->learning_session_id,
+        &runtime.learning_sessions,
+        &reward_engine,
+        &app_state->user_state,
+        &runtime.reward_events,
+        complete->completed_at);
+    if (changed) {
+      runtime.dirty.learning_sessions.insert(complete->learning_session_id);
+      ClearActiveUnit(complete->learning_session_id, app_state);
+    }
+    return changed;
+  }
+
+  if (const auto* checkpoint = std::get_if<domain::contracts::CheckpointLearningSessionCommand>(&command)) {
+    const bool changed = flow.CheckpointLearningSession(
+        checkpoint->learning_session_id,
+        checkpoint->checkpoint_note,
+        &runtime.learning_sessions);
+    if (changed) {
+      runtime.dirty.learning_sessions.insert(checkpoint->learning_session_id);
+    }
+    return changed;
+  }
+
+  if (const auto* create = std::get_if<domain::contracts::CreateLearningGoalCommand>(&command)) {
+    if (create->title.empty() || create->milestone.empty()) {
+      return false;
+    }
+    auto goal = flow.CreateLearningGoal(create->title, create->milestone);
+    if (!create->learning_goal_id.empty()) {
+      if (ContainsId(runtime.learning_goals, create->learning_goal_id)) {
+        return false;
+      }
+      goal.id = create->learning_goal_id;
+    }
+    runtime.learning_goals.push_back(std::move(goal));
+    MarkDirty(app_state, runtime.learning_goals.back());
+    return true;
+  }
+
+  if (const auto* create = std::get_if<domain::contracts::CreateLearningSessionCommand>(&command)) {
+    if (create->title.empty() || !ContainsId(runtime.learning_goals, create->learning_goal_id)) {
+      return false;
+    }
+    auto session = flow.CreateLearningSession(
+        create->learning_goal_id,
+        create->title,
+        create->duration_minutes,
+        create->priority_score,
+        create->artifact_kind,
+        create->artifact_ref);
+    if (!create->learning_session_id.empty()) {
+      if (ContainsId(runtime.learning_sessions, create->learning_session_id)) {
+        return false;
+      }
+      session.id = create->learning_session_id;
+    }
+    runtime.learning_sessions.push_back(std::move(session));
+    MarkDirty(app_state, runtime.learning_sessions.back());
+    return true;
+  }
+
+  if (const auto* set = std::get_if<domain::contracts::SetUnitLifecycleCommand>(&command)) {
+    if (set->lifecycle_state != domain::LifecycleState::Partial &&
+        set->lifecycle_state != domain::LifecycleState::Paused &&
+        set->lifecycle_state != domain::LifecycleState::Missed) {
+      return false;
+    }
+    if (set->track_type == domain::TrackType::Life) {
+      for (auto& action_unit : runtime.life_actions) {
+        if (action_unit.id == set->unit_id) {
+          action_unit.lifecycle_state = set->lifecycle_state;
+          action_unit.status = domain::ActionStatus::Todo;
+          MarkDirty(app_state, action_unit);
+          return true;
+        }
+      }
+      return false;
+    }
+    for (auto& session : runtime.learning_sessions) {
+      if (session.id == set->unit_id) {
+        session.lifecycle_state = set->lifecycle_state;
+        MarkDirty(app_state, session);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if (const auto* save = std::get_if<domain::contracts::SaveCheckpointCandidateCommand>(&command)) {
+    const auto session = std::find_if(
+        runtime.learning_sessions.begin(),
+        runtime.learning_sessions.end(),
+        [&save](const domain::LearningSession& row) { return row.id == save->learning_session_id; });
+    if (session == runtime.learning_sessions.end()) {
+      return false;
+    }
+
+    const auto open = std::find_if(
+        runtime.milestone_checkpoints.begin(),
+        runtime.milestone_checkpoints.end(),
+        [&save](const domain::MilestoneCheckpoint& checkpoint) {
+          return checkpoint.learning_session_id == save->learning_session_id &&
+                 checkpoint.state == domain::MilestoneCheckpointState::Candidate;
+        });
+    if (open != runtime.milestone_checkpoints.end()) {
+      open->updated_at = domain::CurrentTimestampUtc();
+      open->candidate_reason = save->candidate_reason;
+      MarkDirty(app_state, *open);
+      return true;
+    }
+
+    auto checkpoint = flow.CreateMilestoneCheckpointCandidate(
+        *session,
+        "default",
+        "snippet",
+        session->artifact_ref,
+        2,
+        save->candidate_reason);
+    if (!save->milestone_checkpoint_id.empty()) {
+      if (ContainsId(runtime.milestone_checkpoints, save->milestone_checkpoint_id)) {
+        return false;
+      }
+      checkpoint.id = save->milestone_checkpoint_id;
+    }
+    runtime.milestone_checkpoints.push_back(std::move(checkpoint));
+    MarkDirty(app_state, runtime.milestone_checkpoints.back());
+    return true;
+  }
+
+  // The ledger window may not hold the checkpoint's reward; storage decides whether it
+  // was already credited.
+  const auto& confirm = std::get<domain::contracts::ConfirmMilestoneCheckpointCommand>(command);
+  const auto reward_recorded = [app_state](const domain::EntityId& reward_event_id) {
+    return app_state->reward_repository != nullptr && app_state->reward_repository->HasRewardEvent(reward_event_id);
+  };
+  domain::RewardEngine reward_engine;
+  const bool changed = flow.PromoteMilestoneCheckpointToConfirmed(
+      confirm.milestone_checkpoint_id,
+      &runtime.milestone_checkpoints,
+      &reward_engine,
+      &app_state->user_state,
+      &runtime.reward_events,
+      reward_recorded,
+      confirm.confirmed_at);
+  if (changed) {
+    runtime.dirty.milestone_checkpoints.insert(confirm.milestone_checkpoint_id);
+  }
+  return changed;
+}
+
+bool DispatchCommand(AppState* app_state, const domain::InteractionFlowService& flow, const JournaledCommand& command) {
+  if (app_state == nullptr) {
+    return false;
+  }
+
+  JournaledCommand assigned = command;
+  if (auto* create = std::get_if<domain::contracts::CreateLifeActionCommand>(&assigned)) {
+    AssignCreatedId(&create->action_unit_id, "action");
+  } else if (auto* create = std::get_if<domain::contracts::CreateLearningGoalCommand>(&assigned)) {
+    AssignCreatedId(&create->learning_goal_id, "goal");
+  } else if (auto* create = std::get_if<domain::contracts::CreateLearningSessionCommand>(&assigned)) {
+    AssignCreatedId(&create->learning_session_id, "session");
+  } else if (auto* save = std::get_if<domain::contracts::SaveCheckpointCandidateCommand>(&assigned)) {
+    AssignCreatedId(&save->milestone_checkpoint_id, "checkpoint");
+  }
+
+  bool journaled = true;
+  if (app_state->command_journal != nullptr) {
+    try {
+      app_state->journaled_through = app_state->command_journal->AppendCommand(EncodeCommand(assigned));
+    } catch (const std::exception& error) {
+      app_state->last_journal_error = error.what();
+      journaled = false;
+    }
+  }
+
+  const bool changed = ApplyCommand(assigned, flow, app_state);
+  if (changed && journaled) {
+    MarkJournaledMutation(app_state);
+  } else if (changed) {
+    MarkMutated(app_state);
+    app_state->unjournaled_revision = app_state->mutation_revision;
+  }
+  return changed;
+}
+
+size_t ReplayCommandJournal(
+    const data::ICommandJournalRepository& journal,
+    const domain::InteractionFlowService& flow,
+    AppState* app_state) {
+  if (app_state == nullptr) {
+    return 0;
+  }
+
+  size_t applied = 0;
+  journal.VisitCommandsAfter(0, [&](const data::CommandJournalRecord& record) {
+    // Skipped records still advance journaled_through so the next save drops them.
+    app_state->journaled_through = std::max(app_state->journaled_through, record.sequence);
+    if (const auto command = DecodeCommand(record); command.has_value() && ApplyCommand(*command, flow, app_state)) {
+      ++applied;
+    }
+    return true;
+  });
+
+  if (applied > 0) {
+    MarkMutated(app_state);
+  }
+  return applied;
+}
+
+}  // namespace habitrpg::app
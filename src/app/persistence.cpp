@@ -0,0 +1,246 @@
+#include "habitrpg/app/persistence.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+#include "habitrpg/app/user_state_ledger.hpp"
+
+namespace habitrpg::app {
+namespace {
+
+template <typename Entity>
+void CollectDirty(
+    const std::vector<Entity>& rows,
+    const std::unordered_set<domain::EntityId>& dirty_ids,
+    std::vector<Entity>* dirty_rows) {
+  if (dirty_ids.empty()) {
+    return;
+  }
+
+  dirty_rows->reserve(dirty_ids.size());
+  for (const auto& row : rows) {
+    if (dirty_ids.contains(row.id)) {
+      dirty_rows->push_back(row);
+    }
+  }
+}
+
+template <typename Entity>
+void MarkClean(const std::vector<Entity>& rows, std::unordered_set<domain::EntityId>* dirty_ids) {
+  for (const auto& row : rows) {
+    dirty_ids->erase(row.id);
+  }
+}
+
+template <typename Entity>
+void MarkDirtyAgain(const std::vector<Entity>& rows, std::unordered_set<domain::EntityId>* dirty_ids) {
+  for (const auto& row : rows) {
+    dirty_ids->insert(row.id);
+  }
+}
+
+template <typename Entity>
+void MergeRows(std::vector<Entity>* into, std::vector<Entity>&& newer) {
+  if (into->empty()) {
+    *into = std::move(newer);
+    return;
+  }
+
+  std::unordered_map<domain::EntityId, size_t> index_by_id;
+  index_by_id.reserve(into->size());
+  for (size_t i = 0; i < into->size(); ++i) {
+    index_by_id.emplace((*into)[i].id, i);
+  }
+
+  for (auto& row : newer) {
+    const auto it = index_by_id.find(row.id);
+    if (it != index_by_id.end()) {
+      (*into)[it->second] = std::move(row);
+    } else {
+      index_by_id.emplace(row.id, into->size());
+      into->push_back(std::move(row));
+    }
+  }
+}
+
+}  // namespace
+
+size_t PersistenceChangeSet::RowCount() const {
+  return (user_state.has_value() ? 1 : 0) + (ui_preferences.has_value() ? 1 : 0) + life_actions.size() +
+         learning_goals.size() + learning_sessions.size() + milestone_checkpoints.size() + reward_events.size();
+}
+
+bool SaveDue(const AppState& app_state, const std::chrono::steady_clock::time_point now) {
+  if (app_state.mutation_revision == app_state.submitted_revision || app_state.save_error_pending_retry) {
+    return false;
+  }
+  return app_state.save_requested || now - app_state.last_save_submitted_at >= kCompactionInterval;
+}
+
+data::UiPreferences BuildUiPreferences(const AppState& app_state) {
+  data::UiPreferences preferences{};
+  preferences.preset_mode = app_state.ui_state.preset_mode;
+  preferences.last_non_custom_preset = app_state.ui_state.last_non_custom_preset;
+  preferences.motion_level = app_state.ui_state.motion_level;
+  preferences.sound_level = app_state.ui_state.sound_level;
+  preferences.density_level = app_state.ui_state.density_level;
+  preferences.queue_mode = app_state.ui_state.queue_mode;
+  preferences.prompt_concurrency_limit = 2;
+  preferences.nudge_cooldown_seconds = 30;
+  return preferences;
+}
+
+void ResetPersistedShadow(AppState* app_state) {
+  if (app_state == nullptr) {
+    return;
+  }
+
+  auto& runtime = app_state->runtime;
+  auto& persisted = runtime.persisted;
+  persisted.user_state = app_state->user_state;
+  persisted.ui_preferences = BuildUiPreferences(*app_state);
+  runtime.dirty = {};
+  persisted.reward_events = runtime.reward_events.size();
+}
+
+PersistenceChangeSet CollectChangeSet(const AppState& app_state) {
+  const auto& runtime = app_state.runtime;
+  const auto& persisted = runtime.persisted;
+
+  PersistenceChangeSet change_set{};
+  change_set.revision = app_state.mutation_revision;
+
+  if (!persisted.user_state.has_value() || !(*persisted.user_state == app_state.user_state)) {
+    change_set.user_state = app_state.user_state;
+  }
+
+  auto preferences = BuildUiPreferences(app_state);
+  if (!persisted.ui_preferences.has_value() || !(*persisted.ui_preferences == preferences)) {
+    change_set.ui_preferences = std::move(preferences);
+  }
+
+  CollectDirty(runtime.life_actions, runtime.dirty.life_actions, &change_set.life_actions);
+  CollectDirty(runtime.learning_goals, runtime.dirty.learning_goals, &change_set.learning_goals);
+  CollectDirty(runtime.learning_sessions, runtime.dirty.learning_sessions, &change_set.learning_sessions);
+  CollectDirty(runtime.milestone_checkpoints, runtime.dirty.milestone_checkpoints, &change_set.milestone_checkpoints);
+
+  const size_t first_new_reward = std::min(persisted.reward_events, runtime.reward_events.size());
+  change_set.reward_events.assign(runtime.reward_events.begin() + first_new_reward, runtime.reward_events.end());
+  change_set.reward_events_begin = first_new_reward;
+  change_set.reward_events_end = runtime.reward_events.size();
+  if (app_state.journaled_through > persisted.journal_through) {
+    change_set.journal_through = app_state.journaled_through;
+  }
+  return change_set;
+}
+
+size_t WriteChangeSet(data::SqliteRepository& repository, const PersistenceChangeSet& change_set) {
+  const size_t row_count = change_set.RowCount();
+  if (row_count == 0 && change_set.journal_through == 0) {
+    return 0;
+  }
+
+  data::UnitOfWork unit_of_work(repository);
+  if (change_set.user_state.has_value()) {
+    repository.SaveUserState(*change_set.user_state);
+  }
+  if (change_set.ui_preferences.has_value()) {
+    auto preferences = *change_set.ui_preferences;
+    preferences.updated_at = domain::CurrentTimestampUtc();
+    repository.SaveUiPreferences(preferences);
+  }
+  repository.UpsertActionUnits(change_set.life_actions);
+  repository.UpsertLearningGoals(change_set.learning_goals);
+  repository.UpsertLearningSessions(change_set.learning_sessions);
+  repository.UpsertMilestoneCheckpoints(change_set.milestone_checkpoints);
+  repository.AppendRewardEvents(change_set.reward_events);
+  if (!change_set.reward_events.empty()) {
+    CheckpointUserState(repository, repository, domain::RewardEngine{});
+  }
+  if (change_set.journal_through > 0) {
+    repository.TruncateCommandsThrough(change_set.journal_through);
+  }
+  unit_of_work.Commit();
+
+  return row_count;
+}
+
+void MarkChangeSetPersisted(AppState* app_state, const PersistenceChangeSet& change_set) {
+  if (app_state == nullptr) {
+    return;
+  }
+
+  auto& persisted = app_state->runtime.persisted;
+  auto& dirty = app_state->runtime.dirty;
+  if (change_set.user_state.has_value()) {
+    persisted.user_state = change_set.user_state;
+  }
+  if (change_set.ui_preferences.has_value()) {
+    persisted.ui_preferences = change_set.ui_preferences;
+  }
+  MarkClean(change_set.life_actions, &dirty.life_actions);
+  MarkClean(change_set.learning_goals, &dirty.learning_goals);
+  MarkClean(change_set.learning_sessions, &dirty.learning_sessions);
+  MarkClean(change_set.milestone_checkpoints, &dirty.milestone_checkpoints);
+  persisted.reward_events = std::max(persisted.reward_events, change_set.reward_events_end);
+  persisted.journal_through = std::max(persisted.journal_through, change_set.journal_through);
+}
+
+void ForgetPersisted(AppState* app_state, const PersistenceChangeSet& change_set) {
+  if (app_state == nullptr) {
+    return;
+  }
+
+  auto& persisted = app_state->runtime.persisted;
+  auto& dirty = app_state->runtime.dirty;
+  if (change_set.user_state.has_value()) {
+    persisted.user_state.reset();
+  }
+  if (change_set.ui_preferences.has_value()) {
+    persisted.ui_preferences.reset();
+  }
+  MarkDirtyAgain(change_set.life_actions, &dirty.life_actions);
+  MarkDirtyAgain(change_set.learning_goals, &dirty.learning_goals);
+  MarkDirtyAgain(change_set.learning_sessions, &dirty.learning_sessions);
+  MarkDirtyAgain(change_set.milestone_checkpoints, &dirty.milestone_checkpoints);
+  if (!change_set.reward_events.empty()) {
+    persisted.reward_events = std::min(persisted.reward_events, change_set.reward_events_begin);
+  }
+  if (change_set.journal_through > 0) {
+    persisted.journal_through = 0;  // truncating again is harmless
+  }
+}
+
+void MergeChangeSets(PersistenceChangeSet* into, PersistenceChangeSet&& newer) {
+  if (into == nullptr) {
+    return;
+  }
+
+  into->revision = std::max(into->revision, newer.revision);
+  if (newer.user_state.has_value()) {
+    into->user_state = std::move(newer.user_state);
+  }
+  if (newer.ui_preferences.has_value()) {
+    into->ui_preferences = std::move(newer.ui_preferences);
+  }
+  MergeRows(&into->life_actions, std::move(newer.life_actions));
+  MergeRows(&into->learning_goals, std::move(newer.learning_goals));
+  MergeRows(&into->learning_sessions, std::move(newer.learning_sessions));
+  MergeRows(&into->milestone_checkpoints, std::move(newer.milestone_checkpoints));
+
+  if (into->reward_events.empty()) {
+    into->reward_events_begin = newer.reward_events_begin;
+  }
+  into->reward_events.insert(
+      into->reward_events.end(),
+      std::make_move_iterator(newer.reward_events.begin()),
+      std::make_move_iterator(newer.reward_events.end()));
+  into->reward_events_end = std::max(into->reward_events_end, newer.reward_events_end);
+  into->journal_through = std::max(into->journal_through, newer.journal_through);
+}
+
+}  // namespace habitrpg::app
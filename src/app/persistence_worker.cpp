@@ -0,0 +1,109 @@
+#include "habitrpg/app/persistence_worker.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace habitrpg::app {
+
+PersistenceWorker::PersistenceWorker(const std::string& sqlite_path, data::SqliteRepositoryOptions options)
+    : repository_(sqlite_path, options) {
+  thread_ = std::jthread([this](const std::stop_token& stop_token) { Run(stop_token); });
+}
+
+PersistenceWorker::~PersistenceWorker() {
+  Stop();
+}
+
+void PersistenceWorker::Submit(PersistenceChangeSet change_set) {
+  pending_.Push(std::move(change_set));
+  submitted_.fetch_add(1, std::memory_order_release);
+  wake_.fetch_add(1, std::memory_order_release);
+  wake_.notify_one();
+}
+
+std::vector<PersistenceResult> PersistenceWorker::PollResults() {
+  return results_.Drain();
+}
+
+void PersistenceWorker::Flush() {
+  const uint64_t target = submitted_.load(std::memory_order_acquire);
+  uint64_t completed = completed_.load(std::memory_order_acquire);
+  while (completed < target) {
+    completed_.wait(completed, std::memory_order_acquire);
+    completed = completed_.load(std::memory_order_acquire);
+  }
+}
+
+void PersistenceWorker::Stop() {
+  if (!thread_.joinable()) {
+    return;
+  }
+
+  thread_.request_stop();
+  wake_.fetch_add(1, std::memory_order_release);
+  wake_.notify_one();
+  thread_.join();
+}
+
+void PersistenceWorker::Run(const std::stop_token& stop_token) {
+  while (true) {
+    const uint64_t observed_wake = wake_.load(std::memory_order_acquire);
+    auto batch = pending_.Drain();
+    if (batch.empty()) {
+      if (stop_token.stop_requested()) {
+        return;
+      }
+      wake_.wait(observed_wake, std::memory_order_acquire);
+      continue;
+    }
+
+    PersistenceChangeSet merged = std::move(batch.front());
+    for (size_t i = 1; i < batch.size(); ++i) {
+      MergeChangeSets(&merged, std::move(batch[i]));
+    }
+
+    PersistenceResult result{};
+    result.revision = merged.revision;
+    result.coalesced_change_sets = batch.size();
+    try {
+      result.rows_written = WriteChangeSet(repository_, merged);
+      result.ok = true;
+    } catch (const std::exception& ex) {
+      result.error = ex.what();
+      result.failed_change_set = std::move(merged);
+    }
+
+    results_.Push(std::move(result));
+    completed_.fetch_add(batch.size(), std::memory_order_release);
+    completed_.notify_all();
+  }
+}
+
+void ApplyPersistenceResult(AppState* app_state, PersistenceResult result) {
+  if (app_state == nullptr) {
+    return;
+  }
+
+  if (!result.ok) {
+    ForgetPersisted(app_state, result.failed_change_set);
+    app_state->save_error_pending_retry = true;
+    app_state->last_save_error = std::move(result.error);
+    app_state->focus_status = app_state->copy_pack.error_save_primary;
+    app_state->submitted_revision = app_state->persisted_revision;
+    return;
+  }
+
+  if (app_state->save_error_pending_retry) {
+    return;
+  }
+
+  app_state->last_save_error.clear();
+  app_state->last_save_rows_written = result.rows_written;
+  app_state->persisted_revision = std::max(app_state->persisted_revision, result.revision);
+  if (app_state->persisted_revision >= app_state->unjournaled_revision) {
+    app_state->last_journal_error.clear();
+  }
+}
+
+}  // namespace habitrpg::app
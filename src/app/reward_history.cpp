@@ -0,0 +1,55 @@
+#include "habitrpg/app/reward_history.hpp"
+
+#include <iterator>
+#include <utility>
+
+namespace habitrpg::app {
+
+void LoadRecentRewardEvents(const data::IRewardRepository& repository, AppState* app_state, const size_t window) {
+  if (app_state == nullptr) {
+    return;
+  }
+
+  auto& runtime = app_state->runtime;
+  runtime.reward_events.clear();
+  runtime.older_reward_events.clear();
+  runtime.older_reward_cursor.reset();
+  if (window == 0) {
+    return;
+  }
+
+  data::RewardEventPageQuery query{};
+  query.page_size = window;
+  auto page = repository.ListRewardEventsPage(query);
+
+  runtime.reward_events.assign(
+      std::make_move_iterator(page.events.rbegin()),
+      std::make_move_iterator(page.events.rend()));
+  runtime.older_reward_cursor = std::move(page.next);
+}
+
+size_t LoadOlderRewardEvents(const data::IRewardRepository& repository, AppState* app_state, const size_t page_size) {
+  if (app_state == nullptr || page_size == 0 || !HasOlderRewardEvents(*app_state)) {
+    return 0;
+  }
+
+  auto& runtime = app_state->runtime;
+  data::RewardEventPageQuery query{};
+  query.before = runtime.older_reward_cursor;
+  query.page_size = page_size;
+  auto page = repository.ListRewardEventsPage(query);
+
+  const size_t fetched = page.events.size();
+  runtime.older_reward_events.insert(
+      runtime.older_reward_events.end(),
+      std::make_move_iterator(page.events.begin()),
+      std::make_move_iterator(page.events.end()));
+  runtime.older_reward_cursor = std::move(page.next);
+  return fetched;
+}
+
+bool HasOlderRewardEvents(const AppState& app_state) {
+  return app_state.runtime.older_reward_cursor.has_value();
+}
+
+}  // namespace habitrpg::app
@@ -10,7 +10,6 @@ namespace habitrpg::app {
 bool StartupSmokeCheck(const std::string& sqlite_path, std::string* error_out) {
   try {
     data::SqliteRepository repository(sqlite_path);
-    repository.Migrate();
 
     const auto user_state = repository.LoadUserState();
     if (user_state.level < 1) {
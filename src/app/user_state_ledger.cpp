@@ -0,0 +1,64 @@
+#include "habitrpg/app/user_state_ledger.hpp"
+
+#include <optional>
+
+namespace habitrpg::app {
+namespace {
+
+UserStateReplay ReplayFrom(
+    const data::IRewardRepository& rewards,
+    const data::IUserStateRepository& user_states,
+    const domain::RewardEngine& reward_engine,
+    const std::optional<data::UserStateSnapshot>& snapshot) {
+  UserStateReplay replay{};
+  if (snapshot.has_value()) {
+    replay.user_state = snapshot->user_state;
+    replay.through_sequence = snapshot->through_sequence;
+  }
+
+  rewards.VisitRewardLedgerAfter(
+      replay.through_sequence,
+      [&replay, &reward_engine](const uint64_t sequence, const domain::RewardEvent& reward_event) {
+        reward_engine.ApplyReward(reward_event, &replay.user_state);
+        replay.through_sequence = sequence;
+        ++replay.replayed_events;
+        return true;
+      });
+
+  const auto stored = user_states.LoadUserState();
+  replay.user_state.recovery_tokens = stored.recovery_tokens;
+  replay.cached_row_stale = !(stored == replay.user_state);
+  return replay;
+}
+
+}  // namespace
+
+UserStateReplay ReplayUserState(
+    const data::IRewardRepository& rewards,
+    const data::IUserStateRepository& user_states,
+    const domain::RewardEngine& reward_engine) {
+  return ReplayFrom(rewards, user_states, reward_engine, user_states.LoadLatestUserStateSnapshot());
+}
+
+bool CheckpointUserState(
+    const data::IRewardRepository& rewards,
+    data::IUserStateRepository& user_states,
+    const domain::RewardEngine& reward_engine,
+    const size_t interval) {
+  const auto snapshot = user_states.LoadLatestUserStateSnapshot();
+  const uint64_t snapshot_sequence = snapshot.has_value() ? snapshot->through_sequence : 0;
+  const uint64_t latest_sequence = rewards.LatestRewardSequence();
+  if (latest_sequence <= snapshot_sequence || latest_sequence - snapshot_sequence < interval) {
+    return false;
+  }
+
+  const auto replay = ReplayFrom(rewards, user_states, reward_engine, snapshot);
+  data::UserStateSnapshot next{};
+  next.through_sequence = replay.through_sequence;
+  next.user_state = replay.user_state;
+  next.created_at = domain::CurrentTimestampUtc();
+  user_states.SaveUserStateSnapshot(next);
+  return true;
+}
+
+}  // namespace habitrpg::app
@@ -0,0 +1,122 @@
+#include "habitrpg/data/cached_repository.hpp"
+
+namespace habitrpg::data {
+
+CachedActionUnitRepository::CachedActionUnitRepository(IActionUnitRepository& inner, const size_t capacity)
+    : inner_(inner), cache_(capacity) {}
+
+void CachedActionUnitRepository::UpsertActionUnit(const domain::ActionUnit& action_unit) {
+  inner_.UpsertActionUnit(action_unit);
+  cache_.Invalidate(action_unit.id);
+}
+
+void CachedActionUnitRepository::UpsertActionUnits(const std::span<const domain::ActionUnit> action_units) {
+  inner_.UpsertActionUnits(action_units);
+  for (const auto& action_unit : action_units) {
+    cache_.Invalidate(action_unit.id);
+  }
+}
+
+std::optional<domain::ActionUnit> CachedActionUnitRepository::FindActionUnitById(const std::string& id) const {
+  return cache_.Find(id, [this](const std::string& key) { return inner_.FindActionUnitById(key); });
+}
+
+void CachedActionUnitRepository::ApplyChanges(const std::span<const EntityChange> changes) {
+  cache_.Invalidate(changes, ChangeTable::ActionUnits);
+}
+
+std::vector<domain::ActionUnit> CachedActionUnitRepository::ListActionUnitsByTrack(
+    const domain::TrackType track_type) const {
+  return inner_.ListActionUnitsByTrack(track_type);
+}
+
+CachedLearningRepository::CachedLearningRepository(ILearningRepository& inner, const size_t capacity)
+    : inner_(inner), cache_(capacity) {}
+
+void CachedLearningRepository::UpsertLearningGoal(const domain::LearningGoal& goal) {
+  inner_.UpsertLearningGoal(goal);
+  cache_.Invalidate(goal.id);
+}
+
+void CachedLearningRepository::UpsertLearningGoals(const std::span<const domain::LearningGoal> goals) {
+  inner_.UpsertLearningGoals(goals);
+  for (const auto& goal : goals) {
+    cache_.Invalidate(goal.id);
+  }
+}
+
+std::optional<domain::LearningGoal> CachedLearningRepository::FindLearningGoalById(const std::string& id) const {
+  return cache_.Find(id, [this](const std::string& key) { return inner_.FindLearningGoalById(key); });
+}
+
+void CachedLearningRepository::ApplyChanges(const std::span<const EntityChange> changes) {
+  cache_.Invalidate(changes, ChangeTable::LearningGoals);
+}
+
+std::vector<domain::LearningGoal> CachedLearningRepository::ListLearningGoals() const {
+  return inner_.ListLearningGoals();
+}
+
+void CachedLearningRepository::UpsertLearningSession(const domain::LearningSession& session) {
+  inner_.UpsertLearningSession(session);
+}
+
+void CachedLearningRepository::UpsertLearningSessions(const std::span<const domain::LearningSession> sessions) {
+  inner_.UpsertLearningSessions(sessions);
+}
+
+std::vector<domain::LearningSession> CachedLearningRepository::ListLearningSessionsByGoal(
+    const std::string& goal_id) const {
+  return inner_.ListLearningSessionsByGoal(goal_id);
+}
+
+std::vector<domain::LearningSession> CachedLearningRepository::ListLearningSessions() const {
+  return inner_.ListLearningSessions();
+}
+
+void CachedLearningRepository::VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const {
+  inner_.VisitLearningSessions(visitor);
+}
+
+CachedMilestoneCheckpointRepository::CachedMilestoneCheckpointRepository(
+    IMilestoneCheckpointRepository& inner,
+    const size_t capacity)
+    : inner_(inner), cache_(capacity) {}
+
+void CachedMilestoneCheckpointRepository::UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) {
+  inner_.UpsertMilestoneCheckpoint(checkpoint);
+  cache_.Invalidate(checkpoint.id);
+}
+
+void CachedMilestoneCheckpointRepository::UpsertMilestoneCheckpoints(
+    const std::span<const domain::MilestoneCheckpoint> checkpoints) {
+  inner_.UpsertMilestoneCheckpoints(checkpoints);
+  for (const auto& checkpoint : checkpoints) {
+    cache_.Invalidate(checkpoint.id);
+  }
+}
+
+std::optional<domain::MilestoneCheckpoint> CachedMilestoneCheckpointRepository::FindMilestoneCheckpointById(
+    const std::string& id) const {
+  return cache_.Find(id, [this](const std::string& key) { return inner_.FindMilestoneCheckpointById(key); });
+}
+
+void CachedMilestoneCheckpointRepository::ApplyChanges(const std::span<const EntityChange> changes) {
+  cache_.Invalidate(changes, ChangeTable::MilestoneCheckpoints);
+}
+
+std::vector<domain::MilestoneCheckpoint> CachedMilestoneCheckpointRepository::ListMilestoneCheckpointsByGoal(
+    const std::string& goal_id) const {
+  return inner_.ListMilestoneCheckpointsByGoal(goal_id);
+}
+
+std::vector<domain::MilestoneCheckpoint> CachedMilestoneCheckpointRepository::ListMilestoneCheckpoints() const {
+  return inner_.ListMilestoneCheckpoints();
+}
+
+void CachedMilestoneCheckpointRepository::VisitMilestoneCheckpoints(
+    const RowVisitor<domain::MilestoneCheckpoint>& visitor) const {
+  inner_.VisitMilestoneCheckpoints(visitor);
+}
+
+}  // namespace habitrpg::data
@@ -0,0 +1,84 @@
+#include "habitrpg/data/change_feed.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace habitrpg::data {
+
+ChangeFeed::SubscriptionId ChangeFeed::Subscribe(ChangeSubscriber subscriber) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const SubscriptionId id = next_id_++;
+  subscribers_.push_back(std::make_shared<Subscription>(Subscription{id, std::move(subscriber)}));
+  return id;
+}
+
+void ChangeFeed::Unsubscribe(const SubscriptionId id) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::erase_if(subscribers_, [id](const auto& subscription) {
+    if (subscription->id != id) {
+      return false;
+    }
+    subscription->active = false;
+    return true;
+  });
+
+  // Called from a callback: the batch in flight skips the subscription from now on, and
+  // waiting for it to finish would wait for ourselves.
+  const auto self = std::this_thread::get_id();
+  if (std::find(publishing_threads_.begin(), publishing_threads_.end(), self) != publishing_threads_.end()) {
+    return;
+  }
+  idle_.wait(lock, [this] { return publishing_threads_.empty(); });
+}
+
+bool ChangeFeed::HasSubscribers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !subscribers_.empty();
+}
+
+void ChangeFeed::Publish(const std::span<const EntityChange> changes) const {
+  if (changes.empty()) {
+    return;
+  }
+
+  std::vector<std::shared_ptr<Subscription>> subscribers;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_.empty()) {
+      return;
+    }
+    subscribers = subscribers_;
+    publishing_threads_.push_back(std::this_thread::get_id());
+  }
+
+  const auto finish = [this] {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      const auto self = std::find(publishing_threads_.begin(), publishing_threads_.end(), std::this_thread::get_id());
+      publishing_threads_.erase(self);
+    }
+    idle_.notify_all();
+  };
+
+  try {
+    for (const auto& subscription : subscribers) {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!subscription->active) {
+          continue;
+        }
+      }
+      try {
+        subscription->callback(changes);
+      } catch (const std::exception&) {
+        // The rows are already committed; a failing subscriber must not look like a failed write.
+      }
+    }
+  } catch (...) {
+    finish();
+    throw;
+  }
+  finish();
+}
+
+}  // namespace habitrpg::data
@@ -0,0 +1,1143 @@
+#include "habitrpg/data/in_memory_repository.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
+#include <utility>
+
+#include "habitrpg/data/search_text.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
+#include "habitrpg/data/storage_codec.hpp"
+
+namespace habitrpg::data {
+namespace {
+
+// Sort key for a stored timestamp column: NULL (empty) sorts first, then epoch ms,
+// matching SQLite's ORDER BY on the v7 INTEGER columns.
+struct TimestampKey {
+  bool present{false};
+  int64_t epoch_ms{0};
+
+  auto operator<=>(const TimestampKey&) const = default;
+};
+
+TimestampKey KeyOf(const std::string& timestamp) {
+  if (timestamp.empty()) {
+    return {};
+  }
+
+  return TimestampKey{true, TimestampToStorage(timestamp)};
+}
+
+// Walks an ascending (created_at, id) order index backwards from just below the page
+// cursor and created_until, mirroring the ORDER BY created_at DESC, id DESC index scan.
+// Returns at most `limit` slots, newest first, stopping below created_from.
+template <typename KeyAt>
+std::vector<uint32_t> NewestSlotsBelow(
+    const std::vector<uint32_t>& order,
+    const KeyAt& key_at,
+    const std::optional<std::pair<int64_t, std::string>>& before,
+    const std::optional<int64_t>& created_from,
+    const std::optional<int64_t>& created_until,
+    const size_t limit) {
+  auto end = order.end();
+  if (before.has_value()) {
+    end = std::lower_bound(order.begin(), order.end(), *before, [&](const uint32_t slot, const auto& cursor) {
+      return key_at(slot) < std::tie(cursor.first, cursor.second);
+    });
+  }
+  if (created_until.has_value()) {
+    end = std::lower_bound(order.begin(), end, *created_until, [&](const uint32_t slot, const int64_t bound) {
+      return std::get<0>(key_at(slot)) < bound;
+    });
+  }
+
+  std::vector<uint32_t> slots;
+  for (auto it = end; it != order.begin() && slots.size() < limit;) {
+    --it;
+    if (created_from.has_value() && std::get<0>(key_at(*it)) < *created_from) {
+      break;
+    }
+    slots.push_back(*it);
+  }
+  return slots;
+}
+
+// Rewrites a timestamp into the form SqliteRepository would read back.
+void Canonicalize(std::string* timestamp) {
+  if (!timestamp->empty()) {
+    *timestamp = domain::FormatTimestampUtcMs(TimestampToStorage(*timestamp));
+  }
+}
+
+void Normalize(domain::Habit* habit) {
+  Canonicalize(&habit->created_at);
+}
+
+void Normalize(domain::Quest* quest) {
+  Canonicalize(&quest->created_at);
+}
+
+void Normalize(domain::ActionUnit* action_unit) {
+  action_unit->status = StatusFromLifecycle(action_unit->lifecycle_state);
+  action_unit->priority_score = std::max(action_unit->priority_score, 0);
+  Canonicalize(&action_unit->started_at);
+  Canonicalize(&action_unit->completed_at);
+}
+
+void Normalize(domain::LearningGoal* goal) {
+  Canonicalize(&goal->created_at);
+}
+
+void Normalize(domain::LearningSession* session) {
+  session->priority_score = std::max(session->priority_score, 0);
+  session->duration_minutes = std::max(session->duration_minutes, 0);
+  Canonicalize(&session->started_at);
+  Canonicalize(&session->completed_at);
+}
+
+void Normalize(domain::MilestoneCheckpoint* checkpoint) {
+  checkpoint->confidence_level = std::clamp(checkpoint->confidence_level, 1, 5);
+  Canonicalize(&checkpoint->submitted_at);
+  Canonicalize(&checkpoint->reviewed_at);
+  Canonicalize(&checkpoint->confirmed_at);
+  Canonicalize(&checkpoint->rejected_at);
+  Canonicalize(&checkpoint->created_at);
+  Canonicalize(&checkpoint->updated_at);
+}
+
+void Normalize(domain::RewardEvent* reward_event) {
+  Canonicalize(&reward_event->created_at);
+}
+
+// Runs Normalize on copies so a batch with an unparseable timestamp throws before any
+// row is applied.
+template <typename Entity>
+void ValidateBatch(const std::span<const Entity> rows) {
+  for (const auto& row : rows) {
+    auto copy = row;
+    Normalize(&copy);
+  }
+}
+
+// Columns the SQLite upserts leave untouched on conflict.
+template <typename Entity>
+void KeepImmutableColumns(const Entity& /*existing*/, Entity* /*incoming*/) {}
+
+void KeepImmutableColumns(const domain::Habit& existing, domain::Habit* incoming) {
+  incoming->created_at = existing.created_at;
+}
+
+void KeepImmutableColumns(const domain::Quest& existing, domain::Quest* incoming) {
+  incoming->created_at = existing.created_at;
+}
+
+void KeepImmutableColumns(const domain::LearningGoal& existing, domain::LearningGoal* incoming) {
+  incoming->created_at = existing.created_at;
+}
+
+// Returns `rows` stably sorted by `key`, i.e. ties keep insertion (row_key) order.
+template <typename Entity, typename Key>
+std::vector<const Entity*> SortedBy(const std::vector<Entity>& rows, Key key) {
+  std::vector<const Entity*> sorted;
+  sorted.reserve(rows.size());
+  for (const auto& row : rows) {
+    sorted.push_back(&row);
+  }
+  std::stable_sort(sorted.begin(), sorted.end(), [&key](const Entity* lhs, const Entity* rhs) {
+    return key(*lhs) < key(*rhs);
+  });
+  return sorted;
+}
+
+template <typename Entity>
+std::vector<Entity> CopyRows(const std::vector<const Entity*>& rows) {
+  std::vector<Entity> copies;
+  copies.reserve(rows.size());
+  for (const auto* row : rows) {
+    copies.push_back(*row);
+  }
+  return copies;
+}
+
+// ORDER BY COALESCE(completed_at, started_at, id): SQLite sorts integers before text.
+std::tuple<bool, int64_t, std::string_view> SessionOrderKey(const domain::LearningSession& session) {
+  const auto& timestamp = !session.completed_at.empty() ? session.completed_at : session.started_at;
+  if (!timestamp.empty()) {
+    return {false, TimestampToStorage(timestamp), std::string_view{}};
+  }
+
+  return {true, 0, session.id.str()};
+}
+
+size_t TrackSlot(const domain::TrackType track_type) {
+  return static_cast<size_t>(TrackTypeToStorage(track_type));
+}
+
+bool InDayRange(const int64_t day, const std::pair<int64_t, int64_t>& range) {
+  return day >= range.first && day < range.second;
+}
+
+std::pair<int64_t, int64_t> EpochDayRange(const std::string& from_day, const std::string& until_day) {
+  return {
+      from_day.empty() ? std::numeric_limits<int64_t>::min() : EpochDayFromString(from_day),
+      until_day.empty() ? std::numeric_limits<int64_t>::max() : EpochDayFromString(until_day)};
+}
+
+struct SearchColumnMatch {
+  int hits{0};
+  std::string marked;
+};
+
+// Wraps every word of `text` that starts with a query word in [ ], counts them, and marks
+// the query words that matched in `covered`.
+SearchColumnMatch MatchSearchColumn(
+    const std::string_view text,
+    const std::vector<std::string>& query_words,
+    std::vector<bool>* covered) {
+  SearchColumnMatch match{};
+  match.marked.reserve(text.size());
+  size_t i = 0;
+  while (i < text.size()) {
+    if (!IsSearchWordByte(text[i])) {
+      match.marked.push_back(text[i++]);
+      continue;
+    }
+
+    size_t end = i;
+    while (end < text.size() && IsSearchWordByte(text[end])) {
+      ++end;
+    }
+    const auto raw = text.substr(i, end - i);
+    const auto words = SplitSearchWords(raw);
+    bool matched = false;
+    for (size_t q = 0; q < query_words.size(); ++q) {
+      if (words.front().starts_with(query_words[q])) {
+        (*covered)[q] = true;
+        matched = true;
+      }
+    }
+    if (matched) {
+      ++match.hits;
+      match.marked.append("[").append(raw).append("]");
+    } else {
+      match.marked.append(raw);
+    }
+    i = end;
+  }
+  return match;
+}
+
+}  // namespace
+
+template <typename Entity>
+void InMemoryRepository::UpsertRow(Table<Entity>* table, Entity row) {
+  Normalize(&row);
+  const auto it = table->slot_by_id.find(row.id);
+  if (it != table->slot_by_id.end()) {
+    auto& existing = table->rows[it->second];
+    KeepImmutableColumns(existing, &row);
+    existing = std::move(row);
+    return;
+  }
+
+  table->slot_by_id.emplace(row.id, table->rows.size());
+  table->rows.push_back(std::move(row));
+}
+
+template <typename Entity, typename Predicate>
+size_t InMemoryRepository::MoveRowsIf(Table<Entity>* from, Table<Entity>* to, Predicate predicate) {
+  size_t kept = 0;
+  for (size_t slot = 0; slot < from->rows.size(); ++slot) {
+    auto& row = from->rows[slot];
+    if (predicate(row)) {
+      to->slot_by_id.emplace(row.id, to->rows.size());
+      to->rows.push_back(std::move(row));
+    } else {
+      if (kept != slot) {
+        from->rows[kept] = std::move(row);
+      }
+      ++kept;
+    }
+  }
+
+  const size_t moved = from->rows.size() - kept;
+  if (moved > 0) {
+    from->rows.resize(kept);
+    from->slot_by_id.clear();
+    for (size_t slot = 0; slot < from->rows.size(); ++slot) {
+      from->slot_by_id.emplace(from->rows[slot].id, slot);
+    }
+  }
+  return moved;
+}
+
+template <typename Entity>
+std::optional<Entity> InMemoryRepository::FindRow(const Table<Entity>& table, const std::string& id) {
+  const auto key = domain::IdInterner::Instance().Find(id);
+  if (!key.has_value()) {
+    return std::nullopt;
+  }
+
+  const auto it = table.slot_by_id.find(domain::EntityId::FromKey(*key));
+  if (it == table.slot_by_id.end()) {
+    return std::nullopt;
+  }
+
+  return table.rows[it->second];
+}
+
+void InMemoryRepository::LoadSnapshot(const std::string& sqlite_path) {
+  SqliteRepository source(sqlite_path);
+
+  std::unique_lock lock(mutex_);
+  ClearLocked();
+
+  for (auto& habit : source.ListHabits()) {
+    UpsertRow(&habits_, std::move(habit));
+  }
+  for (auto& quest : source.ListQuests()) {
+    UpsertRow(&quests_, std::move(quest));
+  }
+  source.VisitArchivedActionUnits([this](const domain::ActionUnit& action_unit) {
+    UpsertRow(&archived_action_units_, action_unit);
+    return true;
+  });
+  source.VisitArchivedLearningSessions([this](const domain::LearningSession& session) {
+    UpsertRow(&archived_learning_sessions_, session);
+    AddLearningRollup(archived_learning_sessions_.rows.back(), 1);
+    return true;
+  });
+  source.VisitArchivedRewardEvents([this](uint64_t /*sequence*/, const domain::RewardEvent& reward_event) {
+    ArchivedRewardEvent archived{archived_reward_events_.size() + 1, reward_event};
+    Normalize(&archived.event);
+    archived.created_at_ms = TimestampToStorage(archived.event.created_at);
+    AddRewardRollup(archived.event, archived.created_at_ms);
+    AppendArchivedRewardEventLocked(std::move(archived));
+    return true;
+  });
+  reward_sequence_base_ = archived_reward_events_.size();
+  for (const auto track_type : {domain::TrackType::Life, domain::TrackType::Learning}) {
+    for (auto& action_unit : source.ListActionUnitsByTrack(track_type)) {
+      UpsertRow(&action_units_, std::move(action_unit));
+    }
+  }
+  for (auto& goal : source.ListLearningGoals()) {
+    UpsertRow(&learning_goals_, std::move(goal));
+  }
+  source.VisitLearningSessions([this](const domain::LearningSession& session) {
+    UpsertLearningSessionLocked(session);
+    return true;
+  });
+  source.VisitMilestoneCheckpoints([this](const domain::MilestoneCheckpoint& checkpoint) {
+    UpsertRow(&milestone_checkpoints_, checkpoint);
+    return true;
+  });
+  // Also visits the archived events again; AppendRewardEventLocked skips those ids.
+  source.VisitRewardLedgerAfter(0, [this](uint64_t /*sequence*/, const domain::RewardEvent& reward_event) {
+    AppendRewardEventLocked(reward_event);
+    return true;
+  });
+
+  user_state_ = source.LoadUserState();
+  ui_preferences_ = source.LoadUiPreferences();
+}
+
+void InMemoryRepository::SaveSnapshot(const std::string& sqlite_path) const {
+  SqliteRepository target(sqlite_path);
+
+  std::shared_lock lock(mutex_);
+  UnitOfWork unit_of_work(target);
+  target.UpsertHabits(habits_.rows);
+  target.UpsertQuests(quests_.rows);
+  target.UpsertActionUnits(archived_action_units_.rows);
+  target.UpsertActionUnits(action_units_.rows);
+  target.UpsertLearningGoals(learning_goals_.rows);
+  target.UpsertLearningSessions(archived_learning_sessions_.rows);
+  target.UpsertLearningSessions(learning_sessions_.rows);
+  target.UpsertMilestoneCheckpoints(milestone_checkpoints_.rows);
+  for (const auto& archived : archived_reward_events_) {
+    target.AppendRewardEvent(archived.event);
+  }
+  for (const auto& stored : reward_events_) {
+    target.AppendRewardEvent(stored.event);
+  }
+  if (user_state_.has_value()) {
+    target.SaveUserState(*user_state_);
+  }
+  if (ui_preferences_.has_value()) {
+    target.SaveUiPreferences(*ui_preferences_);
+  }
+  unit_of_work.Commit();
+}
+
+void InMemoryRepository::Clear() {
+  std::unique_lock lock(mutex_);
+  ClearLocked();
+}
+
+void InMemoryRepository::UpsertHabit(const domain::Habit& habit) {
+  std::unique_lock lock(mutex_);
+  UpsertRow(&habits_, habit);
+}
+
+void InMemoryRepository::UpsertHabits(const std::span<const domain::Habit> habits) {
+  ValidateBatch(habits);
+  std::unique_lock lock(mutex_);
+  for (const auto& habit : habits) {
+    UpsertRow(&habits_, habit);
+  }
+}
+
+std::optional<domain::Habit> InMemoryRepository::FindHabitById(const std::string& id) const {
+  std::shared_lock lock(mutex_);
+  return FindRow(habits_, id);
+}
+
+std::vector<domain::Habit> InMemoryRepository::ListHabits() const {
+  std::shared_lock lock(mutex_);
+  return CopyRows(SortedBy(habits_.rows, [](const domain::Habit& habit) { return KeyOf(habit.created_at); }));
+}
+
+void InMemoryRepository::UpsertQuest(const domain::Quest& quest) {
+  std::unique_lock lock(mutex_);
+  UpsertRow(&quests_, quest);
+}
+
+void InMemoryRepository::UpsertQuests(const std::span<const domain::Quest> quests) {
+  ValidateBatch(quests);
+  std::unique_lock lock(mutex_);
+  for (const auto& quest : quests) {
+    UpsertRow(&quests_, quest);
+  }
+}
+
+std::vector<domain::Quest> InMemoryRepository::ListQuests() const {
+  std::shared_lock lock(mutex_);
+  return CopyRows(SortedBy(quests_.rows, [](const domain::Quest& quest) { return KeyOf(quest.created_at); }));
+}
+
+void InMemoryRepository::UpsertActionUnit(const domain::ActionUnit& action_unit) {
+  std::unique_lock lock(mutex_);
+  if (archived_action_units_.slot_by_id.contains(action_unit.id)) {
+    return;
+  }
+  UpsertRow(&action_units_, action_unit);
+}
+
+void InMemoryRepository::UpsertActionUnits(const std::span<const domain::ActionUnit> action_units) {
+  ValidateBatch(action_units);
+  std::unique_lock lock(mutex_);
+  for (const auto& action_unit : action_units) {
+    if (!archived_action_units_.slot_by_id.contains(action_unit.id)) {
+      UpsertRow(&action_units_, action_unit);
+    }
+  }
+}
+
+std::optional<domain::ActionUnit> InMemoryRepository::FindActionUnitById(const std::string& id) const {
+  std::shared_lock lock(mutex_);
+  return FindRow(action_units_, id);
+}
+
+std::vector<domain::ActionUnit> InMemoryRepository::ListActionUnitsByTrack(const domain::TrackType track_type) const {
+  std::shared_lock lock(mutex_);
+  std::vector<domain::ActionUnit> action_units;
+  for (const auto& action_unit : action_units_.rows) {
+    if (action_unit.track_type == track_type) {
+      action_units.push_back(action_unit);
+    }
+  }
+  std::sort(action_units.begin(), action_units.end(), [](const domain::ActionUnit& lhs, const domain::ActionUnit& rhs) {
+    return lhs.id < rhs.id;
+  });
+  return action_units;
+}
+
+void InMemoryRepository::UpsertLearningGoal(const domain::LearningGoal& goal) {
+  std::unique_lock lock(mutex_);
+  UpsertRow(&learning_goals_, goal);
+}
+
+void InMemoryRepository::UpsertLearningGoals(const std::span<const domain::LearningGoal> goals) {
+  ValidateBatch(goals);
+  std::unique_lock lock(mutex_);
+  for (const auto& goal : goals) {
+    UpsertRow(&learning_goals_, goal);
+  }
+}
+
+std::optional<domain::LearningGoal> InMemoryRepository::FindLearningGoalById(const std::string& id) const {
+  std::shared_lock lock(mutex_);
+  return FindRow(learning_goals_, id);
+}
+
+std::vector<domain::LearningGoal> InMemoryRepository::ListLearningGoals() const {
+  std::shared_lock lock(mutex_);
+  return CopyRows(
+      SortedBy(learning_goals_.rows, [](const domain::LearningGoal& goal) { return KeyOf(goal.created_at); }));
+}
+
+void InMemoryRepository::UpsertLearningSession(const domain::LearningSession& session) {
+  std::unique_lock lock(mutex_);
+  UpsertLearningSessionLocked(session);
+}
+
+void InMemoryRepository::UpsertLearningSessions(const std::span<const domain::LearningSession> sessions) {
+  ValidateBatch(sessions);
+  std::unique_lock lock(mutex_);
+  for (const auto& session : sessions) {
+    UpsertLearningSessionLocked(session);
+  }
+}
+
+std::vector<domain::LearningSession> InMemoryRepository::ListLearningSessionsByGoal(const std::string& goal_id) const {
+  std::shared_lock lock(mutex_);
+  std::vector<domain::LearningSession> sessions;
+  for (const auto& session : learning_sessions_.rows) {
+    if (session.goal_id.str() == goal_id) {
+      sessions.push_back(session);
+    }
+  }
+  std::stable_sort(
+      sessions.begin(),
+      sessions.end(),
+      [](const domain::LearningSession& lhs, const domain::LearningSession& rhs) {
+        return SessionOrderKey(lhs) < SessionOrderKey(rhs);
+      });
+  return sessions;
+}
+
+std::vector<domain::LearningSession> InMemoryRepository::ListLearningSessions() const {
+  std::vector<domain::LearningSession> sessions;
+  VisitLearningSessions([&sessions](const domain::LearningSession& session) {
+    sessions.push_back(session);
+    return true;
+  });
+  return sessions;
+}
+
+void InMemoryRepository::VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto* session : SortedBy(
+           learning_sessions_.rows,
+           [](const domain::LearningSession& row) -> const std::string& { return row.id.str(); })) {
+    if (!visitor(*session)) {
+      break;
+    }
+  }
+}
+
+void InMemoryRepository::UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) {
+  std::unique_lock lock(mutex_);
+  UpsertRow(&milestone_checkpoints_, checkpoint);
+}
+
+void InMemoryRepository::UpsertMilestoneCheckpoints(
+    const std::span<const domain::MilestoneCheckpoint> checkpoints) {
+  ValidateBatch(checkpoints);
+  std::unique_lock lock(mutex_);
+  for (const auto& checkpoint : checkpoints) {
+    UpsertRow(&milestone_checkpoints_, checkpoint);
+  }
+}
+
+std::optional<domain::MilestoneCheckpoint> InMemoryRepository::FindMilestoneCheckpointById(
+    const std::string& id) const {
+  std::shared_lock lock(mutex_);
+  return FindRow(milestone_checkpoints_, id);
+}
+
+std::vector<domain::MilestoneCheckpoint> InMemoryRepository::ListMilestoneCheckpointsByGoal(
+    const std::string& goal_id) const {
+  std::shared_lock lock(mutex_);
+  std::vector<domain::MilestoneCheckpoint> checkpoints;
+  for (const auto* checkpoint : SortedBy(
+           milestone_checkpoints_.rows,
+           [](const domain::MilestoneCheckpoint& row) { return KeyOf(row.submitted_at); })) {
+    if (checkpoint->goal_id.str() == goal_id) {
+      checkpoints.push_back(*checkpoint);
+    }
+  }
+  return checkpoints;
+}
+
+std::vector<domain::MilestoneCheckpoint> InMemoryRepository::ListMilestoneCheckpoints() const {
+  std::vector<domain::MilestoneCheckpoint> checkpoints;
+  VisitMilestoneCheckpoints([&checkpoints](const domain::MilestoneCheckpoint& checkpoint) {
+    checkpoints.push_back(checkpoint);
+    return true;
+  });
+  return checkpoints;
+}
+
+void InMemoryRepository::VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto* checkpoint : SortedBy(
+           milestone_checkpoints_.rows,
+           [](const domain::MilestoneCheckpoint& row) { return KeyOf(row.submitted_at); })) {
+    if (!visitor(*checkpoint)) {
+      break;
+    }
+  }
+}
+
+void InMemoryRepository::AppendRewardEvent(const domain::RewardEvent& reward_event) {
+  std::unique_lock lock(mutex_);
+  AppendRewardEventLocked(reward_event);
+}
+
+void InMemoryRepository::AppendRewardEvents(const std::span<const domain::RewardEvent> reward_events) {
+  std::unique_lock lock(mutex_);
+  // Appends parse created_at (empty is rejected too); ids already stored are skipped.
+  for (const auto& reward_event : reward_events) {
+    if (!reward_slot_by_id_.contains(reward_event.id) && !archived_reward_ids_.contains(reward_event.id)) {
+      TimestampToStorage(reward_event.created_at);
+    }
+  }
+  for (const auto& reward_event : reward_events) {
+    AppendRewardEventLocked(reward_event);
+  }
+}
+
+std::vector<domain::RewardEvent> InMemoryRepository::ListRewardEventsByTrack(const domain::TrackType track_type) const {
+  std::vector<domain::RewardEvent> events;
+  VisitRewardEventsByTrack(track_type, [&events](const domain::RewardEvent& event) {
+    events.push_back(event);
+    return true;
+  });
+  return events;
+}
+
+void InMemoryRepository::VisitRewardEventsByTrack(
+    const domain::TrackType track_type,
+    const RowVisitor<domain::RewardEvent>& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto slot : reward_order_by_track_[TrackSlot(track_type)]) {
+    if (!visitor(reward_events_[slot].event)) {
+      break;
+    }
+  }
+}
+
+RewardEventPage InMemoryRepository::ListRewardEventsPage(const RewardEventPageQuery& query) const {
+  if (query.page_size == 0) {
+    throw std::invalid_argument("ListRewardEventsPage requires a non-zero page_size");
+  }
+
+  std::optional<std::pair<int64_t, std::string>> before;
+  if (query.before.has_value()) {
+    before.emplace(TimestampToStorage(query.before->created_at), query.before->id);
+  }
+  const std::optional<int64_t> created_from =
+      query.created_from.empty() ? std::nullopt : std::optional<int64_t>(TimestampToStorage(query.created_from));
+  const std::optional<int64_t> created_until =
+      query.created_until.empty() ? std::nullopt : std::optional<int64_t>(TimestampToStorage(query.created_until));
+
+  std::shared_lock lock(mutex_);
+  const auto live_key = [this](const uint32_t slot) {
+    const auto& stored = reward_events_[slot];
+    return std::tie(stored.created_at_ms, stored.event.id);
+  };
+  const auto archived_key = [this](const uint32_t slot) {
+    const auto& archived = archived_reward_events_[slot];
+    return std::tie(archived.created_at_ms, archived.event.id);
+  };
+  const size_t limit = query.page_size + 1;
+  const auto live = NewestSlotsBelow(
+      query.track_type.has_value() ? reward_order_by_track_[TrackSlot(*query.track_type)] : reward_order_,
+      live_key, before, created_from, created_until, limit);
+  const auto archived = NewestSlotsBelow(
+      query.track_type.has_value() ? archived_reward_order_by_track_[TrackSlot(*query.track_type)]
+                                   : archived_reward_order_,
+      archived_key, before, created_from, created_until, limit);
+
+  // Merge the two newest-first runs, like the UNION ALL merge over both tables' indexes.
+  RewardEventPage page{};
+  page.events.reserve(std::min(query.page_size, live.size() + archived.size()));
+  auto live_it = live.begin();
+  auto archived_it = archived.begin();
+  while (live_it != live.end() || archived_it != archived.end()) {
+    if (page.events.size() == query.page_size) {
+      const auto& oldest = page.events.back();
+      page.next = RewardEventCursor{oldest.created_at, oldest.id};
+      break;
+    }
+    const bool take_live = archived_it == archived.end() ||
+                           (live_it != live.end() && archived_key(*archived_it) < live_key(*live_it));
+    if (take_live) {
+      page.events.push_back(reward_events_[*live_it++].event);
+    } else {
+      page.events.push_back(archived_reward_events_[*archived_it++].event);
+    }
+  }
+
+  return page;
+}
+
+bool InMemoryRepository::HasRewardEvent(const std::string& reward_event_id) const {
+  std::shared_lock lock(mutex_);
+  return reward_slot_by_id_.contains(reward_event_id) || archived_reward_ids_.contains(reward_event_id);
+}
+
+uint64_t InMemoryRepository::LatestRewardSequence() const {
+  std::shared_lock lock(mutex_);
+  return reward_sequence_base_ + reward_events_.size();
+}
+
+// The ledger sequence of a reward event is reward_sequence_base_ + slot + 1; archived
+// events hold the sequences up to the base.
+void InMemoryRepository::VisitRewardLedgerAfter(
+    const uint64_t after_sequence,
+    const RewardLedgerVisitor& visitor) const {
+  std::shared_lock lock(mutex_);
+  const auto first_archived = std::upper_bound(
+      archived_reward_events_.begin(),
+      archived_reward_events_.end(),
+      after_sequence,
+      [](const uint64_t sequence, const ArchivedRewardEvent& archived) { return sequence < archived.sequence; });
+  for (auto it = first_archived; it != archived_reward_events_.end(); ++it) {
+    if (!visitor(it->sequence, it->event)) {
+      return;
+    }
+  }
+
+  const uint64_t latest = reward_sequence_base_ + reward_events_.size();
+  for (uint64_t sequence = std::max(after_sequence, reward_sequence_base_) + 1; sequence <= latest; ++sequence) {
+    if (!visitor(sequence, reward_events_[sequence - reward_sequence_base_ - 1].event)) {
+      break;
+    }
+  }
+}
+
+domain::UserState InMemoryRepository::LoadUserState() const {
+  std::shared_lock lock(mutex_);
+  return user_state_.value_or(domain::UserState{});
+}
+
+void InMemoryRepository::SaveUserState(const domain::UserState& user_state) {
+  std::unique_lock lock(mutex_);
+  user_state_ = user_state;
+}
+
+void InMemoryRepository::SaveUserStateSnapshot(const UserStateSnapshot& snapshot) {
+  auto stored = snapshot;
+  Canonicalize(&stored.created_at);
+
+  std::unique_lock lock(mutex_);
+  const auto it = std::lower_bound(
+      user_state_snapshots_.begin(),
+      user_state_snapshots_.end(),
+      stored.through_sequence,
+      [](const UserStateSnapshot& existing, const uint64_t sequence) { return existing.through_sequence < sequence; });
+  if (it != user_state_snapshots_.end() && it->through_sequence == stored.through_sequence) {
+    *it = std::move(stored);
+  } else {
+    user_state_snapshots_.insert(it, std::move(stored));
+  }
+}
+
+std::optional<UserStateSnapshot> InMemoryRepository::LoadLatestUserStateSnapshot() const {
+  std::shared_lock lock(mutex_);
+  if (user_state_snapshots_.empty()) {
+    return std::nullopt;
+  }
+
+  return user_state_snapshots_.back();
+}
+
+std::vector<DailyXpPoint> InMemoryRepository::ListDailyXp(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const auto range = EpochDayRange(from_day, until_day);
+  std::shared_lock lock(mutex_);
+  std::vector<DailyXpPoint> points;
+  for (auto it = reward_daily_rollups_.lower_bound(range.first);
+       it != reward_daily_rollups_.end() && InDayRange(it->first, range);
+       ++it) {
+    points.push_back(DailyXpPoint{
+        EpochDayToString(it->first),
+        it->second.xp_total[TrackSlot(domain::TrackType::Life)],
+        it->second.xp_total[TrackSlot(domain::TrackType::Learning)],
+        it->second.event_count});
+  }
+  return points;
+}
+
+std::vector<LearningMinutesPoint> InMemoryRepository::ListDailyLearningMinutes(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const auto range = EpochDayRange(from_day, until_day);
+  std::shared_lock lock(mutex_);
+  std::vector<LearningMinutesPoint> points;
+  for (auto it = learning_daily_rollups_.lower_bound(range.first);
+       it != learning_daily_rollups_.end() && InDayRange(it->first, range);
+       ++it) {
+    if (it->second.completed_sessions > 0) {
+      points.push_back(
+          LearningMinutesPoint{EpochDayToString(it->first), it->second.minutes, it->second.completed_sessions});
+    }
+  }
+  return points;
+}
+
+std::vector<LearningMinutesPoint> InMemoryRepository::ListWeeklyLearningMinutes(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const auto range = EpochDayRange(from_day, until_day);
+  std::shared_lock lock(mutex_);
+  std::vector<LearningMinutesPoint> points;
+  int64_t current_week = 0;
+  for (auto it = learning_daily_rollups_.lower_bound(range.first);
+       it != learning_daily_rollups_.end() && InDayRange(it->first, range);
+       ++it) {
+    if (it->second.completed_sessions <= 0) {
+      continue;
+    }
+    // Same Monday-based week numbering as the SQL: epoch day 4 is a Monday.
+    const int64_t week = (it->first + 3) / 7;
+    if (points.empty() || week != current_week) {
+      current_week = week;
+      points.push_back(LearningMinutesPoint{EpochDayToString(week * 7 - 3), 0, 0});
+    }
+    points.back().minutes += it->second.minutes;
+    points.back().completed_sessions += it->second.completed_sessions;
+  }
+  return points;
+}
+
+TrackXpTotals InMemoryRepository::LoadTrackXpTotals() const {
+  std::shared_lock lock(mutex_);
+  TrackXpTotals totals{};
+  for (const auto& [day, rollup] : reward_daily_rollups_) {
+    totals.life_xp += rollup.xp_total[TrackSlot(domain::TrackType::Life)];
+    totals.learning_xp += rollup.xp_total[TrackSlot(domain::TrackType::Learning)];
+    totals.reward_events += rollup.event_count;
+  }
+  return totals;
+}
+
+ArchiveSummary InMemoryRepository::ArchiveCompletedBefore(const std::string& completed_before) {
+  const int64_t horizon_ms = TimestampToStorage(completed_before);
+  const auto finished_before_horizon = [horizon_ms](const std::string& completed_at) {
+    return !completed_at.empty() && TimestampToStorage(completed_at) < horizon_ms;
+  };
+
+  std::unique_lock lock(mutex_);
+  ArchiveSummary summary{};
+  summary.action_units = MoveRowsIf(
+      &action_units_,
+      &archived_action_units_,
+      [&finished_before_horizon](const domain::ActionUnit& action_unit) {
+        return action_unit.status == domain::ActionStatus::Completed &&
+               finished_before_horizon(action_unit.completed_at);
+      });
+
+  std::unordered_set<domain::EntityId> checkpointed_sessions;
+  for (const auto& checkpoint : milestone_checkpoints_.rows) {
+    checkpointed_sessions.insert(checkpoint.learning_session_id);
+  }
+  // Archived sessions keep their rollup contribution, so no AddLearningRollup here.
+  summary.learning_sessions = MoveRowsIf(
+      &learning_sessions_,
+      &archived_learning_sessions_,
+      [&](const domain::LearningSession& session) {
+        return session.lifecycle_state == domain::LifecycleState::Completed &&
+               finished_before_horizon(session.completed_at) && !checkpointed_sessions.contains(session.id);
+      });
+
+  summary.reward_events = ArchiveLedgerPrefixLocked(horizon_ms);
+  return summary;
+}
+
+ArchiveSummary InMemoryRepository::CountArchivedRows() const {
+  std::shared_lock lock(mutex_);
+  ArchiveSummary summary{};
+  summary.action_units = archived_action_units_.rows.size();
+  summary.learning_sessions = archived_learning_sessions_.rows.size();
+  summary.reward_events = archived_reward_events_.size();
+  return summary;
+}
+
+void InMemoryRepository::VisitArchivedActionUnits(const RowVisitor<domain::ActionUnit>& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto& action_unit : archived_action_units_.rows) {
+    if (!visitor(action_unit)) {
+      break;
+    }
+  }
+}
+
+void InMemoryRepository::VisitArchivedLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto& session : archived_learning_sessions_.rows) {
+    if (!visitor(session)) {
+      break;
+    }
+  }
+}
+
+void InMemoryRepository::VisitArchivedRewardEvents(const RewardLedgerVisitor& visitor) const {
+  std::shared_lock lock(mutex_);
+  for (const auto& archived : archived_reward_events_) {
+    if (!visitor(archived.sequence, archived.event)) {
+      break;
+    }
+  }
+}
+
+uint64_t InMemoryRepository::AppendCommand(const CommandJournalRecord& record) {
+  auto stored = record;
+  stored.recorded_at = domain::FormatTimestampUtcMs(
+      TimestampToStorage(record.recorded_at.empty() ? domain::CurrentTimestampUtc() : record.recorded_at));
+
+  std::unique_lock lock(mutex_);
+  stored.sequence = next_command_sequence_++;
+  command_journal_.push_back(std::move(stored));
+  return command_journal_.back().sequence;
+}
+
+void InMemoryRepository::VisitCommandsAfter(
+    const uint64_t after_sequence,
+    const CommandJournalVisitor& visitor) const {
+  std::shared_lock lock(mutex_);
+  const auto first = std::upper_bound(
+      command_journal_.begin(),
+      command_journal_.end(),
+      after_sequence,
+      [](const uint64_t sequence, const CommandJournalRecord& record) { return sequence < record.sequence; });
+  for (auto it = first; it != command_journal_.end(); ++it) {
+    if (!visitor(*it)) {
+      break;
+    }
+  }
+}
+
+void InMemoryRepository::TruncateCommandsThrough(const uint64_t through_sequence) {
+  std::unique_lock lock(mutex_);
+  std::erase_if(command_journal_, [through_sequence](const CommandJournalRecord& record) {
+    return record.sequence <= through_sequence;
+  });
+}
+
+SearchPage InMemoryRepository::Search(const SearchQuery& query) const {
+  if (query.page_size == 0) {
+    throw std::invalid_argument("Search requires a non-zero page_size");
+  }
+
+  SearchPage page{};
+  const auto words = SplitSearchWords(query.text);
+  if (words.empty()) {
+    return page;
+  }
+
+  std::vector<std::pair<int, SearchHit>> scored;
+  const auto consider = [&](const SearchEntityKind kind, const domain::EntityId& id, const std::string& title,
+                            const std::string& body) {
+    if (query.kind.has_value() && *query.kind != kind) {
+      return;
+    }
+    std::vector<bool> covered(words.size(), false);
+    auto title_match = MatchSearchColumn(title, words, &covered);
+    auto body_match = MatchSearchColumn(body, words, &covered);
+    if (std::find(covered.begin(), covered.end(), false) != covered.end()) {
+      return;
+    }
+    // Title hits weigh twice as much, like the bm25(2.0, 1.0) ranking of the SQLite index.
+    const int score = 2 * title_match.hits + body_match.hits;
+    auto& snippet = body_match.hits > 0 ? body_match.marked : title_match.marked;
+    scored.emplace_back(score, SearchHit{kind, id, title, std::move(snippet)});
+  };
+
+  std::shared_lock lock(mutex_);
+  for (const auto& action_unit : action_units_.rows) {
+    consider(SearchEntityKind::ActionUnit, action_unit.id, action_unit.title, {});
+  }
+  for (const auto& session : learning_sessions_.rows) {
+    consider(SearchEntityKind::LearningSession, session.id, session.title, session.checkpoint_note);
+  }
+  for (const auto& checkpoint : milestone_checkpoints_.rows) {
+    consider(
+        SearchEntityKind::MilestoneCheckpoint,
+        checkpoint.id,
+        checkpoint.milestone_key,
+        checkpoint.evidence_ref + "\n" + checkpoint.candidate_reason);
+  }
+  lock.unlock();
+
+  std::stable_sort(
+      scored.begin(), scored.end(), [](const auto& lhs, const auto& rhs) { return lhs.first > rhs.first; });
+  for (size_t i = query.offset; i < scored.size(); ++i) {
+    if (page.hits.size() == query.page_size) {
+      page.next_offset = i;
+      break;
+    }
+    page.hits.push_back(std::move(scored[i].second));
+  }
+  return page;
+}
+
+UiPreferences InMemoryRepository::LoadUiPreferences() const {
+  std::shared_lock lock(mutex_);
+  return ui_preferences_.value_or(UiPreferences{});
+}
+
+void InMemoryRepository::SaveUiPreferences(const UiPreferences& preferences) {
+  std::unique_lock lock(mutex_);
+  ui_preferences_ = preferences;
+  if (ui_preferences_->last_non_custom_preset == ui::contracts::PresetMode::Custom) {
+    ui_preferences_->last_non_custom_preset = ui::contracts::PresetMode::Calm;
+  }
+}
+
+bool InMemoryRepository::RewardSlotLess(const uint32_t lhs, const uint32_t rhs) const {
+  const auto& left = reward_events_[lhs];
+  const auto& right = reward_events_[rhs];
+  return std::tie(left.created_at_ms, left.event.id) < std::tie(right.created_at_ms, right.event.id);
+}
+
+void InMemoryRepository::AppendRewardEventLocked(const domain::RewardEvent& reward_event) {
+  if (reward_slot_by_id_.contains(reward_event.id) || archived_reward_ids_.contains(reward_event.id)) {
+    return;
+  }
+
+  StoredRewardEvent stored{reward_event, TimestampToStorage(reward_event.created_at)};
+  Normalize(&stored.event);
+
+  const auto slot = static_cast<uint32_t>(reward_events_.size());
+  reward_slot_by_id_.emplace(stored.event.id, slot);
+  reward_events_.push_back(std::move(stored));
+
+  // Events almost always arrive in time order, so upper_bound lands at the end and the
+  // insert is an append.
+  const auto less = [this](const uint32_t lhs, const uint32_t rhs) { return RewardSlotLess(lhs, rhs); };
+  for (auto* order : {&reward_order_, &reward_order_by_track_[TrackSlot(reward_event.track_type)]}) {
+    order->insert(std::upper_bound(order->begin(), order->end(), slot, less), slot);
+  }
+
+  const auto& appended = reward_events_.back();
+  AddRewardRollup(appended.event, appended.created_at_ms);
+}
+
+// Archived events arrive in sequence order, which is not always (created_at, id) order,
+// so they get their own order indexes for history pages.
+void InMemoryRepository::AppendArchivedRewardEventLocked(ArchivedRewardEvent archived) {
+  const auto slot = static_cast<uint32_t>(archived_reward_events_.size());
+  const auto track_slot = TrackSlot(archived.event.track_type);
+  archived_reward_ids_.insert(archived.event.id);
+  archived_reward_events_.push_back(std::move(archived));
+
+  const auto less = [this](const uint32_t lhs, const uint32_t rhs) {
+    const auto& left = archived_reward_events_[lhs];
+    const auto& right = archived_reward_events_[rhs];
+    return std::tie(left.created_at_ms, left.event.id) < std::tie(right.created_at_ms, right.event.id);
+  };
+  for (auto* order : {&archived_reward_order_, &archived_reward_order_by_track_[track_slot]}) {
+    order->insert(std::upper_bound(order->begin(), order->end(), slot, less), slot);
+  }
+}
+
+void InMemoryRepository::AddRewardRollup(const domain::RewardEvent& reward_event, const int64_t created_at_ms) {
+  auto& rollup = reward_daily_rollups_[created_at_ms / kMillisecondsPerDay];
+  rollup.xp_total[TrackSlot(reward_event.track_type)] += reward_event.xp_delta;
+  ++rollup.event_count;
+}
+
+// Same cutoff as SqliteRepository: up to the first event at or after the horizon, no
+// further than the latest UserState snapshot, and never the newest event.
+size_t InMemoryRepository::ArchiveLedgerPrefixLocked(const int64_t horizon_ms) {
+  const uint64_t latest = reward_sequence_base_ + reward_events_.size();
+  uint64_t cutoff = user_state_snapshots_.empty() ? 0 : user_state_snapshots_.back().through_sequence;
+  cutoff = std::min(cutoff, latest > 0 ? latest - 1 : 0);
+  for (size_t slot = 0; slot < reward_events_.size(); ++slot) {
+    if (reward_events_[slot].created_at_ms >= horizon_ms) {
+      cutoff = std::min<uint64_t>(cutoff, reward_sequence_base_ + slot);
+      break;
+    }
+  }
+  if (cutoff <= reward_sequence_base_) {
+    return 0;
+  }
+
+  const auto moved = static_cast<size_t>(cutoff - reward_sequence_base_);
+  for (size_t slot = 0; slot < moved; ++slot) {
+    auto& stored = reward_events_[slot];
+    AppendArchivedRewardEventLocked({reward_sequence_base_ + slot + 1, std::move(stored.event), stored.created_at_ms});
+  }
+  reward_events_.erase(reward_events_.begin(), reward_events_.begin() + static_cast<std::ptrdiff_t>(moved));
+  reward_sequence_base_ = cutoff;
+
+  reward_slot_by_id_.clear();
+  for (size_t slot = 0; slot < reward_events_.size(); ++slot) {
+    reward_slot_by_id_.emplace(reward_events_[slot].event.id, slot);
+  }
+  for (auto* order : {&reward_order_, &reward_order_by_track_[0], &reward_order_by_track_[1]}) {
+    std::erase_if(*order, [moved](const uint32_t slot) { return slot < moved; });
+    for (auto& slot : *order) {
+      slot -= static_cast<uint32_t>(moved);
+    }
+  }
+  return moved;
+}
+
+void InMemoryRepository::UpsertLearningSessionLocked(const domain::LearningSession& session) {
+  if (archived_learning_sessions_.slot_by_id.contains(session.id)) {
+    return;
+  }
+  if (const auto it = learning_sessions_.slot_by_id.find(session.id); it != learning_sessions_.slot_by_id.end()) {
+    AddLearningRollup(learning_sessions_.rows[it->second], -1);
+  }
+  UpsertRow(&learning_sessions_, session);
+  AddLearningRollup(learning_sessions_.rows[learning_sessions_.slot_by_id.at(session.id)], 1);
+}
+
+// Mirrors the learning_sessions rollup triggers: completed sessions count toward their
+// completion day.
+void InMemoryRepository::AddLearningRollup(const domain::LearningSession& session, const int sign) {
+  if (session.lifecycle_state != domain::LifecycleState::Completed || session.completed_at.empty()) {
+    return;
+  }
+
+  auto& rollup = learning_daily_rollups_[TimestampToStorage(session.completed_at) / kMillisecondsPerDay];
+  rollup.minutes += sign * session.duration_minutes;
+  rollup.completed_sessions += sign;
+}
+
+void InMemoryRepository::ClearLocked() {
+  habits_ = {};
+  quests_ = {};
+  action_units_ = {};
+  learning_goals_ = {};
+  learning_sessions_ = {};
+  milestone_checkpoints_ = {};
+  reward_events_.clear();
+  reward_slot_by_id_.clear();
+  reward_order_.clear();
+  for (auto& order : reward_order_by_track_) {
+    order.clear();
+  }
+  reward_daily_rollups_.clear();
+  learning_daily_rollups_.clear();
+  reward_sequence_base_ = 0;
+  archived_action_units_ = {};
+  archived_learning_sessions_ = {};
+  archived_reward_events_.clear();
+  archived_reward_ids_.clear();
+  archived_reward_order_.clear();
+  for (auto& order : archived_reward_order_by_track_) {
+    order.clear();
+  }
+  user_state_snapshots_.clear();
+  command_journal_.clear();
+  next_command_sequence_ = 1;
+  user_state_.reset();
+  ui_preferences_.reset();
+}
+
+}  // namespace habitrpg::data
@@ -1,7 +1,11 @@
 #include "habitrpg/data/migrations.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <optional>
 #include <stdexcept>
 #include <string>
+#include <unordered_set>
 
 namespace habitrpg::data {
 namespace {
@@ -16,7 +20,8 @@ void ExecOrThrow(sqlite3* db, const char* sql) {
   }
 }
 
-bool ColumnExists(sqlite3* db, const char* table_name, const char* column_name) {
+// Column names of `table_name`, read with a single PRAGMA; empty when the table does not exist.
+std::unordered_set<std::string> TableColumns(sqlite3* db, const char* table_name) {
   const std::string sql = "PRAGMA table_info(" + std::string(table_name) + ");";
   sqlite3_stmt* statement = nullptr;
   const int prepare_rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr);
@@ -24,18 +29,187 @@ bool ColumnExists(sqlite3* db, const char* table_name, const char* column_name)
     throw std::runtime_error("Failed to inspect table_info(" + std::string(table_name) + ")");
   }
 
-  bool exists = false;
+  std::unordered_set<std::string> columns;
   while (sqlite3_step(statement) == SQLITE_ROW) {
     const auto* raw_name = sqlite3_column_text(statement, 1);
-    const std::string name = raw_name != nullptr ? reinterpret_cast<const char*>(raw_name) : "";
-    if (name == column_name) {
-      exists = true;
-      break;
-    }
+    columns.emplace(raw_name != nullptr ? reinterpret_cast<const char*>(raw_name) : "");
   }
 
   sqlite3_finalize(statement);
-  return exists;
+  return columns;
+}
+
+int64_t QueryInt64(sqlite3* db, const char* sql) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &statement, nullptr) != SQLITE_OK) {
+    throw std::runtime_error("Failed to prepare migration query: " + std::string(sqlite3_errmsg(db)));
+  }
+
+  int64_t value = 0;
+  const int step_result = sqlite3_step(statement);
+  if (step_result == SQLITE_ROW) {
+    value = sqlite3_column_int64(statement, 0);
+  } else if (step_result != SQLITE_DONE) {
+    const std::string details = sqlite3_errmsg(db);
+    sqlite3_finalize(statement);
+    throw std::runtime_error("Failed running migration query: " + details);
+  }
+
+  sqlite3_finalize(statement);
+  return value;
+}
+
+// Reads schema_meta without creating it. nullopt when the table or its row is missing.
+std::optional<int> QuerySchemaVersion(sqlite3* db) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(db, "SELECT version FROM schema_meta WHERE id = 1;", -1, &statement, nullptr) !=
+      SQLITE_OK) {
+    return std::nullopt;
+  }
+
+  std::optional<int> version;
+  const int step_result = sqlite3_step(statement);
+  if (step_result == SQLITE_ROW) {
+    version = sqlite3_column_int(statement, 0);
+  } else if (step_result != SQLITE_DONE) {
+    sqlite3_finalize(statement);
+    throw std::runtime_error("Failed reading schema version");
+  }
+
+  sqlite3_finalize(statement);
+  return version;
+}
+
+// Recreates `table_name` from `create_sql`, which must create `<table_name>_rebuild`,
+// copying rows with `insert_columns` <- `select_expressions` in original rowid order.
+// Indexes on the old table are dropped with it; callers recreate them afterwards.
+void RebuildTable(
+    sqlite3* db,
+    const std::string& table_name,
+    const char* create_sql,
+    const std::string& insert_columns,
+    const std::string& select_expressions) {
+  ExecOrThrow(db, create_sql);
+  const std::string copy_sql = "INSERT INTO " + table_name + "_rebuild(" + insert_columns + ") SELECT " +
+                               select_expressions + " FROM " + table_name + " ORDER BY rowid;";
+  ExecOrThrow(db, copy_sql.c_str());
+  ExecOrThrow(db, ("DROP TABLE " + table_name + ";").c_str());
+  ExecOrThrow(db, ("ALTER TABLE " + table_name + "_rebuild RENAME TO " + table_name + ";").c_str());
+}
+
+// Secondary indexes for the list queries, as of the latest schema. Table rebuilds call
+// this to restore them.
+void CreateListQueryIndexes(sqlite3* db) {
+  ExecOrThrow(db, R"SQL(
+    CREATE INDEX IF NOT EXISTS idx_action_units_track_id
+    ON action_units(track_type, id);
+  )SQL");
+
+  ExecOrThrow(db, R"SQL(
+    CREATE INDEX IF NOT EXISTS idx_learning_sessions_goal_order
+    ON learning_sessions(goal_id, COALESCE(completed_at, started_at, id));
+  )SQL");
+
+  ExecOrThrow(db, R"SQL(
+    CREATE INDEX IF NOT EXISTS idx_milestone_checkpoints_goal_submitted
+    ON milestone_checkpoints(goal_id, submitted_at);
+  )SQL");
+
+  ExecOrThrow(db, R"SQL(
+    CREATE INDEX IF NOT EXISTS idx_reward_events_track_created_id
+    ON reward_events(track_type, created_at, id);
+  )SQL");
+
+  ExecOrThrow(db, R"SQL(
+    CREATE INDEX IF NOT EXISTS idx_reward_events_created_id
+    ON reward_events(created_at, id);
+  )SQL");
+}
+
+// SQL expression converting an ISO-8601 UTC text timestamp column to epoch milliseconds.
+// Empty or unparseable text becomes NULL.
+std::string EpochMsFromText(const std::string& column) {
+  return "CAST(ROUND((julianday(NULLIF(" + column + ", '')) - 2440587.5) * 86400000.0) AS INTEGER)";
+}
+
+std::string RequiredEpochMsFromText(const std::string& column) {
+  return "COALESCE(" + EpochMsFromText(column) + ", 0)";
+}
+
+std::string TrackCodeFromText(const std::string& column) {
+  return "CASE " + column + " WHEN 'life' THEN 0 WHEN 'learning' THEN 1 END";
+}
+
+std::string LifecycleCodeFromText(const std::string& column, const std::string& fallback) {
+  return "CASE " + column +
+         " WHEN 'ready' THEN 0 WHEN 'active' THEN 1 WHEN 'partial' THEN 2 WHEN 'missed' THEN 3"
+         " WHEN 'paused' THEN 4 WHEN 'completed' THEN 5 WHEN 'checkpoint_candidate' THEN 6 ELSE " +
+         fallback + " END";
+}
+
+// Triggers keeping the v9 rollup tables in step with their source rows. Table rebuilds
+// drop triggers along with the table, so rebuilds call this to restore them.
+void CreateRollupTriggers(sqlite3* db) {
+  ExecOrThrow(db, R"SQL(
+    CREATE TRIGGER IF NOT EXISTS trg_reward_events_rollup_insert
+    AFTER INSERT ON reward_events
+    BEGIN
+      INSERT INTO reward_daily_rollups(day, track_type, xp_total, event_count)
+      VALUES(NEW.created_at / 86400000, NEW.track_type, NEW.xp_delta, 1)
+      ON CONFLICT(day, track_type) DO UPDATE SET
+        xp_total = xp_total + excluded.xp_total,
+        event_count = event_count + 1;
+    END;
+  )SQL");
+
+  // A session contributes to its completion day once it is completed; upserts can move
+  // it in or out of that state, so updates retract the old contribution first.
+  ExecOrThrow(db, R"SQL(
+    CREATE TRIGGER IF NOT EXISTS trg_learning_sessions_rollup_insert
+    AFTER INSERT ON learning_sessions
+    WHEN NEW.lifecycle_state = 5 AND NEW.completed_at IS NOT NULL
+    BEGIN
+      INSERT INTO learning_daily_rollups(day, minutes, completed_sessions)
+      VALUES(NEW.completed_at / 86400000, NEW.duration_minutes, 1)
+      ON CONFLICT(day) DO UPDATE SET
+        minutes = minutes + excluded.minutes,
+        completed_sessions = completed_sessions + 1;
+    END;
+  )SQL");
+
+  ExecOrThrow(db, R"SQL(
+    CREATE TRIGGER IF NOT EXISTS trg_learning_sessions_rollup_update
+    AFTER UPDATE OF lifecycle_state, duration_minutes, completed_at ON learning_sessions
+    BEGIN
+      UPDATE learning_daily_rollups
+      SET minutes = minutes - OLD.duration_minutes, completed_sessions = completed_sessions - 1
+      WHERE OLD.lifecycle_state = 5 AND OLD.completed_at IS NOT NULL AND day = OLD.completed_at / 86400000;
+
+      INSERT INTO learning_daily_rollups(day, minutes, completed_sessions)
+      SELECT NEW.completed_at / 86400000, NEW.duration_minutes, 1
+      WHERE NEW.lifecycle_state = 5 AND NEW.completed_at IS NOT NULL
+      ON CONFLICT(day) DO UPDATE SET
+        minutes = minutes + excluded.minutes,
+        completed_sessions = completed_sessions + 1;
+    END;
+  )SQL");
+
+  // From v10 on, sessions moved to learning_sessions_archive keep counting.
+  const bool has_archive = !TableColumns(db, "learning_sessions_archive").empty();
+  const std::string delete_trigger_sql =
+      std::string(R"SQL(
+    CREATE TRIGGER IF NOT EXISTS trg_learning_sessions_rollup_delete
+    AFTER DELETE ON learning_sessions
+    WHEN OLD.lifecycle_state = 5 AND OLD.completed_at IS NOT NULL)SQL") +
+      (has_archive ? "\n      AND NOT EXISTS (SELECT 1 FROM learning_sessions_archive WHERE id = OLD.id)" : "") +
+      R"SQL(
+    BEGIN
+      UPDATE learning_daily_rollups
+      SET minutes = minutes - OLD.duration_minutes, completed_sessions = completed_sessions - 1
+      WHERE day = OLD.completed_at / 86400000;
+    END;
+  )SQL";
+  ExecOrThrow(db, delete_trigger_sql.c_str());
 }
 
 void EnsureSchemaMeta(sqlite3* db) {
@@ -147,17 +321,90 @@ void ApplyV1(sqlite3* db) {
   }
 }
 
-void ApplyV2(sqlite3* db) {
+// Copies learning_sessions_legacy into the rebuilt learning_sessions in rowid order, one
+// transaction per batch. Rows keep their legacy rowid, so an upgrade interrupted between
+// batches resumes after the highest rowid already copied.
+void CopyLegacyLearningSessions(sqlite3* db, const MigrationOptions& options) {
+  const auto columns = TableColumns(db, "learning_sessions_legacy");
+  const auto has = [&columns](const char* column) { return columns.contains(column); };
+  const std::string title_expr = has("title") ? "COALESCE(title, 'Learning Session')" : "'Learning Session'";
+  const std::string state_expr = has("lifecycle_state") ? "COALESCE(lifecycle_state, 'completed')" : "'completed'";
+  const std::string priority_expr = has("priority_score") ? "COALESCE(priority_score, 100)" : "100";
+  const std::string checkpoint_expr = has("checkpoint_note") ? "checkpoint_note" : "NULL";
+  const std::string started_expr = has("started_at") ? "started_at" : "completed_at";
+
+  const std::string copy_sql =
+      "INSERT INTO learning_sessions(" \
+      "rowid, id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, " \
+      "artifact_ref, checkpoint_note, started_at, completed_at) " \
+      "SELECT rowid, id, goal_id, " +
+      title_expr + ", " + state_expr + ", " + priority_expr +
+      ", duration_minutes, artifact_kind, artifact_ref, " + checkpoint_expr + ", " + started_expr +
+      ", completed_at "
+      "FROM learning_sessions_legacy WHERE rowid > ?1 ORDER BY rowid LIMIT ?2;";
+
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(db, copy_sql.c_str(), -1, &statement, nullptr) != SQLITE_OK) {
+    throw std::runtime_error("Failed to prepare learning session copy: " + std::string(sqlite3_errmsg(db)));
+  }
+
+  MigrationProgress progress{};
+  progress.version = kSchemaVersionV2;
+  progress.rows_done = static_cast<size_t>(QueryInt64(db, "SELECT COUNT(*) FROM learning_sessions;"));
+  progress.rows_total =
+      progress.rows_done + static_cast<size_t>(QueryInt64(
+                               db,
+                               "SELECT COUNT(*) FROM learning_sessions_legacy "
+                               "WHERE rowid > (SELECT COALESCE(MAX(rowid), 0) FROM learning_sessions);"));
+  const auto batch_rows = static_cast<sqlite3_int64>(std::max<size_t>(options.batch_rows, 1));
+
+  try {
+    while (true) {
+      ExecOrThrow(db, "BEGIN TRANSACTION;");
+      try {
+        const sqlite3_int64 after_rowid = QueryInt64(db, "SELECT COALESCE(MAX(rowid), 0) FROM learning_sessions;");
+        sqlite3_reset(statement);
+        sqlite3_bind_int64(statement, 1, after_rowid);
+        sqlite3_bind_int64(statement, 2, batch_rows);
+        if (sqlite3_step(statement) != SQLITE_DONE) {
+          throw std::runtime_error("Failed copying learning sessions: " + std::string(sqlite3_errmsg(db)));
+        }
+        const auto copied = static_cast<size_t>(sqlite3_changes(db));
+        ExecOrThrow(db, "COMMIT;");
+
+        if (copied == 0) {
+          break;
+        }
+        progress.rows_done += copied;
+        if (options.on_progress) {
+          options.on_progress(progress);
+        }
+      } catch (...) {
+        sqlite3_reset(statement);
+        ExecOrThrow(db, "ROLLBACK;");
+        throw;
+      }
+    }
+  } catch (...) {
+    sqlite3_finalize(statement);
+    throw;
+  }
+
+  sqlite3_finalize(statement);
+}
+
+void ApplyV2(sqlite3* db, const MigrationOptions& options) {
   ExecOrThrow(db, "BEGIN TRANSACTION;");
 
   try {
-    if (!ColumnExists(db, "action_units", "runtime_state")) {
+    const auto action_columns = TableColumns(db, "action_units");
+    if (!action_columns.contains("runtime_state")) {
       ExecOrThrow(db, "ALTER TABLE action_units ADD COLUMN runtime_state TEXT NOT NULL DEFAULT 'ready';");
     }
-    if (!ColumnExists(db, "action_units", "priority_score")) {
+    if (!action_columns.contains("priority_score")) {
       ExecOrThrow(db, "ALTER TABLE action_units ADD COLUMN priority_score INTEGER NOT NULL DEFAULT 100;");
     }
-    if (!ColumnExists(db, "action_units", "started_at")) {
+    if (!action_columns.contains("started_at")) {
       ExecOrThrow(db, "ALTER TABLE action_units ADD COLUMN started_at TEXT;");
     }
 
@@ -170,62 +417,59 @@ void ApplyV2(sqlite3* db) {
       END;
     )SQL");
 
-    const bool has_title = ColumnExists(db, "learning_sessions", "title");
-    const bool has_state = ColumnExists(db, "learning_sessions", "lifecycle_state");
-    const bool has_priority = ColumnExists(db, "learning_sessions", "priority_score");
-    const bool has_checkpoint_note = ColumnExists(db, "learning_sessions", "checkpoint_note");
-    const bool has_started_at = ColumnExists(db, "learning_sessions", "started_at");
-
-    if (!(has_title && has_state && has_priority && has_checkpoint_note && has_started_at)) {
-      ExecOrThrow(db, "ALTER TABLE learning_sessions RENAME TO learning_sessions_legacy;");
-
-      ExecOrThrow(db, R"SQL(
-        CREATE TABLE learning_sessions (
-          id TEXT PRIMARY KEY,
-          goal_id TEXT NOT NULL,
-          title TEXT NOT NULL,
-          lifecycle_state TEXT NOT NULL CHECK(
-            lifecycle_state IN (
-              'ready',
-              'active',
-              'partial',
-              'missed',
-              'paused',
-              'completed',
-              'checkpoint_candidate'
-            )
-          ),
-          priority_score INTEGER NOT NULL,
-          duration_minutes INTEGER NOT NULL,
-          artifact_kind TEXT,
-          artifact_ref TEXT,
-          checkpoint_note TEXT,
-          started_at TEXT,
-          completed_at TEXT,
-          FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
-        );
-      )SQL");
-
-      const std::string title_expr = has_title ? "COALESCE(title, 'Learning Session')" : "'Learning Session'";
-      const std::string state_expr = has_state ? "COALESCE(lifecycle_state, 'completed')" : "'completed'";
-      const std::string priority_expr = has_priority ? "COALESCE(priority_score, 100)" : "100";
-      const std::string checkpoint_expr = has_checkpoint_note ? "checkpoint_note" : "NULL";
-      const std::string started_expr = has_started_at ? "started_at" : "completed_at";
-
-      const std::string migrate_sql =
-          "INSERT INTO learning_sessions(" \
-          "id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, artifact_ref, " \
-          "checkpoint_note, started_at, completed_at) " \
-          "SELECT id, goal_id, " +
-          title_expr + ", " + state_expr + ", " + priority_expr +
-          ", duration_minutes, artifact_kind, artifact_ref, " + checkpoint_expr + ", " + started_expr +
-          ", completed_at "
-          "FROM learning_sessions_legacy;";
-      ExecOrThrow(db, migrate_sql.c_str());
+    // A leftover legacy table means an earlier upgrade stopped mid-copy; resume it below.
+    if (TableColumns(db, "learning_sessions_legacy").empty()) {
+      const auto session_columns = TableColumns(db, "learning_sessions");
+      const bool current = session_columns.contains("title") && session_columns.contains("lifecycle_state") &&
+                           session_columns.contains("priority_score") &&
+                           session_columns.contains("checkpoint_note") && session_columns.contains("started_at");
+      if (!current) {
+        ExecOrThrow(db, "ALTER TABLE learning_sessions RENAME TO learning_sessions_legacy;");
 
-      ExecOrThrow(db, "DROP TABLE learning_sessions_legacy;");
+        ExecOrThrow(db, R"SQL(
+          CREATE TABLE learning_sessions (
+            id TEXT PRIMARY KEY,
+            goal_id TEXT NOT NULL,
+            title TEXT NOT NULL,
+            lifecycle_state TEXT NOT NULL CHECK(
+              lifecycle_state IN (
+                'ready',
+                'active',
+                'partial',
+                'missed',
+                'paused',
+                'completed',
+                'checkpoint_candidate'
+              )
+            ),
+            priority_score INTEGER NOT NULL,
+            duration_minutes INTEGER NOT NULL,
+            artifact_kind TEXT,
+            artifact_ref TEXT,
+            checkpoint_note TEXT,
+            started_at TEXT,
+            completed_at TEXT,
+            FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
+          );
+        )SQL");
+      }
     }
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
 
+  const bool copy_pending = !TableColumns(db, "learning_sessions_legacy").empty();
+  if (copy_pending) {
+    CopyLegacyLearningSessions(db, options);
+  }
+
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+  try {
+    if (copy_pending) {
+      ExecOrThrow(db, "DROP TABLE learning_sessions_legacy;");
+    }
     ExecOrThrow(db, "UPDATE schema_meta SET version = 2 WHERE id = 1;");
     ExecOrThrow(db, "COMMIT;");
   } catch (...) {
@@ -301,63 +545,794 @@ void ApplyV3(sqlite3* db) {
   }
 }
 
-}  // namespace
+// Secondary indexes for the per-track / per-goal list queries. Each index leads with
+// the equality column and continues with the ORDER BY key, so SQLite can both seek
+// and return rows in order without a temp b-tree. The learning session index is an
+// expression index because that query orders by COALESCE(completed_at, started_at, id).
+void ApplyV4(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
 
-int ReadSchemaVersion(sqlite3* db) {
-  if (db == nullptr) {
-    throw std::invalid_argument("ReadSchemaVersion requires a non-null sqlite handle");
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_action_units_track_id
+      ON action_units(track_type, id);
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_learning_sessions_goal_order
+      ON learning_sessions(goal_id, COALESCE(completed_at, started_at, id));
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_reward_events_track_created
+      ON reward_events(track_type, created_at);
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_milestone_checkpoints_goal_submitted
+      ON milestone_checkpoints(goal_id, submitted_at);
+    )SQL");
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 4 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
   }
+}
 
-  EnsureSchemaMeta(db);
+// Keyset pagination over the reward ledger orders by (created_at, id), both per track
+// and across tracks. Extending the v4 track index with id makes the tie-break seekable.
+void ApplyV5(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
 
-  sqlite3_stmt* statement = nullptr;
-  const int prepare_result = sqlite3_prepare_v2(
-      db,
-      "SELECT version FROM schema_meta WHERE id = 1;",
-      -1,
-      &statement,
-      nullptr);
+  try {
+    ExecOrThrow(db, "DROP INDEX IF EXISTS idx_reward_events_track_created;");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_reward_events_track_created_id
+      ON reward_events(track_type, created_at, id);
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_reward_events_created_id
+      ON reward_events(created_at, id);
+    )SQL");
 
-  if (prepare_result != SQLITE_OK) {
-    throw std::runtime_error("Failed to prepare schema version select statement");
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 5 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
   }
+}
 
-  int version = 0;
-  const int step_result = sqlite3_step(statement);
-  if (step_result == SQLITE_ROW) {
-    version = sqlite3_column_int(statement, 0);
-  } else if (step_result != SQLITE_DONE) {
-    sqlite3_finalize(statement);
-    throw std::runtime_error("Failed reading schema version");
+// Gives every entity table an explicit `row_key INTEGER PRIMARY KEY` (a stable alias of
+// the rowid that VACUUM cannot renumber) and demotes the external string id to a UNIQUE
+// column. Secondary indexes then carry an 8-byte key instead of the id text.
+void ApplyV6(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    RebuildTable(
+        db,
+        "habits",
+        R"SQL(
+          CREATE TABLE habits_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            cadence TEXT NOT NULL,
+            is_active INTEGER NOT NULL,
+            created_at TEXT NOT NULL
+          );
+        )SQL",
+        "id, title, cadence, is_active, created_at",
+        "id, title, cadence, is_active, created_at");
+
+    RebuildTable(
+        db,
+        "quests",
+        R"SQL(
+          CREATE TABLE quests_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            track_type TEXT NOT NULL CHECK(track_type IN ('life', 'learning')),
+            is_completed INTEGER NOT NULL,
+            created_at TEXT NOT NULL
+          );
+        )SQL",
+        "id, title, track_type, is_completed, created_at",
+        "id, title, track_type, is_completed, created_at");
+
+    RebuildTable(
+        db,
+        "action_units",
+        R"SQL(
+          CREATE TABLE action_units_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            parent_id TEXT NOT NULL,
+            title TEXT NOT NULL,
+            track_type TEXT NOT NULL CHECK(track_type IN ('life', 'learning')),
+            status TEXT NOT NULL CHECK(status IN ('todo', 'in_progress', 'completed')),
+            runtime_state TEXT NOT NULL DEFAULT 'ready',
+            priority_score INTEGER NOT NULL DEFAULT 100,
+            started_at TEXT,
+            completed_at TEXT
+          );
+        )SQL",
+        "id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at",
+        "id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at");
+
+    RebuildTable(
+        db,
+        "learning_goals",
+        R"SQL(
+          CREATE TABLE learning_goals_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            milestone TEXT NOT NULL,
+            confidence_level INTEGER NOT NULL,
+            created_at TEXT NOT NULL
+          );
+        )SQL",
+        "id, title, milestone, confidence_level, created_at",
+        "id, title, milestone, confidence_level, created_at");
+
+    RebuildTable(
+        db,
+        "learning_sessions",
+        R"SQL(
+          CREATE TABLE learning_sessions_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            goal_id TEXT NOT NULL,
+            title TEXT NOT NULL,
+            lifecycle_state TEXT NOT NULL CHECK(
+              lifecycle_state IN (
+                'ready',
+                'active',
+                'partial',
+                'missed',
+                'paused',
+                'completed',
+                'checkpoint_candidate'
+              )
+            ),
+            priority_score INTEGER NOT NULL,
+            duration_minutes INTEGER NOT NULL,
+            artifact_kind TEXT,
+            artifact_ref TEXT,
+            checkpoint_note TEXT,
+            started_at TEXT,
+            completed_at TEXT,
+            FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
+          );
+        )SQL",
+        "id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, artifact_ref, "
+        "checkpoint_note, started_at, completed_at",
+        "id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, artifact_ref, "
+        "checkpoint_note, started_at, completed_at");
+
+    RebuildTable(
+        db,
+        "milestone_checkpoints",
+        R"SQL(
+          CREATE TABLE milestone_checkpoints_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            goal_id TEXT NOT NULL,
+            learning_session_id TEXT NOT NULL,
+            milestone_key TEXT NOT NULL,
+            state TEXT NOT NULL CHECK(state IN ('candidate', 'confirmed', 'rejected')),
+            evidence_kind TEXT NOT NULL CHECK(evidence_kind IN ('note', 'snippet', 'exercise', 'reference')),
+            evidence_ref TEXT,
+            confidence_level INTEGER NOT NULL CHECK(confidence_level BETWEEN 1 AND 5),
+            candidate_reason TEXT,
+            reward_event_id TEXT UNIQUE,
+            submitted_at TEXT NOT NULL,
+            reviewed_at TEXT,
+            confirmed_at TEXT,
+            rejected_at TEXT,
+            created_at TEXT NOT NULL,
+            updated_at TEXT NOT NULL,
+            FOREIGN KEY(goal_id) REFERENCES learning_goals(id),
+            FOREIGN KEY(learning_session_id) REFERENCES learning_sessions(id)
+          );
+        )SQL",
+        "id, goal_id, learning_session_id, milestone_key, state, evidence_kind, evidence_ref, confidence_level, "
+        "candidate_reason, reward_event_id, submitted_at, reviewed_at, confirmed_at, rejected_at, created_at, "
+        "updated_at",
+        "id, goal_id, learning_session_id, milestone_key, state, evidence_kind, evidence_ref, confidence_level, "
+        "candidate_reason, reward_event_id, submitted_at, reviewed_at, confirmed_at, rejected_at, created_at, "
+        "updated_at");
+
+    RebuildTable(
+        db,
+        "reward_events",
+        R"SQL(
+          CREATE TABLE reward_events_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            source_type TEXT NOT NULL,
+            source_id TEXT NOT NULL,
+            track_type TEXT NOT NULL CHECK(track_type IN ('life', 'learning')),
+            xp_delta INTEGER NOT NULL,
+            reward_kind TEXT NOT NULL,
+            created_at TEXT NOT NULL
+          );
+        )SQL",
+        "id, source_type, source_id, track_type, xp_delta, reward_kind, created_at",
+        "id, source_type, source_id, track_type, xp_delta, reward_kind, created_at");
+
+    CreateListQueryIndexes(db);
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 6 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
   }
+}
 
-  sqlite3_finalize(statement);
-  return version;
+// Stores enum columns as small INTEGER codes (see storage_codec.hpp) and timestamps as
+// INTEGER epoch milliseconds, NULL where the entity has no value. Free-form text
+// (titles, notes, evidence/source/reward kinds, ui_preferences) is unchanged.
+void ApplyV7(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    RebuildTable(
+        db,
+        "habits",
+        R"SQL(
+          CREATE TABLE habits_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            cadence TEXT NOT NULL,
+            is_active INTEGER NOT NULL,
+            created_at INTEGER NOT NULL
+          );
+        )SQL",
+        "row_key, id, title, cadence, is_active, created_at",
+        "row_key, id, title, cadence, is_active, " + RequiredEpochMsFromText("created_at"));
+
+    RebuildTable(
+        db,
+        "quests",
+        R"SQL(
+          CREATE TABLE quests_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            track_type INTEGER NOT NULL CHECK(track_type IN (0, 1)),
+            is_completed INTEGER NOT NULL,
+            created_at INTEGER NOT NULL
+          );
+        )SQL",
+        "row_key, id, title, track_type, is_completed, created_at",
+        "row_key, id, title, " + TrackCodeFromText("track_type") + ", is_completed, " +
+            RequiredEpochMsFromText("created_at"));
+
+    RebuildTable(
+        db,
+        "action_units",
+        R"SQL(
+          CREATE TABLE action_units_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            parent_id TEXT NOT NULL,
+            title TEXT NOT NULL,
+            track_type INTEGER NOT NULL CHECK(track_type IN (0, 1)),
+            status INTEGER NOT NULL CHECK(status IN (0, 1, 2)),
+            runtime_state INTEGER NOT NULL DEFAULT 0 CHECK(runtime_state BETWEEN 0 AND 6),
+            priority_score INTEGER NOT NULL DEFAULT 100,
+            started_at INTEGER,
+            completed_at INTEGER
+          );
+        )SQL",
+        "row_key, id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at",
+        "row_key, id, parent_id, title, " + TrackCodeFromText("track_type") +
+            ", CASE status WHEN 'todo' THEN 0 WHEN 'in_progress' THEN 1 WHEN 'completed' THEN 2 END, " +
+            LifecycleCodeFromText(
+                "runtime_state", "CASE status WHEN 'completed' THEN 5 WHEN 'in_progress' THEN 1 ELSE 0 END") +
+            ", priority_score, " + EpochMsFromText("started_at") + ", " + EpochMsFromText("completed_at"));
+
+    RebuildTable(
+        db,
+        "learning_goals",
+        R"SQL(
+          CREATE TABLE learning_goals_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            title TEXT NOT NULL,
+            milestone TEXT NOT NULL,
+            confidence_level INTEGER NOT NULL,
+            created_at INTEGER NOT NULL
+          );
+        )SQL",
+        "row_key, id, title, milestone, confidence_level, created_at",
+        "row_key, id, title, milestone, confidence_level, " + RequiredEpochMsFromText("created_at"));
+
+    RebuildTable(
+        db,
+        "learning_sessions",
+        R"SQL(
+          CREATE TABLE learning_sessions_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            goal_id TEXT NOT NULL,
+            title TEXT NOT NULL,
+            lifecycle_state INTEGER NOT NULL CHECK(lifecycle_state BETWEEN 0 AND 6),
+            priority_score INTEGER NOT NULL,
+            duration_minutes INTEGER NOT NULL,
+            artifact_kind TEXT,
+            artifact_ref TEXT,
+            checkpoint_note TEXT,
+            started_at INTEGER,
+            completed_at INTEGER,
+            FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
+          );
+        )SQL",
+        "row_key, id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, "
+        "artifact_ref, checkpoint_note, started_at, completed_at",
+        "row_key, id, goal_id, title, " + LifecycleCodeFromText("lifecycle_state", "5") +
+            ", priority_score, duration_minutes, artifact_kind, artifact_ref, checkpoint_note, " +
+            EpochMsFromText("started_at") + ", " + EpochMsFromText("completed_at"));
+
+    RebuildTable(
+        db,
+        "milestone_checkpoints",
+        R"SQL(
+          CREATE TABLE milestone_checkpoints_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            goal_id TEXT NOT NULL,
+            learning_session_id TEXT NOT NULL,
+            milestone_key TEXT NOT NULL,
+            state INTEGER NOT NULL CHECK(state IN (0, 1, 2)),
+            evidence_kind TEXT NOT NULL CHECK(evidence_kind IN ('note', 'snippet', 'exercise', 'reference')),
+            evidence_ref TEXT,
+            confidence_level INTEGER NOT NULL CHECK(confidence_level BETWEEN 1 AND 5),
+            candidate_reason TEXT,
+            reward_event_id TEXT UNIQUE,
+            submitted_at INTEGER NOT NULL,
+            reviewed_at INTEGER,
+            confirmed_at INTEGER,
+            rejected_at INTEGER,
+            created_at INTEGER NOT NULL,
+            updated_at INTEGER NOT NULL,
+            FOREIGN KEY(goal_id) REFERENCES learning_goals(id),
+            FOREIGN KEY(learning_session_id) REFERENCES learning_sessions(id)
+          );
+        )SQL",
+        "row_key, id, goal_id, learning_session_id, milestone_key, state, evidence_kind, evidence_ref, "
+        "confidence_level, candidate_reason, reward_event_id, submitted_at, reviewed_at, confirmed_at, rejected_at, "
+        "created_at, updated_at",
+        "row_key, id, goal_id, learning_session_id, milestone_key, "
+        "CASE state WHEN 'candidate' THEN 0 WHEN 'confirmed' THEN 1 WHEN 'rejected' THEN 2 END, "
+        "evidence_kind, evidence_ref, confidence_level, candidate_reason, reward_event_id, " +
+            RequiredEpochMsFromText("submitted_at") + ", " + EpochMsFromText("reviewed_at") + ", " +
+            EpochMsFromText("confirmed_at") + ", " + EpochMsFromText("rejected_at") + ", " +
+            RequiredEpochMsFromText("created_at") + ", " + RequiredEpochMsFromText("updated_at"));
+
+    RebuildTable(
+        db,
+        "reward_events",
+        R"SQL(
+          CREATE TABLE reward_events_rebuild (
+            row_key INTEGER PRIMARY KEY,
+            id TEXT NOT NULL UNIQUE,
+            source_type TEXT NOT NULL,
+            source_id TEXT NOT NULL,
+            track_type INTEGER NOT NULL CHECK(track_type IN (0, 1)),
+            xp_delta INTEGER NOT NULL,
+            reward_kind TEXT NOT NULL,
+            created_at INTEGER NOT NULL
+          );
+        )SQL",
+        "row_key, id, source_type, source_id, track_type, xp_delta, reward_kind, created_at",
+        "row_key, id, source_type, source_id, " + TrackCodeFromText("track_type") + ", xp_delta, reward_kind, " +
+            RequiredEpochMsFromText("created_at"));
+
+    CreateListQueryIndexes(db);
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 7 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Periodic UserState snapshots keyed by the reward ledger position (reward_events.row_key)
+// they fold through, so state can be rebuilt by replaying only the newer events.
+void ApplyV8(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS user_state_snapshots (
+        row_key INTEGER PRIMARY KEY,
+        through_reward_key INTEGER NOT NULL UNIQUE,
+        level INTEGER NOT NULL,
+        total_xp INTEGER NOT NULL,
+        life_xp INTEGER NOT NULL,
+        learning_xp INTEGER NOT NULL,
+        recovery_tokens INTEGER NOT NULL,
+        created_at INTEGER NOT NULL
+      );
+    )SQL");
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 8 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Per-day rollups for insights queries, keyed by UTC epoch day (epoch ms / 86400000).
+// The reward ledger is append-only, so reward rollups only ever grow.
+void ApplyV9(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS reward_daily_rollups (
+        day INTEGER NOT NULL,
+        track_type INTEGER NOT NULL CHECK(track_type IN (0, 1)),
+        xp_total INTEGER NOT NULL,
+        event_count INTEGER NOT NULL,
+        PRIMARY KEY(day, track_type)
+      ) WITHOUT ROWID;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS learning_daily_rollups (
+        day INTEGER PRIMARY KEY,
+        minutes INTEGER NOT NULL,
+        completed_sessions INTEGER NOT NULL
+      ) WITHOUT ROWID;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      INSERT INTO reward_daily_rollups(day, track_type, xp_total, event_count)
+      SELECT created_at / 86400000, track_type, SUM(xp_delta), COUNT(*)
+      FROM reward_events
+      GROUP BY created_at / 86400000, track_type;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      INSERT INTO learning_daily_rollups(day, minutes, completed_sessions)
+      SELECT completed_at / 86400000, SUM(duration_minutes), COUNT(*)
+      FROM learning_sessions
+      WHERE lifecycle_state = 5 AND completed_at IS NOT NULL
+      GROUP BY completed_at / 86400000;
+    )SQL");
+
+    CreateRollupTriggers(db);
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 9 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Archive tables for finished work moved out of the hot tables. Archived rows keep
+// their columns plus archived_at; reward_events_archive keeps the ledger row_key so
+// snapshot sequences stay meaningful. Rollups are not touched by archival.
+void ApplyV10(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS action_units_archive (
+        row_key INTEGER PRIMARY KEY,
+        id TEXT NOT NULL UNIQUE,
+        parent_id TEXT NOT NULL,
+        title TEXT NOT NULL,
+        track_type INTEGER NOT NULL,
+        status INTEGER NOT NULL,
+        runtime_state INTEGER NOT NULL,
+        priority_score INTEGER NOT NULL,
+        started_at INTEGER,
+        completed_at INTEGER,
+        archived_at INTEGER NOT NULL
+      );
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS learning_sessions_archive (
+        row_key INTEGER PRIMARY KEY,
+        id TEXT NOT NULL UNIQUE,
+        goal_id TEXT NOT NULL,
+        title TEXT NOT NULL,
+        lifecycle_state INTEGER NOT NULL,
+        priority_score INTEGER NOT NULL,
+        duration_minutes INTEGER NOT NULL,
+        artifact_kind TEXT,
+        artifact_ref TEXT,
+        checkpoint_note TEXT,
+        started_at INTEGER,
+        completed_at INTEGER,
+        archived_at INTEGER NOT NULL
+      );
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS reward_events_archive (
+        row_key INTEGER PRIMARY KEY,
+        id TEXT NOT NULL UNIQUE,
+        source_type TEXT NOT NULL,
+        source_id TEXT NOT NULL,
+        track_type INTEGER NOT NULL,
+        xp_delta INTEGER NOT NULL,
+        reward_kind TEXT NOT NULL,
+        created_at INTEGER NOT NULL,
+        archived_at INTEGER NOT NULL
+      );
+    )SQL");
+
+    ExecOrThrow(db, "DROP TRIGGER IF EXISTS trg_learning_sessions_rollup_delete;");
+    CreateRollupTriggers(db);
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 10 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Append-only journal of user commands written before they are applied. Rows are deleted
+// in the same transaction that saves their effects; AUTOINCREMENT keeps sequences from
+// being reused once the journal has been emptied.
+void ApplyV11(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE TABLE IF NOT EXISTS command_journal (
+        sequence INTEGER PRIMARY KEY AUTOINCREMENT,
+        command_id TEXT NOT NULL,
+        payload TEXT NOT NULL,
+        recorded_at INTEGER NOT NULL
+      );
+    )SQL");
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 11 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Full-text index over action unit titles, learning session titles and checkpoint notes,
+// and milestone keys/evidence. Document rowids are base row_key * 3 + the search kind
+// code, so the triggers address a document without a lookup. Updates that leave the
+// indexed text unchanged do not touch the index.
+void ApplyV12(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE VIRTUAL TABLE IF NOT EXISTS search_documents USING fts5(
+        title,
+        body,
+        entity_kind UNINDEXED,
+        entity_id UNINDEXED,
+        tokenize = 'unicode61 remove_diacritics 2',
+        prefix = '2 3'
+      );
+    )SQL");
+    // Title hits weigh twice as much as body hits.
+    ExecOrThrow(db, "INSERT INTO search_documents(search_documents, rank) VALUES('rank', 'bm25(2.0, 1.0)');");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS action_units_search_insert AFTER INSERT ON action_units BEGIN
+        INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+        VALUES(NEW.row_key * 3, NEW.title, '', 0, NEW.id);
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS action_units_search_update AFTER UPDATE OF title ON action_units
+      WHEN OLD.title IS NOT NEW.title BEGIN
+        UPDATE search_documents SET title = NEW.title WHERE rowid = NEW.row_key * 3;
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS action_units_search_delete AFTER DELETE ON action_units BEGIN
+        DELETE FROM search_documents WHERE rowid = OLD.row_key * 3;
+      END;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS learning_sessions_search_insert AFTER INSERT ON learning_sessions BEGIN
+        INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+        VALUES(NEW.row_key * 3 + 1, NEW.title, COALESCE(NEW.checkpoint_note, ''), 1, NEW.id);
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS learning_sessions_search_update
+      AFTER UPDATE OF title, checkpoint_note ON learning_sessions
+      WHEN OLD.title IS NOT NEW.title OR OLD.checkpoint_note IS NOT NEW.checkpoint_note BEGIN
+        UPDATE search_documents SET title = NEW.title, body = COALESCE(NEW.checkpoint_note, '')
+        WHERE rowid = NEW.row_key * 3 + 1;
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS learning_sessions_search_delete AFTER DELETE ON learning_sessions BEGIN
+        DELETE FROM search_documents WHERE rowid = OLD.row_key * 3 + 1;
+      END;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS milestone_checkpoints_search_insert AFTER INSERT ON milestone_checkpoints BEGIN
+        INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+        VALUES(
+          NEW.row_key * 3 + 2,
+          NEW.milestone_key,
+          COALESCE(NEW.evidence_ref, '') || char(10) || COALESCE(NEW.candidate_reason, ''),
+          2,
+          NEW.id);
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS milestone_checkpoints_search_update
+      AFTER UPDATE OF milestone_key, evidence_ref, candidate_reason ON milestone_checkpoints
+      WHEN OLD.milestone_key IS NOT NEW.milestone_key OR OLD.evidence_ref IS NOT NEW.evidence_ref
+        OR OLD.candidate_reason IS NOT NEW.candidate_reason BEGIN
+        UPDATE search_documents
+        SET
+          title = NEW.milestone_key,
+          body = COALESCE(NEW.evidence_ref, '') || char(10) || COALESCE(NEW.candidate_reason, '')
+        WHERE rowid = NEW.row_key * 3 + 2;
+      END;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      CREATE TRIGGER IF NOT EXISTS milestone_checkpoints_search_delete AFTER DELETE ON milestone_checkpoints BEGIN
+        DELETE FROM search_documents WHERE rowid = OLD.row_key * 3 + 2;
+      END;
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+      SELECT row_key * 3, title, '', 0, id FROM action_units;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+      SELECT row_key * 3 + 1, title, COALESCE(checkpoint_note, ''), 1, id FROM learning_sessions;
+    )SQL");
+    ExecOrThrow(db, R"SQL(
+      INSERT INTO search_documents(rowid, title, body, entity_kind, entity_id)
+      SELECT
+        row_key * 3 + 2,
+        milestone_key,
+        COALESCE(evidence_ref, '') || char(10) || COALESCE(candidate_reason, ''),
+        2,
+        id
+      FROM milestone_checkpoints;
+    )SQL");
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 12 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+// Reward history pages continue from the live ledger into reward_events_archive; the
+// archive gets the same (created_at, id) keyset indexes so both sides of the merge are
+// index-ordered.
+void ApplyV13(sqlite3* db) {
+  ExecOrThrow(db, "BEGIN TRANSACTION;");
+
+  try {
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_reward_events_archive_track_created_id
+      ON reward_events_archive(track_type, created_at, id);
+    )SQL");
+
+    ExecOrThrow(db, R"SQL(
+      CREATE INDEX IF NOT EXISTS idx_reward_events_archive_created_id
+      ON reward_events_archive(created_at, id);
+    )SQL");
+
+    ExecOrThrow(db, "UPDATE schema_meta SET version = 13 WHERE id = 1;");
+    ExecOrThrow(db, "COMMIT;");
+  } catch (...) {
+    ExecOrThrow(db, "ROLLBACK;");
+    throw;
+  }
+}
+
+}  // namespace
+
+int ReadSchemaVersion(sqlite3* db) {
+  if (db == nullptr) {
+    throw std::invalid_argument("ReadSchemaVersion requires a non-null sqlite handle");
+  }
+
+  if (const auto version = QuerySchemaVersion(db); version.has_value()) {
+    return *version;
+  }
+
+  EnsureSchemaMeta(db);
+  return QuerySchemaVersion(db).value_or(0);
 }
 
 void RunMigrations(sqlite3* db, const int target_version) {
+  MigrationOptions options{};
+  options.target_version = target_version;
+  RunMigrations(db, options);
+}
+
+void RunMigrations(sqlite3* db, const MigrationOptions& options) {
   if (db == nullptr) {
     throw std::invalid_argument("RunMigrations requires a non-null sqlite handle");
   }
 
+  const int target_version = options.target_version;
   if (target_version < 0) {
     throw std::invalid_argument("RunMigrations target_version must be >= 0");
   }
 
-  int current_version = ReadSchemaVersion(db);
+  // Fast path for every open after the first: one read-only SELECT, no PRAGMAs, no writes.
+  if (const auto stored = QuerySchemaVersion(db); stored.has_value() && *stored >= target_version) {
+    return;
+  }
+
+  // Each step runs only when the stored version is below it, so the version read up front
+  // stays valid for the whole chain; the steps record their own version as they commit.
+  const int current_version = ReadSchemaVersion(db);
   if (current_version < 1 && target_version >= 1) {
     ApplyV1(db);
-    current_version = ReadSchemaVersion(db);
   }
-
   if (current_version < 2 && target_version >= 2) {
-    ApplyV2(db);
-    current_version = ReadSchemaVersion(db);
+    ApplyV2(db, options);
   }
-
   if (current_version < 3 && target_version >= 3) {
     ApplyV3(db);
   }
+  if (current_version < 4 && target_version >= 4) {
+    ApplyV4(db);
+  }
+  if (current_version < 5 && target_version >= 5) {
+    ApplyV5(db);
+  }
+  if (current_version < 6 && target_version >= 6) {
+    ApplyV6(db);
+  }
+  if (current_version < 7 && target_version >= 7) {
+    ApplyV7(db);
+  }
+  if (current_version < 8 && target_version >= 8) {
+    ApplyV8(db);
+  }
+  if (current_version < 9 && target_version >= 9) {
+    ApplyV9(db);
+  }
+  if (current_version < 10 && target_version >= 10) {
+    ApplyV10(db);
+  }
+  if (current_version < 11 && target_version >= 11) {
+    ApplyV11(db);
+  }
+  if (current_version < 12 && target_version >= 12) {
+    ApplyV12(db);
+  }
+  if (current_version < 13 && target_version >= 13) {
+    ApplyV13(db);
+  }
 
   const int final_version = ReadSchemaVersion(db);
   if (final_version < target_version) {
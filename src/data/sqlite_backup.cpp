@@ -0,0 +1,139 @@
+#include "habitrpg/data/sqlite_backup.hpp"
+
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sqlite3.h>
+
+namespace habitrpg::data {
+namespace {
+
+struct ConnectionCloser {
+  void operator()(sqlite3* db) const { sqlite3_close(db); }
+};
+
+using Connection = std::unique_ptr<sqlite3, ConnectionCloser>;
+
+Connection OpenOrThrow(const std::string& path, const int flags) {
+  sqlite3* db = nullptr;
+  const int rc = sqlite3_open_v2(path.c_str(), &db, flags, nullptr);
+  Connection connection(db);
+  if (rc != SQLITE_OK) {
+    const std::string details = db != nullptr ? sqlite3_errmsg(db) : "unknown sqlite open error";
+    throw std::runtime_error("Failed to open sqlite database at path " + path + " for backup: " + details);
+  }
+  sqlite3_busy_timeout(db, 5000);
+  return connection;
+}
+
+void ExecOrThrow(sqlite3* db, const char* sql) {
+  char* error_message = nullptr;
+  const int rc = sqlite3_exec(db, sql, nullptr, nullptr, &error_message);
+  if (rc != SQLITE_OK) {
+    const std::string details = error_message != nullptr ? error_message : "unknown sqlite error";
+    sqlite3_free(error_message);
+    throw std::runtime_error("SQLite exec failed: " + details);
+  }
+}
+
+bool IsWalMode(sqlite3* db) {
+  sqlite3_stmt* statement = nullptr;
+  if (sqlite3_prepare_v2(db, "PRAGMA journal_mode;", -1, &statement, nullptr) != SQLITE_OK) {
+    throw std::runtime_error("Failed to read journal_mode for backup: " + std::string(sqlite3_errmsg(db)));
+  }
+
+  bool wal = false;
+  if (sqlite3_step(statement) == SQLITE_ROW) {
+    const auto* raw_mode = sqlite3_column_text(statement, 0);
+    wal = raw_mode != nullptr && std::string(reinterpret_cast<const char*>(raw_mode)) == "wal";
+  }
+  sqlite3_finalize(statement);
+  return wal;
+}
+
+SqliteBackupStats CopyPages(
+    sqlite3* source,
+    sqlite3* destination,
+    const SqliteBackupOptions& options,
+    const std::stop_token& stop_token) {
+  sqlite3_backup* backup = sqlite3_backup_init(destination, "main", source, "main");
+  if (backup == nullptr) {
+    throw std::runtime_error("Failed to start sqlite backup: " + std::string(sqlite3_errmsg(destination)));
+  }
+
+  SqliteBackupStats stats{};
+  const int pages_per_step = options.pages_per_step > 0 ? options.pages_per_step : -1;
+  int rc = SQLITE_OK;
+  while (true) {
+    rc = sqlite3_backup_step(backup, pages_per_step);
+    stats.steps += 1;
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY && rc != SQLITE_LOCKED) {
+      break;
+    }
+    if (stop_token.stop_requested()) {
+      sqlite3_backup_finish(backup);
+      throw std::runtime_error("Sqlite backup cancelled");
+    }
+    if (options.step_pause.count() > 0) {
+      std::this_thread::sleep_for(options.step_pause);
+    }
+  }
+
+  stats.pages = sqlite3_backup_pagecount(backup);
+  sqlite3_backup_finish(backup);
+  if (rc != SQLITE_DONE) {
+    throw std::runtime_error("Sqlite backup step failed: " + std::string(sqlite3_errstr(rc)));
+  }
+  return stats;
+}
+
+}  // namespace
+
+SqliteBackupStats BackupDatabase(
+    const std::string& source_path,
+    const std::string& destination_path,
+    const SqliteBackupOptions& options,
+    const std::stop_token& stop_token) {
+  const std::string partial_path = destination_path + ".partial";
+  std::error_code remove_error;
+  std::filesystem::remove(partial_path, remove_error);
+
+  SqliteBackupStats stats{};
+  try {
+    const auto source = OpenOrThrow(source_path, SQLITE_OPEN_READONLY | SQLITE_OPEN_FULLMUTEX);
+    const auto destination =
+        OpenOrThrow(partial_path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX);
+
+    // Holding a read transaction across steps pins the WAL snapshot: writers keep
+    // committing, and the copy never sees their pages. A rollback-journal reader would
+    // block writers instead, so there the backup takes short per-step locks.
+    const bool pin_snapshot = IsWalMode(source.get());
+    if (pin_snapshot) {
+      ExecOrThrow(source.get(), "BEGIN; SELECT COUNT(*) FROM sqlite_schema;");
+    }
+    stats = CopyPages(source.get(), destination.get(), options, stop_token);
+    if (pin_snapshot) {
+      ExecOrThrow(source.get(), "COMMIT;");
+    }
+  } catch (...) {
+    std::filesystem::remove(partial_path, remove_error);
+    throw;
+  }
+
+  std::error_code rename_error;
+  std::filesystem::rename(partial_path, destination_path, rename_error);
+  if (rename_error) {
+    std::filesystem::remove(partial_path, remove_error);
+    throw std::runtime_error("Failed to move backup into place at " + destination_path + ": " + rename_error.message());
+  }
+  return stats;
+}
+
+}  // namespace habitrpg::data
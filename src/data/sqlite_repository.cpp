@@ -1,98 +1,459 @@
 #include "habitrpg/data/sqlite_repository.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
+
+#include "habitrpg/data/search_text.hpp"
+#include "habitrpg/data/storage_codec.hpp"
+#include "habitrpg/data/table_descriptor.hpp"
 
 namespace habitrpg::data {
 namespace {
 
 class Statement final {
  public:
-  Statement(sqlite3* db, const std::string& sql) : db_(db) {
-    const int rc = sqlite3_prepare_v2(db, sql.c_str(), -1, &statement_, nullptr);
-    if (rc != SQLITE_OK) {
-      throw std::runtime_error("Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
-    }
-  }
+  Statement(StatementCache& cache, const std::string_view sql) : cache_(cache), lease_(cache.Acquire(sql)) {}
 
-  ~Statement() {
-    if (statement_ != nullptr) {
-      sqlite3_finalize(statement_);
-    }
-  }
+  ~Statement() { cache_.Release(lease_); }
 
   Statement(const Statement&) = delete;
   Statement& operator=(const Statement&) = delete;
 
-  sqlite3_stmt* get() { return statement_; }
+  sqlite3_stmt* get() { return lease_.statement; }
 
  private:
-  sqlite3* db_{nullptr};
-  sqlite3_stmt* statement_{nullptr};
+  StatementCache& cache_;
+  StatementCache::Lease lease_;
 };
 
-void CheckResult(const int rc, sqlite3* db, const std::string& context) {
+// `context` is only turned into a string on failure; this runs for every bind and step.
+void CheckResult(const int rc, sqlite3* db, const std::string_view context) {
   if (rc == SQLITE_OK || rc == SQLITE_ROW || rc == SQLITE_DONE) {
     return;
   }
 
-  throw std::runtime_error(context + ": " + sqlite3_errmsg(db));
+  throw std::runtime_error(std::string(context) + ": " + sqlite3_errmsg(db));
 }
 
-void BindText(sqlite3* db, sqlite3_stmt* statement, const int index, const std::string& value) {
-  const int rc = sqlite3_bind_text(statement, index, value.c_str(), -1, SQLITE_TRANSIENT);
+// Binds without copying (SQLITE_STATIC): `value` must stay alive until the statement has
+// been stepped. Statement leases clear their bindings on release, so nothing dangles
+// afterwards. Temporaries are rejected at compile time.
+void BindText(sqlite3* db, sqlite3_stmt* statement, const int index, const std::string_view value) {
+  const char* data = value.data() != nullptr ? value.data() : "";
+  const int rc = sqlite3_bind_text(statement, index, data, static_cast<int>(value.size()), SQLITE_STATIC);
   CheckResult(rc, db, "sqlite3_bind_text failed");
 }
 
+void BindText(sqlite3* db, sqlite3_stmt* statement, int index, std::string&& value) = delete;
+
 void BindInt(sqlite3* db, sqlite3_stmt* statement, const int index, const int value) {
   const int rc = sqlite3_bind_int(statement, index, value);
   CheckResult(rc, db, "sqlite3_bind_int failed");
 }
 
-domain::ActionStatus StatusFromLifecycle(const domain::LifecycleState state) {
-  switch (state) {
-    case domain::LifecycleState::Completed:
-      return domain::ActionStatus::Completed;
-    case domain::LifecycleState::Active:
-      return domain::ActionStatus::InProgress;
-    case domain::LifecycleState::Ready:
-    case domain::LifecycleState::Partial:
-    case domain::LifecycleState::Missed:
-    case domain::LifecycleState::Paused:
-    case domain::LifecycleState::CheckpointCandidate:
-      return domain::ActionStatus::Todo;
+// Timestamps are stored as INTEGER epoch milliseconds; an empty string maps to NULL.
+void BindTimestamp(sqlite3* db, sqlite3_stmt* statement, const int index, const std::string& timestamp) {
+  const int rc = timestamp.empty() ? sqlite3_bind_null(statement, index)
+                                   : sqlite3_bind_int64(statement, index, TimestampToStorage(timestamp));
+  CheckResult(rc, db, "sqlite3_bind_int64 failed");
+}
+
+// Rollup day range [from_day, until_day) as epoch days; empty bounds are open.
+std::pair<int64_t, int64_t> EpochDayRange(const std::string& from_day, const std::string& until_day) {
+  return {
+      from_day.empty() ? std::numeric_limits<int64_t>::min() : EpochDayFromString(from_day),
+      until_day.empty() ? std::numeric_limits<int64_t>::max() : EpochDayFromString(until_day)};
+}
+
+void BindEpochDayRange(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    const std::string& from_day,
+    const std::string& until_day) {
+  const auto [from, until] = EpochDayRange(from_day, until_day);
+  CheckResult(sqlite3_bind_int64(statement, 1, from), db, "sqlite3_bind_int64 failed");
+  CheckResult(sqlite3_bind_int64(statement, 2, until), db, "sqlite3_bind_int64 failed");
+}
+
+std::string ColumnTimestamp(sqlite3_stmt* statement, const int index) {
+  if (sqlite3_column_type(statement, index) == SQLITE_NULL) {
+    return "";
   }
 
-  return domain::ActionStatus::Todo;
+  return domain::FormatTimestampUtcMs(sqlite3_column_int64(statement, index));
+}
+
+// Steps a `SELECT row_key, <reward event columns> ... WHERE row_key > ?` ledger query
+// (see LedgerSelectSql). Returns false once the visitor stops.
+template <typename Table>
+bool VisitLedgerRows(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    const Table& table,
+    const uint64_t after_sequence,
+    const RewardLedgerVisitor& visitor) {
+  CheckResult(
+      sqlite3_bind_int64(statement, 1, static_cast<sqlite3_int64>(after_sequence)),
+      db,
+      "sqlite3_bind_int64 failed");
+
+  domain::RewardEvent event{};
+  while (true) {
+    const int rc = sqlite3_step(statement);
+    if (rc == SQLITE_DONE) {
+      return true;
+    }
+    CheckResult(rc, db, "Reward ledger scan failed");
+
+    const auto sequence = static_cast<uint64_t>(sqlite3_column_int64(statement, 0));
+    table.Decode(statement, &event, 1);
+    if (!visitor(sequence, event)) {
+      return false;
+    }
+  }
 }
 
-domain::LifecycleState LifecycleFromLegacyStatus(const domain::ActionStatus status) {
-  switch (status) {
-    case domain::ActionStatus::Completed:
-      return domain::LifecycleState::Completed;
-    case domain::ActionStatus::InProgress:
-      return domain::LifecycleState::Active;
-    case domain::ActionStatus::Todo:
-      return domain::LifecycleState::Ready;
+// Copies the rows selected by `copy_sql` (?1 = bound, ?2 = archived_at, ?3 = state when
+// given) into an archive table, then deletes them with `delete_sql` (?1 = bound, ?3 =
+// state, same predicate). Returns the number of rows moved. Callers hold a transaction.
+// `delete_sql` must end in `RETURNING id`; `removed` is called with each moved id.
+template <typename Removed>
+size_t MoveRows(
+    StatementCache& statements,
+    sqlite3* db,
+    const std::string_view copy_sql,
+    const std::string_view delete_sql,
+    const int64_t bound,
+    const int64_t archived_at,
+    const std::optional<int> state,
+    const Removed& removed) {
+  {
+    Statement copy(statements, copy_sql);
+    CheckResult(sqlite3_bind_int64(copy.get(), 1, bound), db, "sqlite3_bind_int64 failed");
+    CheckResult(sqlite3_bind_int64(copy.get(), 2, archived_at), db, "sqlite3_bind_int64 failed");
+    if (state.has_value()) {
+      BindInt(db, copy.get(), 3, *state);
+    }
+    CheckResult(sqlite3_step(copy.get()), db, "Archive copy failed");
+  }
+
+  Statement remove(statements, delete_sql);
+  CheckResult(sqlite3_bind_int64(remove.get(), 1, bound), db, "sqlite3_bind_int64 failed");
+  if (state.has_value()) {
+    BindInt(db, remove.get(), 3, *state);
+  }
+  size_t moved = 0;
+  while (true) {
+    const int rc = sqlite3_step(remove.get());
+    if (rc == SQLITE_DONE) {
+      return moved;
+    }
+    CheckResult(rc, db, "Archive delete failed");
+    removed(std::string(ColumnView(remove.get(), 0)));
+    ++moved;
   }
+}
 
-  return domain::LifecycleState::Ready;
+constexpr auto kHabitTable = DescribeTable(
+    "habits",
+    Column("id", &domain::Habit::id),
+    Column("title", &domain::Habit::title),
+    Column("cadence", &domain::Habit::cadence),
+    Column("is_active", &domain::Habit::is_active),
+    TimestampColumn("created_at", &domain::Habit::created_at).InsertOnly());
+
+constexpr auto kQuestTable = DescribeTable(
+    "quests",
+    Column("id", &domain::Quest::id),
+    Column("title", &domain::Quest::title),
+    Column("track_type", &domain::Quest::track_type),
+    Column("is_completed", &domain::Quest::is_completed),
+    TimestampColumn("created_at", &domain::Quest::created_at).InsertOnly());
+
+// `status` is stored as derived from the lifecycle state; `runtime_state` holds the latter.
+constexpr auto kActionUnitTable =
+    DescribeTable(
+        "action_units",
+        Column("id", &domain::ActionUnit::id),
+        Column("parent_id", &domain::ActionUnit::parent_id),
+        Column("title", &domain::ActionUnit::title),
+        Column("track_type", &domain::ActionUnit::track_type),
+        Column("status", &domain::ActionUnit::status).WrittenAs([](const domain::ActionUnit& unit) {
+          return StatusFromLifecycle(unit.lifecycle_state);
+        }),
+        Column("runtime_state", &domain::ActionUnit::lifecycle_state),
+        Column("priority_score", &domain::ActionUnit::priority_score).WrittenAs([](const domain::ActionUnit& unit) {
+          return std::max(unit.priority_score, 0);
+        }),
+        TimestampColumn("started_at", &domain::ActionUnit::started_at),
+        TimestampColumn("completed_at", &domain::ActionUnit::completed_at))
+        .GuardedByArchive("action_units_archive");
+
+constexpr auto kLearningGoalTable = DescribeTable(
+    "learning_goals",
+    Column("id", &domain::LearningGoal::id),
+    Column("title", &domain::LearningGoal::title),
+    Column("milestone", &domain::LearningGoal::milestone),
+    Column("confidence_level", &domain::LearningGoal::confidence_level),
+    TimestampColumn("created_at", &domain::LearningGoal::created_at).InsertOnly());
+
+constexpr auto kLearningSessionTable =
+    DescribeTable(
+        "learning_sessions",
+        Column("id", &domain::LearningSession::id),
+        Column("goal_id", &domain::LearningSession::goal_id),
+        Column("title", &domain::LearningSession::title),
+        Column("lifecycle_state", &domain::LearningSession::lifecycle_state),
+        Column("priority_score", &domain::LearningSession::priority_score)
+            .WrittenAs([](const domain::LearningSession& session) { return std::max(session.priority_score, 0); }),
+        Column("duration_minutes", &domain::LearningSession::duration_minutes)
+            .WrittenAs([](const domain::LearningSession& session) { return std::max(session.duration_minutes, 0); }),
+        Column("artifact_kind", &domain::LearningSession::artifact_kind),
+        Column("artifact_ref", &domain::LearningSession::artifact_ref),
+        Column("checkpoint_note", &domain::LearningSession::checkpoint_note),
+        TimestampColumn("started_at", &domain::LearningSession::started_at),
+        TimestampColumn("completed_at", &domain::LearningSession::completed_at))
+        .GuardedByArchive("learning_sessions_archive");
+
+constexpr auto kMilestoneCheckpointTable = DescribeTable(
+    "milestone_checkpoints",
+    Column("id", &domain::MilestoneCheckpoint::id),
+    Column("goal_id", &domain::MilestoneCheckpoint::goal_id),
+    Column("learning_session_id", &domain::MilestoneCheckpoint::learning_session_id),
+    Column("milestone_key", &domain::MilestoneCheckpoint::milestone_key),
+    Column("state", &domain::MilestoneCheckpoint::state),
+    Column("evidence_kind", &domain::MilestoneCheckpoint::evidence_kind),
+    Column("evidence_ref", &domain::MilestoneCheckpoint::evidence_ref),
+    Column("confidence_level", &domain::MilestoneCheckpoint::confidence_level)
+        .WrittenAs([](const domain::MilestoneCheckpoint& checkpoint) {
+          return std::clamp(checkpoint.confidence_level, 1, 5);
+        }),
+    Column("candidate_reason", &domain::MilestoneCheckpoint::candidate_reason),
+    Column("reward_event_id", &domain::MilestoneCheckpoint::reward_event_id),
+    TimestampColumn("submitted_at", &domain::MilestoneCheckpoint::submitted_at),
+    TimestampColumn("reviewed_at", &domain::MilestoneCheckpoint::reviewed_at),
+    TimestampColumn("confirmed_at", &domain::MilestoneCheckpoint::confirmed_at),
+    TimestampColumn("rejected_at", &domain::MilestoneCheckpoint::rejected_at),
+    TimestampColumn("created_at", &domain::MilestoneCheckpoint::created_at),
+    TimestampColumn("updated_at", &domain::MilestoneCheckpoint::updated_at));
+
+constexpr auto kRewardEventTable =
+    DescribeTable(
+        "reward_events",
+        Column("id", &domain::RewardEvent::id),
+        Column("source_type", &domain::RewardEvent::source_type),
+        Column("source_id", &domain::RewardEvent::source_id),
+        Column("track_type", &domain::RewardEvent::track_type),
+        Column("xp_delta", &domain::RewardEvent::xp_delta),
+        Column("reward_kind", &domain::RewardEvent::reward_kind),
+        TimestampColumn("created_at", &domain::RewardEvent::created_at))
+        .GuardedByArchive("reward_events_archive")
+        .AppendOnly();
+
+const std::string kUpsertHabitSql = kHabitTable.UpsertSql();
+const std::string kUpsertQuestSql = kQuestTable.UpsertSql();
+const std::string kUpsertActionUnitSql = kActionUnitTable.UpsertSql();
+const std::string kUpsertLearningGoalSql = kLearningGoalTable.UpsertSql();
+const std::string kUpsertLearningSessionSql = kLearningSessionTable.UpsertSql();
+const std::string kUpsertMilestoneCheckpointSql = kMilestoneCheckpointTable.UpsertSql();
+const std::string kAppendRewardEventSql = kRewardEventTable.UpsertSql();
+
+// Ledger scans lead with row_key, so the reward event columns start at result column 1.
+std::string LedgerSelectSql(const std::string_view table) {
+  return "SELECT row_key, " + kRewardEventTable.ColumnList() + " FROM " + std::string(table) +
+         " WHERE row_key > ? ORDER BY row_key ASC;";
 }
 
-std::string ColumnText(sqlite3_stmt* statement, const int index) {
-  const auto* raw = sqlite3_column_text(statement, index);
-  if (raw == nullptr) {
-    return "";
+// Runs `sql` once per row through a single leased statement, rebinding between steps.
+// `stepped` runs after each row's step.
+template <typename Entity, typename Table, typename Stepped>
+void ExecuteForEach(
+    StatementCache& statements,
+    sqlite3* db,
+    const std::string_view sql,
+    const std::span<const Entity> rows,
+    const Table& table,
+    const std::string_view context,
+    const Stepped& stepped) {
+  Statement statement(statements, sql);
+  for (const auto& row : rows) {
+    table.Bind(db, statement.get(), row);
+    CheckResult(sqlite3_step(statement.get()), db, context);
+    sqlite3_reset(statement.get());
+    stepped(row);
+  }
+}
+
+// Returns the first row of an already bound query, or nullopt when there is none.
+template <typename Table>
+std::optional<typename Table::Row> DecodeFirst(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    const Table& table,
+    const std::string_view context) {
+  const int rc = sqlite3_step(statement);
+  if (rc == SQLITE_DONE) {
+    return std::nullopt;
+  }
+  CheckResult(rc, db, context);
+
+  std::optional<typename Table::Row> row(std::in_place);
+  table.Decode(statement, &*row);
+  return row;
+}
+
+// Decodes every row of an already bound query in place at the end of the result vector.
+template <typename Table>
+std::vector<typename Table::Row> DecodeAll(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    const Table& table,
+    const std::string_view context) {
+  std::vector<typename Table::Row> rows;
+  while (true) {
+    const int rc = sqlite3_step(statement);
+    if (rc == SQLITE_DONE) {
+      return rows;
+    }
+    CheckResult(rc, db, context);
+    table.Decode(statement, &rows.emplace_back());
+  }
+}
+
+// One row object is reused across the scan so string buffers keep their capacity.
+template <typename Table>
+void DecodeEach(
+    sqlite3* db,
+    sqlite3_stmt* statement,
+    const Table& table,
+    const std::string_view context,
+    const RowVisitor<typename Table::Row>& visitor) {
+  typename Table::Row row{};
+  while (true) {
+    const int rc = sqlite3_step(statement);
+    if (rc == SQLITE_DONE) {
+      return;
+    }
+    CheckResult(rc, db, context);
+    table.Decode(statement, &row);
+    if (!visitor(row)) {
+      return;
+    }
+  }
+}
+
+void ExecOn(sqlite3* db, const std::string& sql) {
+  char* error_message = nullptr;
+  const int rc = sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &error_message);
+  if (rc != SQLITE_OK) {
+    const std::string details = error_message != nullptr ? error_message : "unknown sqlite error";
+    sqlite3_free(error_message);
+    throw std::runtime_error("SQLite exec failed: " + details);
   }
+}
 
-  return reinterpret_cast<const char*>(raw);
+std::string_view SynchronousPragmaValue(const SqliteSynchronous synchronous) {
+  switch (synchronous) {
+    case SqliteSynchronous::Off:
+      return "OFF";
+    case SqliteSynchronous::Normal:
+      return "NORMAL";
+    case SqliteSynchronous::Full:
+      return "FULL";
+  }
+
+  return "FULL";
 }
 
 }  // namespace
 
-SqliteRepository::SqliteRepository(std::string sqlite_path) : sqlite_path_(std::move(sqlite_path)) {
+class SqliteRepository::WriteLock final {
+ public:
+  explicit WriteLock(SqliteRepository& repository) : repository_(repository), lock_(repository.writer_mutex_) {}
+
+  // Outside a unit of work the staged change is published once the lock is released, so
+  // subscribers never run while holding it.
+  ~WriteLock() {
+    if (repository_.transaction_depth_ > 0) {
+      return;
+    }
+    const auto changes = std::exchange(repository_.pending_changes_, {});
+    lock_.unlock();
+    if (!changes.empty()) {
+      repository_.change_feed_.Publish(changes);
+    }
+  }
+
+  WriteLock(const WriteLock&) = delete;
+  WriteLock& operator=(const WriteLock&) = delete;
+
+ private:
+  SqliteRepository& repository_;
+  std::unique_lock<std::recursive_mutex> lock_;
+};
+
+class SqliteRepository::ReadLease final {
+ public:
+  explicit ReadLease(const SqliteRepository& repository) : repository_(repository) {
+    if (repository.ReadsUseWriter()) {
+      writer_lock_ = std::unique_lock(repository.writer_mutex_);
+      return;
+    }
+
+    connection_ = repository.AcquireReadConnection();
+    if (connection_ == nullptr) {
+      temporary_ = repository.OpenReadConnection();
+      connection_ = temporary_.get();
+    }
+  }
+
+  ~ReadLease() {
+    if (snapshot_) {
+      sqlite3_exec(db(), "COMMIT;", nullptr, nullptr, nullptr);
+    }
+    if (temporary_ == nullptr) {
+      repository_.ReleaseReadConnection(connection_);
+    }
+  }
+
+  ReadLease(const ReadLease&) = delete;
+  ReadLease& operator=(const ReadLease&) = delete;
+
+  sqlite3* db() const { return connection_ != nullptr ? connection_->db : repository_.db_; }
+  StatementCache& statements() const {
+    return connection_ != nullptr ? connection_->statements : repository_.statements_;
+  }
+
+  // Keeps one read transaction open until the lease ends, so consecutive statements see
+  // the same snapshot. A pooled or temporary connection is private to this lease. On the
+  // writer this lease holds the writer lock: inside this thread's own unit of work the
+  // open transaction already is the snapshot, and otherwise no other thread can run a
+  // statement inside it before the COMMIT.
+  void HoldSnapshot() {
+    if (sqlite3_get_autocommit(db()) != 0) {
+      ExecOn(db(), "BEGIN;");
+      snapshot_ = true;
+    }
+  }
+
+ private:
+  const SqliteRepository& repository_;
+  std::unique_lock<std::recursive_mutex> writer_lock_;
+  ReadConnection* connection_{nullptr};
+  std::unique_ptr<ReadConnection> temporary_;
+  bool snapshot_{false};
+};
+
+SqliteRepository::SqliteRepository(std::string sqlite_path, SqliteRepositoryOptions options)
+    : sqlite_path_(std::move(sqlite_path)), options_(options) {
   const int rc = sqlite3_open_v2(
       sqlite_path_.c_str(),
       &db_,
@@ -108,10 +469,34 @@ SqliteRepository::SqliteRepository(std::string sqlite_path) : sqlite_path_(std::
     throw std::runtime_error("Failed to open sqlite database at path " + sqlite_path_ + ": " + details);
   }
 
-  Migrate();
+  // The write-behind persistence worker holds a second connection to the same file.
+  sqlite3_busy_timeout(db_, options_.busy_timeout_ms);
+  statements_.Attach(db_);
+
+  try {
+    if (options_.enable_wal) {
+      ExecOrThrow("PRAGMA journal_mode = WAL;");
+      ExecOrThrow("PRAGMA synchronous = " + std::string(SynchronousPragmaValue(options_.synchronous)) + ";");
+      ApplyConnectionPragmas(db_);
+    }
+    Migrate();
+    if (options_.enable_wal) {
+      OpenReadConnections();
+    }
+    // Installed after migrations so schema upgrades do not show up as row changes.
+    sqlite3_update_hook(db_, &SqliteRepository::OnRowChanged, this);
+  } catch (...) {
+    CloseReadConnections();
+    statements_.Clear();
+    sqlite3_close(db_);
+    db_ = nullptr;
+    throw;
+  }
 }
 
 SqliteRepository::~SqliteRepository() {
+  CloseReadConnections();
+  statements_.Clear();
   if (db_ != nullptr) {
     sqlite3_close(db_);
     db_ = nullptr;
@@ -119,797 +504,972 @@ SqliteRepository::~SqliteRepository() {
 }
 
 void SqliteRepository::Migrate() {
-  RunMigrations(db_);
+  const WriteLock lock(*this);
+  MigrationOptions migration_options{};
+  migration_options.on_progress = options_.on_migration_progress;
+  RunMigrations(db_, migration_options);
 }
 
 int SqliteRepository::SchemaVersion() const {
+  const std::lock_guard<std::recursive_mutex> lock(writer_mutex_);
   return ReadSchemaVersion(db_);
 }
 
+StatementCacheStats SqliteRepository::StatementStats() const {
+  const std::lock_guard<std::recursive_mutex> lock(writer_mutex_);
+  return statements_.Stats();
+}
+
 void SqliteRepository::UpsertHabit(const domain::Habit& habit) {
-  Statement statement(
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
       db_,
-      R"SQL(
-        INSERT INTO habits(id, title, cadence, is_active, created_at)
-        VALUES(?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          title = excluded.title,
-          cadence = excluded.cadence,
-          is_active = excluded.is_active;
-      )SQL");
+      kUpsertHabitSql,
+      std::span(&habit, 1),
+      kHabitTable,
+      "UpsertHabit failed",
+      [this](const auto& row) { RecordChange(ChangeTable::Habits, row.id); });
+}
 
-  BindText(db_, statement.get(), 1, habit.id);
-  BindText(db_, statement.get(), 2, habit.title);
-  BindText(db_, statement.get(), 3, habit.cadence);
-  BindInt(db_, statement.get(), 4, habit.is_active ? 1 : 0);
-  BindText(db_, statement.get(), 5, habit.created_at);
+void SqliteRepository::UpsertHabits(const std::span<const domain::Habit> habits) {
+  if (habits.empty()) {
+    return;
+  }
 
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertHabit failed");
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertHabitSql,
+      habits,
+      kHabitTable,
+      "UpsertHabits failed",
+      [this](const auto& row) { RecordChange(ChangeTable::Habits, row.id); });
+  unit_of_work.Commit();
 }
 
 std::optional<domain::Habit> SqliteRepository::FindHabitById(const std::string& id) const {
-  Statement statement(
+  static const std::string sql = kHabitTable.SelectSql("WHERE id = ? LIMIT 1;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, id);
+  return DecodeFirst(reader.db(), statement.get(), kHabitTable, "FindHabitById failed");
+}
+
+std::vector<domain::Habit> SqliteRepository::ListHabits() const {
+  static const std::string sql = kHabitTable.SelectSql("ORDER BY created_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  return DecodeAll(reader.db(), statement.get(), kHabitTable, "ListHabits failed");
+}
+
+void SqliteRepository::UpsertQuest(const domain::Quest& quest) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
       db_,
-      "SELECT id, title, cadence, is_active, created_at FROM habits WHERE id = ? LIMIT 1;");
+      kUpsertQuestSql,
+      std::span(&quest, 1),
+      kQuestTable,
+      "UpsertQuest failed",
+      [this](const auto& row) { RecordChange(ChangeTable::Quests, row.id); });
+}
 
-  BindText(db_, statement.get(), 1, id);
+void SqliteRepository::UpsertQuests(const std::span<const domain::Quest> quests) {
+  if (quests.empty()) {
+    return;
+  }
 
-  const int rc = sqlite3_step(statement.get());
-  if (rc == SQLITE_DONE) {
-    return std::nullopt;
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertQuestSql,
+      quests,
+      kQuestTable,
+      "UpsertQuests failed",
+      [this](const auto& row) { RecordChange(ChangeTable::Quests, row.id); });
+  unit_of_work.Commit();
+}
+
+std::vector<domain::Quest> SqliteRepository::ListQuests() const {
+  static const std::string sql = kQuestTable.SelectSql("ORDER BY created_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  return DecodeAll(reader.db(), statement.get(), kQuestTable, "ListQuests failed");
+}
+
+void SqliteRepository::UpsertActionUnit(const domain::ActionUnit& action_unit) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertActionUnitSql,
+      std::span(&action_unit, 1),
+      kActionUnitTable,
+      "UpsertActionUnit failed",
+      [this](const auto& row) { RecordChange(ChangeTable::ActionUnits, row.id); });
+}
+
+void SqliteRepository::UpsertActionUnits(const std::span<const domain::ActionUnit> action_units) {
+  if (action_units.empty()) {
+    return;
   }
-  CheckResult(rc, db_, "FindHabitById failed");
 
-  domain::Habit habit{};
-  habit.id = ColumnText(statement.get(), 0);
-  habit.title = ColumnText(statement.get(), 1);
-  habit.cadence = ColumnText(statement.get(), 2);
-  habit.is_active = sqlite3_column_int(statement.get(), 3) == 1;
-  habit.created_at = ColumnText(statement.get(), 4);
-  return habit;
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertActionUnitSql,
+      action_units,
+      kActionUnitTable,
+      "UpsertActionUnits failed",
+      [this](const auto& row) { RecordChange(ChangeTable::ActionUnits, row.id); });
+  unit_of_work.Commit();
 }
 
-std::vector<domain::Habit> SqliteRepository::ListHabits() const {
-  Statement statement(
+std::optional<domain::ActionUnit> SqliteRepository::FindActionUnitById(const std::string& id) const {
+  static const std::string sql = kActionUnitTable.SelectSql("WHERE id = ? LIMIT 1;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, id);
+  return DecodeFirst(reader.db(), statement.get(), kActionUnitTable, "FindActionUnitById failed");
+}
+
+std::vector<domain::ActionUnit> SqliteRepository::ListActionUnitsByTrack(const domain::TrackType track_type) const {
+  static const std::string sql = kActionUnitTable.SelectSql("WHERE track_type = ? ORDER BY id ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindInt(reader.db(), statement.get(), 1, TrackTypeToStorage(track_type));
+  return DecodeAll(reader.db(), statement.get(), kActionUnitTable, "ListActionUnitsByTrack failed");
+}
+
+void SqliteRepository::UpsertLearningGoal(const domain::LearningGoal& goal) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
       db_,
-      "SELECT id, title, cadence, is_active, created_at FROM habits ORDER BY created_at ASC;");
+      kUpsertLearningGoalSql,
+      std::span(&goal, 1),
+      kLearningGoalTable,
+      "UpsertLearningGoal failed",
+      [this](const auto& row) { RecordChange(ChangeTable::LearningGoals, row.id); });
+}
+
+void SqliteRepository::UpsertLearningGoals(const std::span<const domain::LearningGoal> goals) {
+  if (goals.empty()) {
+    return;
+  }
 
-  std::vector<domain::Habit> habits;
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertLearningGoalSql,
+      goals,
+      kLearningGoalTable,
+      "UpsertLearningGoals failed",
+      [this](const auto& row) { RecordChange(ChangeTable::LearningGoals, row.id); });
+  unit_of_work.Commit();
+}
+
+std::optional<domain::LearningGoal> SqliteRepository::FindLearningGoalById(const std::string& id) const {
+  static const std::string sql = kLearningGoalTable.SelectSql("WHERE id = ? LIMIT 1;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, id);
+  return DecodeFirst(reader.db(), statement.get(), kLearningGoalTable, "FindLearningGoalById failed");
+}
+
+std::vector<domain::LearningGoal> SqliteRepository::ListLearningGoals() const {
+  static const std::string sql = kLearningGoalTable.SelectSql("ORDER BY created_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  return DecodeAll(reader.db(), statement.get(), kLearningGoalTable, "ListLearningGoals failed");
+}
+
+void SqliteRepository::UpsertLearningSession(const domain::LearningSession& session) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertLearningSessionSql,
+      std::span(&session, 1),
+      kLearningSessionTable,
+      "UpsertLearningSession failed",
+      [this](const auto& row) { RecordChange(ChangeTable::LearningSessions, row.id); });
+}
+
+void SqliteRepository::UpsertLearningSessions(const std::span<const domain::LearningSession> sessions) {
+  if (sessions.empty()) {
+    return;
+  }
+
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertLearningSessionSql,
+      sessions,
+      kLearningSessionTable,
+      "UpsertLearningSessions failed",
+      [this](const auto& row) { RecordChange(ChangeTable::LearningSessions, row.id); });
+  unit_of_work.Commit();
+}
+
+std::vector<domain::LearningSession> SqliteRepository::ListLearningSessionsByGoal(const std::string& goal_id) const {
+  static const std::string sql =
+      kLearningSessionTable.SelectSql("WHERE goal_id = ? ORDER BY COALESCE(completed_at, started_at, id) ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, goal_id);
+  return DecodeAll(reader.db(), statement.get(), kLearningSessionTable, "ListLearningSessionsByGoal failed");
+}
+
+std::vector<domain::LearningSession> SqliteRepository::ListLearningSessions() const {
+  static const std::string sql = kLearningSessionTable.SelectSql("ORDER BY id ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  return DecodeAll(reader.db(), statement.get(), kLearningSessionTable, "ListLearningSessions failed");
+}
+
+void SqliteRepository::VisitLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const {
+  static const std::string sql = kLearningSessionTable.SelectSql("ORDER BY id ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  DecodeEach(reader.db(), statement.get(), kLearningSessionTable, "VisitLearningSessions failed", visitor);
+}
+
+void SqliteRepository::UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertMilestoneCheckpointSql,
+      std::span(&checkpoint, 1),
+      kMilestoneCheckpointTable,
+      "UpsertMilestoneCheckpoint failed",
+      [this](const auto& row) { RecordChange(ChangeTable::MilestoneCheckpoints, row.id); });
+}
+
+void SqliteRepository::UpsertMilestoneCheckpoints(const std::span<const domain::MilestoneCheckpoint> checkpoints) {
+  if (checkpoints.empty()) {
+    return;
+  }
+
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kUpsertMilestoneCheckpointSql,
+      checkpoints,
+      kMilestoneCheckpointTable,
+      "UpsertMilestoneCheckpoints failed",
+      [this](const auto& row) { RecordChange(ChangeTable::MilestoneCheckpoints, row.id); });
+  unit_of_work.Commit();
+}
+
+std::optional<domain::MilestoneCheckpoint> SqliteRepository::FindMilestoneCheckpointById(const std::string& id) const {
+  static const std::string sql = kMilestoneCheckpointTable.SelectSql("WHERE id = ? LIMIT 1;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, id);
+  return DecodeFirst(reader.db(), statement.get(), kMilestoneCheckpointTable, "FindMilestoneCheckpointById failed");
+}
+
+std::vector<domain::MilestoneCheckpoint> SqliteRepository::ListMilestoneCheckpointsByGoal(
+    const std::string& goal_id) const {
+  static const std::string sql = kMilestoneCheckpointTable.SelectSql("WHERE goal_id = ? ORDER BY submitted_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindText(reader.db(), statement.get(), 1, goal_id);
+  return DecodeAll(reader.db(), statement.get(), kMilestoneCheckpointTable, "ListMilestoneCheckpointsByGoal failed");
+}
+
+std::vector<domain::MilestoneCheckpoint> SqliteRepository::ListMilestoneCheckpoints() const {
+  static const std::string sql = kMilestoneCheckpointTable.SelectSql("ORDER BY submitted_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  return DecodeAll(reader.db(), statement.get(), kMilestoneCheckpointTable, "ListMilestoneCheckpoints failed");
+}
+
+void SqliteRepository::VisitMilestoneCheckpoints(const RowVisitor<domain::MilestoneCheckpoint>& visitor) const {
+  static const std::string sql = kMilestoneCheckpointTable.SelectSql("ORDER BY submitted_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  DecodeEach(reader.db(), statement.get(), kMilestoneCheckpointTable, "VisitMilestoneCheckpoints failed", visitor);
+}
+
+void SqliteRepository::AppendRewardEvent(const domain::RewardEvent& reward_event) {
+  const WriteLock lock(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kAppendRewardEventSql,
+      std::span(&reward_event, 1),
+      kRewardEventTable,
+      "AppendRewardEvent failed",
+      [this](const auto& row) { RecordChange(ChangeTable::RewardEvents, row.id); });
+}
+
+void SqliteRepository::AppendRewardEvents(const std::span<const domain::RewardEvent> reward_events) {
+  if (reward_events.empty()) {
+    return;
+  }
+
+  UnitOfWork unit_of_work(*this);
+  ExecuteForEach(
+      statements_,
+      db_,
+      kAppendRewardEventSql,
+      reward_events,
+      kRewardEventTable,
+      "AppendRewardEvents failed",
+      [this](const auto& row) { RecordChange(ChangeTable::RewardEvents, row.id); });
+  unit_of_work.Commit();
+}
+
+std::vector<domain::RewardEvent> SqliteRepository::ListRewardEventsByTrack(const domain::TrackType track_type) const {
+  static const std::string sql = kRewardEventTable.SelectSql("WHERE track_type = ? ORDER BY created_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindInt(reader.db(), statement.get(), 1, TrackTypeToStorage(track_type));
+  return DecodeAll(reader.db(), statement.get(), kRewardEventTable, "ListRewardEventsByTrack failed");
+}
+
+void SqliteRepository::VisitRewardEventsByTrack(
+    const domain::TrackType track_type,
+    const RowVisitor<domain::RewardEvent>& visitor) const {
+  static const std::string sql = kRewardEventTable.SelectSql("WHERE track_type = ? ORDER BY created_at ASC;");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  BindInt(reader.db(), statement.get(), 1, TrackTypeToStorage(track_type));
+  DecodeEach(reader.db(), statement.get(), kRewardEventTable, "VisitRewardEventsByTrack failed", visitor);
+}
+
+RewardEventPage SqliteRepository::ListRewardEventsPage(const RewardEventPageQuery& query) const {
+  if (query.page_size == 0) {
+    throw std::invalid_argument("ListRewardEventsPage requires a non-zero page_size");
+  }
+
+  // The SQL text only varies with which filters are present, so each shape is prepared
+  // once and kept in the statement cache. Archived events stay part of the history: the
+  // live ledger and the archive are merged on the same keyset, each side in index order.
+  std::string where = "WHERE 1 = 1";
+  if (query.track_type.has_value()) {
+    where += " AND track_type = ?1";
+  }
+  if (query.before.has_value()) {
+    where += " AND (created_at, id) < (?2, ?3)";
+  }
+  if (!query.created_from.empty()) {
+    where += " AND created_at >= ?4";
+  }
+  if (!query.created_until.empty()) {
+    where += " AND created_at < ?5";
+  }
+  const std::string sql = kRewardEventTable.SelectSql(where) + " UNION ALL " +
+                          kRewardEventTable.SelectSql(where, "reward_events_archive") +
+                          " ORDER BY created_at DESC, id DESC LIMIT ?6;";
+
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+
+  if (query.track_type.has_value()) {
+    BindInt(reader.db(), statement.get(), 1, TrackTypeToStorage(*query.track_type));
+  }
+  if (query.before.has_value()) {
+    BindTimestamp(reader.db(), statement.get(), 2, query.before->created_at);
+    BindText(reader.db(), statement.get(), 3, query.before->id);
+  }
+  if (!query.created_from.empty()) {
+    BindTimestamp(reader.db(), statement.get(), 4, query.created_from);
+  }
+  if (!query.created_until.empty()) {
+    BindTimestamp(reader.db(), statement.get(), 5, query.created_until);
+  }
+  // One extra row tells whether an older page exists without a COUNT query.
+  const int rc_limit = sqlite3_bind_int64(statement.get(), 6, static_cast<sqlite3_int64>(query.page_size) + 1);
+  CheckResult(rc_limit, reader.db(), "sqlite3_bind_int64 failed");
+
+  RewardEventPage page{};
+  page.events.reserve(query.page_size);
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
       break;
     }
-    CheckResult(rc, db_, "ListHabits failed");
+    CheckResult(rc, reader.db(), "ListRewardEventsPage failed");
+
+    if (page.events.size() == query.page_size) {
+      const auto& oldest = page.events.back();
+      page.next = RewardEventCursor{oldest.created_at, oldest.id};
+      break;
+    }
 
-    domain::Habit habit{};
-    habit.id = ColumnText(statement.get(), 0);
-    habit.title = ColumnText(statement.get(), 1);
-    habit.cadence = ColumnText(statement.get(), 2);
-    habit.is_active = sqlite3_column_int(statement.get(), 3) == 1;
-    habit.created_at = ColumnText(statement.get(), 4);
-    habits.push_back(std::move(habit));
+    kRewardEventTable.Decode(statement.get(), &page.events.emplace_back());
   }
 
-  return habits;
+  return page;
 }
 
-void SqliteRepository::UpsertQuest(const domain::Quest& quest) {
+bool SqliteRepository::HasRewardEvent(const std::string& reward_event_id) const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        INSERT INTO quests(id, title, track_type, is_completed, created_at)
-        VALUES(?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          title = excluded.title,
-          track_type = excluded.track_type,
-          is_completed = excluded.is_completed;
+        SELECT EXISTS(SELECT 1 FROM reward_events WHERE id = ?1)
+            OR EXISTS(SELECT 1 FROM reward_events_archive WHERE id = ?1);
       )SQL");
+  BindText(reader.db(), statement.get(), 1, reward_event_id);
 
-  BindText(db_, statement.get(), 1, quest.id);
-  BindText(db_, statement.get(), 2, quest.title);
-  BindText(db_, statement.get(), 3, std::string(domain::TrackTypeToString(quest.track_type)));
-  BindInt(db_, statement.get(), 4, quest.is_completed ? 1 : 0);
-  BindText(db_, statement.get(), 5, quest.created_at);
-
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertQuest failed");
+  const int rc = sqlite3_step(statement.get());
+  CheckResult(rc, reader.db(), "HasRewardEvent failed");
+  return sqlite3_column_int(statement.get(), 0) != 0;
 }
 
-std::vector<domain::Quest> SqliteRepository::ListQuests() const {
-  Statement statement(
-      db_,
-      "SELECT id, title, track_type, is_completed, created_at FROM quests ORDER BY created_at ASC;");
+uint64_t SqliteRepository::LatestRewardSequence() const {
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), "SELECT COALESCE(MAX(row_key), 0) FROM reward_events;");
 
-  std::vector<domain::Quest> quests;
-  while (true) {
-    const int rc = sqlite3_step(statement.get());
-    if (rc == SQLITE_DONE) {
-      break;
+  const int rc = sqlite3_step(statement.get());
+  CheckResult(rc, reader.db(), "LatestRewardSequence failed");
+  return static_cast<uint64_t>(sqlite3_column_int64(statement.get(), 0));
+}
+
+// Archived rows keep their row_key and all precede the live ones, so the archive is
+// read first; with a current snapshot its range scan finds nothing. Both scans share one
+// read transaction, so rows archived by a concurrent commit are seen exactly once.
+void SqliteRepository::VisitRewardLedgerAfter(
+    const uint64_t after_sequence,
+    const RewardLedgerVisitor& visitor) const {
+  static const std::string archived_sql = LedgerSelectSql("reward_events_archive");
+  static const std::string live_sql = LedgerSelectSql("reward_events");
+  ReadLease reader(*this);
+  reader.HoldSnapshot();
+  {
+    Statement archived(reader.statements(), archived_sql);
+    if (!VisitLedgerRows(reader.db(), archived.get(), kRewardEventTable, after_sequence, visitor)) {
+      return;
     }
-    CheckResult(rc, db_, "ListQuests failed");
+  }
+
+  Statement statement(reader.statements(), live_sql);
+  VisitLedgerRows(reader.db(), statement.get(), kRewardEventTable, after_sequence, visitor);
+}
 
-    domain::Quest quest{};
-    quest.id = ColumnText(statement.get(), 0);
-    quest.title = ColumnText(statement.get(), 1);
-    quest.track_type = domain::TrackTypeFromString(ColumnText(statement.get(), 2));
-    quest.is_completed = sqlite3_column_int(statement.get(), 3) == 1;
-    quest.created_at = ColumnText(statement.get(), 4);
-    quests.push_back(std::move(quest));
+domain::UserState SqliteRepository::LoadUserState() const {
+  const ReadLease reader(*this);
+  Statement statement(
+      reader.statements(),
+      "SELECT level, total_xp, life_xp, learning_xp, recovery_tokens FROM user_state WHERE id = 1;");
+
+  const int rc = sqlite3_step(statement.get());
+  if (rc == SQLITE_DONE) {
+    return {};
   }
+  CheckResult(rc, reader.db(), "LoadUserState failed");
 
-  return quests;
+  domain::UserState state{};
+  state.level = sqlite3_column_int(statement.get(), 0);
+  state.total_xp = sqlite3_column_int(statement.get(), 1);
+  state.life_xp = sqlite3_column_int(statement.get(), 2);
+  state.learning_xp = sqlite3_column_int(statement.get(), 3);
+  state.recovery_tokens = sqlite3_column_int(statement.get(), 4);
+  return state;
 }
 
-void SqliteRepository::UpsertActionUnit(const domain::ActionUnit& action_unit) {
+void SqliteRepository::SaveUserState(const domain::UserState& user_state) {
+  const WriteLock lock(*this);
   Statement statement(
-      db_,
+      statements_,
       R"SQL(
-        INSERT INTO action_units(
-          id,
-          parent_id,
-          title,
-          track_type,
-          status,
-          runtime_state,
-          priority_score,
-          started_at,
-          completed_at
-        )
-        VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?)
+        INSERT INTO user_state(id, level, total_xp, life_xp, learning_xp, recovery_tokens)
+        VALUES(1, ?, ?, ?, ?, ?)
         ON CONFLICT(id) DO UPDATE SET
-          parent_id = excluded.parent_id,
-          title = excluded.title,
-          track_type = excluded.track_type,
-          status = excluded.status,
-          runtime_state = excluded.runtime_state,
-          priority_score = excluded.priority_score,
-          started_at = excluded.started_at,
-          completed_at = excluded.completed_at;
+          level = excluded.level,
+          total_xp = excluded.total_xp,
+          life_xp = excluded.life_xp,
+          learning_xp = excluded.learning_xp,
+          recovery_tokens = excluded.recovery_tokens;
+      )SQL");
+
+  BindInt(db_, statement.get(), 1, user_state.level);
+  BindInt(db_, statement.get(), 2, user_state.total_xp);
+  BindInt(db_, statement.get(), 3, user_state.life_xp);
+  BindInt(db_, statement.get(), 4, user_state.learning_xp);
+  BindInt(db_, statement.get(), 5, user_state.recovery_tokens);
+
+  CheckResult(sqlite3_step(statement.get()), db_, "SaveUserState failed");
+  RecordChange(ChangeTable::UserState, {});
+}
+
+void SqliteRepository::SaveUserStateSnapshot(const UserStateSnapshot& snapshot) {
+  const WriteLock lock(*this);
+  Statement statement(
+      statements_,
+      R"SQL(
+        INSERT INTO user_state_snapshots(
+          through_reward_key,
+          level,
+          total_xp,
+          life_xp,
+          learning_xp,
+          recovery_tokens,
+          created_at
+        )
+        VALUES(?, ?, ?, ?, ?, ?, ?)
+        ON CONFLICT(through_reward_key) DO UPDATE SET
+          level = excluded.level,
+          total_xp = excluded.total_xp,
+          life_xp = excluded.life_xp,
+          learning_xp = excluded.learning_xp,
+          recovery_tokens = excluded.recovery_tokens,
+          created_at = excluded.created_at;
       )SQL");
 
-  BindText(db_, statement.get(), 1, action_unit.id);
-  BindText(db_, statement.get(), 2, action_unit.parent_id);
-  BindText(db_, statement.get(), 3, action_unit.title);
-  BindText(db_, statement.get(), 4, std::string(domain::TrackTypeToString(action_unit.track_type)));
-  const auto status = StatusFromLifecycle(action_unit.lifecycle_state);
-  BindText(db_, statement.get(), 5, std::string(domain::ActionStatusToString(status)));
-  BindText(db_, statement.get(), 6, std::string(domain::LifecycleStateToString(action_unit.lifecycle_state)));
-  BindInt(db_, statement.get(), 7, std::max(action_unit.priority_score, 0));
-  BindText(db_, statement.get(), 8, action_unit.started_at);
-  BindText(db_, statement.get(), 9, action_unit.completed_at);
+  const int rc_bind = sqlite3_bind_int64(statement.get(), 1, static_cast<sqlite3_int64>(snapshot.through_sequence));
+  CheckResult(rc_bind, db_, "sqlite3_bind_int64 failed");
+  BindInt(db_, statement.get(), 2, snapshot.user_state.level);
+  BindInt(db_, statement.get(), 3, snapshot.user_state.total_xp);
+  BindInt(db_, statement.get(), 4, snapshot.user_state.life_xp);
+  BindInt(db_, statement.get(), 5, snapshot.user_state.learning_xp);
+  BindInt(db_, statement.get(), 6, snapshot.user_state.recovery_tokens);
+  BindTimestamp(db_, statement.get(), 7, snapshot.created_at);
 
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertActionUnit failed");
+  CheckResult(sqlite3_step(statement.get()), db_, "SaveUserStateSnapshot failed");
 }
 
-std::optional<domain::ActionUnit> SqliteRepository::FindActionUnitById(const std::string& id) const {
+std::optional<UserStateSnapshot> SqliteRepository::LoadLatestUserStateSnapshot() const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        SELECT id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at
-        FROM action_units
-        WHERE id = ? LIMIT 1;
+        SELECT through_reward_key, level, total_xp, life_xp, learning_xp, recovery_tokens, created_at
+        FROM user_state_snapshots
+        ORDER BY through_reward_key DESC
+        LIMIT 1;
       )SQL");
 
-  BindText(db_, statement.get(), 1, id);
-
   const int rc = sqlite3_step(statement.get());
   if (rc == SQLITE_DONE) {
     return std::nullopt;
   }
-  CheckResult(rc, db_, "FindActionUnitById failed");
-
-  domain::ActionUnit action_unit{};
-  action_unit.id = ColumnText(statement.get(), 0);
-  action_unit.parent_id = ColumnText(statement.get(), 1);
-  action_unit.title = ColumnText(statement.get(), 2);
-  action_unit.track_type = domain::TrackTypeFromString(ColumnText(statement.get(), 3));
-  action_unit.status = domain::ActionStatusFromString(ColumnText(statement.get(), 4));
-  const auto lifecycle_raw = ColumnText(statement.get(), 5);
-  if (lifecycle_raw.empty()) {
-    action_unit.lifecycle_state = LifecycleFromLegacyStatus(action_unit.status);
-  } else {
-    action_unit.lifecycle_state = domain::LifecycleStateFromString(lifecycle_raw);
-  }
-  action_unit.priority_score = sqlite3_column_int(statement.get(), 6);
-  action_unit.started_at = ColumnText(statement.get(), 7);
-  action_unit.completed_at = ColumnText(statement.get(), 8);
-  return action_unit;
+  CheckResult(rc, reader.db(), "LoadLatestUserStateSnapshot failed");
+
+  UserStateSnapshot snapshot{};
+  snapshot.through_sequence = static_cast<uint64_t>(sqlite3_column_int64(statement.get(), 0));
+  snapshot.user_state.level = sqlite3_column_int(statement.get(), 1);
+  snapshot.user_state.total_xp = sqlite3_column_int(statement.get(), 2);
+  snapshot.user_state.life_xp = sqlite3_column_int(statement.get(), 3);
+  snapshot.user_state.learning_xp = sqlite3_column_int(statement.get(), 4);
+  snapshot.user_state.recovery_tokens = sqlite3_column_int(statement.get(), 5);
+  snapshot.created_at = ColumnTimestamp(statement.get(), 6);
+  return snapshot;
 }
 
-std::vector<domain::ActionUnit> SqliteRepository::ListActionUnitsByTrack(const domain::TrackType track_type) const {
+std::vector<DailyXpPoint> SqliteRepository::ListDailyXp(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        SELECT id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at
-        FROM action_units
-        WHERE track_type = ?
-        ORDER BY id ASC;
+        SELECT
+          day,
+          SUM(CASE WHEN track_type = 0 THEN xp_total ELSE 0 END),
+          SUM(CASE WHEN track_type = 1 THEN xp_total ELSE 0 END),
+          SUM(event_count)
+        FROM reward_daily_rollups
+        WHERE day >= ? AND day < ?
+        GROUP BY day
+        ORDER BY day ASC;
       )SQL");
 
-  BindText(db_, statement.get(), 1, std::string(domain::TrackTypeToString(track_type)));
+  BindEpochDayRange(reader.db(), statement.get(), from_day, until_day);
 
-  std::vector<domain::ActionUnit> action_units;
+  std::vector<DailyXpPoint> points;
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
       break;
     }
-    CheckResult(rc, db_, "ListActionUnitsByTrack failed");
-
-    domain::ActionUnit action_unit{};
-    action_unit.id = ColumnText(statement.get(), 0);
-    action_unit.parent_id = ColumnText(statement.get(), 1);
-    action_unit.title = ColumnText(statement.get(), 2);
-    action_unit.track_type = domain::TrackTypeFromString(ColumnText(statement.get(), 3));
-    action_unit.status = domain::ActionStatusFromString(ColumnText(statement.get(), 4));
-    const auto lifecycle_raw = ColumnText(statement.get(), 5);
-    if (lifecycle_raw.empty()) {
-      action_unit.lifecycle_state = LifecycleFromLegacyStatus(action_unit.status);
-    } else {
-      action_unit.lifecycle_state = domain::LifecycleStateFromString(lifecycle_raw);
-    }
-    action_unit.priority_score = sqlite3_column_int(statement.get(), 6);
-    action_unit.started_at = ColumnText(statement.get(), 7);
-    action_unit.completed_at = ColumnText(statement.get(), 8);
-    action_units.push_back(std::move(action_unit));
+    CheckResult(rc, reader.db(), "ListDailyXp failed");
+
+    DailyXpPoint point{};
+    point.day = EpochDayToString(sqlite3_column_int64(statement.get(), 0));
+    point.life_xp = sqlite3_column_int(statement.get(), 1);
+    point.learning_xp = sqlite3_column_int(statement.get(), 2);
+    point.reward_events = sqlite3_column_int(statement.get(), 3);
+    points.push_back(std::move(point));
   }
 
-  return action_units;
-}
-
-void SqliteRepository::UpsertLearningGoal(const domain::LearningGoal& goal) {
-  Statement statement(
-      db_,
-      R"SQL(
-        INSERT INTO learning_goals(id, title, milestone, confidence_level, created_at)
-        VALUES(?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          title = excluded.title,
-          milestone = excluded.milestone,
-          confidence_level = excluded.confidence_level;
-      )SQL");
-
-  BindText(db_, statement.get(), 1, goal.id);
-  BindText(db_, statement.get(), 2, goal.title);
-  BindText(db_, statement.get(), 3, goal.milestone);
-  BindInt(db_, statement.get(), 4, goal.confidence_level);
-  BindText(db_, statement.get(), 5, goal.created_at);
-
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertLearningGoal failed");
+  return points;
 }
 
-std::optional<domain::LearningGoal> SqliteRepository::FindLearningGoalById(const std::string& id) const {
+std::vector<LearningMinutesPoint> SqliteRepository::ListDailyLearningMinutes(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        SELECT id, title, milestone, confidence_level, created_at
-        FROM learning_goals
-        WHERE id = ?
-        LIMIT 1;
+        SELECT day, minutes, completed_sessions
+        FROM learning_daily_rollups
+        WHERE day >= ? AND day < ? AND completed_sessions > 0
+        ORDER BY day ASC;
       )SQL");
 
-  BindText(db_, statement.get(), 1, id);
-
-  const int rc = sqlite3_step(statement.get());
-  if (rc == SQLITE_DONE) {
-    return std::nullopt;
-  }
-  CheckResult(rc, db_, "FindLearningGoalById failed");
-
-  domain::LearningGoal goal{};
-  goal.id = ColumnText(statement.get(), 0);
-  goal.title = ColumnText(statement.get(), 1);
-  goal.milestone = ColumnText(statement.get(), 2);
-  goal.confidence_level = sqlite3_column_int(statement.get(), 3);
-  goal.created_at = ColumnText(statement.get(), 4);
-  return goal;
-}
-
-std::vector<domain::LearningGoal> SqliteRepository::ListLearningGoals() const {
-  Statement statement(
-      db_,
-      R"SQL(
-        SELECT id, title, milestone, confidence_level, created_at
-        FROM learning_goals
-        ORDER BY created_at ASC;
-      )SQL");
+  BindEpochDayRange(reader.db(), statement.get(), from_day, until_day);
 
-  std::vector<domain::LearningGoal> goals;
+  std::vector<LearningMinutesPoint> points;
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
       break;
     }
-    CheckResult(rc, db_, "ListLearningGoals failed");
+    CheckResult(rc, reader.db(), "ListDailyLearningMinutes failed");
 
-    domain::LearningGoal goal{};
-    goal.id = ColumnText(statement.get(), 0);
-    goal.title = ColumnText(statement.get(), 1);
-    goal.milestone = ColumnText(statement.get(), 2);
-    goal.confidence_level = sqlite3_column_int(statement.get(), 3);
-    goal.created_at = ColumnText(statement.get(), 4);
-    goals.push_back(std::move(goal));
+    LearningMinutesPoint point{};
+    point.period_start = EpochDayToString(sqlite3_column_int64(statement.get(), 0));
+    point.minutes = sqlite3_column_int(statement.get(), 1);
+    point.completed_sessions = sqlite3_column_int(statement.get(), 2);
+    points.push_back(std::move(point));
   }
 
-  return goals;
-}
-
-void SqliteRepository::UpsertLearningSession(const domain::LearningSession& session) {
-  Statement statement(
-      db_,
-      R"SQL(
-        INSERT INTO learning_sessions(
-          id,
-          goal_id,
-          title,
-          lifecycle_state,
-          priority_score,
-          duration_minutes,
-          artifact_kind,
-          artifact_ref,
-          checkpoint_note,
-          started_at,
-          completed_at
-        )
-        VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          goal_id = excluded.goal_id,
-          title = excluded.title,
-          lifecycle_state = excluded.lifecycle_state,
-          priority_score = excluded.priority_score,
-          duration_minutes = excluded.duration_minutes,
-          artifact_kind = excluded.artifact_kind,
-          artifact_ref = excluded.artifact_ref,
-          checkpoint_note = excluded.checkpoint_note,
-          started_at = excluded.started_at,
-          completed_at = excluded.completed_at;
-      )SQL");
-
-  BindText(db_, statement.get(), 1, session.id);
-  BindText(db_, statement.get(), 2, session.goal_id);
-  BindText(db_, statement.get(), 3, session.title);
-  BindText(db_, statement.get(), 4, std::string(domain::LifecycleStateToString(session.lifecycle_state)));
-  BindInt(db_, statement.get(), 5, std::max(session.priority_score, 0));
-  BindInt(db_, statement.get(), 6, std::max(session.duration_minutes, 0));
-  BindText(db_, statement.get(), 7, session.artifact_kind);
-  BindText(db_, statement.get(), 8, session.artifact_ref);
-  BindText(db_, statement.get(), 9, session.checkpoint_note);
-  BindText(db_, statement.get(), 10, session.started_at);
-  BindText(db_, statement.get(), 11, session.completed_at);
-
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertLearningSession failed");
+  return points;
 }
 
-std::vector<domain::LearningSession> SqliteRepository::ListLearningSessionsByGoal(const std::string& goal_id) const {
+std::vector<LearningMinutesPoint> SqliteRepository::ListWeeklyLearningMinutes(
+    const std::string& from_day,
+    const std::string& until_day) const {
+  const ReadLease reader(*this);
+  // Epoch day 4 (1970-01-05) is a Monday, so (day + 3) / 7 numbers Monday-based weeks.
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        SELECT
-          id,
-          goal_id,
-          title,
-          lifecycle_state,
-          priority_score,
-          duration_minutes,
-          artifact_kind,
-          artifact_ref,
-          checkpoint_note,
-          started_at,
-          completed_at
-        FROM learning_sessions
-        WHERE goal_id = ?
-        ORDER BY COALESCE(completed_at, started_at, id) ASC;
+        SELECT (day + 3) / 7 AS week, SUM(minutes), SUM(completed_sessions)
+        FROM learning_daily_rollups
+        WHERE day >= ? AND day < ? AND completed_sessions > 0
+        GROUP BY week
+        ORDER BY week ASC;
       )SQL");
 
-  BindText(db_, statement.get(), 1, goal_id);
+  BindEpochDayRange(reader.db(), statement.get(), from_day, until_day);
 
-  std::vector<domain::LearningSession> sessions;
+  std::vector<LearningMinutesPoint> points;
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
       break;
     }
-    CheckResult(rc, db_, "ListLearningSessionsByGoal failed");
+    CheckResult(rc, reader.db(), "ListWeeklyLearningMinutes failed");
 
-    domain::LearningSession session{};
-    session.id = ColumnText(statement.get(), 0);
-    session.goal_id = ColumnText(statement.get(), 1);
-    session.title = ColumnText(statement.get(), 2);
-    const auto lifecycle_raw = ColumnText(statement.get(), 3);
-    session.lifecycle_state = lifecycle_raw.empty() ? domain::LifecycleState::Completed
-                                                    : domain::LifecycleStateFromString(lifecycle_raw);
-    session.priority_score = sqlite3_column_int(statement.get(), 4);
-    session.duration_minutes = sqlite3_column_int(statement.get(), 5);
-    session.artifact_kind = ColumnText(statement.get(), 6);
-    session.artifact_ref = ColumnText(statement.get(), 7);
-    session.checkpoint_note = ColumnText(statement.get(), 8);
-    session.started_at = ColumnText(statement.get(), 9);
-    session.completed_at = ColumnText(statement.get(), 10);
-    sessions.push_back(std::move(session));
+    LearningMinutesPoint point{};
+    point.period_start = EpochDayToString(sqlite3_column_int64(statement.get(), 0) * 7 - 3);
+    point.minutes = sqlite3_column_int(statement.get(), 1);
+    point.completed_sessions = sqlite3_column_int(statement.get(), 2);
+    points.push_back(std::move(point));
   }
 
-  return sessions;
+  return points;
 }
 
-std::vector<domain::LearningSession> SqliteRepository::ListLearningSessions() const {
+TrackXpTotals SqliteRepository::LoadTrackXpTotals() const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
-      R"SQL(
-        SELECT
-          id,
-          goal_id,
-          title,
-          lifecycle_state,
-          priority_score,
-          duration_minutes,
-          artifact_kind,
-          artifact_ref,
-          checkpoint_note,
-          started_at,
-          completed_at
-        FROM learning_sessions
-        ORDER BY id ASC;
-      )SQL");
+      reader.statements(),
+      "SELECT track_type, SUM(xp_total), SUM(event_count) FROM reward_daily_rollups GROUP BY track_type;");
 
-  std::vector<domain::LearningSession> sessions;
+  TrackXpTotals totals{};
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
       break;
     }
-    CheckResult(rc, db_, "ListLearningSessions failed");
+    CheckResult(rc, reader.db(), "LoadTrackXpTotals failed");
 
-    domain::LearningSession session{};
-    session.id = ColumnText(statement.get(), 0);
-    session.goal_id = ColumnText(statement.get(), 1);
-    session.title = ColumnText(statement.get(), 2);
-    const auto lifecycle_raw = ColumnText(statement.get(), 3);
-    session.lifecycle_state = lifecycle_raw.empty() ? domain::LifecycleState::Completed
-                                                    : domain::LifecycleStateFromString(lifecycle_raw);
-    session.priority_score = sqlite3_column_int(statement.get(), 4);
-    session.duration_minutes = sqlite3_column_int(statement.get(), 5);
-    session.artifact_kind = ColumnText(statement.get(), 6);
-    session.artifact_ref = ColumnText(statement.get(), 7);
-    session.checkpoint_note = ColumnText(statement.get(), 8);
-    session.started_at = ColumnText(statement.get(), 9);
-    session.completed_at = ColumnText(statement.get(), 10);
-    sessions.push_back(std::move(session));
+    const int xp_total = sqlite3_column_int(statement.get(), 1);
+    if (TrackTypeFromStorage(sqlite3_column_int(statement.get(), 0)) == domain::TrackType::Life) {
+      totals.life_xp = xp_total;
+    } else {
+      totals.learning_xp = xp_total;
+    }
+    totals.reward_events += sqlite3_column_int(statement.get(), 2);
   }
 
-  return sessions;
+  return totals;
 }
 
-void SqliteRepository::UpsertMilestoneCheckpoint(const domain::MilestoneCheckpoint& checkpoint) {
-  Statement statement(
-      db_,
-      R"SQL(
-        INSERT INTO milestone_checkpoints(
-          id,
-          goal_id,
-          learning_session_id,
-          milestone_key,
-          state,
-          evidence_kind,
-          evidence_ref,
-          confidence_level,
-          candidate_reason,
-          reward_event_id,
-          submitted_at,
-          reviewed_at,
-          confirmed_at,
-          rejected_at,
-          created_at,
-          updated_at
-        )
-        VALUES(?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          goal_id = excluded.goal_id,
-          learning_session_id = excluded.learning_session_id,
-          milestone_key = excluded.milestone_key,
-          state = excluded.state,
-          evidence_kind = excluded.evidence_kind,
-          evidence_ref = excluded.evidence_ref,
-          confidence_level = excluded.confidence_level,
-          candidate_reason = excluded.candidate_reason,
-          reward_event_id = excluded.reward_event_id,
-          submitted_at = excluded.submitted_at,
-          reviewed_at = excluded.reviewed_at,
-          confirmed_at = excluded.confirmed_at,
-          rejected_at = excluded.rejected_at,
-          created_at = excluded.created_at,
-          updated_at = excluded.updated_at;
-      )SQL");
-
-  BindText(db_, statement.get(), 1, checkpoint.id);
-  BindText(db_, statement.get(), 2, checkpoint.goal_id);
-  BindText(db_, statement.get(), 3, checkpoint.learning_session_id);
-  BindText(db_, statement.get(), 4, checkpoint.milestone_key);
-  BindText(db_, statement.get(), 5, std::string(domain::MilestoneCheckpointStateToString(checkpoint.state)));
-  BindText(db_, statement.get(), 6, checkpoint.evidence_kind);
-  BindText(db_, statement.get(), 7, checkpoint.evidence_ref);
-  BindInt(db_, statement.get(), 8, std::clamp(checkpoint.confidence_level, 1, 5));
-  BindText(db_, statement.get(), 9, checkpoint.candidate_reason);
-  BindText(db_, statement.get(), 10, checkpoint.reward_event_id);
-  BindText(db_, statement.get(), 11, checkpoint.submitted_at);
-  BindText(db_, statement.get(), 12, checkpoint.reviewed_at);
-  BindText(db_, statement.get(), 13, checkpoint.confirmed_at);
-  BindText(db_, statement.get(), 14, checkpoint.rejected_at);
-  BindText(db_, statement.get(), 15, checkpoint.created_at);
-  BindText(db_, statement.get(), 16, checkpoint.updated_at);
-
-  CheckResult(sqlite3_step(statement.get()), db_, "UpsertMilestoneCheckpoint failed");
-}
+ArchiveSummary SqliteRepository::ArchiveCompletedBefore(const std::string& completed_before) {
+  const int64_t horizon_ms = TimestampToStorage(completed_before);
+  const int64_t archived_at_ms = TimestampToStorage(domain::CurrentTimestampUtc());
 
-std::optional<domain::MilestoneCheckpoint> SqliteRepository::FindMilestoneCheckpointById(const std::string& id) const {
-  Statement statement(
+  UnitOfWork unit_of_work(*this);
+  ArchiveSummary summary{};
+  summary.action_units = MoveRows(
+      statements_,
       db_,
       R"SQL(
+        INSERT INTO action_units_archive(
+          id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at,
+          archived_at)
         SELECT
-          id,
-          goal_id,
-          learning_session_id,
-          milestone_key,
-          state,
-          evidence_kind,
-          evidence_ref,
-          confidence_level,
-          candidate_reason,
-          reward_event_id,
-          submitted_at,
-          reviewed_at,
-          confirmed_at,
-          rejected_at,
-          created_at,
-          updated_at
-        FROM milestone_checkpoints
-        WHERE id = ?
-        LIMIT 1;
-      )SQL");
-
-  BindText(db_, statement.get(), 1, id);
-
-  const int rc = sqlite3_step(statement.get());
-  if (rc == SQLITE_DONE) {
-    return std::nullopt;
-  }
-  CheckResult(rc, db_, "FindMilestoneCheckpointById failed");
-
-  domain::MilestoneCheckpoint checkpoint{};
-  checkpoint.id = ColumnText(statement.get(), 0);
-  checkpoint.goal_id = ColumnText(statement.get(), 1);
-  checkpoint.learning_session_id = ColumnText(statement.get(), 2);
-  checkpoint.milestone_key = ColumnText(statement.get(), 3);
-  checkpoint.state = domain::MilestoneCheckpointStateFromString(ColumnText(statement.get(), 4));
-  checkpoint.evidence_kind = ColumnText(statement.get(), 5);
-  checkpoint.evidence_ref = ColumnText(statement.get(), 6);
-  checkpoint.confidence_level = sqlite3_column_int(statement.get(), 7);
-  checkpoint.candidate_reason = ColumnText(statement.get(), 8);
-  checkpoint.reward_event_id = ColumnText(statement.get(), 9);
-  checkpoint.submitted_at = ColumnText(statement.get(), 10);
-  checkpoint.reviewed_at = ColumnText(statement.get(), 11);
-  checkpoint.confirmed_at = ColumnText(statement.get(), 12);
-  checkpoint.rejected_at = ColumnText(statement.get(), 13);
-  checkpoint.created_at = ColumnText(statement.get(), 14);
-  checkpoint.updated_at = ColumnText(statement.get(), 15);
-  return checkpoint;
-}
-
-std::vector<domain::MilestoneCheckpoint> SqliteRepository::ListMilestoneCheckpointsByGoal(
-    const std::string& goal_id) const {
-  Statement statement(
+          id, parent_id, title, track_type, status, runtime_state, priority_score, started_at, completed_at, ?2
+        FROM action_units
+        WHERE status = ?3 AND completed_at < ?1
+        ORDER BY row_key ASC;
+      )SQL",
+      "DELETE FROM action_units WHERE status = ?3 AND completed_at < ?1 RETURNING id;",
+      horizon_ms,
+      archived_at_ms,
+      ActionStatusToStorage(domain::ActionStatus::Completed),
+      [this](const std::string& id) { StageChange({ChangeTable::ActionUnits, id, ChangeOperation::Delete}); });
+
+  summary.learning_sessions = MoveRows(
+      statements_,
       db_,
       R"SQL(
+        INSERT INTO learning_sessions_archive(
+          id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, artifact_ref,
+          checkpoint_note, started_at, completed_at, archived_at)
         SELECT
-          id,
-          goal_id,
-          learning_session_id,
-          milestone_key,
-          state,
-          evidence_kind,
-          evidence_ref,
-          confidence_level,
-          candidate_reason,
-          reward_event_id,
-          submitted_at,
-          reviewed_at,
-          confirmed_at,
-          rejected_at,
-          created_at,
-          updated_at
-        FROM milestone_checkpoints
-        WHERE goal_id = ?
-        ORDER BY submitted_at ASC;
-      )SQL");
-
-  BindText(db_, statement.get(), 1, goal_id);
-
-  std::vector<domain::MilestoneCheckpoint> checkpoints;
-  while (true) {
-    const int rc = sqlite3_step(statement.get());
-    if (rc == SQLITE_DONE) {
-      break;
-    }
-    CheckResult(rc, db_, "ListMilestoneCheckpointsByGoal failed");
-
-    domain::MilestoneCheckpoint checkpoint{};
-    checkpoint.id = ColumnText(statement.get(), 0);
-    checkpoint.goal_id = ColumnText(statement.get(), 1);
-    checkpoint.learning_session_id = ColumnText(statement.get(), 2);
-    checkpoint.milestone_key = ColumnText(statement.get(), 3);
-    checkpoint.state = domain::MilestoneCheckpointStateFromString(ColumnText(statement.get(), 4));
-    checkpoint.evidence_kind = ColumnText(statement.get(), 5);
-    checkpoint.evidence_ref = ColumnText(statement.get(), 6);
-    checkpoint.confidence_level = sqlite3_column_int(statement.get(), 7);
-    checkpoint.candidate_reason = ColumnText(statement.get(), 8);
-    checkpoint.reward_event_id = ColumnText(statement.get(), 9);
-    checkpoint.submitted_at = ColumnText(statement.get(), 10);
-    checkpoint.reviewed_at = ColumnText(statement.get(), 11);
-    checkpoint.confirmed_at = ColumnText(statement.get(), 12);
-    checkpoint.rejected_at = ColumnText(statement.get(), 13);
-    checkpoint.created_at = ColumnText(statement.get(), 14);
-    checkpoint.updated_at = ColumnText(statement.get(), 15);
-    checkpoints.push_back(std::move(checkpoint));
+          id, goal_id, title, lifecycle_state, priority_score, duration_minutes, artifact_kind, artifact_ref,
+          checkpoint_note, started_at, completed_at, ?2
+        FROM learning_sessions
+        WHERE lifecycle_state = ?3 AND completed_at < ?1
+          AND NOT EXISTS (
+            SELECT 1 FROM milestone_checkpoints WHERE learning_session_id = learning_sessions.id)
+        ORDER BY row_key ASC;
+      )SQL",
+      R"SQL(
+        DELETE FROM learning_sessions
+        WHERE lifecycle_state = ?3 AND completed_at < ?1
+          AND NOT EXISTS (
+            SELECT 1 FROM milestone_checkpoints WHERE learning_session_id = learning_sessions.id)
+        RETURNING id;
+      )SQL",
+      horizon_ms,
+      archived_at_ms,
+      LifecycleStateToStorage(domain::LifecycleState::Completed),
+      [this](const std::string& id) {
+        StageChange({ChangeTable::LearningSessions, id, ChangeOperation::Delete});
+      });
+
+  int64_t ledger_cutoff = 0;
+  {
+    Statement cutoff(
+        statements_,
+        R"SQL(
+          SELECT MIN(
+            (SELECT COALESCE(MAX(through_reward_key), 0) FROM user_state_snapshots),
+            (SELECT COALESCE(MAX(row_key), 0) - 1 FROM reward_events),
+            COALESCE(
+              (SELECT MIN(row_key) FROM reward_events WHERE created_at >= ?1) - 1,
+              (SELECT COALESCE(MAX(row_key), 0) FROM reward_events)));
+        )SQL");
+    CheckResult(sqlite3_bind_int64(cutoff.get(), 1, horizon_ms), db_, "sqlite3_bind_int64 failed");
+    const int rc = sqlite3_step(cutoff.get());
+    CheckResult(rc, db_, "ArchiveCompletedBefore ledger cutoff failed");
+    ledger_cutoff = sqlite3_column_int64(cutoff.get(), 0);
+  }
+  if (ledger_cutoff > 0) {
+    summary.reward_events = MoveRows(
+        statements_,
+        db_,
+        R"SQL(
+          INSERT INTO reward_events_archive(
+            row_key, id, source_type, source_id, track_type, xp_delta, reward_kind, created_at, archived_at)
+          SELECT row_key, id, source_type, source_id, track_type, xp_delta, reward_kind, created_at, ?2
+          FROM reward_events
+          WHERE row_key <= ?1;
+        )SQL",
+        "DELETE FROM reward_events WHERE row_key <= ?1 RETURNING id;",
+        ledger_cutoff,
+        archived_at_ms,
+        std::nullopt,
+        [this](const std::string& id) { StageChange({ChangeTable::RewardEvents, id, ChangeOperation::Delete}); });
   }
 
-  return checkpoints;
+  unit_of_work.Commit();
+  return summary;
 }
 
-std::vector<domain::MilestoneCheckpoint> SqliteRepository::ListMilestoneCheckpoints() const {
+ArchiveSummary SqliteRepository::CountArchivedRows() const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
         SELECT
-          id,
-          goal_id,
-          learning_session_id,
-          milestone_key,
-          state,
-          evidence_kind,
-          evidence_ref,
-          confidence_level,
-          candidate_reason,
-          reward_event_id,
-          submitted_at,
-          reviewed_at,
-          confirmed_at,
-          rejected_at,
-          created_at,
-          updated_at
-        FROM milestone_checkpoints
-        ORDER BY submitted_at ASC;
+          (SELECT COUNT(*) FROM action_units_archive),
+          (SELECT COUNT(*) FROM learning_sessions_archive),
+          (SELECT COUNT(*) FROM reward_events_archive);
       )SQL");
 
-  std::vector<domain::MilestoneCheckpoint> checkpoints;
-  while (true) {
-    const int rc = sqlite3_step(statement.get());
-    if (rc == SQLITE_DONE) {
-      break;
-    }
-    CheckResult(rc, db_, "ListMilestoneCheckpoints failed");
+  const int rc = sqlite3_step(statement.get());
+  CheckResult(rc, reader.db(), "CountArchivedRows failed");
 
-    domain::MilestoneCheckpoint checkpoint{};
-    checkpoint.id = ColumnText(statement.get(), 0);
-    checkpoint.goal_id = ColumnText(statement.get(), 1);
-    checkpoint.learning_session_id = ColumnText(statement.get(), 2);
-    checkpoint.milestone_key = ColumnText(statement.get(), 3);
-    checkpoint.state = domain::MilestoneCheckpointStateFromString(ColumnText(statement.get(), 4));
-    checkpoint.evidence_kind = ColumnText(statement.get(), 5);
-    checkpoint.evidence_ref = ColumnText(statement.get(), 6);
-    checkpoint.confidence_level = sqlite3_column_int(statement.get(), 7);
-    checkpoint.candidate_reason = ColumnText(statement.get(), 8);
-    checkpoint.reward_event_id = ColumnText(statement.get(), 9);
-    checkpoint.submitted_at = ColumnText(statement.get(), 10);
-    checkpoint.reviewed_at = ColumnText(statement.get(), 11);
-    checkpoint.confirmed_at = ColumnText(statement.get(), 12);
-    checkpoint.rejected_at = ColumnText(statement.get(), 13);
-    checkpoint.created_at = ColumnText(statement.get(), 14);
-    checkpoint.updated_at = ColumnText(statement.get(), 15);
-    checkpoints.push_back(std::move(checkpoint));
-  }
+  ArchiveSummary summary{};
+  summary.action_units = static_cast<size_t>(sqlite3_column_int64(statement.get(), 0));
+  summary.learning_sessions = static_cast<size_t>(sqlite3_column_int64(statement.get(), 1));
+  summary.reward_events = static_cast<size_t>(sqlite3_column_int64(statement.get(), 2));
+  return summary;
+}
 
-  return checkpoints;
+void SqliteRepository::VisitArchivedActionUnits(const RowVisitor<domain::ActionUnit>& visitor) const {
+  static const std::string sql = kActionUnitTable.SelectSql("ORDER BY row_key ASC;", "action_units_archive");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  DecodeEach(reader.db(), statement.get(), kActionUnitTable, "VisitArchivedActionUnits failed", visitor);
 }
 
-void SqliteRepository::AppendRewardEvent(const domain::RewardEvent& reward_event) {
+void SqliteRepository::VisitArchivedLearningSessions(const RowVisitor<domain::LearningSession>& visitor) const {
+  static const std::string sql = kLearningSessionTable.SelectSql("ORDER BY row_key ASC;", "learning_sessions_archive");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  DecodeEach(reader.db(), statement.get(), kLearningSessionTable, "VisitArchivedLearningSessions failed", visitor);
+}
+
+void SqliteRepository::VisitArchivedRewardEvents(const RewardLedgerVisitor& visitor) const {
+  static const std::string sql = LedgerSelectSql("reward_events_archive");
+  const ReadLease reader(*this);
+  Statement statement(reader.statements(), sql);
+  VisitLedgerRows(reader.db(), statement.get(), kRewardEventTable, 0, visitor);
+}
+
+uint64_t SqliteRepository::AppendCommand(const CommandJournalRecord& record) {
+  const WriteLock lock(*this);
   Statement statement(
-      db_,
-      R"SQL(
-        INSERT INTO reward_events(id, source_type, source_id, track_type, xp_delta, reward_kind, created_at)
-        VALUES(?, ?, ?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO NOTHING;
-      )SQL");
+      statements_,
+      "INSERT INTO command_journal(command_id, payload, recorded_at) VALUES(?, ?, ?);");
 
-  BindText(db_, statement.get(), 1, reward_event.id);
-  BindText(db_, statement.get(), 2, reward_event.source_type);
-  BindText(db_, statement.get(), 3, reward_event.source_id);
-  BindText(db_, statement.get(), 4, std::string(domain::TrackTypeToString(reward_event.track_type)));
-  BindInt(db_, statement.get(), 5, reward_event.xp_delta);
-  BindText(db_, statement.get(), 6, reward_event.reward_kind);
-  BindText(db_, statement.get(), 7, reward_event.created_at);
+  BindText(db_, statement.get(), 1, record.command_id);
+  BindText(db_, statement.get(), 2, record.payload);
+  BindTimestamp(
+      db_,
+      statement.get(),
+      3,
+      record.recorded_at.empty() ? domain::CurrentTimestampUtc() : record.recorded_at);
 
-  CheckResult(sqlite3_step(statement.get()), db_, "AppendRewardEvent failed");
+  CheckResult(sqlite3_step(statement.get()), db_, "AppendCommand failed");
+  return static_cast<uint64_t>(sqlite3_last_insert_rowid(db_));
 }
 
-std::vector<domain::RewardEvent> SqliteRepository::ListRewardEventsByTrack(const domain::TrackType track_type) const {
+void SqliteRepository::VisitCommandsAfter(const uint64_t after_sequence, const CommandJournalVisitor& visitor) const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        SELECT id, source_type, source_id, track_type, xp_delta, reward_kind, created_at
-        FROM reward_events
-        WHERE track_type = ?
-        ORDER BY created_at ASC;
+        SELECT sequence, command_id, payload, recorded_at
+        FROM command_journal
+        WHERE sequence > ?
+        ORDER BY sequence ASC;
       )SQL");
 
-  BindText(db_, statement.get(), 1, std::string(domain::TrackTypeToString(track_type)));
+  CheckResult(
+      sqlite3_bind_int64(statement.get(), 1, static_cast<sqlite3_int64>(after_sequence)),
+      reader.db(),
+      "sqlite3_bind_int64 failed");
 
-  std::vector<domain::RewardEvent> reward_events;
+  CommandJournalRecord record{};
   while (true) {
     const int rc = sqlite3_step(statement.get());
     if (rc == SQLITE_DONE) {
-      break;
+      return;
+    }
+    CheckResult(rc, reader.db(), "VisitCommandsAfter failed");
+
+    record.sequence = static_cast<uint64_t>(sqlite3_column_int64(statement.get(), 0));
+    record.command_id.assign(ColumnView(statement.get(), 1));
+    record.payload.assign(ColumnView(statement.get(), 2));
+    TimestampCodec::Read(statement.get(), 3, &record.recorded_at);
+    if (!visitor(record)) {
+      return;
     }
-    CheckResult(rc, db_, "ListRewardEventsByTrack failed");
-
-    domain::RewardEvent event{};
-    event.id = ColumnText(statement.get(), 0);
-    event.source_type = ColumnText(statement.get(), 1);
-    event.source_id = ColumnText(statement.get(), 2);
-    event.track_type = domain::TrackTypeFromString(ColumnText(statement.get(), 3));
-    event.xp_delta = sqlite3_column_int(statement.get(), 4);
-    event.reward_kind = ColumnText(statement.get(), 5);
-    event.created_at = ColumnText(statement.get(), 6);
-    reward_events.push_back(std::move(event));
   }
-
-  return reward_events;
 }
 
-domain::UserState SqliteRepository::LoadUserState() const {
-  Statement statement(
+void SqliteRepository::TruncateCommandsThrough(const uint64_t through_sequence) {
+  const WriteLock lock(*this);
+  Statement statement(statements_, "DELETE FROM command_journal WHERE sequence <= ?;");
+  CheckResult(
+      sqlite3_bind_int64(statement.get(), 1, static_cast<sqlite3_int64>(through_sequence)),
       db_,
-      "SELECT level, total_xp, life_xp, learning_xp, recovery_tokens FROM user_state WHERE id = 1;");
+      "sqlite3_bind_int64 failed");
+  CheckResult(sqlite3_step(statement.get()), db_, "TruncateCommandsThrough failed");
+}
 
-  const int rc = sqlite3_step(statement.get());
-  if (rc == SQLITE_DONE) {
-    return {};
+SearchPage SqliteRepository::Search(const SearchQuery& query) const {
+  if (query.page_size == 0) {
+    throw std::invalid_argument("Search requires a non-zero page_size");
   }
-  CheckResult(rc, db_, "LoadUserState failed");
 
-  domain::UserState state{};
-  state.level = sqlite3_column_int(statement.get(), 0);
-  state.total_xp = sqlite3_column_int(statement.get(), 1);
-  state.life_xp = sqlite3_column_int(statement.get(), 2);
-  state.learning_xp = sqlite3_column_int(statement.get(), 3);
-  state.recovery_tokens = sqlite3_column_int(statement.get(), 4);
-  return state;
-}
+  SearchPage page{};
+  const auto words = SplitSearchWords(query.text);
+  if (words.empty()) {
+    return page;
+  }
 
-void SqliteRepository::SaveUserState(const domain::UserState& user_state) {
+  // Every word becomes a quoted prefix term, so user input never reaches the FTS5 query
+  // syntax; terms are implicitly ANDed.
+  std::string match;
+  for (const auto& word : words) {
+    if (!match.empty()) {
+      match.push_back(' ');
+    }
+    match.append("\"").append(word).append("\"*");
+  }
+
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
-        INSERT INTO user_state(id, level, total_xp, life_xp, learning_xp, recovery_tokens)
-        VALUES(1, ?, ?, ?, ?, ?)
-        ON CONFLICT(id) DO UPDATE SET
-          level = excluded.level,
-          total_xp = excluded.total_xp,
-          life_xp = excluded.life_xp,
-          learning_xp = excluded.learning_xp,
-          recovery_tokens = excluded.recovery_tokens;
+        SELECT entity_kind, entity_id, title, snippet(search_documents, -1, '[', ']', '...', 12)
+        FROM search_documents
+        WHERE search_documents MATCH ?1 AND (?2 < 0 OR entity_kind = ?2)
+        ORDER BY rank, rowid
+        LIMIT ?3 OFFSET ?4;
       )SQL");
 
-  BindInt(db_, statement.get(), 1, user_state.level);
-  BindInt(db_, statement.get(), 2, user_state.total_xp);
-  BindInt(db_, statement.get(), 3, user_state.life_xp);
-  BindInt(db_, statement.get(), 4, user_state.learning_xp);
-  BindInt(db_, statement.get(), 5, user_state.recovery_tokens);
+  BindText(reader.db(), statement.get(), 1, match);
+  BindInt(reader.db(), statement.get(), 2, query.kind.has_value() ? SearchEntityKindToStorage(*query.kind) : -1);
+  // One extra row tells whether another page follows.
+  CheckResult(
+      sqlite3_bind_int64(statement.get(), 3, static_cast<sqlite3_int64>(query.page_size) + 1),
+      reader.db(),
+      "sqlite3_bind_int64 failed");
+  CheckResult(
+      sqlite3_bind_int64(statement.get(), 4, static_cast<sqlite3_int64>(query.offset)),
+      reader.db(),
+      "sqlite3_bind_int64 failed");
 
-  CheckResult(sqlite3_step(statement.get()), db_, "SaveUserState failed");
+  while (true) {
+    const int rc = sqlite3_step(statement.get());
+    if (rc == SQLITE_DONE) {
+      break;
+    }
+    CheckResult(rc, reader.db(), "Search failed");
+
+    if (page.hits.size() == query.page_size) {
+      page.next_offset = query.offset + query.page_size;
+      break;
+    }
+    SearchHit hit{};
+    hit.kind = SearchEntityKindFromStorage(sqlite3_column_int(statement.get(), 0));
+    hit.entity_id = domain::EntityId(ColumnView(statement.get(), 1));
+    hit.title.assign(ColumnView(statement.get(), 2));
+    hit.snippet.assign(ColumnView(statement.get(), 3));
+    page.hits.push_back(std::move(hit));
+  }
+
+  return page;
 }
 
 UiPreferences SqliteRepository::LoadUiPreferences() const {
+  const ReadLease reader(*this);
   Statement statement(
-      db_,
+      reader.statements(),
       R"SQL(
         SELECT
           preset_mode,
@@ -929,27 +1489,28 @@ UiPreferences SqliteRepository::LoadUiPreferences() const {
   if (rc == SQLITE_DONE) {
     return {};
   }
-  CheckResult(rc, db_, "LoadUiPreferences failed");
+  CheckResult(rc, reader.db(), "LoadUiPreferences failed");
 
   UiPreferences preferences{};
-  preferences.preset_mode = ui::contracts::PresetModeFromString(ColumnText(statement.get(), 0));
-  preferences.last_non_custom_preset = ui::contracts::PresetModeFromString(ColumnText(statement.get(), 1));
+  preferences.preset_mode = ui::contracts::PresetModeFromString(ColumnView(statement.get(), 0));
+  preferences.last_non_custom_preset = ui::contracts::PresetModeFromString(ColumnView(statement.get(), 1));
   if (preferences.last_non_custom_preset == ui::contracts::PresetMode::Custom) {
     preferences.last_non_custom_preset = ui::contracts::PresetMode::Calm;
   }
   preferences.motion_level = sqlite3_column_int(statement.get(), 2);
   preferences.sound_level = sqlite3_column_int(statement.get(), 3);
   preferences.density_level = sqlite3_column_int(statement.get(), 4);
-  preferences.queue_mode = ui::contracts::TrackFilterFromQueueModeString(ColumnText(statement.get(), 5));
+  preferences.queue_mode = ui::contracts::TrackFilterFromQueueModeString(ColumnView(statement.get(), 5));
   preferences.prompt_concurrency_limit = sqlite3_column_int(statement.get(), 6);
   preferences.nudge_cooldown_seconds = sqlite3_column_int(statement.get(), 7);
-  preferences.updated_at = ColumnText(statement.get(), 8);
+  preferences.updated_at.assign(ColumnView(statement.get(), 8));
   return preferences;
 }
 
 void SqliteRepository::SaveUiPreferences(const UiPreferences& preferences) {
+  const WriteLock lock(*this);
   Statement statement(
-      db_,
+      statements_,
       R"SQL(
         INSERT INTO ui_preferences(
           id,
@@ -976,31 +1537,208 @@ void SqliteRepository::SaveUiPreferences(const UiPreferences& preferences) {
           updated_at = excluded.updated_at;
       )SQL");
 
-  BindText(db_, statement.get(), 1, std::string(ui::contracts::PresetModeToString(preferences.preset_mode)));
-  BindText(
-      db_,
-      statement.get(),
-      2,
-      std::string(ui::contracts::PresetModeToString(preferences.last_non_custom_preset)));
+  BindText(db_, statement.get(), 1, ui::contracts::PresetModeToString(preferences.preset_mode));
+  BindText(db_, statement.get(), 2, ui::contracts::PresetModeToString(preferences.last_non_custom_preset));
   BindInt(db_, statement.get(), 3, preferences.motion_level);
   BindInt(db_, statement.get(), 4, preferences.sound_level);
   BindInt(db_, statement.get(), 5, preferences.density_level);
-  BindText(db_, statement.get(), 6, std::string(ui::contracts::TrackFilterToQueueModeString(preferences.queue_mode)));
+  BindText(db_, statement.get(), 6, ui::contracts::TrackFilterToQueueModeString(preferences.queue_mode));
   BindInt(db_, statement.get(), 7, preferences.prompt_concurrency_limit);
   BindInt(db_, statement.get(), 8, preferences.nudge_cooldown_seconds);
   BindText(db_, statement.get(), 9, preferences.updated_at);
 
   CheckResult(sqlite3_step(statement.get()), db_, "SaveUiPreferences failed");
+  RecordChange(ChangeTable::UiPreferences, {});
 }
 
-void SqliteRepository::ExecOrThrow(const std::string& sql) const {
-  char* error_message = nullptr;
-  const int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &error_message);
+void SqliteRepository::ApplyConnectionPragmas(sqlite3* db) const {
+  ExecOn(db, "PRAGMA mmap_size = " + std::to_string(options_.mmap_size_bytes) + ";");
+  // A negative cache_size is interpreted by SQLite as KiB rather than pages.
+  ExecOn(db, "PRAGMA cache_size = -" + std::to_string(options_.cache_size_kib) + ";");
+}
+
+void SqliteRepository::OpenReadConnections() {
+  // Separate connections to an in-memory database would each see their own empty database.
+  if (sqlite_path_.empty() || sqlite_path_ == ":memory:") {
+    return;
+  }
+
+  for (size_t i = 0; i < options_.read_connections; ++i) {
+    read_connections_.push_back(OpenReadConnection());
+  }
+
+  std::lock_guard<std::mutex> lock(read_connections_mutex_);
+  for (const auto& connection : read_connections_) {
+    idle_read_connections_.push_back(connection.get());
+  }
+}
+
+std::unique_ptr<SqliteRepository::ReadConnection> SqliteRepository::OpenReadConnection() const {
+  auto connection = std::make_unique<ReadConnection>();
+  const int rc = sqlite3_open_v2(
+      sqlite_path_.c_str(),
+      &connection->db,
+      SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+      nullptr);
   if (rc != SQLITE_OK) {
-    const std::string details = error_message != nullptr ? error_message : "unknown sqlite error";
-    sqlite3_free(error_message);
-    throw std::runtime_error("SQLite exec failed: " + details);
+    const std::string details =
+        connection->db != nullptr ? sqlite3_errmsg(connection->db) : "unknown sqlite open error";
+    throw std::runtime_error("Failed to open sqlite read connection at path " + sqlite_path_ + ": " + details);
+  }
+
+  sqlite3_busy_timeout(connection->db, options_.busy_timeout_ms);
+  connection->statements.Attach(connection->db);
+  ApplyConnectionPragmas(connection->db);
+  ExecOn(connection->db, "PRAGMA query_only = ON;");
+  return connection;
+}
+
+SqliteRepository::ReadConnection::~ReadConnection() {
+  statements.Clear();
+  sqlite3_close(db);
+}
+
+void SqliteRepository::CloseReadConnections() noexcept {
+  std::lock_guard<std::mutex> lock(read_connections_mutex_);
+  idle_read_connections_.clear();
+  read_connections_.clear();
+}
+
+bool SqliteRepository::ReadsUseWriter() const {
+  // Reads issued inside this thread's own unit of work must see its uncommitted rows.
+  return read_connections_.empty() ||
+         transaction_thread_.load(std::memory_order_acquire) == std::this_thread::get_id();
+}
+
+SqliteRepository::ReadConnection* SqliteRepository::AcquireReadConnection() const {
+  std::lock_guard<std::mutex> lock(read_connections_mutex_);
+  if (idle_read_connections_.empty()) {
+    return nullptr;
+  }
+
+  ReadConnection* connection = idle_read_connections_.back();
+  idle_read_connections_.pop_back();
+  return connection;
+}
+
+void SqliteRepository::ReleaseReadConnection(ReadConnection* connection) const {
+  if (connection == nullptr) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(read_connections_mutex_);
+  idle_read_connections_.push_back(connection);
+}
+
+void SqliteRepository::RollbackQuietly() noexcept {
+  sqlite3_exec(db_, "ROLLBACK;", nullptr, nullptr, nullptr);
+  pending_changes_.clear();
+}
+
+void SqliteRepository::OnRowChanged(
+    void* repository,
+    const int operation,
+    const char* /*database*/,
+    const char* table,
+    const sqlite3_int64 /*rowid*/) {
+  static constexpr std::pair<std::string_view, ChangeTable> kTrackedTables[] = {
+      {"habits", ChangeTable::Habits},
+      {"quests", ChangeTable::Quests},
+      {"action_units", ChangeTable::ActionUnits},
+      {"learning_goals", ChangeTable::LearningGoals},
+      {"learning_sessions", ChangeTable::LearningSessions},
+      {"milestone_checkpoints", ChangeTable::MilestoneCheckpoints},
+      {"reward_events", ChangeTable::RewardEvents},
+      {"user_state", ChangeTable::UserState},
+      {"ui_preferences", ChangeTable::UiPreferences},
+  };
+
+  // Only remember the operation here; the write path that ran the statement knows the
+  // entity id and records the change (RecordChange). Rows touched by triggers or other
+  // tables are ignored. Every statement on db_ runs under the writer lock, so the hook
+  // and the RecordChange that follows it are always on the same thread.
+  auto* self = static_cast<SqliteRepository*>(repository);
+  for (const auto& [name, tracked] : kTrackedTables) {
+    if (name == table) {
+      self->hooked_table_ = tracked;
+      self->hooked_operation_ = operation == SQLITE_INSERT   ? ChangeOperation::Insert
+                                : operation == SQLITE_DELETE ? ChangeOperation::Delete
+                                                             : ChangeOperation::Update;
+      return;
+    }
+  }
+}
+
+void SqliteRepository::RecordChange(const ChangeTable table, const std::string& id) {
+  // No hook call means the statement changed nothing (e.g. a duplicate reward event).
+  const auto hooked_table = std::exchange(hooked_table_, std::nullopt);
+  if (hooked_table == table) {
+    StageChange({table, id, hooked_operation_});
+  }
+}
+
+void SqliteRepository::StageChange(EntityChange change) {
+  hooked_table_.reset();
+  if (change_feed_.HasSubscribers()) {
+    pending_changes_.push_back(std::move(change));
+  }
+}
+
+UnitOfWork::UnitOfWork(SqliteRepository& repository)
+    : repository_(repository), writer_lock_(repository.writer_mutex_) {
+  // Only the thread holding the writer lock gets here, so a non-zero depth is its own
+  // outer unit of work.
+  if (repository_.transaction_depth_ == 0) {
+    repository_.ExecOrThrow("BEGIN IMMEDIATE;");
+    repository_.transaction_rollback_only_ = false;
+    repository_.transaction_thread_.store(std::this_thread::get_id(), std::memory_order_release);
+    owns_transaction_ = true;
+  }
+  repository_.transaction_depth_ += 1;
+}
+
+UnitOfWork::~UnitOfWork() {
+  if (finished_) {
+    return;
+  }
+
+  repository_.transaction_depth_ -= 1;
+  if (owns_transaction_) {
+    repository_.RollbackQuietly();
+    repository_.transaction_rollback_only_ = false;
+    repository_.transaction_thread_.store(std::thread::id{}, std::memory_order_release);
+  } else {
+    repository_.transaction_rollback_only_ = true;
+  }
+}
+
+void UnitOfWork::Commit() {
+  if (finished_) {
+    throw std::logic_error("UnitOfWork::Commit called twice");
+  }
+
+  if (owns_transaction_) {
+    if (repository_.transaction_rollback_only_) {
+      throw std::runtime_error("UnitOfWork commit rejected: a nested unit of work was abandoned");
+    }
+    repository_.ExecOrThrow("COMMIT;");
+    repository_.transaction_thread_.store(std::thread::id{}, std::memory_order_release);
+  }
+
+  finished_ = true;
+  repository_.transaction_depth_ -= 1;
+  std::vector<EntityChange> committed;
+  if (owns_transaction_) {
+    committed = std::exchange(repository_.pending_changes_, {});
   }
+  writer_lock_.unlock();
+  if (!committed.empty()) {
+    repository_.change_feed_.Publish(committed);
+  }
+}
+
+void SqliteRepository::ExecOrThrow(const std::string& sql) const {
+  ExecOn(db_, sql);
 }
 
 }  // namespace habitrpg::data
@@ -0,0 +1,88 @@
+#include "habitrpg/data/statement_cache.hpp"
+
+#include <stdexcept>
+#include <string>
+
+namespace habitrpg::data {
+
+StatementCache::~StatementCache() {
+  Clear();
+}
+
+void StatementCache::Attach(sqlite3* db) {
+  Clear();
+  std::lock_guard<std::mutex> lock(mutex_);
+  db_ = db;
+}
+
+StatementCache::Lease StatementCache::Acquire(const std::string_view sql) {
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto it = entries_.find(sql);
+  if (it != entries_.end() && !it->second.in_use) {
+    ++hits_;
+    it->second.in_use = true;
+    return Lease{it->second.statement, &it->second.in_use};
+  }
+
+  ++misses_;
+  sqlite3_stmt* statement = Prepare(sql);
+  if (it != entries_.end()) {
+    return Lease{statement, nullptr};
+  }
+
+  auto [inserted, _] = entries_.emplace(std::string(sql), Entry{statement, true});
+  return Lease{inserted->second.statement, &inserted->second.in_use};
+}
+
+void StatementCache::Release(const Lease& lease) {
+  if (lease.statement == nullptr) {
+    return;
+  }
+
+  if (lease.in_use == nullptr) {
+    sqlite3_finalize(lease.statement);
+    return;
+  }
+
+  sqlite3_reset(lease.statement);
+  sqlite3_clear_bindings(lease.statement);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  *lease.in_use = false;
+}
+
+void StatementCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto& [sql, entry] : entries_) {
+    sqlite3_finalize(entry.statement);
+  }
+  entries_.clear();
+}
+
+StatementCacheStats StatementCache::Stats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return StatementCacheStats{hits_, misses_, entries_.size()};
+}
+
+sqlite3_stmt* StatementCache::Prepare(const std::string_view sql) const {
+  if (db_ == nullptr) {
+    throw std::logic_error("StatementCache used before a connection was attached");
+  }
+
+  sqlite3_stmt* statement = nullptr;
+  const int rc = sqlite3_prepare_v3(
+      db_,
+      sql.data(),
+      static_cast<int>(sql.size()),
+      SQLITE_PREPARE_PERSISTENT,
+      &statement,
+      nullptr);
+  if (rc != SQLITE_OK) {
+    throw std::runtime_error("Failed to prepare statement: " + std::string(sqlite3_errmsg(db_)));
+  }
+
+  return statement;
+}
+
+}  // namespace habitrpg::data
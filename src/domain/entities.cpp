@@ -2,8 +2,6 @@
 
 #include <atomic>
 #include <chrono>
-#include <ctime>
-#include <iomanip>
 #include <sstream>
 #include <stdexcept>
 
@@ -12,17 +10,53 @@ namespace habitrpg::domain {
 namespace {
 std::atomic<uint64_t> g_id_counter{0};
 
-std::string ToIso8601Utc(std::time_t now_seconds) {
-  std::tm utc_tm{};
-#if defined(_WIN32)
-  gmtime_s(&utc_tm, &now_seconds);
-#else
-  gmtime_r(&now_seconds, &utc_tm);
-#endif
+// Howard Hinnant's days_from_civil / civil_from_days, valid for the proleptic
+// Gregorian calendar. These replace gmtime + std::put_time on the hot save path.
+int64_t DaysFromCivil(int64_t year, const unsigned month, const unsigned day) {
+  year -= month <= 2 ? 1 : 0;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const auto year_of_era = static_cast<unsigned>(year - era * 400);
+  const unsigned day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const unsigned day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + static_cast<int64_t>(day_of_era) - 719468;
+}
+
+void CivilFromDays(int64_t days, int64_t* year, unsigned* month, unsigned* day) {
+  days += 719468;
+  const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const auto day_of_era = static_cast<unsigned>(days - era * 146097);
+  const unsigned year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+  const unsigned day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const unsigned month_index = (5 * day_of_year + 2) / 153;
+  *day = day_of_year - (153 * month_index + 2) / 5 + 1;
+  *month = month_index < 10 ? month_index + 3 : month_index - 9;
+  *year = static_cast<int64_t>(year_of_era) + era * 400 + (*month <= 2 ? 1 : 0);
+}
+
+bool ParseDigits(const std::string_view text, const size_t offset, const size_t count, int* value) {
+  if (offset + count > text.size()) {
+    return false;
+  }
+
+  int result = 0;
+  for (size_t i = offset; i < offset + count; ++i) {
+    const char c = text[i];
+    if (c < '0' || c > '9') {
+      return false;
+    }
+    result = result * 10 + (c - '0');
+  }
+
+  *value = result;
+  return true;
+}
 
-  std::ostringstream builder;
-  builder << std::put_time(&utc_tm, "%Y-%m-%dT%H:%M:%SZ");
-  return builder.str();
+char* WriteDigits(char* out, int value, const int count) {
+  for (int i = count - 1; i >= 0; --i) {
+    out[i] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  }
+  return out + count;
 }
 
 }  // namespace
@@ -167,7 +201,84 @@ MilestoneCheckpointState MilestoneCheckpointStateFromString(const std::string_vi
 
 std::string CurrentTimestampUtc() {
   const auto now = std::chrono::system_clock::now();
-  return ToIso8601Utc(std::chrono::system_clock::to_time_t(now));
+  const auto now_seconds = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
+  return FormatTimestampUtcMs(static_cast<int64_t>(now_seconds) * 1000);
+}
+
+std::optional<int64_t> ParseTimestampUtcMs(const std::string_view timestamp) {
+  int year = 0;
+  int month = 0;
+  int day = 0;
+  int hour = 0;
+  int minute = 0;
+  int second = 0;
+  if (!ParseDigits(timestamp, 0, 4, &year) || timestamp.size() < 20 || timestamp[4] != '-' ||
+      !ParseDigits(timestamp, 5, 2, &month) || timestamp[7] != '-' || !ParseDigits(timestamp, 8, 2, &day) ||
+      timestamp[10] != 'T' || !ParseDigits(timestamp, 11, 2, &hour) || timestamp[13] != ':' ||
+      !ParseDigits(timestamp, 14, 2, &minute) || timestamp[16] != ':' || !ParseDigits(timestamp, 17, 2, &second)) {
+    return std::nullopt;
+  }
+  if (month < 1 || month > 12 || day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60) {
+    return std::nullopt;
+  }
+
+  int millis = 0;
+  size_t cursor = 19;
+  if (timestamp[cursor] == '.') {
+    if (!ParseDigits(timestamp, cursor + 1, 3, &millis)) {
+      return std::nullopt;
+    }
+    cursor += 4;
+  }
+  if (cursor + 1 != timestamp.size() || timestamp[cursor] != 'Z') {
+    return std::nullopt;
+  }
+
+  const int64_t days = DaysFromCivil(year, static_cast<unsigned>(month), static_cast<unsigned>(day));
+  const int64_t seconds = days * 86400 + hour * 3600 + minute * 60 + second;
+  return seconds * 1000 + millis;
+}
+
+std::string FormatTimestampUtcMs(const int64_t epoch_ms) {
+  std::string formatted;
+  FormatTimestampUtcMs(epoch_ms, &formatted);
+  return formatted;
+}
+
+void FormatTimestampUtcMs(const int64_t epoch_ms, std::string* formatted) {
+  int64_t days = epoch_ms / 86400000;
+  int64_t millis_of_day = epoch_ms % 86400000;
+  if (millis_of_day < 0) {
+    millis_of_day += 86400000;
+    days -= 1;
+  }
+
+  int64_t year = 0;
+  unsigned month = 0;
+  unsigned day = 0;
+  CivilFromDays(days, &year, &month, &day);
+
+  const auto seconds_of_day = static_cast<int>(millis_of_day / 1000);
+  const auto millis = static_cast<int>(millis_of_day % 1000);
+
+  char buffer[24];
+  char* out = WriteDigits(buffer, static_cast<int>(year), 4);
+  *out++ = '-';
+  out = WriteDigits(out, static_cast<int>(month), 2);
+  *out++ = '-';
+  out = WriteDigits(out, static_cast<int>(day), 2);
+  *out++ = 'T';
+  out = WriteDigits(out, seconds_of_day / 3600, 2);
+  *out++ = ':';
+  out = WriteDigits(out, (seconds_of_day / 60) % 60, 2);
+  *out++ = ':';
+  out = WriteDigits(out, seconds_of_day % 60, 2);
+  if (millis != 0) {
+    *out++ = '.';
+    out = WriteDigits(out, millis, 3);
+  }
+  *out++ = 'Z';
+  formatted->assign(buffer, out);
 }
 
 std::string GenerateStableId(const std::string_view prefix) {
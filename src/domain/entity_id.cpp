@@ -0,0 +1,81 @@
+#include "habitrpg/domain/entity_id.hpp"
+
+#include <mutex>
+#include <stdexcept>
+
+namespace habitrpg::domain {
+
+const std::string EntityId::kEmptyText{};
+
+IdInterner& IdInterner::Instance() {
+  static IdInterner interner;
+  return interner;
+}
+
+IdInterner::IdInterner() {
+  texts_.emplace_back();
+  keys_.emplace(std::string_view(texts_.front()), kEmptyEntityKey);
+}
+
+EntityKey IdInterner::Intern(const std::string_view text, const std::string** interned_text) {
+  {
+    std::shared_lock lock(mutex_);
+    const auto it = keys_.find(text);
+    if (it != keys_.end()) {
+      *interned_text = &texts_[it->second];
+      return it->second;
+    }
+  }
+
+  std::unique_lock lock(mutex_);
+  const auto it = keys_.find(text);
+  if (it != keys_.end()) {
+    *interned_text = &texts_[it->second];
+    return it->second;
+  }
+
+  const auto key = static_cast<EntityKey>(texts_.size());
+  const std::string& stored = texts_.emplace_back(text);
+  keys_.emplace(std::string_view(stored), key);
+  *interned_text = &stored;
+  return key;
+}
+
+std::optional<EntityKey> IdInterner::Find(const std::string_view text) const {
+  std::shared_lock lock(mutex_);
+  const auto it = keys_.find(text);
+  if (it == keys_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+const std::string& IdInterner::Text(const EntityKey key) const {
+  std::shared_lock lock(mutex_);
+  if (key >= texts_.size()) {
+    throw std::out_of_range("Unknown entity key: " + std::to_string(key));
+  }
+  return texts_[key];
+}
+
+size_t IdInterner::Size() const {
+  std::shared_lock lock(mutex_);
+  return texts_.size();
+}
+
+EntityId::EntityId(const std::string_view text) {
+  if (!text.empty()) {
+    key_ = IdInterner::Instance().Intern(text, &text_);
+  }
+}
+
+EntityId EntityId::FromKey(const EntityKey key) {
+  EntityId id;
+  if (key != kEmptyEntityKey) {
+    id.text_ = &IdInterner::Instance().Text(key);
+    id.key_ = key;
+  }
+  return id;
+}
+
+}  // namespace habitrpg::domain
@@ -5,7 +5,7 @@
 namespace habitrpg::domain {
 namespace {
 
-void PauseAllActiveActions(const std::string& except_id, std::vector<ActionUnit>* action_units) {
+void PauseAllActiveActions(const EntityId& except_id, std::vector<ActionUnit>* action_units) {
   if (action_units == nullptr) {
     return;
   }
@@ -22,7 +22,7 @@ void PauseAllActiveActions(const std::string& except_id, std::vector<ActionUnit>
   }
 }
 
-void PauseAllActiveLearning(const std::string& except_id, std::vector<LearningSession>* learning_sessions) {
+void PauseAllActiveLearning(const EntityId& except_id, std::vector<LearningSession>* learning_sessions) {
   if (learning_sessions == nullptr) {
     return;
   }
@@ -41,7 +41,7 @@ void PauseAllActiveLearning(const std::string& except_id, std::vector<LearningSe
 }  // namespace
 
 ActionUnit InteractionFlowService::CreateLifeAction(
-    const std::string& parent_id,
+    const EntityId& parent_id,
     const std::string& title,
     const int priority_score,
     std::string created_at) const {
@@ -72,7 +72,7 @@ LearningGoal InteractionFlowService::CreateLearningGoal(
 }
 
 LearningSession InteractionFlowService::CreateLearningSession(
-    const std::string& goal_id,
+    const EntityId& goal_id,
     const std::string& title,
     const int duration_minutes,
     const int priority_score,
@@ -94,7 +94,7 @@ LearningSession InteractionFlowService::CreateLearningSession(
 }
 
 bool InteractionFlowService::StartActionUnit(
-    const std::string& action_id,
+    const EntityId& action_id,
     std::vector<ActionUnit>* action_units,
     std::vector<LearningSession>* learning_sessions) const {
   if (action_units == nullptr) {
@@ -122,11 +122,12 @@ bool InteractionFlowService::StartActionUnit(
 }
 
 bool InteractionFlowService::CompleteActionUnit(
-    const std::string& action_id,
+    const EntityId& action_id,
     std::vector<ActionUnit>* action_units,
     RewardEngine* reward_engine,
     UserState* user_state,
-    std::vector<RewardEvent>* reward_events) const {
+    std::vector<RewardEvent>* reward_events,
+    std::string completed_at) const {
   if (action_units == nullptr || reward_engine == nullptr || user_state == nullptr || reward_events == nullptr) {
     return false;
   }
@@ -144,7 +145,7 @@ bool InteractionFlowService::CompleteActionUnit(
   if (it->started_at.empty()) {
     it->started_at = CurrentTimestampUtc();
   }
-  it->completed_at = CurrentTimestampUtc();
+  it->completed_at = completed_at.empty() ? CurrentTimestampUtc() : std::move(completed_at);
 
   const auto reward_event = reward_engine->BuildActionCompletionReward(*it, it->completed_at);
   reward_engine->ApplyReward(reward_event, user_state);
@@ -153,7 +154,7 @@ bool InteractionFlowService::CompleteActionUnit(
 }
 
 bool InteractionFlowService::StartLearningSession(
-    const std::string& session_id,
+    const EntityId& session_id,
     std::vector<ActionUnit>* action_units,
     std::vector<LearningSession>* learning_sessions) const {
   if (learning_sessions == nullptr) {
@@ -181,7 +182,7 @@ bool InteractionFlowService::StartLearningSession(
 }
 
 bool InteractionFlowService::CheckpointLearningSession(
-    const std::string& session_id,
+    const EntityId& session_id,
     const std::string& checkpoint_note,
     std::vector<LearningSession>* learning_sessions) const {
   if (learning_sessions == nullptr) {
@@ -237,11 +238,13 @@ MilestoneCheckpoint InteractionFlowService::CreateMilestoneCheckpointCandidate(
 }
 
 bool InteractionFlowService::PromoteMilestoneCheckpointToConfirmed(
-    const std::string& checkpoint_id,
+    const EntityId& checkpoint_id,
     std::vector<MilestoneCheckpoint>* checkpoints,
     RewardEngine* reward_engine,
     UserState* user_state,
-    std::vector<RewardEvent>* reward_events) const {
+    std::vector<RewardEvent>* reward_events,
+    const std::function<bool(const EntityId&)>& reward_recorded,
+    std::string confirmed_at) const {
   if (checkpoints == nullptr || reward_engine == nullptr || user_state == nullptr || reward_events == nullptr) {
     return false;
   }
@@ -260,17 +263,20 @@ bool InteractionFlowService::PromoteMilestoneCheckpointToConfirmed(
   }
 
   checkpoint_it->state = MilestoneCheckpointState::Confirmed;
-  checkpoint_it->reviewed_at = CurrentTimestampUtc();
+  checkpoint_it->reviewed_at = confirmed_at.empty() ? CurrentTimestampUtc() : std::move(confirmed_at);
   checkpoint_it->confirmed_at = checkpoint_it->reviewed_at;
   checkpoint_it->updated_at = checkpoint_it->reviewed_at;
   if (checkpoint_it->reward_event_id.empty()) {
-    checkpoint_it->reward_event_id = "reward_milestone_" + checkpoint_it->id;
+    checkpoint_it->reward_event_id = "reward_milestone_" + checkpoint_it->id.str();
   }
 
-  const bool reward_exists = std::any_of(
-      reward_events->begin(),
-      reward_events->end(),
-      [checkpoint_it](const RewardEvent& reward_event) { return reward_event.id == checkpoint_it->reward_event_id; });
+  const EntityId& reward_event_id = checkpoint_it->reward_event_id;
+  const bool reward_exists =
+      std::any_of(
+          reward_events->begin(),
+          reward_events->end(),
+          [&reward_event_id](const RewardEvent& reward_event) { return reward_event.id == reward_event_id; }) ||
+      (reward_recorded && reward_recorded(reward_event_id));
 
   if (reward_exists) {
     return true;
@@ -286,11 +292,12 @@ bool InteractionFlowService::PromoteMilestoneCheckpointToConfirmed(
 }
 
 bool InteractionFlowService::CompleteLearningSession(
-    const std::string& session_id,
+    const EntityId& session_id,
     std::vector<LearningSession>* learning_sessions,
     RewardEngine* reward_engine,
     UserState* user_state,
-    std::vector<RewardEvent>* reward_events) const {
+    std::vector<RewardEvent>* reward_events,
+    std::string completed_at) const {
   if (learning_sessions == nullptr || reward_engine == nullptr || user_state == nullptr || reward_events == nullptr) {
     return false;
   }
@@ -308,7 +315,7 @@ bool InteractionFlowService::CompleteLearningSession(
   if (it->started_at.empty()) {
     it->started_at = CurrentTimestampUtc();
   }
-  it->completed_at = CurrentTimestampUtc();
+  it->completed_at = completed_at.empty() ? CurrentTimestampUtc() : std::move(completed_at);
 
   const auto reward_event = reward_engine->BuildLearningSessionCompletionReward(*it, it->completed_at);
   reward_engine->ApplyReward(reward_event, user_state);
@@ -42,12 +42,12 @@ RewardEvent RewardEngine::BuildLearningSessionCompletionReward(
 RewardEvent RewardEngine::BuildMilestoneCheckpointConfirmedReward(
     const MilestoneCheckpoint& milestone_checkpoint,
     const std::string_view created_at,
-    const std::string_view event_id_override) const {
+    const EntityId& event_id_override) const {
   RewardEvent reward_event{};
   if (!event_id_override.empty()) {
-    reward_event.id = std::string(event_id_override);
+    reward_event.id = event_id_override;
   } else {
-    reward_event.id = "reward_milestone_" + milestone_checkpoint.id;
+    reward_event.id = "reward_milestone_" + milestone_checkpoint.id.str();
   }
   reward_event.source_type = "milestone_checkpoint";
   reward_event.source_id = milestone_checkpoint.id;
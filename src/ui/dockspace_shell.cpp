@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <exception>
 #include <filesystem>
 #include <sstream>
 #include <string>
@@ -9,6 +10,9 @@
 #include "imgui.h"
 #include "imgui_internal.h"
 
+#include "habitrpg/app/command_journal.hpp"
+#include "habitrpg/app/reward_history.hpp"
+
 namespace habitrpg::ui {
 
 namespace {
@@ -436,11 +440,12 @@ void DockspaceShell::RenderTodayControls(app::AppState* app_state) {
   if (ImGui::Button("Create Life Action")) {
     const std::string title = app_state->new_life_action_title.data();
     if (!title.empty()) {
-      auto action = interaction_flow_service_.CreateLifeAction("habit.manual", title, app_state->input_priority_score);
-      app_state->runtime.life_actions.push_back(std::move(action));
+      app::DispatchCommand(
+          app_state,
+          interaction_flow_service_,
+          domain::contracts::CreateLifeActionCommand{"habit.manual", title, app_state->input_priority_score});
       app_state->new_life_action_title[0] = '\0';
       app_state->focus_status = "Life action created";
-      app::MarkMutated(app_state);
     }
   }
 
@@ -463,18 +468,18 @@ void DockspaceShell::RenderTodayControls(app::AppState* app_state) {
           app_state->runtime.learning_goals.end(),
           [&title](const domain::LearningGoal& goal) { return goal.title == title; });
 
-      auto learning_goal = interaction_flow_service_.CreateLearningGoal(title, milestone);
-      if (!duplicate) {
-        app_state->runtime.learning_goals.push_back(std::move(learning_goal));
+      if (!duplicate && app::DispatchCommand(
+                            app_state,
+                            interaction_flow_service_,
+                            domain::contracts::CreateLearningGoalCommand{title, milestone})) {
         app_state->selected_learning_goal_index = static_cast<int>(app_state->runtime.learning_goals.size()) - 1;
         app_state->focus_status = "Learning goal created";
-      } else {
+      } else if (duplicate) {
         app_state->focus_status = "A similar goal already exists.";
       }
 
       app_state->new_learning_goal_title[0] = '\0';
       app_state->new_learning_goal_milestone[0] = '\0';
-      app::MarkMutated(app_state);
     }
   }
 
@@ -518,19 +523,19 @@ void DockspaceShell::RenderTodayControls(app::AppState* app_state) {
       const std::string title = app_state->new_learning_session_title.data();
       if (!title.empty()) {
         const auto& learning_goal = app_state->runtime.learning_goals[app_state->selected_learning_goal_index];
-        auto session = interaction_flow_service_.CreateLearningSession(
-            learning_goal.id,
-            title,
-            app_state->input_learning_duration_minutes,
-            app_state->input_priority_score,
-            "code_snippet",
-            app_state->new_learning_artifact_ref.data());
-
-        app_state->runtime.learning_sessions.push_back(std::move(session));
+        app::DispatchCommand(
+            app_state,
+            interaction_flow_service_,
+            domain::contracts::CreateLearningSessionCommand{
+                learning_goal.id,
+                title,
+                app_state->input_learning_duration_minutes,
+                app_state->input_priority_score,
+                "code_snippet",
+                app_state->new_learning_artifact_ref.data()});
         app_state->new_learning_session_title[0] = '\0';
         app_state->new_learning_artifact_ref[0] = '\0';
         app_state->focus_status = "Learning session created";
-        app::MarkMutated(app_state);
       }
     }
   }
@@ -588,24 +593,12 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
   ImGui::TextUnformatted(row_label.str().c_str());
 
   const auto start_selected_unit = [this, app_state](const std::string& unit_id, const domain::TrackType track_type) {
-    bool changed = false;
-    if (track_type == domain::TrackType::Life) {
-      changed = interaction_flow_service_.StartActionUnit(
-          unit_id,
-          &app_state->runtime.life_actions,
-          &app_state->runtime.learning_sessions);
-    } else {
-      changed = interaction_flow_service_.StartLearningSession(
-          unit_id,
-          &app_state->runtime.life_actions,
-          &app_state->runtime.learning_sessions);
-    }
-
+    const bool changed = app::DispatchCommand(
+        app_state,
+        interaction_flow_service_,
+        domain::contracts::StartUnitCommand{unit_id, track_type});
     if (changed) {
-      app_state->active_unit_id = unit_id;
-      app_state->active_track_type = track_type;
       app_state->focus_status = "Unit started (single-active mode enforced)";
-      app::MarkMutated(app_state);
     }
   };
 
@@ -626,31 +619,12 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
   std::ostringstream partial_id;
   partial_id << "Partial##" << item.source_kind << "." << item.unit_id;
   if (ImGui::Button(partial_id.str().c_str())) {
-    bool changed = false;
-    if (item.track_type == domain::TrackType::Life) {
-      auto it = std::find_if(
-          app_state->runtime.life_actions.begin(),
-          app_state->runtime.life_actions.end(),
-          [&item](const domain::ActionUnit& action) { return action.id == item.unit_id; });
-      if (it != app_state->runtime.life_actions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Partial;
-        it->status = domain::ActionStatus::Todo;
-        changed = true;
-      }
-    } else {
-      auto it = std::find_if(
-          app_state->runtime.learning_sessions.begin(),
-          app_state->runtime.learning_sessions.end(),
-          [&item](const domain::LearningSession& session) { return session.id == item.unit_id; });
-      if (it != app_state->runtime.learning_sessions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Partial;
-        changed = true;
-      }
-    }
-
+    const bool changed = app::DispatchCommand(
+        app_state,
+        interaction_flow_service_,
+        domain::contracts::SetUnitLifecycleCommand{item.unit_id, item.track_type, domain::LifecycleState::Partial});
     if (changed) {
       app_state->focus_status = "Marked partial";
-      app::MarkMutated(app_state);
     }
   }
 
@@ -658,31 +632,12 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
   std::ostringstream pause_id;
   pause_id << "Pause##" << item.source_kind << "." << item.unit_id;
   if (ImGui::Button(pause_id.str().c_str())) {
-    bool changed = false;
-    if (item.track_type == domain::TrackType::Life) {
-      auto it = std::find_if(
-          app_state->runtime.life_actions.begin(),
-          app_state->runtime.life_actions.end(),
-          [&item](const domain::ActionUnit& action) { return action.id == item.unit_id; });
-      if (it != app_state->runtime.life_actions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Paused;
-        it->status = domain::ActionStatus::Todo;
-        changed = true;
-      }
-    } else {
-      auto it = std::find_if(
-          app_state->runtime.learning_sessions.begin(),
-          app_state->runtime.learning_sessions.end(),
-          [&item](const domain::LearningSession& session) { return session.id == item.unit_id; });
-      if (it != app_state->runtime.learning_sessions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Paused;
-        changed = true;
-      }
-    }
-
+    const bool changed = app::DispatchCommand(
+        app_state,
+        interaction_flow_service_,
+        domain::contracts::SetUnitLifecycleCommand{item.unit_id, item.track_type, domain::LifecycleState::Paused});
     if (changed) {
       app_state->focus_status = "Paused";
-      app::MarkMutated(app_state);
     }
   }
 
@@ -690,31 +645,12 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
   std::ostringstream missed_id;
   missed_id << "Missed##" << item.source_kind << "." << item.unit_id;
   if (ImGui::Button(missed_id.str().c_str())) {
-    bool changed = false;
-    if (item.track_type == domain::TrackType::Life) {
-      auto it = std::find_if(
-          app_state->runtime.life_actions.begin(),
-          app_state->runtime.life_actions.end(),
-          [&item](const domain::ActionUnit& action) { return action.id == item.unit_id; });
-      if (it != app_state->runtime.life_actions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Missed;
-        it->status = domain::ActionStatus::Todo;
-        changed = true;
-      }
-    } else {
-      auto it = std::find_if(
-          app_state->runtime.learning_sessions.begin(),
-          app_state->runtime.learning_sessions.end(),
-          [&item](const domain::LearningSession& session) { return session.id == item.unit_id; });
-      if (it != app_state->runtime.learning_sessions.end()) {
-        it->lifecycle_state = domain::LifecycleState::Missed;
-        changed = true;
-      }
-    }
-
+    const bool changed = app::DispatchCommand(
+        app_state,
+        interaction_flow_service_,
+        domain::contracts::SetUnitLifecycleCommand{item.unit_id, item.track_type, domain::LifecycleState::Missed});
     if (changed) {
       app_state->focus_status = "Marked missed";
-      app::MarkMutated(app_state);
     }
   }
 
@@ -723,43 +659,16 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
     std::ostringstream checkpoint_id;
     checkpoint_id << "Save Candidate##" << item.source_kind << "." << item.unit_id;
     if (ImGui::Button(checkpoint_id.str().c_str())) {
-      const bool changed = interaction_flow_service_.CheckpointLearningSession(
-          item.unit_id,
-          "Checkpoint candidate logged",
-          &app_state->runtime.learning_sessions);
-
-      if (changed) {
-        auto session_it = std::find_if(
-            app_state->runtime.learning_sessions.begin(),
-            app_state->runtime.learning_sessions.end(),
-            [&item](const domain::LearningSession& session) { return session.id == item.unit_id; });
-
-        if (session_it != app_state->runtime.learning_sessions.end()) {
-          auto checkpoint_it = std::find_if(
-              app_state->runtime.milestone_checkpoints.begin(),
-              app_state->runtime.milestone_checkpoints.end(),
-              [&item](const domain::MilestoneCheckpoint& checkpoint) {
-                return checkpoint.learning_session_id == item.unit_id &&
-                       checkpoint.state == domain::MilestoneCheckpointState::Candidate;
-              });
-
-          if (checkpoint_it == app_state->runtime.milestone_checkpoints.end()) {
-            auto checkpoint = interaction_flow_service_.CreateMilestoneCheckpointCandidate(
-                *session_it,
-                "default",
-                "snippet",
-                session_it->artifact_ref,
-                2,
-                "manual_candidate");
-            app_state->runtime.milestone_checkpoints.push_back(std::move(checkpoint));
-          } else {
-            checkpoint_it->updated_at = domain::CurrentTimestampUtc();
-            checkpoint_it->candidate_reason = "manual_candidate";
-          }
-        }
-
+      const bool changed = app::DispatchCommand(
+          app_state,
+          interaction_flow_service_,
+          domain::contracts::CheckpointLearningSessionCommand{item.unit_id, "Checkpoint candidate logged"});
+
+      if (changed && app::DispatchCommand(
+                         app_state,
+                         interaction_flow_service_,
+                         domain::contracts::SaveCheckpointCandidateCommand{item.unit_id, "manual_candidate"})) {
         app_state->focus_status = app_state->copy_pack.completion_milestone_candidate_toast;
-        app::MarkMutated(app_state);
       }
     }
 
@@ -776,15 +685,11 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
       std::ostringstream confirm_id;
       confirm_id << "Confirm Candidate##" << item.source_kind << "." << item.unit_id;
       if (ImGui::Button(confirm_id.str().c_str())) {
-        domain::RewardEngine reward_engine;
         const size_t reward_count_before = app_state->runtime.reward_events.size();
-
-        const bool changed = interaction_flow_service_.PromoteMilestoneCheckpointToConfirmed(
-            candidate_it->id,
-            &app_state->runtime.milestone_checkpoints,
-            &reward_engine,
-            &app_state->user_state,
-            &app_state->runtime.reward_events);
+        const bool changed = app::DispatchCommand(
+            app_state,
+            interaction_flow_service_,
+            domain::contracts::ConfirmMilestoneCheckpointCommand{candidate_it->id, domain::CurrentTimestampUtc()});
 
         if (changed) {
           if (app_state->runtime.reward_events.size() > reward_count_before) {
@@ -800,7 +705,6 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
           }
 
           app_state->focus_status = app_state->copy_pack.completion_milestone_confirmed_toast;
-          app::MarkMutated(app_state);
         }
       }
     }
@@ -810,23 +714,19 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
   std::ostringstream complete_id;
   complete_id << "Complete##" << item.source_kind << "." << item.unit_id;
   if (ImGui::Button(complete_id.str().c_str())) {
-    domain::RewardEngine reward_engine;
+    const std::string completed_at = domain::CurrentTimestampUtc();
     bool changed = false;
 
     if (item.track_type == domain::TrackType::Life) {
-      changed = interaction_flow_service_.CompleteActionUnit(
-          item.unit_id,
-          &app_state->runtime.life_actions,
-          &reward_engine,
-          &app_state->user_state,
-          &app_state->runtime.reward_events);
+      changed = app::DispatchCommand(
+          app_state,
+          interaction_flow_service_,
+          domain::contracts::CompleteActionCommand{item.unit_id, domain::TrackType::Life, completed_at});
     } else {
-      changed = interaction_flow_service_.CompleteLearningSession(
-          item.unit_id,
-          &app_state->runtime.learning_sessions,
-          &reward_engine,
-          &app_state->user_state,
-          &app_state->runtime.reward_events);
+      changed = app::DispatchCommand(
+          app_state,
+          interaction_flow_service_,
+          domain::contracts::CompleteLearningSessionCommand{item.unit_id, item.parent_id, 0, completed_at});
     }
 
     if (changed && !app_state->runtime.reward_events.empty()) {
@@ -847,12 +747,6 @@ void DockspaceShell::RenderQueueItemRow(app::AppState* app_state, const domain::
       } else {
         app_state->focus_status = app_state->copy_pack.completion_learning_toast;
       }
-
-      if (app_state->active_unit_id == item.unit_id) {
-        app_state->active_unit_id.clear();
-      }
-
-      app::MarkMutated(app_state);
     }
   }
 
@@ -911,22 +805,14 @@ void DockspaceShell::RenderCenterActionPanel(app::AppState* app_state) {
     ImGui::SameLine();
     if (ImGui::Button(app_state->copy_pack.conflict_action_pause_switch.c_str())) {
       if (!app_state->pending_start_unit_id.empty()) {
-        if (app_state->pending_start_track_type == domain::TrackType::Life) {
-          interaction_flow_service_.StartActionUnit(
-              app_state->pending_start_unit_id,
-              &app_state->runtime.life_actions,
-              &app_state->runtime.learning_sessions);
-        } else {
-          interaction_flow_service_.StartLearningSession(
-              app_state->pending_start_unit_id,
-              &app_state->runtime.life_actions,
-              &app_state->runtime.learning_sessions);
-        }
+        app::DispatchCommand(
+            app_state,
+            interaction_flow_service_,
+            domain::contracts::StartUnitCommand{app_state->pending_start_unit_id, app_state->pending_start_track_type});
 
         app_state->active_unit_id = app_state->pending_start_unit_id;
         app_state->active_track_type = app_state->pending_start_track_type;
         app_state->focus_status = "Unit started (single-active mode enforced)";
-        app::MarkMutated(app_state);
       }
 
       app_state->show_active_conflict_modal = false;
@@ -1016,6 +902,8 @@ void DockspaceShell::RenderRightStatePanel(app::AppState* app_state) {
     ImGui::TextWrapped("Asset: %s", app_state->last_feedback_asset.c_str());
   }
 
+  RenderRewardHistory(app_state);
+
   if (app_state->save_error_pending_retry) {
     ImGui::SeparatorText("Save Error");
     ImGui::TextWrapped("%s", app_state->copy_pack.error_save_primary.c_str());
@@ -1036,12 +924,53 @@ void DockspaceShell::RenderRightStatePanel(app::AppState* app_state) {
     }
   }
 
+  if (!app_state->last_journal_error.empty()) {
+    ImGui::SeparatorText("Journal Error");
+    ImGui::TextWrapped("A recent action could not be journaled; it is kept and reaches disk with the next save.");
+    ImGui::TextWrapped("Details: %s", app_state->last_journal_error.c_str());
+  }
+
   ImGui::SeparatorText("Status");
   ImGui::TextWrapped("%s", app_state->focus_status.c_str());
 
   ImGui::End();
 }
 
+void DockspaceShell::RenderRewardHistory(app::AppState* app_state) {
+  ImGui::SeparatorText("Reward History");
+
+  // Newest first: the recent window (stored oldest first), then the older pages.
+  const auto& recent = app_state->runtime.reward_events;
+  const auto& older = app_state->runtime.older_reward_events;
+  ImGui::BeginChild("RewardHistoryRows", ImVec2(0.0f, 160.0f), ImGuiChildFlags_Borders);
+  ImGuiListClipper clipper;
+  clipper.Begin(static_cast<int>(recent.size() + older.size()));
+  while (clipper.Step()) {
+    for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+      const auto index = static_cast<size_t>(row);
+      const auto& reward_event = index < recent.size() ? recent[recent.size() - 1 - index] : older[index - recent.size()];
+      ImGui::Text(
+          "+%d XP  %s  %s",
+          reward_event.xp_delta,
+          reward_event.reward_kind.c_str(),
+          reward_event.created_at.c_str());
+    }
+  }
+
+  // Older pages come from storage when the list is scrolled to its end or on request.
+  if (app_state->reward_repository != nullptr && app::HasOlderRewardEvents(*app_state)) {
+    const bool scrolled_to_end = ImGui::GetScrollMaxY() > 0.0f && ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
+    if (ImGui::Button("Load Older Rewards") || scrolled_to_end) {
+      try {
+        app::LoadOlderRewardEvents(*app_state->reward_repository, app_state);
+      } catch (const std::exception& error) {
+        app_state->focus_status = std::string("Reward history unavailable: ") + error.what();
+      }
+    }
+  }
+  ImGui::EndChild();
+}
+
 void DockspaceShell::RenderBottomControlStrip(app::AppState* app_state) {
   ImGui::Begin("Session Controls");
 
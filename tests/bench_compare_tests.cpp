@@ -0,0 +1,174 @@
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench_compare.hpp"
+#include "bench_report.hpp"
+
+namespace {
+
+void Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    throw std::runtime_error(message);
+  }
+}
+
+habitrpg::bench::CaseResult BuildCase(const std::string& name, const std::vector<double>& repetition_p50_ns) {
+  habitrpg::bench::CaseResult result{};
+  result.name = name;
+  result.rows = 1000;
+  result.iterations = 10;
+  result.repetition_p50_ns = repetition_p50_ns;
+  result.p50_ns = repetition_p50_ns.front();
+  result.p90_ns = result.p50_ns * 1.5;
+  result.p99_ns = result.p50_ns * 2.0;
+  result.min_ns = result.p50_ns * 0.5;
+  result.max_ns = result.p50_ns * 3.0;
+  result.mean_ns = result.p50_ns;
+  return result;
+}
+
+habitrpg::bench::BenchReport BuildReport(const std::vector<habitrpg::bench::CaseResult>& cases) {
+  habitrpg::bench::BenchReport report{};
+  report.tier = habitrpg::bench::ScaleTier::Small;
+  report.rows = 1000;
+  report.repetitions = 5;
+  report.build_type = "Release";
+  report.sqlite_version = "3.40.1";
+  report.recorded_at = "2026-06-01T12:00:00Z";
+  report.cases = cases;
+  return report;
+}
+
+const habitrpg::bench::CaseComparison& FindComparison(
+    const habitrpg::bench::ComparisonReport& report,
+    const std::string& name) {
+  for (const auto& comparison : report.cases) {
+    if (comparison.name == name) {
+      return comparison;
+    }
+  }
+  throw std::runtime_error("No comparison for " + name);
+}
+
+}  // namespace
+
+bool RunBenchCompareTest() {
+  namespace bench = habitrpg::bench;
+
+  Expect(bench::Median({3.0, 1.0, 2.0}) == 2.0, "Median of an odd sample set should be the middle value");
+  Expect(bench::Median({4.0, 1.0, 3.0, 2.0}) == 2.5, "Median of an even sample set should average the middle pair");
+  Expect(
+      bench::MedianAbsoluteDeviation({1.0, 2.0, 3.0, 4.0, 100.0}) == 1.0,
+      "MAD should ignore a single outlier");
+
+  const auto baseline = BuildReport({
+      BuildCase("sqlite.list_habits", {1000.0, 1010.0, 990.0, 1005.0, 995.0}),
+      BuildCase("sqlite.upsert_habit", {100.0, 140.0, 70.0, 120.0, 90.0}),
+      BuildCase("domain.today_queue.mixed", {500.0, 505.0, 495.0, 502.0, 498.0}),
+      BuildCase("app.startup", {2000.0, 2010.0, 1990.0, 2005.0, 1995.0}),
+  });
+
+  // Both formats read back to the values that were written (to the written precision).
+  for (const bool csv : {false, true}) {
+    std::stringstream stream;
+    csv ? bench::WriteCsv(stream, baseline) : bench::WriteJson(stream, baseline);
+    const auto read = bench::ReadReport(stream);
+    Expect(read.tier == baseline.tier && read.rows == baseline.rows, "Report metadata should round-trip");
+    Expect(read.cases.size() == baseline.cases.size(), "Every case should round-trip");
+    for (size_t i = 0; i < read.cases.size(); ++i) {
+      const auto& expected = baseline.cases[i];
+      const auto& actual = read.cases[i];
+      Expect(actual.name == expected.name && actual.iterations == expected.iterations, "Case identity should match");
+      Expect(std::abs(actual.p99_ns - expected.p99_ns) < 0.1, "Percentiles should round-trip");
+      Expect(actual.repetition_p50_ns == expected.repetition_p50_ns, "Repetition medians should round-trip");
+    }
+  }
+
+  bool rejected = false;
+  try {
+    std::stringstream malformed("{\"schema_version\": 1, \"tier\": \"small\", \"rows\": ");
+    bench::ReadReport(malformed);
+  } catch (const std::runtime_error&) {
+    rejected = true;
+  }
+  Expect(rejected, "Truncated JSON should be rejected");
+
+  const auto unchanged = bench::CompareReports(baseline, baseline);
+  Expect(unchanged.regressions == 0 && unchanged.improvements == 0, "A report compared with itself should not change");
+
+  // list_habits: +20% with tight repetitions regresses. upsert_habit: +20% but the
+  // repetitions spread by ~±30%, so the shift is inside the noise. today_queue: +8% is
+  // under the 10% threshold. startup improved by half. A new case is reported as added.
+  auto candidate = BuildReport({
+      BuildCase("sqlite.list_habits", {1200.0, 1210.0, 1190.0, 1205.0, 1195.0}),
+      BuildCase("sqlite.upsert_habit", {120.0, 170.0, 80.0, 150.0, 100.0}),
+      BuildCase("domain.today_queue.mixed", {540.0, 545.0, 535.0, 542.0, 538.0}),
+      BuildCase("app.startup", {1000.0, 1010.0, 990.0, 1005.0, 995.0}),
+      BuildCase("sqlite.search", {50.0}),
+  });
+  const auto compared = bench::CompareReports(baseline, candidate);
+  Expect(compared.regressions == 1 && compared.improvements == 1, "Exactly one regression and one improvement");
+  const auto& habits = FindComparison(compared, "sqlite.list_habits");
+  Expect(habits.verdict == bench::CaseVerdict::Regressed, "A tight 20% slowdown should regress");
+  Expect(std::abs(habits.delta - 0.2) < 1e-9, "Delta should compare the medians of repetition medians");
+  Expect(
+      FindComparison(compared, "sqlite.upsert_habit").verdict == bench::CaseVerdict::Unchanged,
+      "A slowdown inside the noise band should not regress");
+  Expect(
+      FindComparison(compared, "domain.today_queue.mixed").verdict == bench::CaseVerdict::Unchanged,
+      "A slowdown under the threshold should not regress");
+  Expect(
+      FindComparison(compared, "app.startup").verdict == bench::CaseVerdict::Improved,
+      "Halving the median should count as an improvement");
+  Expect(
+      FindComparison(compared, "sqlite.search").verdict == bench::CaseVerdict::Added,
+      "A case missing from the baseline should be reported as added");
+
+  bench::CompareOptions options{};
+  options.prefix_thresholds.emplace_back("sqlite.list", 0.25);
+  options.prefix_thresholds.emplace_back("domain.", 0.05);
+  const auto configured = bench::CompareReports(baseline, candidate, options);
+  Expect(
+      FindComparison(configured, "sqlite.list_habits").verdict == bench::CaseVerdict::Unchanged,
+      "A looser prefix threshold should absorb the slowdown");
+  Expect(
+      FindComparison(configured, "domain.today_queue.mixed").verdict == bench::CaseVerdict::Regressed,
+      "A tighter prefix threshold should flag the slowdown");
+
+  candidate.cases.erase(candidate.cases.begin());
+  Expect(
+      FindComparison(bench::CompareReports(baseline, candidate), "sqlite.list_habits").verdict ==
+          bench::CaseVerdict::Missing,
+      "A case missing from the candidate should be reported, not failed");
+
+  // Pooling keeps every run's repetition medians, so a run that drifted as a whole widens
+  // the noise band instead of hiding behind a tight within-run spread.
+  const auto drifted = BuildReport({BuildCase("sqlite.list_habits", {1300.0, 1310.0, 1290.0, 1305.0, 1295.0})});
+  const auto pooled = bench::MergeReports({baseline, drifted, baseline});
+  Expect(pooled.repetitions == 15 && pooled.cases.size() == baseline.cases.size(), "Merge should pool every run");
+  const auto& pooled_habits = pooled.cases.front();
+  Expect(pooled_habits.repetition_p50_ns.size() == 15, "Merged cases should keep each run's repetition medians");
+  Expect(pooled_habits.p50_ns == 1000.0, "Merged percentiles should be the median across runs");
+  Expect(pooled.cases[1].repetition_p50_ns.size() == 10, "Cases missing from a run should pool the others");
+
+  candidate.tier = bench::ScaleTier::Medium;
+  rejected = false;
+  try {
+    bench::CompareReports(baseline, candidate);
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  Expect(rejected, "Reports from different tiers should not be compared");
+
+  rejected = false;
+  try {
+    bench::MergeReports({baseline, candidate});
+  } catch (const std::invalid_argument&) {
+    rejected = true;
+  }
+  Expect(rejected, "Runs from different tiers should not be merged");
+  return true;
+}
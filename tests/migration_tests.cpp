@@ -1,10 +1,13 @@
+#include <cstdio>
 #include <filesystem>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include <sqlite3.h>
 
 #include "habitrpg/data/migrations.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
 #include "habitrpg/domain/entities.hpp"
 
 namespace {
@@ -89,6 +92,44 @@ bool TableExists(sqlite3* db, const std::string& table_name) {
              "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table' AND name = '" + table_name + "';") > 0;
 }
 
+void CreateSchemaV1Tables(sqlite3* db) {
+  Exec(db, "CREATE TABLE schema_meta (id INTEGER PRIMARY KEY CHECK(id = 1), version INTEGER NOT NULL);");
+  Exec(db, "INSERT INTO schema_meta(id, version) VALUES(1, 1);");
+
+  Exec(db, R"SQL(
+    CREATE TABLE action_units (
+      id TEXT PRIMARY KEY,
+      parent_id TEXT NOT NULL,
+      title TEXT NOT NULL,
+      track_type TEXT NOT NULL,
+      status TEXT NOT NULL,
+      completed_at TEXT
+    );
+  )SQL");
+
+  Exec(db, R"SQL(
+    CREATE TABLE learning_goals (
+      id TEXT PRIMARY KEY,
+      title TEXT NOT NULL,
+      milestone TEXT NOT NULL,
+      confidence_level INTEGER NOT NULL,
+      created_at TEXT NOT NULL
+    );
+  )SQL");
+
+  Exec(db, R"SQL(
+    CREATE TABLE learning_sessions (
+      id TEXT PRIMARY KEY,
+      goal_id TEXT NOT NULL,
+      duration_minutes INTEGER NOT NULL,
+      artifact_kind TEXT,
+      artifact_ref TEXT,
+      completed_at TEXT NOT NULL,
+      FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
+    );
+  )SQL");
+}
+
 }  // namespace
 
 bool RunSchemaMigrationV1ToV3Test() {
@@ -104,41 +145,7 @@ bool RunSchemaMigrationV1ToV3Test() {
   }
 
   try {
-    Exec(db, "CREATE TABLE schema_meta (id INTEGER PRIMARY KEY CHECK(id = 1), version INTEGER NOT NULL);");
-    Exec(db, "INSERT INTO schema_meta(id, version) VALUES(1, 1);");
-
-    Exec(db, R"SQL(
-      CREATE TABLE action_units (
-        id TEXT PRIMARY KEY,
-        parent_id TEXT NOT NULL,
-        title TEXT NOT NULL,
-        track_type TEXT NOT NULL,
-        status TEXT NOT NULL,
-        completed_at TEXT
-      );
-    )SQL");
-
-    Exec(db, R"SQL(
-      CREATE TABLE learning_goals (
-        id TEXT PRIMARY KEY,
-        title TEXT NOT NULL,
-        milestone TEXT NOT NULL,
-        confidence_level INTEGER NOT NULL,
-        created_at TEXT NOT NULL
-      );
-    )SQL");
-
-    Exec(db, R"SQL(
-      CREATE TABLE learning_sessions (
-        id TEXT PRIMARY KEY,
-        goal_id TEXT NOT NULL,
-        duration_minutes INTEGER NOT NULL,
-        artifact_kind TEXT,
-        artifact_ref TEXT,
-        completed_at TEXT NOT NULL,
-        FOREIGN KEY(goal_id) REFERENCES learning_goals(id)
-      );
-    )SQL");
+    CreateSchemaV1Tables(db);
 
     Exec(
         db,
@@ -220,3 +227,494 @@ bool RunSchemaMigrationV1ToV3Test() {
   std::filesystem::remove(sqlite_path, remove_error);
   return true;
 }
+
+bool RunSchemaV4IndexesAvoidScansTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_v4_indexes");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  // Returns every EXPLAIN QUERY PLAN detail line that reads a whole table or sorts.
+  const auto find_scans = [db](const std::string& sql) {
+    const std::string explain_sql = "EXPLAIN QUERY PLAN " + sql;
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, explain_sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+      throw std::runtime_error("Failed to prepare query plan for: " + sql);
+    }
+
+    std::string scans;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      const auto* raw = sqlite3_column_text(stmt, 3);
+      const std::string detail = raw != nullptr ? reinterpret_cast<const char*>(raw) : "";
+      if (detail.rfind("SCAN ", 0) == 0 || detail.find("TEMP B-TREE") != std::string::npos) {
+        scans += detail + "; ";
+      }
+    }
+
+    sqlite3_finalize(stmt);
+    return scans;
+  };
+
+  try {
+    habitrpg::data::RunMigrations(db);
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionLatest,
+        "Schema should migrate to the latest version");
+
+    Exec(db, "BEGIN TRANSACTION;");
+    Exec(db, R"SQL(
+      WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < 100000)
+      INSERT INTO action_units(id, parent_id, title, track_type, status, runtime_state, priority_score)
+      SELECT printf('action_%06d', n), 'habit', 'Action', n % 2, 0, 0, 100
+      FROM seq;
+    )SQL");
+    Exec(db, R"SQL(
+      WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < 100000)
+      INSERT INTO learning_sessions(id, goal_id, title, lifecycle_state, priority_score, duration_minutes, started_at)
+      SELECT printf('session_%06d', n), printf('goal_%03d', n % 100), 'Session', 0, 100, 25,
+             1767225600000 + n * 1000
+      FROM seq;
+    )SQL");
+    Exec(db, R"SQL(
+      WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < 100000)
+      INSERT INTO reward_events(id, source_type, source_id, track_type, xp_delta, reward_kind, created_at)
+      SELECT printf('reward_%06d', n), 'action_unit', printf('action_%06d', n), n % 2, 10, 'completion',
+             1767225600000 + n * 1000
+      FROM seq;
+    )SQL");
+    Exec(db, R"SQL(
+      WITH RECURSIVE seq(n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < 100000)
+      INSERT INTO milestone_checkpoints(
+        id, goal_id, learning_session_id, milestone_key, state, evidence_kind, confidence_level,
+        submitted_at, created_at, updated_at)
+      SELECT printf('checkpoint_%06d', n), printf('goal_%03d', n % 100), printf('session_%06d', n), 'milestone',
+             0, 'note', 3, 1767225600000, 1767225600000, 1767225600000
+      FROM seq;
+    )SQL");
+    Exec(db, "COMMIT;");
+
+    Expect(QueryInt(db, "SELECT COUNT(*) FROM action_units;") == 100000, "action_units should hold 100k rows");
+
+    const std::string action_scans =
+        find_scans("SELECT id, title FROM action_units WHERE track_type = ? ORDER BY id ASC;");
+    Expect(action_scans.empty(), "ListActionUnitsByTrack should use an index: " + action_scans);
+
+    const std::string session_scans = find_scans(
+        "SELECT id, title FROM learning_sessions WHERE goal_id = ? "
+        "ORDER BY COALESCE(completed_at, started_at, id) ASC;");
+    Expect(session_scans.empty(), "ListLearningSessionsByGoal should use an index: " + session_scans);
+
+    const std::string reward_scans =
+        find_scans("SELECT id, xp_delta FROM reward_events WHERE track_type = ? ORDER BY created_at ASC;");
+    Expect(reward_scans.empty(), "ListRewardEventsByTrack should use an index: " + reward_scans);
+
+    const std::string checkpoint_scans =
+        find_scans("SELECT id, state FROM milestone_checkpoints WHERE goal_id = ? ORDER BY submitted_at ASC;");
+    Expect(checkpoint_scans.empty(), "ListMilestoneCheckpointsByGoal should use an index: " + checkpoint_scans);
+
+    const std::string page_scans = find_scans(
+        "SELECT id FROM reward_events WHERE 1 = 1 AND track_type = ? AND (created_at, id) < (?, ?) "
+        "ORDER BY created_at DESC, id DESC LIMIT ?;");
+    Expect(page_scans.empty(), "Per-track reward keyset page should use an index: " + page_scans);
+
+    const std::string window_scans = find_scans(
+        "SELECT id FROM reward_events WHERE 1 = 1 AND created_at >= ? ORDER BY created_at DESC, id DESC LIMIT ?;");
+    Expect(window_scans.empty(), "Cross-track reward window should use an index: " + window_scans);
+
+    const std::string merged_page_scans = find_scans(
+        "SELECT id, created_at FROM reward_events WHERE 1 = 1 AND track_type = ?1 AND (created_at, id) < (?2, ?3) "
+        "UNION ALL "
+        "SELECT id, created_at FROM reward_events_archive WHERE 1 = 1 AND track_type = ?1 "
+        "AND (created_at, id) < (?2, ?3) "
+        "ORDER BY created_at DESC, id DESC LIMIT ?6;");
+    Expect(
+        merged_page_scans.empty(),
+        "A history page merged with the archive should use both indexes: " + merged_page_scans);
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunSchemaV6RowKeyRebuildTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_v6_row_keys");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  try {
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV5);
+    Exec(
+        db,
+        "INSERT INTO learning_goals(id, title, milestone, confidence_level, created_at) VALUES"
+        "('goal_1', 'Goal', 'Milestone', 1, '2026-02-19T00:00:00Z');");
+    Exec(
+        db,
+        "INSERT INTO action_units(id, parent_id, title, track_type, status, runtime_state, priority_score) VALUES"
+        "('action_b', 'habit_1', 'B', 'life', 'todo', 'ready', 90),"
+        "('action_a', 'habit_1', 'A', 'life', 'completed', 'completed', 110);");
+    Exec(
+        db,
+        "INSERT INTO reward_events(id, source_type, source_id, track_type, xp_delta, reward_kind, created_at) VALUES"
+        "('reward_1', 'action_unit', 'action_a', 'life', 10, 'completion', '2026-02-19T00:01:00Z');");
+
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV6);
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionV6,
+        "Schema should migrate to v6");
+
+    for (const char* table : {"habits", "quests", "action_units", "learning_goals", "learning_sessions",
+                              "milestone_checkpoints", "reward_events"}) {
+      Expect(ColumnExists(db, table, "row_key"), std::string(table) + ".row_key should exist");
+    }
+
+    Expect(QueryInt(db, "SELECT COUNT(*) FROM action_units;") == 2, "Action rows should survive the rebuild");
+    Expect(
+        QueryInt(db, "SELECT row_key FROM action_units WHERE id = 'action_b';") == 1,
+        "Row keys should follow the original insertion order");
+    Expect(
+        QueryText(db, "SELECT runtime_state FROM action_units WHERE id = 'action_a';") == "completed",
+        "Column values should be copied by name");
+    Expect(
+        QueryInt(db, "SELECT xp_delta FROM reward_events WHERE id = 'reward_1';") == 10,
+        "Reward rows should survive the rebuild");
+    Expect(
+        QueryInt(db, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND name LIKE 'idx_%';") == 5,
+        "List query indexes should be recreated after the rebuild");
+
+    Exec(
+        db,
+        "INSERT INTO action_units(id, parent_id, title, track_type, status) VALUES"
+        "('action_b', 'habit_1', 'B2', 'life', 'todo') ON CONFLICT(id) DO UPDATE SET title = excluded.title;");
+    Expect(QueryText(db, "SELECT title FROM action_units WHERE id = 'action_b';") == "B2", "Upsert by id still works");
+    Expect(QueryInt(db, "SELECT COUNT(*) FROM action_units;") == 2, "Upsert by id should not add a row");
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunSchemaV7IntegerEncodingTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_v7_integer_encoding");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  try {
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV6);
+    Exec(
+        db,
+        "INSERT INTO learning_goals(id, title, milestone, confidence_level, created_at) VALUES"
+        "('goal_1', 'Goal', 'Milestone', 1, '2026-02-19T00:00:00Z');");
+    Exec(
+        db,
+        "INSERT INTO action_units(id, parent_id, title, track_type, status, runtime_state, priority_score, "
+        "started_at, completed_at) VALUES"
+        "('action_a', 'habit_1', 'A', 'learning', 'completed', 'checkpoint_candidate', 110, "
+        "'2026-02-19T00:00:30Z', '2026-02-19T00:01:00.250Z'),"
+        "('action_b', 'habit_1', 'B', 'life', 'in_progress', '', 90, NULL, NULL);");
+    Exec(
+        db,
+        "INSERT INTO reward_events(id, source_type, source_id, track_type, xp_delta, reward_kind, created_at) VALUES"
+        "('reward_1', 'action_unit', 'action_a', 'learning', 10, 'completion', '2026-02-19T00:01:00Z');");
+
+    habitrpg::data::RunMigrations(db);
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionLatest,
+        "Schema should migrate to the latest version");
+
+    Expect(
+        QueryText(
+            db,
+            "SELECT typeof(track_type) || ',' || track_type || ',' || status || ',' || runtime_state "
+            "FROM action_units WHERE id = 'action_a';") == "integer,1,2,6",
+        "Enum columns should be stored as integer codes");
+    Expect(
+        QueryText(db, "SELECT started_at || ',' || completed_at FROM action_units WHERE id = 'action_a';") ==
+            "1771459230000,1771459260250",
+        "Timestamps should be stored as epoch milliseconds");
+    Expect(
+        QueryText(db, "SELECT runtime_state || ',' || typeof(started_at) FROM action_units WHERE id = 'action_b';") ==
+            "1,null",
+        "Legacy empty lifecycle should fall back to status and missing timestamps should stay NULL");
+    Expect(
+        QueryText(db, "SELECT track_type || ',' || created_at FROM reward_events WHERE id = 'reward_1';") ==
+            "1,1771459260000",
+        "Reward rows should be re-encoded");
+    Expect(
+        QueryInt(
+            db,
+            "SELECT COUNT(*) FROM sqlite_master "
+            "WHERE type = 'index' AND name LIKE 'idx_%' AND tbl_name NOT LIKE '%_archive';") == 5,
+        "List query indexes should be recreated after the rebuild");
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+
+  try {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    const auto actions = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Learning);
+    Expect(actions.size() == 1, "Repository should decode integer track codes");
+    Expect(
+        actions[0].lifecycle_state == habitrpg::domain::LifecycleState::CheckpointCandidate,
+        "Repository should decode integer lifecycle codes");
+    Expect(actions[0].completed_at == "2026-02-19T00:01:00.250Z", "Repository should format epoch milliseconds");
+
+    auto reward = repository.ListRewardEventsByTrack(habitrpg::domain::TrackType::Learning).at(0);
+    Expect(reward.created_at == "2026-02-19T00:01:00Z", "Whole-second timestamps should round-trip unchanged");
+    reward.id = "reward_2";
+    reward.created_at = "not a timestamp";
+    bool rejected = false;
+    try {
+      repository.AppendRewardEvent(reward);
+    } catch (const std::invalid_argument&) {
+      rejected = true;
+    }
+    Expect(rejected, "Unparseable timestamps should be rejected at the repository boundary");
+  } catch (...) {
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunSchemaV9RollupBackfillTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_v9_rollups");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  try {
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV8);
+    // 1771459200000 is 2026-02-19T00:00:00Z, epoch day 20503.
+    Exec(
+        db,
+        "INSERT INTO reward_events(id, source_type, source_id, track_type, xp_delta, reward_kind, created_at) VALUES"
+        "('reward_1', 'action_unit', 'action_a', 0, 10, 'completion', 1771459200000),"
+        "('reward_2', 'action_unit', 'action_b', 0, 5, 'completion', 1771459260000),"
+        "('reward_3', 'learning_session', 'session_a', 1, 7, 'completion', 1771459200000);");
+    Exec(
+        db,
+        "INSERT INTO learning_sessions(id, goal_id, title, lifecycle_state, priority_score, duration_minutes, "
+        "completed_at) VALUES"
+        "('session_a', 'goal_1', 'A', 5, 100, 25, 1771459200000),"
+        "('session_b', 'goal_1', 'B', 1, 100, 40, NULL);");
+
+    habitrpg::data::RunMigrations(db);
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionLatest,
+        "Schema should migrate to the latest version");
+    Expect(
+        QueryText(db, "SELECT day || ',' || xp_total || ',' || event_count FROM reward_daily_rollups "
+                      "WHERE track_type = 0;") == "20503,15,2",
+        "Existing rewards should be backfilled per day and track");
+    Expect(
+        QueryText(db, "SELECT minutes || ',' || completed_sessions FROM learning_daily_rollups;") == "25,1",
+        "Only completed sessions should be backfilled");
+
+    Exec(
+        db,
+        "UPDATE learning_sessions SET lifecycle_state = 5, completed_at = 1771459200000 WHERE id = 'session_b';");
+    Expect(
+        QueryText(db, "SELECT minutes || ',' || completed_sessions FROM learning_daily_rollups;") == "65,2",
+        "Triggers should keep rollups current after the backfill");
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunSchemaMigrationFastPathTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_fast_path");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  try {
+    habitrpg::data::RunMigrations(db);
+
+    int statements = 0;
+    sqlite3_trace_v2(
+        db,
+        SQLITE_TRACE_STMT,
+        [](unsigned, void* context, void*, void*) {
+          ++*static_cast<int*>(context);
+          return 0;
+        },
+        &statements);
+    habitrpg::data::RunMigrations(db);
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV3);
+    sqlite3_trace_v2(db, 0, nullptr, nullptr);
+
+    Expect(statements == 2, "Migrating a current schema should run exactly one statement per call");
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionLatest,
+        "Fast path should leave the schema version unchanged");
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunSchemaV2ChunkedSessionCopyTest() {
+  const std::string sqlite_path = BuildTempDbPath("migration_v2_chunked");
+  sqlite3* db = nullptr;
+  const int open_rc = sqlite3_open_v2(
+      sqlite_path.c_str(),
+      &db,
+      SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX,
+      nullptr);
+  if (open_rc != SQLITE_OK || db == nullptr) {
+    throw std::runtime_error("Failed to open sqlite test database");
+  }
+
+  constexpr int kLegacySessions = 5000;
+  try {
+    CreateSchemaV1Tables(db);
+    Exec(
+        db,
+        "INSERT INTO learning_goals(id, title, milestone, confidence_level, created_at) VALUES"
+        "('goal_1', 'Goal', 'Milestone', 1, '2026-02-19T00:00:00Z');");
+    Exec(db, "BEGIN TRANSACTION;");
+    for (int i = 0; i < kLegacySessions; ++i) {
+      char sql[256];
+      std::snprintf(
+          sql,
+          sizeof(sql),
+          "INSERT INTO learning_sessions(id, goal_id, duration_minutes, completed_at) "
+          "VALUES('session_%05d', 'goal_1', %d, '2026-02-19T01:00:00Z');",
+          kLegacySessions - i,
+          1 + i % 60);
+      Exec(db, sql);
+    }
+    Exec(db, "COMMIT;");
+
+    // Interrupt the copy after the third batch; the committed batches must survive.
+    habitrpg::data::MigrationOptions options{};
+    options.target_version = habitrpg::data::kSchemaVersionV2;
+    options.batch_rows = 512;
+    int batches = 0;
+    options.on_progress = [&batches](const habitrpg::data::MigrationProgress&) {
+      if (++batches == 3) {
+        throw std::runtime_error("interrupted");
+      }
+    };
+    bool interrupted = false;
+    try {
+      habitrpg::data::RunMigrations(db, options);
+    } catch (const std::runtime_error&) {
+      interrupted = true;
+    }
+    Expect(interrupted, "Progress callback exception should abort the migration");
+    Expect(habitrpg::data::ReadSchemaVersion(db) == 1, "Interrupted upgrade should stay at v1");
+    Expect(TableExists(db, "learning_sessions_legacy"), "Interrupted upgrade should keep the legacy table");
+    Expect(
+        QueryInt(db, "SELECT COUNT(*) FROM learning_sessions;") == 3 * 512,
+        "Committed batches should persist across the interruption");
+
+    std::vector<habitrpg::data::MigrationProgress> reports;
+    options.on_progress = [&reports](const habitrpg::data::MigrationProgress& progress) {
+      reports.push_back(progress);
+    };
+    habitrpg::data::RunMigrations(db, options);
+
+    Expect(
+        habitrpg::data::ReadSchemaVersion(db) == habitrpg::data::kSchemaVersionV2,
+        "Resumed upgrade should reach v2");
+    Expect(!TableExists(db, "learning_sessions_legacy"), "Legacy table should be dropped after the copy");
+    Expect(reports.size() == 7, "Remaining rows should be copied in 512-row batches");
+    for (size_t i = 0; i < reports.size(); ++i) {
+      Expect(reports[i].version == habitrpg::data::kSchemaVersionV2, "Progress should name the v2 step");
+      Expect(reports[i].rows_total == kLegacySessions, "Progress total should count every legacy row");
+      Expect(i == 0 || reports[i].rows_done > reports[i - 1].rows_done, "Progress should advance");
+    }
+    Expect(reports.back().rows_done == kLegacySessions, "Final progress should cover every row");
+    Expect(
+        QueryInt(db, "SELECT COUNT(*) FROM learning_sessions;") == kLegacySessions,
+        "Every legacy session should be copied exactly once");
+    Expect(
+        QueryText(db, "SELECT id FROM learning_sessions ORDER BY rowid LIMIT 1;") == "session_05000",
+        "Copied sessions should keep their legacy insertion order");
+    Expect(
+        QueryInt(db, "SELECT COUNT(*) FROM learning_sessions WHERE lifecycle_state = 'completed';") ==
+            kLegacySessions,
+        "Legacy sessions should migrate as completed");
+  } catch (...) {
+    sqlite3_close(db);
+    std::error_code remove_error;
+    std::filesystem::remove(sqlite_path, remove_error);
+    throw;
+  }
+
+  sqlite3_close(db);
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
@@ -0,0 +1,2205 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <initializer_list>
+#include <mutex>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "habitrpg/app/archival.hpp"
+#include "habitrpg/app/backup_service.hpp"
+#include "habitrpg/app/command_journal.hpp"
+#include "habitrpg/app/persistence.hpp"
+#include "habitrpg/app/persistence_worker.hpp"
+#include "habitrpg/app/reward_history.hpp"
+#include "habitrpg/app/user_state_ledger.hpp"
+#include "habitrpg/data/cached_repository.hpp"
+#include "habitrpg/data/in_memory_repository.hpp"
+#include "habitrpg/data/migrations.hpp"
+#include "habitrpg/data/sqlite_repository.hpp"
+#include "habitrpg/data/table_descriptor.hpp"
+#include "habitrpg/domain/entities.hpp"
+#include "habitrpg/domain/interaction_flow.hpp"
+#include "habitrpg/domain/reward_engine.hpp"
+
+namespace {
+
+void Expect(bool condition, const std::string& message) {
+  if (!condition) {
+    throw std::runtime_error(message);
+  }
+}
+
+std::string BuildTempDbPath(const std::string& suffix) {
+  const auto temp_dir = std::filesystem::temp_directory_path();
+  const auto file_name = "habitrpg_test_" + suffix + "_" + habitrpg::domain::GenerateStableId("db") + ".sqlite3";
+  return (temp_dir / file_name).string();
+}
+
+habitrpg::domain::ActionUnit BuildAction(const std::string& id, const int priority) {
+  habitrpg::domain::ActionUnit action{};
+  action.id = id;
+  action.parent_id = "habit.cache";
+  action.title = "Cached upsert " + id;
+  action.track_type = habitrpg::domain::TrackType::Life;
+  action.lifecycle_state = habitrpg::domain::LifecycleState::Ready;
+  action.priority_score = priority;
+  return action;
+}
+
+// Writes the same fixture through any backend; used to compare backends row for row.
+template <typename Repository>
+void PopulateParityFixture(Repository& repository) {
+  habitrpg::domain::LearningGoal goal{};
+  goal.id = "goal_parity";
+  goal.title = "Parity";
+  goal.milestone = "Milestone";
+  goal.confidence_level = 2;
+  goal.created_at = "2026-02-19T00:00:00Z";
+  repository.UpsertLearningGoal(goal);
+  goal.title = "Parity renamed";
+  goal.created_at = "2026-02-20T00:00:00Z";
+  repository.UpsertLearningGoal(goal);
+
+  for (int i = 0; i < 6; ++i) {
+    auto action = BuildAction("action_parity_" + std::to_string(5 - i), i - 2);
+    action.track_type = i % 2 == 0 ? habitrpg::domain::TrackType::Life : habitrpg::domain::TrackType::Learning;
+    action.lifecycle_state = i == 0 ? habitrpg::domain::LifecycleState::Completed : action.lifecycle_state;
+    action.completed_at = i == 0 ? "2026-02-19T00:00:01.500Z" : "";
+    repository.UpsertActionUnit(action);
+
+    habitrpg::domain::LearningSession session{};
+    session.id = "session_parity_" + std::to_string(i);
+    session.goal_id = goal.id;
+    session.title = "Session";
+    session.lifecycle_state = habitrpg::domain::LifecycleState::Ready;
+    session.duration_minutes = -5;
+    session.started_at = i % 3 == 0 ? "" : "2026-02-19T00:0" + std::to_string(5 - i) + ":00Z";
+    repository.UpsertLearningSession(session);
+
+    habitrpg::domain::MilestoneCheckpoint checkpoint{};
+    checkpoint.id = "checkpoint_parity_" + std::to_string(i);
+    checkpoint.goal_id = goal.id;
+    checkpoint.learning_session_id = session.id;
+    checkpoint.milestone_key = "milestone";
+    checkpoint.evidence_kind = "note";
+    checkpoint.confidence_level = 9;
+    checkpoint.reward_event_id = "reward_parity_checkpoint_" + std::to_string(i);
+    checkpoint.submitted_at = "2026-02-19T00:00:0" + std::to_string(i % 2) + "Z";
+    checkpoint.created_at = checkpoint.submitted_at;
+    checkpoint.updated_at = checkpoint.submitted_at;
+    repository.UpsertMilestoneCheckpoint(checkpoint);
+  }
+
+  for (int i = 0; i < 30; ++i) {
+    habitrpg::domain::RewardEvent reward_event{};
+    reward_event.id = "reward_parity_" + std::to_string(i);
+    reward_event.source_type = "action_unit";
+    reward_event.source_id = "action_parity_0";
+    reward_event.track_type = i % 3 == 0 ? habitrpg::domain::TrackType::Learning : habitrpg::domain::TrackType::Life;
+    reward_event.xp_delta = i;
+    reward_event.reward_kind = "completion";
+    // Out of order, with shared timestamps, to exercise the (created_at, id) ordering.
+    char created_at[32];
+    std::snprintf(created_at, sizeof(created_at), "2026-02-19T00:00:%02dZ", (i % 7) * 2 % 11);
+    reward_event.created_at = created_at;
+    repository.AppendRewardEvent(reward_event);
+  }
+  habitrpg::domain::RewardEvent duplicate{};
+  duplicate.id = "reward_parity_0";
+  duplicate.xp_delta = 999;
+  duplicate.created_at = "2026-02-19T00:00:00Z";
+  repository.AppendRewardEvent(duplicate);
+
+  habitrpg::domain::UserState user_state{};
+  user_state.total_xp = 42;
+  repository.SaveUserState(user_state);
+}
+
+template <typename Repository>
+std::vector<std::string> ReadRewardPages(const Repository& repository, habitrpg::data::RewardEventPageQuery query) {
+  std::vector<std::string> ids;
+  while (true) {
+    const auto page = repository.ListRewardEventsPage(query);
+    for (const auto& reward_event : page.events) {
+      ids.push_back(reward_event.id + "@" + reward_event.created_at);
+    }
+    if (!page.next.has_value()) {
+      return ids;
+    }
+    query.before = page.next;
+  }
+}
+
+// Rewards and completed sessions spread over two ISO weeks; used by both backends.
+template <typename Repository>
+void PopulateInsightsFixture(Repository& repository) {
+  const char* days[] = {"2026-02-13", "2026-02-15", "2026-02-16", "2026-02-16", "2026-02-18"};
+  int index = 0;
+  for (const char* day : days) {
+    for (const auto track_type : {habitrpg::domain::TrackType::Life, habitrpg::domain::TrackType::Learning}) {
+      habitrpg::domain::RewardEvent reward_event{};
+      reward_event.id = "reward_insights_" + std::to_string(index++);
+      reward_event.source_type = "action_unit";
+      reward_event.source_id = "action_insights";
+      reward_event.track_type = track_type;
+      reward_event.xp_delta = track_type == habitrpg::domain::TrackType::Life ? 10 : 4;
+      reward_event.reward_kind = "completion";
+      reward_event.created_at = std::string(day) + "T23:59:59.999Z";
+      repository.AppendRewardEvent(reward_event);
+    }
+  }
+
+  habitrpg::domain::LearningSession session{};
+  session.goal_id = "goal_insights";
+  session.title = "Session";
+  session.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+
+  session.id = "session_insights_sunday";
+  session.duration_minutes = 30;
+  session.completed_at = "2026-02-15T10:00:00Z";
+  repository.UpsertLearningSession(session);
+
+  session.id = "session_insights_monday";
+  session.duration_minutes = 20;
+  session.completed_at = "2026-02-16T10:00:00Z";
+  repository.UpsertLearningSession(session);
+
+  // Starts active, then completes with a different duration: only the final row counts.
+  session.id = "session_insights_moved";
+  session.lifecycle_state = habitrpg::domain::LifecycleState::Active;
+  session.duration_minutes = 99;
+  session.completed_at = "";
+  repository.UpsertLearningSession(session);
+  session.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+  session.completed_at = "2026-02-15T12:00:00Z";
+  repository.UpsertLearningSession(session);
+  session.duration_minutes = 25;
+  session.completed_at = "2026-02-17T12:00:00Z";
+  repository.UpsertLearningSession(session);
+}
+
+// Old finished work (January), recent finished work (May) and open work; the old
+// checkpointed session must stay live. The snapshot folds the four January rewards.
+template <typename Repository>
+void PopulateArchivalFixture(Repository& repository) {
+  auto action = BuildAction("action_archival_old", 1);
+  action.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+  action.completed_at = "2026-01-05T08:00:00Z";
+  repository.UpsertActionUnit(action);
+  action.id = "action_archival_new";
+  action.completed_at = "2026-05-01T08:00:00Z";
+  repository.UpsertActionUnit(action);
+  repository.UpsertActionUnit(BuildAction("action_archival_open", 2));
+
+  habitrpg::domain::LearningSession session{};
+  session.goal_id = "goal_archival";
+  session.title = "Session";
+  session.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+  const std::pair<const char*, const char*> finished_sessions[] = {
+      {"session_archival_old", "2026-01-10T10:00:00Z"},
+      {"session_archival_new", "2026-05-02T10:00:00Z"},
+      {"session_archival_checkpointed", "2026-01-11T10:00:00Z"},
+  };
+  for (const auto& [id, completed_at] : finished_sessions) {
+    session.id = id;
+    session.duration_minutes = 30;
+    session.completed_at = completed_at;
+    repository.UpsertLearningSession(session);
+  }
+  session.id = "session_archival_active";
+  session.lifecycle_state = habitrpg::domain::LifecycleState::Active;
+  session.completed_at = "";
+  repository.UpsertLearningSession(session);
+
+  habitrpg::domain::MilestoneCheckpoint checkpoint{};
+  checkpoint.id = "checkpoint_archival";
+  checkpoint.goal_id = session.goal_id;
+  checkpoint.learning_session_id = "session_archival_checkpointed";
+  checkpoint.milestone_key = "milestone";
+  checkpoint.evidence_kind = "note";
+  checkpoint.confidence_level = 3;
+  checkpoint.submitted_at = "2026-01-11T11:00:00Z";
+  checkpoint.created_at = checkpoint.submitted_at;
+  checkpoint.updated_at = checkpoint.submitted_at;
+  repository.UpsertMilestoneCheckpoint(checkpoint);
+
+  const habitrpg::domain::RewardEngine reward_engine;
+  for (int i = 0; i < 8; ++i) {
+    habitrpg::domain::RewardEvent reward_event{};
+    reward_event.id = "reward_archival_" + std::to_string(i);
+    reward_event.source_type = "action_unit";
+    reward_event.source_id = "action_archival_old";
+    reward_event.track_type = i % 2 == 0 ? habitrpg::domain::TrackType::Life : habitrpg::domain::TrackType::Learning;
+    reward_event.xp_delta = 5 + i;
+    reward_event.reward_kind = "completion";
+    reward_event.created_at = i < 6 ? "2026-01-1" + std::to_string(i) + "T12:00:00Z" : "2026-06-01T12:00:00Z";
+    repository.AppendRewardEvent(reward_event);
+    if (i == 3) {
+      habitrpg::app::CheckpointUserState(repository, repository, reward_engine, 1);
+    }
+  }
+}
+
+}  // namespace
+
+bool RunStatementCacheReuseTest() {
+  const std::string sqlite_path = BuildTempDbPath("statement_cache");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    const auto before = repository.StatementStats();
+
+    constexpr int kUpsertCount = 64;
+    for (int i = 0; i < kUpsertCount; ++i) {
+      repository.UpsertActionUnit(BuildAction("action_cache_" + std::to_string(i), i));
+    }
+
+    const auto after_upserts = repository.StatementStats();
+    Expect(after_upserts.misses - before.misses == 1, "Repeated upserts should prepare the statement once");
+    Expect(
+        after_upserts.hits - before.hits == kUpsertCount - 1,
+        "Repeated upserts should reuse the cached statement");
+
+    const auto first = repository.FindActionUnitById("action_cache_3");
+    const auto second = repository.FindActionUnitById("action_cache_7");
+    Expect(first.has_value() && first->priority_score == 3, "First lookup should bind its own id");
+    Expect(second.has_value() && second->priority_score == 7, "Reused lookup should not leak prior bindings");
+    Expect(!repository.FindActionUnitById("action_cache_missing").has_value(), "Missing id should not match");
+
+    const auto life_actions = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life);
+    Expect(life_actions.size() == kUpsertCount, "All cached upserts should be persisted");
+
+    const auto after_reads = repository.StatementStats();
+    Expect(after_reads.misses - after_upserts.misses == 2, "Each distinct read query should prepare once");
+    Expect(after_reads.cached_statements >= 3, "Cache should retain every prepared query");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunUnitOfWorkCommitAndRollbackTest() {
+  const std::string sqlite_path = BuildTempDbPath("unit_of_work");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_uow_committed", 10));
+      {
+        habitrpg::data::UnitOfWork nested(repository);
+        repository.UpsertActionUnit(BuildAction("action_uow_nested", 11));
+        nested.Commit();
+      }
+      unit_of_work.Commit();
+    }
+    Expect(repository.FindActionUnitById("action_uow_committed").has_value(), "Committed unit should persist");
+    Expect(repository.FindActionUnitById("action_uow_nested").has_value(), "Nested unit should join the outer commit");
+
+    bool threw = false;
+    try {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_uow_rolled_back", 12));
+      throw std::runtime_error("simulated save failure");
+    } catch (const std::runtime_error&) {
+      threw = true;
+    }
+    Expect(threw, "Simulated failure should propagate");
+    Expect(
+        !repository.FindActionUnitById("action_uow_rolled_back").has_value(),
+        "Abandoned unit of work should roll back");
+
+    bool commit_rejected = false;
+    try {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_uow_poisoned", 13));
+      {
+        habitrpg::data::UnitOfWork nested(repository);
+      }
+      unit_of_work.Commit();
+    } catch (const std::runtime_error&) {
+      commit_rejected = true;
+    }
+    Expect(commit_rejected, "Outer commit should be rejected after an abandoned nested unit");
+    Expect(
+        !repository.FindActionUnitById("action_uow_poisoned").has_value(),
+        "Rejected commit should roll back the outer transaction");
+
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_uow_after_failure", 14));
+      unit_of_work.Commit();
+    }
+    Expect(
+        repository.FindActionUnitById("action_uow_after_failure").has_value(),
+        "Repository should accept new units of work after a rollback");
+
+    // A unit of work on another thread waits for the open one instead of joining it, so
+    // abandoning the first does not take the second thread's rows with it.
+    std::atomic<bool> other_started{false};
+    std::atomic<bool> other_committed{false};
+    std::thread other;
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_uow_owner_abandoned", 15));
+      other = std::thread([&] {
+        other_started.store(true);
+        habitrpg::data::UnitOfWork other_unit(repository);
+        repository.UpsertActionUnit(BuildAction("action_uow_other_thread", 16));
+        other_unit.Commit();
+        other_committed.store(true);
+      });
+      while (!other_started.load()) {
+        std::this_thread::yield();
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      Expect(!other_committed.load(), "A unit of work on another thread should wait for the open one");
+    }
+    other.join();
+    Expect(
+        repository.FindActionUnitById("action_uow_other_thread").has_value() &&
+            !repository.FindActionUnitById("action_uow_owner_abandoned").has_value(),
+        "Each thread's unit of work should commit or roll back only its own rows");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunDirtyTrackingIncrementalSaveTest() {
+  const std::string sqlite_path = BuildTempDbPath("dirty_tracking");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::domain::InteractionFlowService flow_service;
+    habitrpg::domain::RewardEngine reward_engine;
+    habitrpg::app::AppState app_state{};
+
+    for (int i = 0; i < 20; ++i) {
+      app_state.runtime.life_actions.push_back(BuildAction("action_dirty_" + std::to_string(i), 100 + i));
+      habitrpg::app::MarkDirty(&app_state, app_state.runtime.life_actions.back());
+    }
+    const auto goal = flow_service.CreateLearningGoal("Templates", "Write one constrained template");
+    app_state.runtime.learning_goals.push_back(goal);
+    habitrpg::app::MarkDirty(&app_state, goal);
+    app_state.runtime.learning_sessions.push_back(
+        flow_service.CreateLearningSession(goal.id, "Concepts drill", 25, 110, "note", "concepts.md"));
+    habitrpg::app::MarkDirty(&app_state, app_state.runtime.learning_sessions.back());
+    habitrpg::app::MarkMutated(&app_state);
+
+    auto change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(change_set.RowCount() == 24, "First save should write every row plus user state and preferences");
+    Expect(habitrpg::app::WriteChangeSet(repository, change_set) == 24, "First save should report 24 rows");
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+
+    Expect(habitrpg::app::CollectChangeSet(app_state).RowCount() == 0, "Unchanged state should have no dirty rows");
+
+    app_state.ui_state.queue_mode = habitrpg::ui::contracts::TrackFilter::LifeOnly;
+    habitrpg::app::MarkMutated(&app_state);
+    change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(
+        change_set.RowCount() == 1 && change_set.ui_preferences.has_value(),
+        "Queue mode toggle should write one row");
+    Expect(habitrpg::app::WriteChangeSet(repository, change_set) == 1, "Queue mode save should report one row");
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+
+    Expect(
+        flow_service.CompleteActionUnit(
+            "action_dirty_4",
+            &app_state.runtime.life_actions,
+            &reward_engine,
+            &app_state.user_state,
+            &app_state.runtime.reward_events),
+        "Completing an action should succeed");
+    habitrpg::app::MarkDirty(&app_state, app_state.runtime.life_actions[4]);
+    habitrpg::app::MarkMutated(&app_state);
+    change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(change_set.life_actions.size() == 1, "Only the completed action should be dirty");
+    Expect(change_set.reward_events.size() == 1, "Only the new reward event should be appended");
+    Expect(change_set.user_state.has_value(), "Reward should dirty the user state");
+    Expect(habitrpg::app::WriteChangeSet(repository, change_set) == 3, "Completion save should report three rows");
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+    Expect(habitrpg::app::CollectChangeSet(app_state).RowCount() == 0, "Saved completion should leave nothing dirty");
+
+    // Commands mark the rows they touch; starting a unit also dirties the unit it pauses.
+    using habitrpg::domain::contracts::StartUnitCommand;
+    const auto life = habitrpg::domain::TrackType::Life;
+    habitrpg::app::ApplyCommand(StartUnitCommand{"action_dirty_1", life}, flow_service, &app_state);
+    change_set = habitrpg::app::CollectChangeSet(app_state);
+    habitrpg::app::WriteChangeSet(repository, change_set);
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+    habitrpg::app::ApplyCommand(StartUnitCommand{"action_dirty_2", life}, flow_service, &app_state);
+    change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(
+        change_set.life_actions.size() == 2 && change_set.learning_sessions.empty(),
+        "Starting a unit should dirty it and the unit it paused, and nothing else");
+    habitrpg::app::WriteChangeSet(repository, change_set);
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+    Expect(
+        repository.FindActionUnitById("action_dirty_1")->lifecycle_state == habitrpg::domain::LifecycleState::Paused,
+        "The paused unit should be saved");
+
+    const auto stored = repository.FindActionUnitById("action_dirty_4");
+    Expect(stored.has_value(), "Completed action should be stored");
+    Expect(stored->lifecycle_state == habitrpg::domain::LifecycleState::Completed, "Stored action should be completed");
+    Expect(repository.ListRewardEventsByTrack(habitrpg::domain::TrackType::Life).size() == 1, "One reward stored");
+    Expect(
+        repository.LoadUiPreferences().queue_mode == habitrpg::ui::contracts::TrackFilter::LifeOnly,
+        "Queue mode should be saved");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunPersistenceWorkerWriteBehindTest() {
+  const std::string sqlite_path = BuildTempDbPath("persistence_worker");
+
+  {
+    habitrpg::app::AppState app_state{};
+    habitrpg::app::PersistenceWorker worker(sqlite_path);
+
+    size_t submitted = 0;
+    for (int i = 0; i < 8; ++i) {
+      app_state.runtime.life_actions.push_back(BuildAction("action_worker_" + std::to_string(i), 100 + i));
+      habitrpg::app::MarkDirty(&app_state, app_state.runtime.life_actions.back());
+      habitrpg::app::MarkMutated(&app_state);
+      auto change_set = habitrpg::app::CollectChangeSet(app_state);
+      habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+      worker.Submit(std::move(change_set));
+      ++submitted;
+    }
+    worker.Flush();
+
+    size_t coalesced = 0;
+    for (auto& result : worker.PollResults()) {
+      Expect(result.ok, "Worker writes should succeed: " + result.error);
+      coalesced += result.coalesced_change_sets;
+      habitrpg::app::ApplyPersistenceResult(&app_state, std::move(result));
+    }
+    Expect(coalesced == submitted, "Every submitted change set should be covered by a result");
+    Expect(app_state.persisted_revision == app_state.mutation_revision, "Flushed results should reach latest revision");
+    Expect(!app_state.save_error_pending_retry, "Successful writes should not leave a pending retry");
+
+    habitrpg::data::SqliteRepository reader(sqlite_path);
+    Expect(
+        reader.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size() == 8,
+        "Worker should persist all actions through its own connection");
+
+    app_state.runtime.life_actions[3].priority_score = 999;
+    habitrpg::app::MarkDirty(&app_state, app_state.runtime.life_actions[3]);
+    habitrpg::app::MarkMutated(&app_state);
+    auto change_set = habitrpg::app::CollectChangeSet(app_state);
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+    Expect(habitrpg::app::CollectChangeSet(app_state).RowCount() == 0, "Submitted rows are optimistically clean");
+
+    habitrpg::app::PersistenceResult failed{};
+    failed.revision = change_set.revision;
+    failed.error = "disk I/O error";
+    failed.failed_change_set = std::move(change_set);
+    habitrpg::app::ApplyPersistenceResult(&app_state, std::move(failed));
+    Expect(app_state.save_error_pending_retry, "Failed write should request a retry");
+    Expect(app_state.last_save_error == "disk I/O error", "Failed write should surface its error");
+    Expect(app_state.persisted_revision != app_state.mutation_revision, "Failed write should not advance revision");
+    Expect(
+        habitrpg::app::CollectChangeSet(app_state).life_actions.size() == 1,
+        "Failed rows should be dirty again for the retry");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunWalReadPoolConcurrentReadsTest() {
+  const std::string sqlite_path = BuildTempDbPath("wal_read_pool");
+
+  {
+    habitrpg::data::SqliteRepositoryOptions options{};
+    options.enable_wal = true;
+    options.read_connections = 2;
+    habitrpg::data::SqliteRepository repository(sqlite_path, options);
+    Expect(repository.ReadConnectionCount() == 2, "WAL mode should open the requested read connections");
+
+    sqlite3* probe = nullptr;
+    Expect(sqlite3_open_v2(sqlite_path.c_str(), &probe, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK, "Probe open");
+    sqlite3_stmt* journal = nullptr;
+    sqlite3_prepare_v2(probe, "PRAGMA journal_mode;", -1, &journal, nullptr);
+    const bool is_wal = sqlite3_step(journal) == SQLITE_ROW &&
+                        std::string(reinterpret_cast<const char*>(sqlite3_column_text(journal, 0))) == "wal";
+    sqlite3_finalize(journal);
+    sqlite3_close(probe);
+    Expect(is_wal, "Database should be in WAL journal mode");
+
+    for (int i = 0; i < 50; ++i) {
+      repository.UpsertActionUnit(BuildAction("action_wal_" + std::to_string(i), 100));
+    }
+
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_wal_pending", 100));
+      Expect(
+          repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size() == 51,
+          "Reads inside the writer's unit of work should see its uncommitted rows");
+
+      size_t other_thread_count = 0;
+      std::thread reader([&] {
+        other_thread_count = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size();
+      });
+      reader.join();
+      Expect(other_thread_count == 50, "Pooled readers should see the last committed snapshot without blocking");
+      unit_of_work.Commit();
+    }
+
+    std::atomic<bool> writing{true};
+    std::atomic<int> failures{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+      readers.emplace_back([&] {
+        size_t last_count = 0;
+        while (writing.load()) {
+          const size_t count = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size();
+          if (count < last_count || count < 51 || count > 101) {
+            failures.fetch_add(1);
+          }
+          last_count = count;
+        }
+      });
+    }
+
+    for (int i = 0; i < 50; ++i) {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_wal_concurrent_" + std::to_string(i), 100));
+      unit_of_work.Commit();
+    }
+    writing.store(false);
+    for (auto& reader : readers) {
+      reader.join();
+    }
+
+    Expect(failures.load() == 0, "Concurrent reads should only observe committed, monotonically growing snapshots");
+    Expect(
+        repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size() == 101,
+        "All concurrent writes should be visible after they commit");
+
+    {
+      // With every pooled connection busy, a read from another thread opens a temporary
+      // read-only connection instead of borrowing the writer mid-transaction.
+      habitrpg::domain::LearningSession session{};
+      session.id = "session_wal_pool";
+      session.goal_id = "goal_wal_pool";
+      session.title = "Pool";
+      session.duration_minutes = 25;
+      repository.UpsertLearningSession(session);
+
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_wal_exhausted", 100));
+      std::vector<size_t> nested_counts;
+      std::thread reader([&] {
+        repository.VisitLearningSessions([&](const habitrpg::domain::LearningSession&) {
+          repository.VisitLearningSessions([&](const habitrpg::domain::LearningSession&) {
+            nested_counts.push_back(repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size());
+            return true;
+          });
+          return true;
+        });
+      });
+      reader.join();
+      unit_of_work.Commit();
+      Expect(
+          nested_counts == std::vector<size_t>{101},
+          "Reads with the pool exhausted should not see another thread's uncommitted rows");
+      Expect(repository.ReadConnectionCount() == 2, "Temporary read connections should not join the pool");
+    }
+  }
+
+  const std::string journal_path = BuildTempDbPath("wal_read_pool_journal");
+  {
+    // Without a pool, a read from another thread waits for the open unit of work rather
+    // than running inside it.
+    habitrpg::data::SqliteRepository repository(journal_path);
+    std::atomic<bool> read_done{false};
+    size_t other_thread_count = 0;
+    std::thread reader;
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_journal_pending", 100));
+      reader = std::thread([&] {
+        other_thread_count = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size();
+        read_done.store(true);
+      });
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      Expect(!read_done.load(), "A read on the shared writer should wait for another thread's unit of work");
+    }
+    reader.join();
+    Expect(other_thread_count == 0, "A read should not see rows from a unit of work that rolled back");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(journal_path, remove_error);
+  std::filesystem::remove(sqlite_path, remove_error);
+  std::filesystem::remove(sqlite_path + "-wal", remove_error);
+  std::filesystem::remove(sqlite_path + "-shm", remove_error);
+  return true;
+}
+
+bool RunRepositoryStreamingVisitorsTest() {
+  const std::string sqlite_path = BuildTempDbPath("streaming_visitors");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::domain::InteractionFlowService flow_service;
+
+    for (int i = 0; i < 10; ++i) {
+      habitrpg::domain::RewardEvent reward_event{};
+      reward_event.id = "reward_stream_" + std::to_string(i);
+      reward_event.source_type = "action_unit";
+      reward_event.source_id = "action_stream_" + std::to_string(i);
+      reward_event.track_type = habitrpg::domain::TrackType::Life;
+      reward_event.xp_delta = 10 + i;
+      reward_event.reward_kind = "completion";
+      reward_event.created_at = "2026-02-19T00:00:0" + std::to_string(i) + "Z";
+      repository.AppendRewardEvent(reward_event);
+    }
+
+    const auto goal = flow_service.CreateLearningGoal("Streaming", "Visit rows without materializing");
+    repository.UpsertLearningGoal(goal);
+    for (int i = 0; i < 4; ++i) {
+      repository.UpsertLearningSession(
+          flow_service.CreateLearningSession(goal.id, "Session " + std::to_string(i), 25, 100, "note", "n.md"));
+    }
+
+    int xp_total = 0;
+    repository.VisitRewardEventsByTrack(
+        habitrpg::domain::TrackType::Life,
+        [&xp_total](const habitrpg::domain::RewardEvent& reward_event) {
+          xp_total += reward_event.xp_delta;
+          return true;
+        });
+    int listed_total = 0;
+    for (const auto& reward_event : repository.ListRewardEventsByTrack(habitrpg::domain::TrackType::Life)) {
+      listed_total += reward_event.xp_delta;
+    }
+    Expect(xp_total == listed_total && xp_total == 145, "Folding the visitor should match the materialized list");
+
+    std::vector<std::string> first_ids;
+    repository.VisitRewardEventsByTrack(
+        habitrpg::domain::TrackType::Life,
+        [&first_ids](const habitrpg::domain::RewardEvent& reward_event) {
+          first_ids.push_back(reward_event.id);
+          return first_ids.size() < 3;
+        });
+    Expect(first_ids.size() == 3, "Returning false should stop the scan");
+    Expect(first_ids.front() == "reward_stream_0", "Visitor should follow the list ordering");
+
+    size_t visited_sessions = 0;
+    repository.VisitLearningSessions([&visited_sessions](const habitrpg::domain::LearningSession&) {
+      ++visited_sessions;
+      return true;
+    });
+    Expect(visited_sessions == repository.ListLearningSessions().size(), "Session visitor should see every row");
+
+    size_t visited_checkpoints = 0;
+    repository.VisitMilestoneCheckpoints([&visited_checkpoints](const habitrpg::domain::MilestoneCheckpoint&) {
+      ++visited_checkpoints;
+      return true;
+    });
+    Expect(visited_checkpoints == 0, "Checkpoint visitor should handle an empty table");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunRewardLedgerKeysetPaginationTest() {
+  const std::string sqlite_path = BuildTempDbPath("reward_keyset");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    const size_t interned = habitrpg::domain::IdInterner::Instance().Size();
+    for (int i = 0; i < 50; ++i) {
+      habitrpg::domain::RewardEvent reward_event{};
+      char id[32];
+      std::snprintf(id, sizeof(id), "reward_page_%02d", i);
+      char created_at[32];
+      // Pairs of events share a timestamp so the id tie-break is exercised.
+      std::snprintf(created_at, sizeof(created_at), "2026-02-19T00:00:%02dZ", i / 2);
+      reward_event.id = id;
+      reward_event.source_type = "action_unit";
+      reward_event.source_id = "action_page";
+      reward_event.track_type =
+          i % 2 == 0 ? habitrpg::domain::TrackType::Life : habitrpg::domain::TrackType::Learning;
+      reward_event.xp_delta = 10;
+      reward_event.reward_kind = "completion";
+      reward_event.created_at = created_at;
+      repository.AppendRewardEvent(reward_event);
+    }
+
+    std::vector<std::string> paged_ids;
+    habitrpg::data::RewardEventPageQuery query{};
+    query.page_size = 7;
+    while (true) {
+      const auto page = repository.ListRewardEventsPage(query);
+      for (const auto& reward_event : page.events) {
+        paged_ids.push_back(reward_event.id);
+      }
+      if (!page.next.has_value()) {
+        break;
+      }
+      query.before = page.next;
+    }
+    Expect(paged_ids.size() == 50, "Keyset paging should visit every reward exactly once");
+    Expect(paged_ids.front() == "reward_page_49" && paged_ids.back() == "reward_page_00", "Pages are newest first");
+    for (size_t i = 1; i < paged_ids.size(); ++i) {
+      Expect(paged_ids[i - 1] > paged_ids[i], "Keyset paging should be strictly descending without duplicates");
+    }
+    Expect(
+        habitrpg::domain::IdInterner::Instance().Size() == interned,
+        "Appending and paging the reward ledger should not intern its ids");
+
+    habitrpg::data::RewardEventPageQuery life_query{};
+    life_query.track_type = habitrpg::domain::TrackType::Life;
+    life_query.created_from = "2026-02-19T00:00:10Z";
+    life_query.created_until = "2026-02-19T00:00:20Z";
+    life_query.page_size = 100;
+    const auto life_page = repository.ListRewardEventsPage(life_query);
+    Expect(life_page.events.size() == 10, "Track and time-range filters should combine");
+    Expect(!life_page.next.has_value(), "A short final page should not carry a cursor");
+
+    habitrpg::app::AppState app_state{};
+    habitrpg::app::LoadRecentRewardEvents(repository, &app_state, 10);
+    Expect(app_state.runtime.reward_events.size() == 10, "Startup should load only the bounded recent window");
+    Expect(app_state.runtime.reward_events.back().id == "reward_page_49", "Recent window should be oldest first");
+    Expect(habitrpg::app::HasOlderRewardEvents(app_state), "Older history should remain available");
+    Expect(habitrpg::app::LoadOlderRewardEvents(repository, &app_state, 100) == 40, "Older page should load the rest");
+    Expect(app_state.runtime.older_reward_events.front().id == "reward_page_39", "Older history is newest first");
+    Expect(!habitrpg::app::HasOlderRewardEvents(app_state), "History should be exhausted");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunInMemoryRepositoryParityTest() {
+  const std::string sqlite_path = BuildTempDbPath("in_memory_parity");
+  const std::string snapshot_path = BuildTempDbPath("in_memory_snapshot");
+
+  {
+    habitrpg::data::SqliteRepository sqlite_repository(sqlite_path);
+    habitrpg::data::InMemoryRepository memory_repository;
+    PopulateParityFixture(sqlite_repository);
+    PopulateParityFixture(memory_repository);
+
+    const auto expect_same = [&](const habitrpg::data::InMemoryRepository& memory, const std::string& label) {
+      for (const auto track_type : {habitrpg::domain::TrackType::Life, habitrpg::domain::TrackType::Learning}) {
+        Expect(
+            memory.ListActionUnitsByTrack(track_type) == sqlite_repository.ListActionUnitsByTrack(track_type),
+            label + ": action units should match");
+        Expect(
+            memory.ListRewardEventsByTrack(track_type) == sqlite_repository.ListRewardEventsByTrack(track_type),
+            label + ": per-track rewards should match");
+      }
+      Expect(memory.ListLearningGoals() == sqlite_repository.ListLearningGoals(), label + ": goals should match");
+      Expect(
+          memory.ListLearningSessionsByGoal("goal_parity") ==
+              sqlite_repository.ListLearningSessionsByGoal("goal_parity"),
+          label + ": sessions by goal should match");
+      Expect(
+          memory.ListLearningSessions() == sqlite_repository.ListLearningSessions(),
+          label + ": session scan should match");
+      Expect(
+          memory.ListMilestoneCheckpointsByGoal("goal_parity") ==
+              sqlite_repository.ListMilestoneCheckpointsByGoal("goal_parity"),
+          label + ": checkpoints should match");
+      Expect(memory.LoadUserState() == sqlite_repository.LoadUserState(), label + ": user state should match");
+
+      habitrpg::data::RewardEventPageQuery query{};
+      query.page_size = 4;
+      Expect(
+          ReadRewardPages(memory, query) == ReadRewardPages(sqlite_repository, query),
+          label + ": reward pages should match");
+      query.track_type = habitrpg::domain::TrackType::Life;
+      query.created_from = "2026-02-19T00:00:01Z";
+      query.created_until = "2026-02-19T00:00:11Z";
+      Expect(
+          ReadRewardPages(memory, query) == ReadRewardPages(sqlite_repository, query),
+          label + ": filtered reward pages should match");
+    };
+    expect_same(memory_repository, "direct");
+
+    Expect(!memory_repository.FindHabitById("missing_habit").has_value(), "Unknown ids should not be found");
+    Expect(
+        memory_repository.FindActionUnitById("action_parity_0") ==
+            sqlite_repository.FindActionUnitById("action_parity_0"),
+        "Point lookups should match");
+
+    bool rejected = false;
+    try {
+      auto action = BuildAction("action_parity_bad", 1);
+      action.started_at = "yesterday";
+      memory_repository.UpsertActionUnit(action);
+    } catch (const std::invalid_argument&) {
+      rejected = true;
+    }
+    Expect(rejected, "In-memory writes should reject unparseable timestamps like SQLite");
+
+    memory_repository.SaveSnapshot(snapshot_path);
+    habitrpg::data::InMemoryRepository restored;
+    restored.LoadSnapshot(snapshot_path);
+    expect_same(restored, "snapshot");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  std::filesystem::remove(snapshot_path, remove_error);
+  return true;
+}
+
+bool RunUserStateLedgerSnapshotsTest() {
+  const std::string sqlite_path = BuildTempDbPath("user_state_ledger");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    const habitrpg::domain::RewardEngine reward_engine;
+    habitrpg::domain::UserState expected{};
+    expected.recovery_tokens = 1;
+
+    size_t snapshots_written = 0;
+    for (int batch = 0; batch < 5; ++batch) {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      for (int i = 0; i < 50; ++i) {
+        habitrpg::domain::RewardEvent reward_event{};
+        reward_event.id = "reward_ledger_" + std::to_string(batch) + "_" + std::to_string(i);
+        reward_event.source_type = "action_unit";
+        reward_event.source_id = "action_ledger";
+        reward_event.track_type =
+            i % 4 == 0 ? habitrpg::domain::TrackType::Learning : habitrpg::domain::TrackType::Life;
+        reward_event.xp_delta = 3 + i % 5;
+        reward_event.reward_kind = "completion";
+        reward_event.created_at = "2026-02-19T00:00:00Z";
+        repository.AppendRewardEvent(reward_event);
+        reward_engine.ApplyReward(reward_event, &expected);
+      }
+      repository.SaveUserState(expected);
+      if (habitrpg::app::CheckpointUserState(repository, repository, reward_engine, 100)) {
+        ++snapshots_written;
+      }
+      unit_of_work.Commit();
+    }
+    Expect(snapshots_written == 2, "A snapshot should be written every 100 ledger events");
+
+    const auto snapshot = repository.LoadLatestUserStateSnapshot();
+    Expect(snapshot.has_value() && snapshot->through_sequence == 200, "Latest snapshot should fold through event 200");
+
+    auto replay = habitrpg::app::ReplayUserState(repository, repository, reward_engine);
+    Expect(replay.replayed_events == 50, "Replay should only fold events after the latest snapshot");
+    Expect(replay.through_sequence == 250, "Replay should reach the ledger head");
+    Expect(replay.user_state == expected, "Snapshot plus replay should equal the full fold");
+    Expect(!replay.cached_row_stale, "A consistent user_state row should not be reported stale");
+
+    auto drifted = expected;
+    drifted.total_xp += 40;
+    drifted.level += 1;
+    repository.SaveUserState(drifted);
+    replay = habitrpg::app::ReplayUserState(repository, repository, reward_engine);
+    Expect(replay.user_state == expected, "The ledger should win over a drifted user_state row");
+    Expect(replay.cached_row_stale, "A drifted user_state row should be reported stale");
+
+    habitrpg::data::InMemoryRepository memory;
+    memory.LoadSnapshot(sqlite_path);
+    const auto memory_replay = habitrpg::app::ReplayUserState(memory, memory, reward_engine);
+    Expect(memory_replay.replayed_events == 250, "Without a snapshot the whole ledger is replayed");
+    Expect(memory_replay.user_state == expected, "Both backends should rebuild the same state");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunInsightsRollupsTest() {
+  const std::string sqlite_path = BuildTempDbPath("insights_rollups");
+
+  {
+    habitrpg::data::SqliteRepository sqlite_repository(sqlite_path);
+    habitrpg::data::InMemoryRepository memory_repository;
+    PopulateInsightsFixture(sqlite_repository);
+    PopulateInsightsFixture(memory_repository);
+
+    const auto daily_xp = sqlite_repository.ListDailyXp("2026-02-14", "2026-02-18");
+    Expect(daily_xp.size() == 2, "Daily XP should cover only active days inside the range");
+    Expect(
+        daily_xp[1] == habitrpg::data::DailyXpPoint{"2026-02-16", 20, 8, 4},
+        "Daily XP should sum both events on the same day per track");
+    Expect(sqlite_repository.ListDailyXp("", "").size() == 4, "Empty bounds should be unbounded");
+
+    const auto minutes = sqlite_repository.ListDailyLearningMinutes("", "");
+    Expect(minutes.size() == 3, "Moving a session out of a day should drop that day");
+    Expect(
+        minutes[0] == habitrpg::data::LearningMinutesPoint{"2026-02-15", 30, 1},
+        "Superseded session versions should be retracted from the rollup");
+    Expect(
+        minutes[2] == habitrpg::data::LearningMinutesPoint{"2026-02-17", 25, 1},
+        "The latest session version should count on its completion day");
+
+    const auto weekly = sqlite_repository.ListWeeklyLearningMinutes("", "");
+    Expect(weekly.size() == 2, "Sunday and Monday should fall into different weeks");
+    Expect(
+        weekly[0] == habitrpg::data::LearningMinutesPoint{"2026-02-09", 30, 1} &&
+            weekly[1] == habitrpg::data::LearningMinutesPoint{"2026-02-16", 45, 2},
+        "Weeks should start on Monday");
+
+    Expect(
+        sqlite_repository.LoadTrackXpTotals() == habitrpg::data::TrackXpTotals{50, 20, 10},
+        "Track totals should sum all rollup days");
+
+    Expect(memory_repository.ListDailyXp("", "") == sqlite_repository.ListDailyXp("", ""), "Backends agree: xp");
+    Expect(
+        memory_repository.ListDailyLearningMinutes("", "") == minutes &&
+            memory_repository.ListWeeklyLearningMinutes("", "") == weekly,
+        "Backends agree: learning minutes");
+    Expect(
+        memory_repository.LoadTrackXpTotals() == sqlite_repository.LoadTrackXpTotals(),
+        "Backends agree: totals");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunOnlineBackupServiceTest() {
+  const std::string sqlite_path = BuildTempDbPath("online_backup");
+  const auto backup_directory =
+      std::filesystem::temp_directory_path() / ("habitrpg_test_backups_" + habitrpg::domain::GenerateStableId("dir"));
+
+  Expect(
+      habitrpg::app::BackupFileName(1771459200123) == "habitrpg-backup-20260219T000000123Z.sqlite3",
+      "Backup names should embed a sortable UTC timestamp");
+
+  {
+    habitrpg::data::SqliteRepositoryOptions options{};
+    options.enable_wal = true;
+    options.read_connections = 0;
+    habitrpg::data::SqliteRepository repository(sqlite_path, options);
+    for (int i = 0; i < 50; ++i) {
+      repository.UpsertActionUnit(BuildAction("action_backup_" + std::to_string(i), i));
+    }
+
+    habitrpg::app::BackupSchedule schedule{};
+    schedule.directory = backup_directory.string();
+    schedule.startup_delay = std::chrono::hours(24);
+    schedule.keep_latest = 2;
+    schedule.copy_options.pages_per_step = 1;
+    schedule.copy_options.step_pause = std::chrono::milliseconds(1);
+    habitrpg::app::BackupService service(sqlite_path, schedule);
+
+    const auto wait_for_result = [&service]() {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+      while (std::chrono::steady_clock::now() < deadline) {
+        auto results = service.PollResults();
+        if (!results.empty()) {
+          return results.front();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      }
+      throw std::runtime_error("Backup did not finish in time");
+    };
+
+    // The writer keeps committing while the first backup copies one page per step.
+    std::atomic<bool> writing{true};
+    std::thread writer([&repository, &writing]() {
+      for (int i = 0; writing.load() && i < 2000; ++i) {
+        repository.UpsertActionUnit(BuildAction("action_during_backup_" + std::to_string(i), i));
+      }
+    });
+    service.RequestBackup();
+    const auto first = wait_for_result();
+    writing.store(false);
+    writer.join();
+    Expect(first.ok, "Backup during writes should succeed: " + first.error);
+    Expect(first.pages > 0, "Backup should report copied pages");
+
+    for (int i = 0; i < 2; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      service.RequestBackup();
+      const auto next = wait_for_result();
+      Expect(next.ok, "Repeated backup should succeed: " + next.error);
+    }
+    service.Stop();
+
+    const auto backups = habitrpg::app::ListBackups(backup_directory.string());
+    Expect(backups.size() == 2, "Retention should keep only the newest backups");
+    Expect(!std::filesystem::exists(backups.front().string() + ".partial"), "No partial copy should remain");
+
+    sqlite3* copy = nullptr;
+    Expect(
+        sqlite3_open_v2(backups.front().string().c_str(), &copy, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK,
+        "Backup should open as a database");
+    sqlite3_stmt* check = nullptr;
+    sqlite3_prepare_v2(copy, "PRAGMA integrity_check;", -1, &check, nullptr);
+    const bool intact = sqlite3_step(check) == SQLITE_ROW &&
+                        std::string(reinterpret_cast<const char*>(sqlite3_column_text(check, 0))) == "ok";
+    sqlite3_finalize(check);
+    sqlite3_close(copy);
+    Expect(intact, "Backup should pass integrity_check");
+
+    habitrpg::data::SqliteRepository restored(backups.front().string());
+    Expect(
+        restored.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size() >= 50,
+        "Backup should contain every row committed before it started");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove_all(backup_directory, remove_error);
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunArchivalTest() {
+  const std::string sqlite_path = BuildTempDbPath("archival");
+  const habitrpg::domain::RewardEngine reward_engine;
+  constexpr int64_t kMarch2026PlusHorizonMs = 1780099200000;  // 2026-03-01T00:00:00Z + 90 days
+
+  const auto ledger_ids = [](const habitrpg::data::IRewardRepository& rewards) {
+    std::vector<std::pair<uint64_t, std::string>> ids;
+    rewards.VisitRewardLedgerAfter(0, [&ids](uint64_t sequence, const habitrpg::domain::RewardEvent& reward_event) {
+      ids.emplace_back(sequence, reward_event.id);
+      return true;
+    });
+    return ids;
+  };
+
+  const auto history_ids = [](const auto& repository) {
+    habitrpg::data::RewardEventPageQuery query{};
+    query.page_size = 3;
+    return ReadRewardPages(repository, query);
+  };
+
+  const auto expect_archived = [&](auto& repository, const habitrpg::data::ArchiveSummary& summary) {
+    const auto totals = repository.LoadTrackXpTotals();
+    const auto minutes = repository.ListDailyLearningMinutes("", "");
+    const auto replay = habitrpg::app::ReplayUserState(repository, repository, reward_engine);
+    const auto ledger = ledger_ids(repository);
+
+    Expect(
+        summary == habitrpg::data::ArchiveSummary{1, 1, 4},
+        "Old finished rows and the ledger prefix folded by the snapshot should be archived");
+    Expect(repository.CountArchivedRows() == summary, "Archived counts should match the summary");
+    Expect(
+        !repository.FindActionUnitById("action_archival_old").has_value() &&
+            repository.FindActionUnitById("action_archival_new").has_value() &&
+            repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life).size() == 2,
+        "Only the old completed action should leave the live table");
+    Expect(repository.ListLearningSessions().size() == 3, "Checkpointed and recent sessions should stay live");
+    Expect(
+        repository.ListRewardEventsByTrack(habitrpg::domain::TrackType::Life).size() == 2,
+        "Archived rewards should leave the live reward lists");
+    Expect(
+        repository.HasRewardEvent("reward_archival_0") && repository.HasRewardEvent("reward_archival_7") &&
+            !repository.HasRewardEvent("reward_archival_missing"),
+        "Reward lookups by id should cover live and archived events");
+
+    Expect(repository.LoadTrackXpTotals() == totals, "Archiving should not change the XP totals");
+    Expect(repository.ListDailyLearningMinutes("", "") == minutes, "Archiving should not change learning minutes");
+    Expect(repository.LatestRewardSequence() == 8, "Ledger sequences should not move");
+    Expect(ledger.size() == 8 && ledger.front().first == 1, "The ledger visit should still cover archived events");
+    Expect(ledger_ids(repository) == ledger, "Repeated ledger visits should agree");
+    const auto history = history_ids(repository);
+    Expect(
+        history.size() == 8 && history.back().starts_with("reward_archival_0@") &&
+            std::set<std::string>(history.begin(), history.end()).size() == 8,
+        "Reward history pages should continue into archived events");
+    Expect(
+        habitrpg::app::ReplayUserState(repository, repository, reward_engine).user_state == replay.user_state,
+        "Replay should be unaffected by archiving");
+
+    size_t archived_sessions = 0;
+    repository.VisitArchivedLearningSessions([&archived_sessions](const habitrpg::domain::LearningSession& session) {
+      archived_sessions += session.id == "session_archival_old" ? 1 : 0;
+      return true;
+    });
+    uint64_t last_archived_sequence = 0;
+    repository.VisitArchivedRewardEvents([&](uint64_t sequence, const habitrpg::domain::RewardEvent&) {
+      last_archived_sequence = sequence;
+      return true;
+    });
+    Expect(archived_sessions == 1 && last_archived_sequence == 4, "Archived rows should be visitable");
+
+    auto resurrected = BuildAction("action_archival_old", 9);
+    repository.UpsertActionUnit(resurrected);
+    habitrpg::domain::RewardEvent duplicate{};
+    duplicate.id = "reward_archival_0";
+    duplicate.xp_delta = 999;
+    duplicate.created_at = "2026-07-01T00:00:00Z";
+    repository.AppendRewardEvent(duplicate);
+    Expect(
+        !repository.FindActionUnitById("action_archival_old").has_value() && repository.LatestRewardSequence() == 8 &&
+            repository.LoadTrackXpTotals() == totals,
+        "Archived ids should be final");
+    Expect(
+        repository.ArchiveCompletedBefore("2026-03-01T00:00:00Z").Total() == 0,
+        "Archiving twice with the same horizon should be a no-op");
+  };
+
+  {
+    habitrpg::data::SqliteRepository sqlite_repository(sqlite_path);
+    habitrpg::data::InMemoryRepository memory_repository;
+    PopulateArchivalFixture(sqlite_repository);
+    PopulateArchivalFixture(memory_repository);
+    const auto expected = habitrpg::app::ReplayUserState(sqlite_repository, sqlite_repository, reward_engine);
+
+    expect_archived(sqlite_repository, sqlite_repository.ArchiveCompletedBefore("2026-03-01T00:00:00Z"));
+    expect_archived(
+        memory_repository,
+        habitrpg::app::ArchiveFinishedWork(memory_repository, habitrpg::app::ArchivePolicy{}, kMarch2026PlusHorizonMs));
+
+    // With a snapshot at the head, everything but the newest event may go.
+    habitrpg::app::CheckpointUserState(sqlite_repository, sqlite_repository, reward_engine, 1);
+    Expect(
+        sqlite_repository.ArchiveCompletedBefore("2100-01-01T00:00:00Z") == habitrpg::data::ArchiveSummary{1, 1, 3},
+        "A far horizon should keep only the newest ledger event and checkpointed sessions");
+    Expect(sqlite_repository.LatestRewardSequence() == 8, "The newest ledger event should stay live");
+
+    habitrpg::data::InMemoryRepository restored;
+    restored.LoadSnapshot(sqlite_path);
+    Expect(
+        restored.CountArchivedRows() == sqlite_repository.CountArchivedRows(),
+        "Snapshots should load archived rows into the archive");
+    Expect(
+        restored.LoadTrackXpTotals() == sqlite_repository.LoadTrackXpTotals() &&
+            restored.ListDailyLearningMinutes("", "") == sqlite_repository.ListDailyLearningMinutes("", ""),
+        "Restored rollups should include archived rows");
+    Expect(
+        ledger_ids(restored) == ledger_ids(sqlite_repository) &&
+            history_ids(restored) == history_ids(sqlite_repository) &&
+            habitrpg::app::ReplayUserState(restored, restored, reward_engine).user_state == expected.user_state,
+        "A restored ledger should replay to the same state");
+  }
+
+  {
+    // A ledger visit reads the archive, then the live table. An archival committed from
+    // another connection in between must not make the moved rows disappear from the visit.
+    const std::string concurrent_path = BuildTempDbPath("archival_concurrent");
+    habitrpg::data::SqliteRepositoryOptions wal_options{};
+    wal_options.enable_wal = true;
+    habitrpg::data::SqliteRepository reader(concurrent_path, wal_options);
+    habitrpg::data::SqliteRepository archiver(concurrent_path, wal_options);
+    PopulateArchivalFixture(reader);
+    reader.ArchiveCompletedBefore("2026-03-01T00:00:00Z");
+    habitrpg::app::CheckpointUserState(reader, reader, reward_engine, 1);
+
+    std::vector<uint64_t> sequences;
+    reader.VisitRewardLedgerAfter(0, [&](const uint64_t sequence, const habitrpg::domain::RewardEvent&) {
+      if (sequences.empty()) {
+        Expect(
+            archiver.ArchiveCompletedBefore("2100-01-01T00:00:00Z").reward_events == 3,
+            "The concurrent archival should move live ledger rows");
+      }
+      sequences.push_back(sequence);
+      return true;
+    });
+    Expect(
+        sequences == std::vector<uint64_t>{1, 2, 3, 4, 5, 6, 7, 8},
+        "A ledger visit should see every event once despite a concurrent archival");
+
+    std::error_code remove_error;
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+      std::filesystem::remove(concurrent_path + suffix, remove_error);
+    }
+  }
+
+  {
+    // Without a read pool the visit's snapshot is taken on the writer. A unit of work from
+    // another thread waits for it instead of failing inside it or being committed by it.
+    const std::string shared_path = BuildTempDbPath("archival_shared_writer");
+    habitrpg::data::SqliteRepository repository(shared_path);
+    PopulateArchivalFixture(repository);
+    std::atomic<bool> writer_started{false};
+    std::atomic<bool> writer_committed{false};
+    std::string writer_error;
+    std::thread writer;
+    repository.VisitRewardLedgerAfter(0, [&](uint64_t, const habitrpg::domain::RewardEvent&) {
+      if (!writer.joinable()) {
+        writer = std::thread([&] {
+          writer_started.store(true);
+          try {
+            habitrpg::data::UnitOfWork unit_of_work(repository);
+            repository.UpsertActionUnit(BuildAction("action_archival_shared_writer", 1));
+            unit_of_work.Commit();
+            writer_committed.store(true);
+          } catch (const std::exception& error) {
+            writer_error = error.what();
+          }
+        });
+        while (!writer_started.load()) {
+          std::this_thread::yield();
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+      return true;
+    });
+    const bool committed_during_visit = writer_committed.load();
+    writer.join();
+    Expect(!committed_during_visit, "A unit of work on another thread should wait for the ledger visit");
+    Expect(
+        writer_error.empty() && repository.FindActionUnitById("action_archival_shared_writer").has_value(),
+        "The waiting unit of work should commit on its own after the visit");
+
+    std::error_code remove_error;
+    std::filesystem::remove(shared_path, remove_error);
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunReadThroughEntityCacheTest() {
+  habitrpg::data::LruCache<int, int> lru(2);
+  lru.Put(1, 10);
+  lru.Put(2, 20);
+  Expect(lru.Get(1) == 10, "LRU should return stored values");
+  lru.Put(3, 30);
+  Expect(!lru.Get(2).has_value() && lru.Get(1) == 10 && lru.Get(3) == 30, "LRU should evict the least recently used");
+  Expect(lru.Stats().evictions == 1 && lru.Stats().entries == 2, "LRU should stay within capacity");
+
+  const std::string sqlite_path = BuildTempDbPath("entity_cache");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::data::CachedLearningRepository learning(repository, 2);
+    habitrpg::data::CachedActionUnitRepository actions(repository);
+
+    habitrpg::domain::LearningGoal goal{};
+    goal.id = "goal_cache";
+    goal.title = "Cached";
+    goal.milestone = "Milestone";
+    goal.confidence_level = 2;
+    goal.created_at = "2026-02-19T00:00:00Z";
+    learning.UpsertLearningGoal(goal);
+
+    const auto first = learning.FindLearningGoalById(goal.id);
+    const auto second = learning.FindLearningGoalById(goal.id);
+    Expect(first.has_value() && first == second, "Cached lookups should return the stored row");
+    Expect(learning.Stats().hits == 1 && learning.Stats().misses == 1, "The second lookup should be a hit");
+
+    goal.title = "Renamed";
+    learning.UpsertLearningGoal(goal);
+    Expect(learning.FindLearningGoalById(goal.id)->title == "Renamed", "Upserts should invalidate the cached row");
+
+    Expect(!learning.FindLearningGoalById("goal_missing").has_value(), "Unknown ids should miss");
+    Expect(!learning.FindLearningGoalById("goal_missing").has_value(), "Unknown ids should stay missing");
+    Expect(learning.Stats().hits == 2 && learning.Stats().misses == 3, "Negative lookups should be cached too");
+
+    learning.FindLearningGoalById("goal_other");
+    Expect(learning.Stats().evictions == 1 && learning.Stats().entries == 2, "The cache should stay bounded");
+
+    const size_t interned = habitrpg::domain::IdInterner::Instance().Size();
+    for (int i = 0; i < 64; ++i) {
+      learning.FindLearningGoalById("goal_cache_probe_" + std::to_string(i));
+    }
+    Expect(
+        habitrpg::domain::IdInterner::Instance().Size() == interned,
+        "Cached misses should not intern the queried ids");
+
+    // Writes that bypass the decorator are invisible until Clear().
+    auto action = BuildAction("action_cache", 3);
+    actions.UpsertActionUnit(action);
+    Expect(actions.FindActionUnitById(action.id)->priority_score == 3, "Actions should be cached");
+    action.priority_score = 4;
+    repository.UpsertActionUnit(action);
+    Expect(actions.FindActionUnitById(action.id)->priority_score == 3, "Bypassing writes should leave the cache stale");
+    actions.Clear();
+    Expect(actions.FindActionUnitById(action.id)->priority_score == 4, "Clear() should drop stale rows");
+    Expect(
+        actions.Stats().hits == 1 && actions.Stats().misses == 2 && actions.Stats().HitRate() * 3 == 1.0,
+        "Hit rate should be hits over lookups");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunBatchUpsertsTest() {
+  const std::string sqlite_path = BuildTempDbPath("batch_upserts");
+
+  std::vector<habitrpg::domain::ActionUnit> actions;
+  std::vector<habitrpg::domain::LearningSession> sessions;
+  std::vector<habitrpg::domain::RewardEvent> reward_events;
+  for (int i = 0; i < 1000; ++i) {
+    actions.push_back(BuildAction("action_batch_" + std::to_string(i), i % 7 - 2));
+
+    habitrpg::domain::LearningSession session{};
+    session.id = "session_batch_" + std::to_string(i);
+    session.goal_id = "goal_batch";
+    session.title = "Session";
+    session.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+    session.duration_minutes = i % 50;
+    session.completed_at = "2026-02-1" + std::to_string(i % 10) + "T08:00:00Z";
+    sessions.push_back(session);
+
+    habitrpg::domain::RewardEvent reward_event{};
+    reward_event.id = "reward_batch_" + std::to_string(i % 900);  // the tail repeats earlier ids
+    reward_event.source_type = "action_unit";
+    reward_event.source_id = actions.back().id;
+    reward_event.track_type = i % 2 == 0 ? habitrpg::domain::TrackType::Life : habitrpg::domain::TrackType::Learning;
+    reward_event.xp_delta = i % 13;
+    reward_event.reward_kind = "completion";
+    reward_event.created_at = session.completed_at;
+    reward_events.push_back(reward_event);
+  }
+
+  {
+    habitrpg::data::SqliteRepository batched(sqlite_path);
+    habitrpg::data::InMemoryRepository single;
+    habitrpg::data::InMemoryRepository memory_batched;
+
+    const auto before = batched.StatementStats();
+    batched.UpsertActionUnits(actions);
+    const auto after = batched.StatementStats();
+    Expect(
+        after.hits + after.misses == before.hits + before.misses + 1,
+        "A batch should lease one statement for all rows");
+    batched.UpsertLearningSessions(sessions);
+    batched.AppendRewardEvents(reward_events);
+    memory_batched.UpsertActionUnits(actions);
+    memory_batched.UpsertLearningSessions(sessions);
+    memory_batched.AppendRewardEvents(reward_events);
+    for (size_t i = 0; i < actions.size(); ++i) {
+      single.UpsertActionUnit(actions[i]);
+      single.UpsertLearningSession(sessions[i]);
+      single.AppendRewardEvent(reward_events[i]);
+    }
+
+    const auto life = habitrpg::domain::TrackType::Life;
+    Expect(batched.ListActionUnitsByTrack(life).size() == 1000, "Every batched action should be stored");
+    Expect(
+        batched.ListActionUnitsByTrack(life) == single.ListActionUnitsByTrack(life) &&
+            memory_batched.ListActionUnitsByTrack(life) == single.ListActionUnitsByTrack(life),
+        "Batched actions should match single-row upserts");
+    Expect(
+        batched.ListLearningSessions() == single.ListLearningSessions() &&
+            memory_batched.ListLearningSessions() == single.ListLearningSessions(),
+        "Batched sessions should match single-row upserts");
+    Expect(batched.LatestRewardSequence() == 900, "Duplicate ids inside a batch should be skipped");
+    Expect(
+        batched.ListRewardEventsByTrack(life) == single.ListRewardEventsByTrack(life) &&
+            memory_batched.LoadTrackXpTotals() == single.LoadTrackXpTotals() &&
+            batched.LoadTrackXpTotals() == single.LoadTrackXpTotals(),
+        "Batched appends should match single-row appends");
+
+    // One bad row rejects the whole batch on both backends.
+    std::vector<habitrpg::domain::ActionUnit> rejected{BuildAction("action_batch_new", 1), actions[0]};
+    rejected[1].started_at = "not a timestamp";
+    for (habitrpg::data::IActionUnitRepository* repository :
+         std::initializer_list<habitrpg::data::IActionUnitRepository*>{&batched, &memory_batched}) {
+      bool threw = false;
+      try {
+        repository->UpsertActionUnits(rejected);
+      } catch (const std::invalid_argument&) {
+        threw = true;
+      }
+      Expect(threw, "An unparseable timestamp should reject the batch");
+      Expect(!repository->FindActionUnitById("action_batch_new").has_value(), "A rejected batch should write nothing");
+    }
+
+    batched.UpsertActionUnits({});
+    Expect(batched.ListActionUnitsByTrack(life).size() == 1000, "An empty batch should be a no-op");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunCommandJournalRecoveryTest() {
+  const std::string sqlite_path = BuildTempDbPath("command_journal");
+  const std::string checkpoint_note = "first line\nsecond \\ line";
+  const std::string completed_at = "2026-03-01T09:00:00Z";
+  habitrpg::domain::InteractionFlowService flow_service;
+  habitrpg::domain::EntityId session_id;
+  std::string created_id;
+  habitrpg::domain::UserState expected_user_state{};
+
+  const habitrpg::app::JournaledCommand checkpoint =
+      habitrpg::domain::contracts::CheckpointLearningSessionCommand{"session_journal", checkpoint_note};
+  const auto decoded = habitrpg::app::DecodeCommand(habitrpg::app::EncodeCommand(checkpoint));
+  Expect(
+      decoded.has_value() &&
+          std::get<habitrpg::domain::contracts::CheckpointLearningSessionCommand>(*decoded).checkpoint_note ==
+              checkpoint_note,
+      "Encoded commands should decode to the same command");
+  Expect(
+      !habitrpg::app::DecodeCommand({0, "command.unknown.v1", "unit_id=a\n", ""}).has_value() &&
+          !habitrpg::app::DecodeCommand({0, "command.start_unit.v2", "unit_id=a\ntrack_type=moon\n", ""}).has_value() &&
+          !habitrpg::app::DecodeCommand({0, "command.start_unit.v2", "no separator", ""}).has_value(),
+      "Unknown or malformed records should not decode");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::app::AppState app_state{};
+    app_state.command_journal = &repository;
+
+    app_state.runtime.life_actions.push_back(BuildAction("action_journal", 120));
+    habitrpg::app::MarkDirty(&app_state, app_state.runtime.life_actions.back());
+    const auto goal = flow_service.CreateLearningGoal("Ranges", "Write one view pipeline");
+    app_state.runtime.learning_goals.push_back(goal);
+    habitrpg::app::MarkDirty(&app_state, goal);
+    app_state.runtime.learning_sessions.push_back(
+        flow_service.CreateLearningSession(goal.id, "Views drill", 25, 110, "note", "views.md"));
+    session_id = app_state.runtime.learning_sessions.back().id;
+    habitrpg::app::MarkDirty(&app_state, app_state.runtime.learning_sessions.back());
+    habitrpg::app::MarkMutated(&app_state);
+    auto change_set = habitrpg::app::CollectChangeSet(app_state);
+    habitrpg::app::WriteChangeSet(repository, change_set);
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+
+    using namespace habitrpg::domain::contracts;
+    const auto life = habitrpg::domain::TrackType::Life;
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CreateLifeActionCommand{"habit.manual", "Stretch", 90}),
+        "Create should apply");
+    created_id = app_state.runtime.life_actions.back().id;
+    Expect(!created_id.empty(), "Dispatch should assign the created action an id");
+    Expect(
+        habitrpg::app::DispatchCommand(&app_state, flow_service, StartUnitCommand{"action_journal", life}),
+        "Start should apply");
+    Expect(app_state.active_unit_id == "action_journal", "Start should make the unit active");
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CompleteActionCommand{"action_journal", life, completed_at}),
+        "Complete should apply");
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CheckpointLearningSessionCommand{session_id, checkpoint_note}),
+        "Checkpoint should apply");
+    // Later commands refer to the created action by the id assigned at dispatch.
+    Expect(
+        habitrpg::app::DispatchCommand(&app_state, flow_service, StartUnitCommand{created_id, life}),
+        "Start of the created action should apply");
+    Expect(
+        habitrpg::app::DispatchCommand(&app_state, flow_service, CompleteActionCommand{created_id, life, completed_at}),
+        "Complete of the created action should apply");
+    Expect(app_state.journaled_through == 6, "Every dispatched command should be journaled");
+    expected_user_state = app_state.user_state;
+    // The process "crashes" here: nothing after the first save reached the tables.
+  }
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::app::AppState app_state{};
+    const habitrpg::domain::RewardEngine reward_engine;
+    app_state.user_state = habitrpg::app::ReplayUserState(repository, repository, reward_engine).user_state;
+    app_state.runtime.life_actions = repository.ListActionUnitsByTrack(habitrpg::domain::TrackType::Life);
+    app_state.runtime.learning_goals = repository.ListLearningGoals();
+    app_state.runtime.learning_sessions = repository.ListLearningSessions();
+    habitrpg::app::ResetPersistedShadow(&app_state);
+    app_state.command_journal = &repository;
+
+    Expect(app_state.runtime.life_actions.size() == 1, "Unsaved commands should not be in the tables");
+    Expect(
+        habitrpg::app::ReplayCommandJournal(repository, flow_service, &app_state) == 6,
+        "Replay should re-apply every journaled command");
+    Expect(app_state.user_state == expected_user_state, "Replay should restore the earned XP");
+    Expect(app_state.runtime.life_actions.size() == 2, "Replay should recreate the new action");
+    const auto created = std::find_if(
+        app_state.runtime.life_actions.begin(),
+        app_state.runtime.life_actions.end(),
+        [&created_id](const habitrpg::domain::ActionUnit& action) { return action.id == created_id; });
+    Expect(
+        created != app_state.runtime.life_actions.end() &&
+            created->lifecycle_state == habitrpg::domain::LifecycleState::Completed,
+        "Replay should recreate the action under its id and complete it");
+    Expect(
+        !habitrpg::app::ApplyCommand(
+            habitrpg::domain::contracts::CreateLifeActionCommand{"habit.manual", "Stretch", 90, created_id},
+            flow_service,
+            &app_state),
+        "A create whose action already exists should not apply twice");
+    const auto completed = std::find_if(
+        app_state.runtime.life_actions.begin(),
+        app_state.runtime.life_actions.end(),
+        [](const habitrpg::domain::ActionUnit& action) { return action.id == "action_journal"; });
+    Expect(
+        completed != app_state.runtime.life_actions.end() &&
+            completed->lifecycle_state == habitrpg::domain::LifecycleState::Completed &&
+            completed->completed_at == completed_at,
+        "Replay should complete the action on the original day");
+    Expect(
+        app_state.runtime.learning_sessions.front().checkpoint_note == checkpoint_note,
+        "Replay should restore the checkpoint note");
+
+    // Saving persists the replayed rows and truncates the journal in the same transaction.
+    auto change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(change_set.journal_through == 6, "The save should cover every replayed command");
+    habitrpg::app::WriteChangeSet(repository, change_set);
+    habitrpg::app::MarkChangeSetPersisted(&app_state, change_set);
+    size_t remaining = 0;
+    repository.VisitCommandsAfter(0, [&remaining](const habitrpg::data::CommandJournalRecord&) {
+      ++remaining;
+      return true;
+    });
+    Expect(remaining == 0, "A save should truncate the commands it covers");
+    Expect(
+        repository.ListRewardEventsByTrack(habitrpg::domain::TrackType::Life).size() == 2,
+        "Rewards should be saved");
+    Expect(habitrpg::app::CollectChangeSet(app_state).journal_through == 0, "Truncation should not repeat");
+
+    Expect(
+        repository.AppendCommand(habitrpg::app::EncodeCommand(checkpoint)) == 7,
+        "Sequences should not be reused after truncation");
+  }
+
+  {
+    // A save holding the write lock makes the journal give up after its own busy timeout
+    // instead of stalling the UI thread; the command still applies.
+    habitrpg::data::SqliteRepository writer(sqlite_path);
+    habitrpg::data::SqliteRepositoryOptions journal_options{};
+    journal_options.busy_timeout_ms = 20;
+    habitrpg::data::SqliteRepository journal(sqlite_path, journal_options);
+    habitrpg::app::AppState app_state{};
+    app_state.command_journal = &journal;
+
+    const habitrpg::data::UnitOfWork save(writer);
+    const auto started = std::chrono::steady_clock::now();
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            habitrpg::domain::contracts::CreateLifeActionCommand{"habit.manual", "Blocked", 50}),
+        "A command should apply while the journal is locked");
+    Expect(
+        std::chrono::steady_clock::now() - started < std::chrono::seconds(1),
+        "A locked journal should not wait for the default busy timeout");
+    Expect(
+        app_state.journaled_through == 0 && !app_state.last_journal_error.empty() &&
+            app_state.unjournaled_revision == app_state.mutation_revision,
+        "A busy append should be reported, not journaled");
+
+    habitrpg::app::PersistenceResult older{};
+    older.ok = true;
+    older.revision = app_state.mutation_revision - 1;
+    habitrpg::app::ApplyPersistenceResult(&app_state, std::move(older));
+    Expect(!app_state.last_journal_error.empty(), "A save from before the command should keep the error shown");
+    habitrpg::app::PersistenceResult covering{};
+    covering.ok = true;
+    covering.revision = app_state.mutation_revision;
+    habitrpg::app::ApplyPersistenceResult(&app_state, std::move(covering));
+    Expect(app_state.last_journal_error.empty(), "A save covering the unjournaled command should clear the error");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunCommandJournalCoversEveryEditTest() {
+  const std::string sqlite_path = BuildTempDbPath("command_journal_edits");
+  const std::string confirmed_at = "2026-03-02T18:30:00Z";
+  habitrpg::domain::InteractionFlowService flow_service;
+  std::string goal_id;
+  std::string session_id;
+  std::string checkpoint_id;
+  habitrpg::domain::UserState expected_user_state{};
+
+  using namespace habitrpg::domain::contracts;
+  const habitrpg::app::JournaledCommand pause = SetUnitLifecycleCommand{
+      "session_a", habitrpg::domain::TrackType::Learning, habitrpg::domain::LifecycleState::Paused};
+  const auto decoded = habitrpg::app::DecodeCommand(habitrpg::app::EncodeCommand(pause));
+  Expect(
+      decoded.has_value() &&
+          std::get<SetUnitLifecycleCommand>(*decoded).lifecycle_state == habitrpg::domain::LifecycleState::Paused &&
+          std::get<SetUnitLifecycleCommand>(*decoded).track_type == habitrpg::domain::TrackType::Learning,
+      "A lifecycle command should decode to the same command");
+  Expect(
+      !habitrpg::app::DecodeCommand(
+           {0, "command.set_unit_lifecycle.v1", "unit_id=a\ntrack_type=life\nlifecycle_state=asleep\n", ""})
+           .has_value(),
+      "An unknown lifecycle state should not decode");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::app::AppState app_state{};
+    app_state.command_journal = &repository;
+    app_state.reward_repository = &repository;
+
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CreateLearningGoalCommand{"Coroutines", "Write one generator"}),
+        "Goal creation should apply");
+    goal_id = app_state.runtime.learning_goals.back().id;
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CreateLearningSessionCommand{goal_id, "Generator drill", 30, 120, "code_snippet", "gen.cpp"}),
+        "Session creation should apply");
+    session_id = app_state.runtime.learning_sessions.back().id;
+    Expect(
+        !habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            CreateLearningSessionCommand{"goal_missing", "Orphan", 30, 120, "code_snippet", ""}),
+        "A session for a missing goal should not apply");
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            SetUnitLifecycleCommand{session_id, habitrpg::domain::TrackType::Learning,
+                                    habitrpg::domain::LifecycleState::Paused}),
+        "Pause should apply");
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            SaveCheckpointCandidateCommand{session_id, "manual_candidate"}),
+        "Saving a candidate should apply");
+    checkpoint_id = app_state.runtime.milestone_checkpoints.back().id;
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            SaveCheckpointCandidateCommand{session_id, "second_look"}) &&
+            app_state.runtime.milestone_checkpoints.size() == 1,
+        "A second save should update the open candidate");
+    Expect(
+        habitrpg::app::DispatchCommand(
+            &app_state,
+            flow_service,
+            ConfirmMilestoneCheckpointCommand{checkpoint_id, confirmed_at}),
+        "Confirmation should apply");
+    // The rejected session is journaled too; it is skipped again on replay.
+    Expect(app_state.journaled_through == 7, "Every edit should be journaled");
+    Expect(!app_state.save_requested, "Journaled edits should not request a save");
+    expected_user_state = app_state.user_state;
+    // The process "crashes" here, before any save.
+  }
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::app::AppState app_state{};
+    app_state.reward_repository = &repository;
+    habitrpg::app::ResetPersistedShadow(&app_state);
+
+    Expect(
+        habitrpg::app::ReplayCommandJournal(repository, flow_service, &app_state) == 6,
+        "Replay should re-apply every edit");
+    Expect(
+        app_state.runtime.learning_goals.size() == 1 && app_state.runtime.learning_goals.front().id == goal_id,
+        "Replay should recreate the goal under its id");
+    Expect(
+        app_state.runtime.learning_sessions.size() == 1 &&
+            app_state.runtime.learning_sessions.front().id == session_id &&
+            app_state.runtime.learning_sessions.front().lifecycle_state == habitrpg::domain::LifecycleState::Paused,
+        "Replay should recreate the session and pause it");
+    Expect(
+        app_state.runtime.milestone_checkpoints.size() == 1 &&
+            app_state.runtime.milestone_checkpoints.front().id == checkpoint_id &&
+            app_state.runtime.milestone_checkpoints.front().candidate_reason == "second_look" &&
+            app_state.runtime.milestone_checkpoints.front().state ==
+                habitrpg::domain::MilestoneCheckpointState::Confirmed &&
+            app_state.runtime.milestone_checkpoints.front().confirmed_at == confirmed_at,
+        "Replay should restore the confirmed checkpoint on its original day");
+    Expect(
+        app_state.runtime.reward_events.size() == 1 && app_state.user_state == expected_user_state,
+        "Replay should credit the milestone reward once");
+
+    auto change_set = habitrpg::app::CollectChangeSet(app_state);
+    Expect(
+        change_set.journal_through == 7 && change_set.learning_goals.size() == 1 &&
+            change_set.learning_sessions.size() == 1 && change_set.milestone_checkpoints.size() == 1,
+        "The compaction save should carry every replayed row");
+  }
+
+  {
+    // Journaled edits wait for the compaction interval; other edits request a save.
+    habitrpg::app::AppState app_state{};
+    const auto now = std::chrono::steady_clock::now();
+    app_state.last_save_submitted_at = now;
+    Expect(!habitrpg::app::SaveDue(app_state, now), "Nothing unsaved should not be due");
+    habitrpg::app::MarkJournaledMutation(&app_state);
+    Expect(!habitrpg::app::SaveDue(app_state, now), "A journaled edit should wait for compaction");
+    Expect(
+        habitrpg::app::SaveDue(app_state, now + habitrpg::app::kCompactionInterval),
+        "A journaled edit should be saved once the interval passes");
+    habitrpg::app::MarkMutated(&app_state);
+    Expect(habitrpg::app::SaveDue(app_state, now), "An unjournaled edit should be saved at once");
+    app_state.save_error_pending_retry = true;
+    Expect(
+        !habitrpg::app::SaveDue(app_state, now + habitrpg::app::kCompactionInterval),
+        "A failed save waiting for retry should not be resubmitted");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunChangeFeedTest() {
+  const std::string sqlite_path = BuildTempDbPath("change_feed");
+
+  {
+    using habitrpg::data::ChangeOperation;
+    using habitrpg::data::ChangeTable;
+    using habitrpg::data::EntityChange;
+
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+    habitrpg::data::CachedActionUnitRepository cached(repository);
+    std::vector<std::vector<EntityChange>> batches;
+    const auto subscription = repository.Changes().Subscribe([&](const std::span<const EntityChange> changes) {
+      batches.emplace_back(changes.begin(), changes.end());
+      cached.ApplyChanges(changes);
+    });
+
+    auto action = BuildAction("action_feed", 100);
+    repository.UpsertActionUnit(action);
+    repository.UpsertActionUnit(action);
+    const EntityChange inserted{ChangeTable::ActionUnits, action.id, ChangeOperation::Insert};
+    Expect(
+        batches.size() == 2 && batches[0] == std::vector<EntityChange>{inserted} &&
+            batches[1].front().operation == ChangeOperation::Update,
+        "Writes outside a unit of work should publish one change each");
+
+    habitrpg::domain::RewardEvent reward_event{};
+    reward_event.id = "reward_feed";
+    reward_event.source_type = "action_unit";
+    reward_event.source_id = action.id;
+    reward_event.xp_delta = 5;
+    reward_event.reward_kind = "completion";
+    reward_event.created_at = "2026-01-01T08:00:00Z";
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.AppendRewardEvent(reward_event);
+      repository.AppendRewardEvent(reward_event);
+      repository.SaveUserState(habitrpg::domain::UserState{});
+      Expect(batches.size() == 2, "Changes inside a unit of work should wait for the commit");
+      unit_of_work.Commit();
+    }
+    Expect(
+        batches.size() == 3 &&
+            batches[2] == std::vector<EntityChange>{
+                              {ChangeTable::RewardEvents, reward_event.id, ChangeOperation::Insert},
+                              {ChangeTable::UserState, {}, ChangeOperation::Update}},
+        "A commit should publish one batch without the skipped duplicate");
+
+    {
+      habitrpg::data::UnitOfWork unit_of_work(repository);
+      repository.UpsertActionUnit(BuildAction("action_feed_rolled_back", 1));
+    }
+    Expect(batches.size() == 3, "A rolled-back unit of work should publish nothing");
+
+    // A write that bypasses the cache decorator still reaches it through the feed.
+    Expect(cached.FindActionUnitById(action.id)->priority_score == 100, "The row should be cached");
+    action.priority_score = 150;
+    action.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+    action.completed_at = "2026-01-01T09:00:00Z";
+    repository.UpsertActionUnit(action);
+    Expect(cached.FindActionUnitById(action.id)->priority_score == 150, "The feed should invalidate the cached row");
+
+    repository.ArchiveCompletedBefore("2026-03-01T00:00:00Z");
+    Expect(
+        batches.back() == std::vector<EntityChange>{{ChangeTable::ActionUnits, action.id, ChangeOperation::Delete}},
+        "Archival should publish the moved rows as deletes");
+    Expect(!cached.FindActionUnitById(action.id).has_value(), "Archived rows should leave the cache");
+
+    repository.Changes().Unsubscribe(subscription);
+    const size_t published = batches.size();
+    repository.UpsertActionUnit(BuildAction("action_feed_unsubscribed", 1));
+    Expect(batches.size() == published && !repository.Changes().HasSubscribers(), "Unsubscribed callbacks should stop");
+
+    // Writers on two threads: every change carries the id and table of the statement that
+    // produced it, and each committed batch holds only its own thread's rows.
+    std::mutex concurrent_mutex;
+    std::vector<std::vector<EntityChange>> concurrent_batches;
+    const auto concurrent = repository.Changes().Subscribe([&](const std::span<const EntityChange> changes) {
+      const std::lock_guard<std::mutex> lock(concurrent_mutex);
+      concurrent_batches.emplace_back(changes.begin(), changes.end());
+    });
+    std::thread unit_writer([&repository] {
+      for (int i = 0; i < 40; ++i) {
+        habitrpg::data::UnitOfWork unit_of_work(repository);
+        repository.UpsertActionUnit(BuildAction("action_feed_unit_" + std::to_string(i), 1));
+        repository.UpsertActionUnit(BuildAction("action_feed_unit_" + std::to_string(i) + "_b", 1));
+        unit_of_work.Commit();
+      }
+    });
+    for (int i = 0; i < 40; ++i) {
+      habitrpg::domain::LearningGoal goal{};
+      goal.id = "goal_feed_single_" + std::to_string(i);
+      goal.title = "Goal";
+      goal.created_at = "2026-01-01T08:00:00Z";
+      repository.UpsertLearningGoal(goal);
+    }
+    unit_writer.join();
+    repository.Changes().Unsubscribe(concurrent);
+
+    size_t unit_batches = 0;
+    size_t single_batches = 0;
+    bool attributed = true;
+    for (const auto& batch : concurrent_batches) {
+      const bool from_unit = batch.front().table == ChangeTable::ActionUnits;
+      unit_batches += from_unit ? 1 : 0;
+      single_batches += from_unit ? 0 : 1;
+      for (const auto& change : batch) {
+        const bool unit_row = change.table == ChangeTable::ActionUnits &&
+                              change.entity_id.starts_with("action_feed_unit_");
+        const bool single_row = change.table == ChangeTable::LearningGoals &&
+                                change.entity_id.starts_with("goal_feed_single_");
+        attributed = attributed && (from_unit ? unit_row && batch.size() == 2 : single_row && batch.size() == 1);
+      }
+    }
+    Expect(
+        attributed && unit_batches == 40 && single_batches == 40,
+        "Concurrent writers should each publish only their own changes");
+
+    // Batches are published after the writer lock is released, so a subscriber may wait on
+    // another thread that writes through the same repository.
+    bool handed_off = false;
+    const auto handoff = repository.Changes().Subscribe([&](const std::span<const EntityChange> changes) {
+      if (changes.front().table != ChangeTable::Quests) {
+        return;
+      }
+      std::thread([&repository] { repository.UpsertActionUnit(BuildAction("action_feed_handoff", 1)); }).join();
+      handed_off = true;
+    });
+    habitrpg::domain::Quest quest{};
+    quest.id = "quest_feed";
+    quest.title = "Quest";
+    quest.created_at = "2026-01-01T08:00:00Z";
+    repository.UpsertQuest(quest);
+    repository.Changes().Unsubscribe(handoff);
+    Expect(
+        handed_off && repository.FindActionUnitById("action_feed_handoff").has_value(),
+        "A subscriber should be able to wait on a write from another thread");
+  }
+
+  {
+    // A one-shot listener unsubscribes itself and subscribes a successor from its callback.
+    using habitrpg::data::ChangeOperation;
+    using habitrpg::data::ChangeTable;
+    using habitrpg::data::EntityChange;
+    habitrpg::data::ChangeFeed feed;
+    const std::vector<EntityChange> batch{{ChangeTable::UserState, {}, ChangeOperation::Update}};
+    int one_shot_calls = 0;
+    int successor_calls = 0;
+    habitrpg::data::ChangeFeed::SubscriptionId one_shot = 0;
+    one_shot = feed.Subscribe([&](const std::span<const EntityChange>) {
+      ++one_shot_calls;
+      feed.Unsubscribe(one_shot);
+      feed.Subscribe([&successor_calls](const std::span<const EntityChange>) { ++successor_calls; });
+    });
+    feed.Publish(batch);
+    feed.Publish(batch);
+    Expect(
+        one_shot_calls == 1 && successor_calls == 1,
+        "Callbacks should be able to unsubscribe and subscribe without deadlocking");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+template <typename Repository>
+void PopulateSearchFixture(Repository& repository) {
+  std::vector<habitrpg::domain::LearningSession> sessions;
+  for (int i = 0; i < 3000; ++i) {
+    habitrpg::domain::LearningSession session{};
+    session.id = "session_search_" + std::to_string(i);
+    session.goal_id = "goal_search";
+    session.title = "Drill " + std::to_string(i);
+    session.duration_minutes = 25;
+    session.checkpoint_note = "Worked through exercise " + std::to_string(i) + " of the ranges chapter";
+    sessions.push_back(std::move(session));
+  }
+  sessions[7].title = "Move semantics";
+  sessions[7].checkpoint_note = "Rvalue references, std::move and the rule of five";
+  sessions[8].checkpoint_note = "Moved on to coroutines next week";
+  repository.UpsertLearningSessions(sessions);
+
+  auto action = BuildAction("action_search_move", 100);
+  action.title = "Refactor the move constructor";
+  repository.UpsertActionUnit(action);
+
+  habitrpg::domain::MilestoneCheckpoint checkpoint{};
+  checkpoint.id = "checkpoint_search";
+  checkpoint.goal_id = "goal_search";
+  checkpoint.learning_session_id = sessions[7].id;
+  checkpoint.milestone_key = "templates";
+  checkpoint.evidence_kind = "snippet";
+  checkpoint.evidence_ref = "concepts/sortable.hpp";
+  checkpoint.confidence_level = 3;
+  checkpoint.candidate_reason = "Wrote a constrained Sortable concept";
+  checkpoint.submitted_at = "2026-02-01T10:00:00Z";
+  checkpoint.created_at = checkpoint.submitted_at;
+  checkpoint.updated_at = checkpoint.submitted_at;
+  repository.UpsertMilestoneCheckpoint(checkpoint);
+}
+
+bool RunFullTextSearchTest() {
+  const std::string sqlite_path = BuildTempDbPath("full_text_search");
+
+  {
+    // Rows written before the index existed are backfilled by the migration.
+    sqlite3* db = nullptr;
+    Expect(sqlite3_open(sqlite_path.c_str(), &db) == SQLITE_OK, "Legacy database should open");
+    habitrpg::data::RunMigrations(db, habitrpg::data::kSchemaVersionV11);
+    Expect(
+        sqlite3_exec(
+            db,
+            "INSERT INTO action_units(id, parent_id, title, track_type, status) "
+            "VALUES('action_search_legacy', 'habit', 'Legacy lambda cleanup', 0, 0);",
+            nullptr,
+            nullptr,
+            nullptr) == SQLITE_OK,
+        "Legacy row should insert");
+    sqlite3_close(db);
+  }
+
+  {
+    habitrpg::data::SqliteRepository sqlite_repository(sqlite_path);
+    habitrpg::data::InMemoryRepository memory_repository;
+    PopulateSearchFixture(sqlite_repository);
+    PopulateSearchFixture(memory_repository);
+
+    const auto legacy = sqlite_repository.Search({"lambda"});
+    Expect(
+        legacy.hits.size() == 1 && legacy.hits.front().entity_id == "action_search_legacy",
+        "The migration should index existing rows");
+
+    for (const habitrpg::data::ISearchRepository* repository :
+         std::initializer_list<const habitrpg::data::ISearchRepository*>{&sqlite_repository, &memory_repository}) {
+      const auto move = repository->Search({"MOVE"});
+      Expect(move.hits.size() == 3 && !move.next_offset.has_value(), "Prefix search should match every mo* word");
+      const auto rank_of = [&move](const std::string& id) {
+        const auto matches = [&id](const auto& hit) { return hit.entity_id == id; };
+        return std::find_if(move.hits.begin(), move.hits.end(), matches) - move.hits.begin();
+      };
+      Expect(
+          rank_of("session_search_7") < rank_of("session_search_8"),
+          "A title and note hit should outrank a note-only hit");
+      Expect(move.hits[rank_of("session_search_8")].snippet.find("[Moved]") == 0, "Snippets should mark the match");
+
+      Expect(repository->Search({"rule five rvalue"}).hits.size() == 1, "All words should be required");
+      Expect(repository->Search({"sortable"}).hits.front().entity_id == "checkpoint_search", "Evidence is indexed");
+      Expect(
+          repository->Search({"move", habitrpg::data::SearchEntityKind::ActionUnit}).hits.size() == 1,
+          "The kind filter should apply");
+      Expect(repository->Search({"  \"* "}).hits.empty(), "Queries without words should match nothing");
+
+      habitrpg::data::SearchQuery query{"ranges chapter"};
+      query.page_size = 1000;
+      size_t total = 0;
+      size_t pages = 0;
+      while (true) {
+        const auto page = repository->Search(query);
+        total += page.hits.size();
+        ++pages;
+        if (!page.next_offset.has_value()) {
+          break;
+        }
+        query.offset = *page.next_offset;
+      }
+      Expect(total == 2998 && pages == 3, "Pages should cover every hit exactly once");
+    }
+
+    // Edits reindex the row; archival drops it from the index.
+    const auto sessions = sqlite_repository.ListLearningSessions();
+    auto session = *std::find_if(sessions.begin(), sessions.end(), [](const habitrpg::domain::LearningSession& row) {
+      return row.id == "session_search_8";
+    });
+    session.checkpoint_note = "Switched to modules";
+    sqlite_repository.UpsertLearningSession(session);
+    Expect(sqlite_repository.Search({"coroutines"}).hits.empty(), "Old note text should leave the index");
+    Expect(sqlite_repository.Search({"modules"}).hits.size() == 1, "New note text should be indexed");
+
+    session.lifecycle_state = habitrpg::domain::LifecycleState::Completed;
+    session.completed_at = "2026-01-01T00:00:00Z";
+    sqlite_repository.UpsertLearningSession(session);
+    sqlite_repository.ArchiveCompletedBefore("2026-02-01T00:00:00Z");
+    Expect(sqlite_repository.Search({"modules"}).hits.empty(), "Archived rows should leave the index");
+  }
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
+
+bool RunTableDescriptorTest() {
+  using habitrpg::data::Column;
+  using habitrpg::data::TimestampColumn;
+  using habitrpg::domain::LearningSession;
+
+  constexpr auto kSessions =
+      habitrpg::data::DescribeTable(
+          "sessions",
+          Column("id", &LearningSession::id),
+          Column("title", &LearningSession::title),
+          Column("lifecycle_state", &LearningSession::lifecycle_state),
+          Column("duration_minutes", &LearningSession::duration_minutes)
+              .WrittenAs([](const LearningSession& session) { return std::max(session.duration_minutes, 0); }),
+          TimestampColumn("started_at", &LearningSession::started_at).InsertOnly(),
+          TimestampColumn("completed_at", &LearningSession::completed_at))
+          .GuardedByArchive("sessions_archive");
+
+  Expect(
+      kSessions.SelectSql("WHERE id = ?;") ==
+          "SELECT id, title, lifecycle_state, duration_minutes, started_at, completed_at FROM sessions WHERE id = ?;",
+      "Select text should list every column in order");
+  Expect(
+      kSessions.UpsertSql() ==
+          "INSERT INTO sessions(id, title, lifecycle_state, duration_minutes, started_at, completed_at) "
+          "SELECT ?1, ?2, ?3, ?4, ?5, ?6 WHERE NOT EXISTS (SELECT 1 FROM sessions_archive WHERE id = ?1) "
+          "ON CONFLICT(id) DO UPDATE SET title = excluded.title, lifecycle_state = excluded.lifecycle_state, "
+          "duration_minutes = excluded.duration_minutes, completed_at = excluded.completed_at;",
+      "Upsert text should skip the id and insert-only columns");
+
+  sqlite3* db = nullptr;
+  Expect(sqlite3_open(":memory:", &db) == SQLITE_OK, "In-memory database should open");
+  try {
+    Expect(
+        sqlite3_exec(
+            db,
+            "CREATE TABLE sessions(id TEXT PRIMARY KEY, title TEXT, lifecycle_state INTEGER, duration_minutes INTEGER, "
+            "started_at INTEGER, completed_at INTEGER);"
+            "CREATE TABLE sessions_archive(id TEXT PRIMARY KEY);",
+            nullptr,
+            nullptr,
+            nullptr) == SQLITE_OK,
+        "Fixture tables should be created");
+
+    const auto upsert = [&](const LearningSession& session) {
+      const std::string sql = kSessions.UpsertSql();
+      sqlite3_stmt* statement = nullptr;
+      Expect(sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) == SQLITE_OK, "Upsert should prepare");
+      kSessions.Bind(db, statement, session);
+      const int rc = sqlite3_step(statement);
+      sqlite3_finalize(statement);
+      Expect(rc == SQLITE_DONE, "Upsert should run");
+    };
+
+    LearningSession session{};
+    session.id = "session_descriptor";
+    session.title = "Descriptor round trip";
+    session.lifecycle_state = habitrpg::domain::LifecycleState::Active;
+    session.duration_minutes = -15;
+    session.started_at = "2026-03-01T08:00:00.250Z";
+    upsert(session);
+    session.title = "Descriptor round trip, renamed";
+    session.started_at = "2026-03-02T08:00:00Z";
+    upsert(session);
+
+    const std::string sql = kSessions.SelectSql("WHERE id = ?;");
+    sqlite3_stmt* statement = nullptr;
+    Expect(sqlite3_prepare_v2(db, sql.c_str(), -1, &statement, nullptr) == SQLITE_OK, "Select should prepare");
+    sqlite3_bind_text(statement, 1, "session_descriptor", -1, SQLITE_STATIC);
+    Expect(sqlite3_step(statement) == SQLITE_ROW, "Row should exist");
+
+    // Decoding reuses the target's buffers and overwrites every mapped member.
+    LearningSession decoded{};
+    decoded.title.assign(256, 'x');
+    decoded.completed_at = "2026-01-01T00:00:00Z";
+    decoded.checkpoint_note = "unmapped";
+    const auto title_capacity = decoded.title.capacity();
+    kSessions.Decode(statement, &decoded);
+    sqlite3_finalize(statement);
+
+    Expect(decoded.id == session.id && decoded.title == "Descriptor round trip, renamed", "Text columns round trip");
+    Expect(decoded.title.capacity() == title_capacity, "Decoding should reuse the string buffer");
+    Expect(decoded.lifecycle_state == habitrpg::domain::LifecycleState::Active, "Enum columns round trip");
+    Expect(decoded.duration_minutes == 0, "WrittenAs should apply on write");
+    Expect(decoded.started_at == "2026-03-01T08:00:00.250Z", "Insert-only columns keep the first value");
+    Expect(decoded.completed_at.empty(), "NULL timestamps should decode as empty");
+    Expect(decoded.checkpoint_note == "unmapped", "Unmapped members should be left alone");
+  } catch (...) {
+    sqlite3_close(db);
+    throw;
+  }
+  sqlite3_close(db);
+  return true;
+}
+
+bool RunZeroCopyBindingTest() {
+  const std::string sqlite_path = BuildTempDbPath("zero_copy_binding");
+
+  {
+    habitrpg::data::SqliteRepository repository(sqlite_path);
+
+    // Text is bound in place, so every row of a batch must still read back as its own.
+    std::vector<habitrpg::domain::LearningSession> sessions;
+    for (int i = 0; i < 3; ++i) {
+      habitrpg::domain::LearningSession session{};
+      session.id = "session_zero_copy_" + std::to_string(i);
+      session.goal_id = "goal_zero_copy";
+      session.title = "Zero-copy binding row " + std::to_string(i) + " with a title past the SSO limit";
+      session.checkpoint_note = i == 0 ? "" : "Note " + std::to_string(i);
+      sessions.push_back(std::move(session));
+    }
+    sessions[2].artifact_ref = std::string("before\0after", 12);
+    repository.UpsertLearningSessions(sessions);
+
+    const auto stored = repository.ListLearningSessionsByGoal("goal_zero_copy");
+    Expect(stored.size() == sessions.size(), "Every batched row should be stored");
+    for (const auto& session : sessions) {
+      const auto it = std::find_if(stored.begin(), stored.end(), [&session](const auto& row) {
+        return row.id == session.id;
+      });
+      Expect(it != stored.end() && *it == session, "Batched rows should round trip unchanged");
+    }
+
+    habitrpg::data::UiPreferences preferences{};
+    preferences.preset_mode = habitrpg::ui::contracts::PresetMode::Custom;
+    preferences.last_non_custom_preset = habitrpg::ui::contracts::PresetMode::Spark;
+    preferences.queue_mode = habitrpg::ui::contracts::TrackFilter::LearningOnly;
+    preferences.updated_at = "2026-03-01T00:00:00Z";
+    repository.SaveUiPreferences(preferences);
+    Expect(repository.LoadUiPreferences() == preferences, "Enum strings should bind without temporaries");
+  }
+
+  sqlite3* probe = nullptr;
+  Expect(sqlite3_open_v2(sqlite_path.c_str(), &probe, SQLITE_OPEN_READONLY, nullptr) == SQLITE_OK, "Probe open");
+  sqlite3_stmt* statement = nullptr;
+  sqlite3_prepare_v2(
+      probe,
+      "SELECT typeof(checkpoint_note) FROM learning_sessions WHERE id = 'session_zero_copy_0';",
+      -1,
+      &statement,
+      nullptr);
+  const bool is_text = sqlite3_step(statement) == SQLITE_ROW &&
+                       std::string(reinterpret_cast<const char*>(sqlite3_column_text(statement, 0))) == "text";
+  sqlite3_finalize(statement);
+  sqlite3_close(probe);
+  Expect(is_text, "Empty strings should bind as '' rather than NULL");
+
+  std::error_code remove_error;
+  std::filesystem::remove(sqlite_path, remove_error);
+  return true;
+}
@@ -81,7 +81,7 @@ bool RunPresetModeExclusivityAndPersistenceTest() {
   const std::string sqlite_path = BuildTempDbPath("preset_persistence");
   {
     habitrpg::data::SqliteRepository repository(sqlite_path);
-    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionV3, "Expected schema version v3");
+    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionLatest, "Expected latest schema version");
 
     habitrpg::data::UiPreferences preferences{};
     preferences.preset_mode = state.preset_mode;
@@ -183,7 +183,7 @@ bool RunMilestoneCheckpointPromotionIdempotencyTest() {
       3,
       "Reference captured",
       "2026-02-19T00:07:00Z");
-  retry_candidate.reward_event_id = "reward_milestone_" + retry_candidate.id;
+  retry_candidate.reward_event_id = "reward_milestone_" + retry_candidate.id.str();
   checkpoints.push_back(retry_candidate);
 
   reward_events.push_back(reward_engine.BuildMilestoneCheckpointConfirmedReward(
@@ -207,6 +207,33 @@ bool RunMilestoneCheckpointPromotionIdempotencyTest() {
       checkpoints.back().state == habitrpg::domain::MilestoneCheckpointState::Confirmed,
       "Retry candidate should still transition to confirmed");
 
+  // The runtime holds only a recent window of rewards, so a reward stored earlier is found
+  // through the lookup instead of the vector.
+  auto windowed_candidate = flow_service.CreateMilestoneCheckpointCandidate(
+      session,
+      "cpp.move_semantics",
+      "snippet",
+      "examples/move.cpp",
+      4,
+      "Explained moved-from state",
+      "2026-02-19T00:09:00Z");
+  windowed_candidate.reward_event_id = "reward_milestone_" + windowed_candidate.id.str();
+  checkpoints.push_back(windowed_candidate);
+  const auto stored_reward_id = windowed_candidate.reward_event_id;
+  Expect(
+      flow_service.PromoteMilestoneCheckpointToConfirmed(
+          windowed_candidate.id,
+          &checkpoints,
+          &reward_engine,
+          &user_state,
+          &reward_events,
+          [&stored_reward_id](const habitrpg::domain::EntityId& reward_event_id) {
+            return reward_event_id == stored_reward_id;
+          }),
+      "Promotion should confirm when the reward is only in storage");
+  Expect(reward_events.size() == reward_count_before_retry, "A stored reward outside the window should not repeat");
+  Expect(user_state.total_xp == xp_before_retry, "A stored reward outside the window should not add XP");
+
   return true;
 }
 
@@ -214,7 +241,7 @@ bool RunQueueModePersistenceAndFilteringTest() {
   const std::string sqlite_path = BuildTempDbPath("queue_mode_persistence");
   {
     habitrpg::data::SqliteRepository repository(sqlite_path);
-    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionV3, "Expected schema version v3");
+    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionLatest, "Expected latest schema version");
 
     habitrpg::data::UiPreferences preferences = repository.LoadUiPreferences();
     preferences.preset_mode = habitrpg::ui::contracts::PresetMode::Calm;
@@ -27,7 +27,7 @@ bool RunHabitActionRewardRoundtripTest() {
 
   {
     habitrpg::data::SqliteRepository repository(sqlite_path);
-    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionV3, "Expected schema version v3");
+    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionLatest, "Expected latest schema version");
 
     habitrpg::domain::Habit habit{};
     habit.id = habitrpg::domain::GenerateStableId("habit");
@@ -85,7 +85,7 @@ bool RunLearningSessionRewardRoundtripTest() {
 
   {
     habitrpg::data::SqliteRepository repository(sqlite_path);
-    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionV3, "Expected schema version v3");
+    Expect(repository.SchemaVersion() == habitrpg::data::kSchemaVersionLatest, "Expected latest schema version");
 
     habitrpg::domain::LearningGoal goal{};
     goal.id = habitrpg::domain::GenerateStableId("goal");
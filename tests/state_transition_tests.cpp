@@ -91,3 +91,24 @@ bool RunLearningCheckpointLifecycleTest() {
 
   return true;
 }
+
+bool RunEntityIdInterningTest() {
+  const habitrpg::domain::EntityId first("action_interned_1");
+  const habitrpg::domain::EntityId same(std::string("action_interned_1"));
+  const habitrpg::domain::EntityId other("action_interned_2");
+
+  Expect(first == same, "Equal id strings should intern to the same id");
+  Expect(first.key() == same.key(), "Equal id strings should share one key");
+  Expect(first.key() != other.key(), "Distinct id strings should get distinct keys");
+  Expect(&first.str() == &same.str(), "Interned ids should share one string");
+  Expect(first < other, "Id ordering should stay lexicographic");
+  Expect(habitrpg::domain::EntityId().empty(), "Default id should be empty");
+  Expect(habitrpg::domain::EntityId("").key() == habitrpg::domain::kEmptyEntityKey, "Empty text is the empty key");
+  Expect(
+      habitrpg::domain::EntityId::FromKey(other.key()).str() == "action_interned_2",
+      "Keys should map back to their string form");
+
+  const std::string& as_string = first;
+  Expect(as_string == "action_interned_1", "Ids should still read as their external string");
+  return true;
+}
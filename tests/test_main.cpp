@@ -12,9 +12,37 @@ bool RunMixedQueueCompositionTest();
 bool RunQueueModePersistenceAndFilteringTest();
 bool RunSingleActiveConflictResolutionTest();
 bool RunLearningCheckpointLifecycleTest();
+bool RunEntityIdInterningTest();
 bool RunMilestoneCheckpointPromotionIdempotencyTest();
 bool RunPresetModeExclusivityAndPersistenceTest();
 bool RunSchemaMigrationV1ToV3Test();
+bool RunSchemaV4IndexesAvoidScansTest();
+bool RunSchemaV6RowKeyRebuildTest();
+bool RunSchemaV7IntegerEncodingTest();
+bool RunSchemaV9RollupBackfillTest();
+bool RunSchemaMigrationFastPathTest();
+bool RunSchemaV2ChunkedSessionCopyTest();
+bool RunStatementCacheReuseTest();
+bool RunUnitOfWorkCommitAndRollbackTest();
+bool RunDirtyTrackingIncrementalSaveTest();
+bool RunPersistenceWorkerWriteBehindTest();
+bool RunOnlineBackupServiceTest();
+bool RunArchivalTest();
+bool RunReadThroughEntityCacheTest();
+bool RunBatchUpsertsTest();
+bool RunCommandJournalRecoveryTest();
+bool RunCommandJournalCoversEveryEditTest();
+bool RunChangeFeedTest();
+bool RunFullTextSearchTest();
+bool RunTableDescriptorTest();
+bool RunZeroCopyBindingTest();
+bool RunWalReadPoolConcurrentReadsTest();
+bool RunRepositoryStreamingVisitorsTest();
+bool RunRewardLedgerKeysetPaginationTest();
+bool RunInMemoryRepositoryParityTest();
+bool RunUserStateLedgerSnapshotsTest();
+bool RunInsightsRollupsTest();
+bool RunBenchCompareTest();
 
 int main() {
   struct TestCase {
@@ -31,9 +59,37 @@ int main() {
       {"queue_mode_persistence_and_filtering", RunQueueModePersistenceAndFilteringTest},
       {"single_active_conflict_resolution", RunSingleActiveConflictResolutionTest},
       {"learning_checkpoint_lifecycle", RunLearningCheckpointLifecycleTest},
+      {"entity_id_interning", RunEntityIdInterningTest},
       {"milestone_checkpoint_promotion_idempotency", RunMilestoneCheckpointPromotionIdempotencyTest},
       {"preset_mode_exclusivity_and_persistence", RunPresetModeExclusivityAndPersistenceTest},
       {"schema_migration_v1_to_v3", RunSchemaMigrationV1ToV3Test},
+      {"schema_v4_indexes_avoid_scans", RunSchemaV4IndexesAvoidScansTest},
+      {"schema_v6_row_key_rebuild", RunSchemaV6RowKeyRebuildTest},
+      {"schema_v7_integer_encoding", RunSchemaV7IntegerEncodingTest},
+      {"schema_v9_rollup_backfill", RunSchemaV9RollupBackfillTest},
+      {"schema_migration_fast_path", RunSchemaMigrationFastPathTest},
+      {"schema_v2_chunked_session_copy", RunSchemaV2ChunkedSessionCopyTest},
+      {"statement_cache_reuse", RunStatementCacheReuseTest},
+      {"unit_of_work_commit_and_rollback", RunUnitOfWorkCommitAndRollbackTest},
+      {"dirty_tracking_incremental_save", RunDirtyTrackingIncrementalSaveTest},
+      {"persistence_worker_write_behind", RunPersistenceWorkerWriteBehindTest},
+      {"online_backup_service", RunOnlineBackupServiceTest},
+      {"archival_moves_finished_work", RunArchivalTest},
+      {"read_through_entity_cache", RunReadThroughEntityCacheTest},
+      {"batch_upserts_match_single_rows", RunBatchUpsertsTest},
+      {"command_journal_recovery", RunCommandJournalRecoveryTest},
+      {"command_journal_covers_every_edit", RunCommandJournalCoversEveryEditTest},
+      {"change_feed_publishes_commits", RunChangeFeedTest},
+      {"full_text_search", RunFullTextSearchTest},
+      {"table_descriptor_round_trip", RunTableDescriptorTest},
+      {"zero_copy_binding_round_trip", RunZeroCopyBindingTest},
+      {"wal_read_pool_concurrent_reads", RunWalReadPoolConcurrentReadsTest},
+      {"repository_streaming_visitors", RunRepositoryStreamingVisitorsTest},
+      {"reward_ledger_keyset_pagination", RunRewardLedgerKeysetPaginationTest},
+      {"in_memory_repository_parity", RunInMemoryRepositoryParityTest},
+      {"user_state_ledger_snapshots", RunUserStateLedgerSnapshotsTest},
+      {"insights_rollups", RunInsightsRollupsTest},
+      {"bench_compare", RunBenchCompareTest},
   };
 
   int failed_count = 0;